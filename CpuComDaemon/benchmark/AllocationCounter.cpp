@@ -0,0 +1,42 @@
+/*
+ * COPYRIGHT (C) 2024 MITSUBISHI ELECTRIC CORPORATION
+ * ALL RIGHTS RESERVED
+ */
+
+#include "AllocationCounter.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+std::atomic<uint64_t> gAllocations{0};
+}  // namespace
+
+void* operator new(std::size_t size)
+{
+    ++gAllocations;
+    void* p = std::malloc(size == 0 ? 1 : size);
+    if (p == nullptr) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+namespace com {
+namespace mitsubishielectric {
+namespace ahu {
+namespace cpucom {
+namespace impl {
+
+uint64_t allocationCount() { return gAllocations; }
+
+}  // namespace impl
+}  // namespace cpucom
+}  // namespace ahu
+}  // namespace mitsubishielectric
+}  // namespace com
@@ -0,0 +1,29 @@
+/*
+ * COPYRIGHT (C) 2024 MITSUBISHI ELECTRIC CORPORATION
+ * ALL RIGHTS RESERVED
+ */
+
+#ifndef COM_MITSUBISHIELECTRIC_AHU_CPUCOM_ALLOCATIONCOUNTER_H_
+#define COM_MITSUBISHIELECTRIC_AHU_CPUCOM_ALLOCATIONCOUNTER_H_
+
+#include <cstdint>
+
+namespace com {
+namespace mitsubishielectric {
+namespace ahu {
+namespace cpucom {
+namespace impl {
+
+/**
+ * Returns the number of heap allocations made by the process so far.
+ * The benchmarks replace the global operator new to count them.
+ */
+uint64_t allocationCount();
+
+}  // namespace impl
+}  // namespace cpucom
+}  // namespace ahu
+}  // namespace mitsubishielectric
+}  // namespace com
+
+#endif  // COM_MITSUBISHIELECTRIC_AHU_CPUCOM_ALLOCATIONCOUNTER_H_
@@ -0,0 +1,116 @@
+/*
+ * COPYRIGHT (C) 2024 MITSUBISHI ELECTRIC CORPORATION
+ * ALL RIGHTS RESERVED
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "Checksum.h"
+#include "FrameChecksum.h"
+#include "FrameFormat.h"
+
+namespace com {
+namespace mitsubishielectric {
+namespace ahu {
+namespace cpucom {
+namespace impl {
+
+using namespace frame;
+
+namespace {
+
+std::vector<uint8_t> makeBytes(size_t size)
+{
+    std::vector<uint8_t> bytes(size);
+    for (size_t i = 0; i < size; ++i) {
+        bytes[i] = static_cast<uint8_t>(i * 31 + 7);
+    }
+    return bytes;
+}
+
+void reportBytes(benchmark::State& state)
+{
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+}
+
+}  // namespace
+
+// The byte at a time loop both paths of Protocol used before, kept as a baseline
+void BM_CommonChecksum(benchmark::State& state)
+{
+    const std::vector<uint8_t> bytes = makeBytes(state.range(0));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(common::checksum(bytes.begin(), bytes.end()));
+    }
+    reportBytes(state);
+}
+
+void BM_WordChecksum(benchmark::State& state)
+{
+    const std::vector<uint8_t> bytes = makeBytes(state.range(0));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(wordChecksum(bytes.data(), bytes.size()));
+    }
+    reportBytes(state);
+}
+
+void BM_BlockChecksum(benchmark::State& state)
+{
+    const std::vector<uint8_t> bytes = makeBytes(state.range(0));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(blockChecksum(bytes.data(), bytes.size()));
+    }
+    reportBytes(state);
+}
+
+// Receiving a field as before: the bytes are copied out of the buffer and read again
+// by recvChecksum()
+void BM_CopyThenChecksum(benchmark::State& state)
+{
+    const std::vector<uint8_t> bytes = makeBytes(state.range(0));
+    std::vector<uint8_t> destination(bytes.size());
+    for (auto _ : state) {
+        std::memcpy(destination.data(), bytes.data(), bytes.size());
+        benchmark::DoNotOptimize(common::checksum(destination.begin(), destination.end()));
+        benchmark::ClobberMemory();
+    }
+    reportBytes(state);
+}
+
+// Receiving a field through ReceiveBuffer, which checksums the bytes while copying them
+void BM_CopyWithChecksum(benchmark::State& state)
+{
+    const std::vector<uint8_t> bytes = makeBytes(state.range(0));
+    std::vector<uint8_t> destination(bytes.size());
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(
+            copyWithChecksum(destination.data(), bytes.data(), bytes.size()));
+        benchmark::ClobberMemory();
+    }
+    reportBytes(state);
+}
+
+// from the shortest frame to the longest frame of a divided message
+void frameLengths(benchmark::internal::Benchmark* benchmark)
+{
+    for (int64_t length : {kMinFrameLength, 64, kMaxFrameLength,
+                           kMaxExtendedLengthFrameDivisionFrameLength}) {
+        benchmark->Arg(length);
+    }
+}
+
+BENCHMARK(BM_CommonChecksum)->Apply(frameLengths);
+BENCHMARK(BM_WordChecksum)->Apply(frameLengths);
+BENCHMARK(BM_BlockChecksum)->Apply(frameLengths);
+BENCHMARK(BM_CopyThenChecksum)->Apply(frameLengths);
+BENCHMARK(BM_CopyWithChecksum)->Apply(frameLengths);
+
+}  // namespace impl
+}  // namespace cpucom
+}  // namespace ahu
+}  // namespace mitsubishielectric
+}  // namespace com
@@ -0,0 +1,174 @@
+/*
+ * COPYRIGHT (C) 2024 MITSUBISHI ELECTRIC CORPORATION
+ * ALL RIGHTS RESERVED
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <vector>
+
+#include "AllocationCounter.h"
+#include "Checksum.h"
+#include "FrameEncoder.h"
+
+namespace com {
+namespace mitsubishielectric {
+namespace ahu {
+namespace cpucom {
+namespace impl {
+
+using namespace frame;
+
+namespace {
+
+// prepareFrames() as it was implemented in Protocol.cpp before FrameEncoder, kept as a baseline
+std::vector<std::vector<uint8_t>> legacyPrepareFrames(const std::vector<uint8_t>& d)
+{
+    std::vector<uint8_t> data = d;
+    std::vector<std::vector<uint8_t>> frames;
+    if (data.size() <= kMaxFrameLength - kFrameFooterLength) {
+        std::vector<uint8_t> frame;
+        frame.reserve(kFrameHeaderLength + kMaxFrameLength);
+        frame.push_back(STX);
+        frame.push_back(data.size() + kFrameFooterLength);
+        frame.insert(frame.end(), data.begin(), data.end());
+        frame.push_back(ETX);
+        frame.push_back(common::checksum(std::next(frame.begin()), frame.end()));
+        frames.push_back(frame);
+    }
+    else if (data.size() <= (kMaxExtendedLengthFrameLength - kFrameFooterLength)) {
+        std::vector<uint8_t> frame;
+        frame.reserve(kFrameHeaderLength + kMaxExtendedLengthFrameLength);
+        frame.push_back(STX);
+        frame.push_back(EXT_LEN);
+        frame.push_back(data.at(0));
+        frame.push_back(data.at(1));
+        frame.push_back(data.at(2));
+        uint32_t length = data.size() + kExtLenLength + kFrameFooterLength;
+        frame.push_back((length >> 16) & 0x000000ff);
+        frame.push_back((length >> 8) & 0x000000ff);
+        frame.push_back(length & 0x000000ff);
+        frame.insert(frame.end(), std::next(data.begin(), 3), data.end());
+        frame.push_back(ETX);
+        frame.push_back(common::checksum(std::next(frame.begin()), frame.end()));
+        frames.push_back(frame);
+    }
+    else {
+        uint32_t actualDataLength = data.size() - kCmdLength;
+        uint32_t framesCount = (actualDataLength / kMaxActualDataLength) +
+                               ((actualDataLength % kMaxActualDataLength) > 0);
+        uint8_t command = data.at(0);
+        uint8_t subCommand = data.at(1);
+        uint8_t codebit = data.at(2);
+
+        for (uint32_t i = 0; i < framesCount; ++i) {
+            std::vector<uint8_t> frame;
+            frame.reserve(kFrameHeaderLength + kMaxExtendedLengthFrameDivisionFrameLength);
+            frame.push_back(STX);
+            frame.push_back(EXT_LEN);
+            frame.push_back(command);
+            frame.push_back(subCommand);
+            codebit |= (i == framesCount - 1) ? 0x03 : 0x02;
+            frame.push_back(codebit);
+
+            uint32_t length = std::min<uint32_t>(actualDataLength, kMaxActualDataLength);
+            actualDataLength -= length;
+            length += kCmdLength + kExtLenLength + kFrameNumberLength + kTotalFramesLength +
+                      kFrameFooterLength;
+            frame.push_back((length >> 16) & 0x000000ff);
+            frame.push_back((length >> 8) & 0x000000ff);
+            frame.push_back(length & 0x000000ff);
+            frame.push_back((i >> 8) & 0x000000ff);
+            frame.push_back(i & 0x000000ff);
+            frame.push_back((framesCount >> 8) & 0x000000ff);
+            frame.push_back(framesCount & 0x000000ff);
+            auto begin = (i == 0) ? std::next(data.begin(), 3) : data.begin();
+            const uint32_t dataLength = std::min<uint32_t>(kMaxActualDataLength, data.size());
+            frame.insert(frame.end(), begin, std::next(begin, dataLength));
+            frame.push_back(ETX);
+            frame.push_back(common::checksum(std::next(frame.begin()), frame.end()));
+            frames.push_back(frame);
+            data.erase(data.begin(),
+                       std::next(data.begin(), dataLength + ((i == 0) ? kCmdLength : 0)));
+        }
+    }
+    return frames;
+}
+
+std::vector<uint8_t> makeMessage(size_t size)
+{
+    std::vector<uint8_t> message(size);
+    for (size_t i = 0; i < size; ++i) {
+        message[i] = static_cast<uint8_t>(i);
+    }
+    return message;
+}
+
+void reportCounters(benchmark::State& state, uint64_t allocations)
+{
+    state.counters["allocs/msg"] =
+        benchmark::Counter(allocations, benchmark::Counter::kAvgIterations);
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+}
+
+}  // namespace
+
+// Prepares all frames of a message the way Protocol::send() did before FrameEncoder
+void BM_LegacyPrepareFrames(benchmark::State& state)
+{
+    const std::vector<uint8_t> message = makeMessage(state.range(0));
+    const uint64_t allocationsBefore = allocationCount();
+    for (auto _ : state) {
+        auto frames = legacyPrepareFrames(message);
+        benchmark::DoNotOptimize(frames.data());
+    }
+    reportCounters(state, allocationCount() - allocationsBefore);
+}
+
+// Describes all frames of a message and builds the gather vectors handed to ILineDevice
+void BM_FrameEncoderGather(benchmark::State& state)
+{
+    const std::vector<uint8_t> message = makeMessage(state.range(0));
+    const uint64_t allocationsBefore = allocationCount();
+    for (auto _ : state) {
+        FrameEncoder encoder(message);
+        for (uint32_t i = 0; i < encoder.frameCount(); ++i) {
+            const auto iov = encoder.frame(i).iov();
+            benchmark::DoNotOptimize(iov.data());
+        }
+    }
+    reportCounters(state, allocationCount() - allocationsBefore);
+}
+
+// Describes all frames of a message and linearizes each of them into one reused buffer,
+// which is what Protocol does for devices without ILineDevice
+void BM_FrameEncoderLinear(benchmark::State& state)
+{
+    const std::vector<uint8_t> message = makeMessage(state.range(0));
+    std::vector<uint8_t> buffer;
+    buffer.reserve(kMaxWireFrameLength);
+    const uint64_t allocationsBefore = allocationCount();
+    for (auto _ : state) {
+        FrameEncoder encoder(message);
+        for (uint32_t i = 0; i < encoder.frameCount(); ++i) {
+            const FrameEncoder::Frame frame = encoder.frame(i);
+            buffer.resize(frame.size());
+            frame.copyTo(buffer.data());
+            benchmark::DoNotOptimize(buffer.data());
+        }
+    }
+    reportCounters(state, allocationCount() - allocationsBefore);
+}
+
+BENCHMARK(BM_LegacyPrepareFrames)->RangeMultiplier(4)->Range(5, 64 << 10);
+BENCHMARK(BM_FrameEncoderGather)->RangeMultiplier(4)->Range(5, 64 << 10);
+BENCHMARK(BM_FrameEncoderLinear)->RangeMultiplier(4)->Range(5, 64 << 10);
+
+}  // namespace impl
+}  // namespace cpucom
+}  // namespace ahu
+}  // namespace mitsubishielectric
+}  // namespace com
@@ -0,0 +1,222 @@
+/*
+ * COPYRIGHT (C) 2024 MITSUBISHI ELECTRIC CORPORATION
+ * ALL RIGHTS RESERVED
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "CpuComDaemon.h"
+#include "CpuComDaemonLog.h"
+#include "ICPU.h"
+#include "MutexWrapper.h"
+
+namespace com {
+namespace mitsubishielectric {
+namespace ahu {
+namespace cpucom {
+namespace impl {
+
+namespace {
+
+const common::CpuCommand kCommand = {0x11, 0x00};
+
+/**
+ * Keeps the task submitted, for the benchmark to run it in place of the executor thread.
+ */
+class CapturingExecutor : public common::IPeriodicTaskExecutor {
+public:
+    explicit CapturingExecutor(std::function<void()>& task)
+        : m_task(task)
+    {
+    }
+
+    std::future<void> submit(std::function<void()> task, std::function<bool()>) override
+    {
+        m_task = std::move(task);
+        return std::future<void>();
+    }
+
+    void stop() override {}
+
+private:
+    std::function<void()>& m_task;
+};
+
+/**
+ * V-CPU which receives the same message on every read.
+ */
+class RepeatingCPU : public ICPU {
+public:
+    explicit RepeatingCPU(size_t size)
+        : m_message(kCommand, std::vector<uint8_t>(size, 0x5a))
+    {
+    }
+
+    bool initialize() override { return true; }
+
+    bool read(std::pair<common::CpuCommand, std::vector<uint8_t>>& value) override
+    {
+        value = m_message;
+        return true;
+    }
+
+    bool write(const common::CpuCommand&, const std::vector<uint8_t>&) override { return true; }
+
+    SendTimes lastSendTimes() const override { return SendTimes(); }
+
+    ReceiveTimes lastReceiveTimes() const override { return ReceiveTimes(); }
+
+private:
+    const std::pair<common::CpuCommand, std::vector<uint8_t>> m_message;
+};
+
+/**
+ * Builds a message for every notification like MessageServer does, either one per session
+ * or one shared by all the sessions, and drops it.
+ */
+class NotifyingServer : public IMessageServer {
+public:
+    explicit NotifyingServer(bool shared)
+        : m_shared(shared)
+    {
+    }
+
+    bool initialize(OnNewConnectionHandler, OnConnectionClosedHandler) override { return true; }
+    bool start() override { return true; }
+    void stop() override {}
+    void setSendCommandMessageHandler(OnSendCommandHandler, CpuComDaemon*) override {}
+    void setSubscribeMessageHandler(OnSubscribeHandler, CpuComDaemon*) override {}
+    void setUnsubscribeMessageHandler(OnUnsubscribeHandler, CpuComDaemon*) override {}
+    void setRequestMessageHandler(OnRequestHandler, CpuComDaemon*) override {}
+    void setCancelRequestMessageHandler(OnCancelRequestHandler, CpuComDaemon*) override {}
+    void setSendCommandWithDeliveryStatusMessageHandler(OnSendCommandWithDeliveryStatusHandler,
+                                                        CpuComDaemon*) override
+    {
+    }
+    void setSendCommandWithTraceMessageHandler(OnSendCommandWithTraceHandler,
+                                               CpuComDaemon*) override
+    {
+    }
+    void setStatsMessageHandler(OnStatsHandler, CpuComDaemon*) override {}
+
+    void sendNotificationMessage(const std::vector<SessionID>& sessionIds,
+                                 common::CpuCommand command,
+                                 const std::vector<uint8_t>& data,
+                                 const std::vector<uint8_t>& stamps) override
+    {
+        std::shared_ptr<const std::vector<uint8_t>> message;
+        for (const SessionID& sessionId : sessionIds) {
+            if (!message || !m_shared) {
+                message = build(command, data, stamps);
+            }
+            // what a session's send queue would hold on to
+            std::shared_ptr<const std::vector<uint8_t>> queued = message;
+            benchmark::DoNotOptimize(sessionId.data());
+            benchmark::DoNotOptimize(queued->data());
+        }
+    }
+
+    void sendRequestResponseMessage(SessionID, common::UUID, std::vector<uint8_t>&) override {}
+    void sendRequestTimeoutMessage(SessionID, common::UUID) override {}
+    void sendSendCommandResultMessage(SessionID, common::CpuCommand, int) override {}
+    void sendDeliveryStatusMessage(SessionID, common::UUID, bool) override {}
+    void sendDeliveryTraceMessage(SessionID,
+                                  common::UUID,
+                                  bool,
+                                  const std::vector<uint8_t>&) override
+    {
+    }
+    void sendStatsMessage(SessionID, const std::string&) override {}
+
+private:
+    // type, command, data and stamps with their sizes, as the message is written to the socket
+    static std::shared_ptr<const std::vector<uint8_t>> build(common::CpuCommand command,
+                                                             const std::vector<uint8_t>& data,
+                                                             const std::vector<uint8_t>& stamps)
+    {
+        auto message = std::make_shared<std::vector<uint8_t>>();
+        message->reserve(data.size() + stamps.size() + 12);
+        message->push_back(static_cast<uint8_t>(CpuComId::Notification));
+        message->push_back(command.first);
+        message->push_back(command.second);
+        append(*message, data);
+        append(*message, stamps);
+        return message;
+    }
+
+    static void append(std::vector<uint8_t>& message, const std::vector<uint8_t>& field)
+    {
+        const uint32_t size = static_cast<uint32_t>(field.size());
+        for (int shift = 0; shift < 32; shift += 8) {
+            message.push_back(static_cast<uint8_t>(size >> shift));
+        }
+        message.insert(message.end(), field.begin(), field.end());
+    }
+
+private:
+    const bool m_shared;
+};
+
+/**
+ * Delivers a received message to range(0) subscribers with range(1) bytes of data,
+ * from the receive thread through the dispatch thread to the message server.
+ */
+void fanOut(benchmark::State& state, bool shared)
+{
+    const auto subscribers = static_cast<size_t>(state.range(0));
+    const auto size = static_cast<size_t>(state.range(1));
+    daemon::InitializeCpuComLogMessages();
+    {
+        std::function<void()> receive;
+        std::function<void()> dispatch;
+        std::function<void()> transmit;
+        CpuComDaemon daemon{std::make_unique<NotifyingServer>(shared),
+                            std::make_unique<RepeatingCPU>(size),
+                            std::make_unique<CapturingExecutor>(receive),
+                            std::make_unique<CapturingExecutor>(dispatch),
+                            std::make_unique<CapturingExecutor>(transmit),
+                            std::make_unique<MutexWrapper>(),
+                            std::make_unique<MutexWrapper>()};
+        daemon.start();
+        for (size_t i = 0; i < subscribers; ++i) {
+            daemon.onSubscribe("session" + std::to_string(i), kCommand);
+        }
+
+        for (auto _ : state) {
+            receive();
+            dispatch();
+        }
+    }
+    daemon::TerminateCpuComLogMessages();
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(subscribers));
+}
+
+// subscribers; bytes of data
+void fanOuts(benchmark::internal::Benchmark* benchmark)
+{
+    for (int64_t subscribers : {1, 4, 16, 64}) {
+        for (int64_t size : {16, 1024}) {
+            benchmark->Args({subscribers, size});
+        }
+    }
+}
+
+void BM_NotificationBuiltPerSession(benchmark::State& state) { fanOut(state, false); }
+
+void BM_NotificationBuiltOnce(benchmark::State& state) { fanOut(state, true); }
+
+}  // namespace
+
+BENCHMARK(BM_NotificationBuiltPerSession)->Apply(fanOuts);
+BENCHMARK(BM_NotificationBuiltOnce)->Apply(fanOuts);
+
+}  // namespace impl
+}  // namespace cpucom
+}  // namespace ahu
+}  // namespace mitsubishielectric
+}  // namespace com
@@ -0,0 +1,121 @@
+/*
+ * COPYRIGHT (C) 2024 MITSUBISHI ELECTRIC CORPORATION
+ * ALL RIGHTS RESERVED
+ */
+
+#include <benchmark/benchmark.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "CpuComDaemonLog.h"
+#include "FrameEncoder.h"
+#include "FrameFormat.h"
+#include "Protocol.h"
+#include "VerboseLog.h"
+
+namespace com {
+namespace mitsubishielectric {
+namespace ahu {
+namespace cpucom {
+namespace impl {
+
+using common::IODevice;
+using namespace frame;
+
+namespace {
+
+/**
+ * Peer which acknowledges every enquiry and frame at once.
+ */
+class AcknowledgingPeer : public IODevice {
+public:
+    AcknowledgingPeer()
+        : m_pending(false)
+    {
+    }
+
+    bool open(OpenMode) override { return true; }
+
+    void close() override {}
+
+    Result poll(std::chrono::milliseconds) override { return Result::Success; }
+
+    Result read(uint8_t* data, std::chrono::milliseconds) override
+    {
+        if (!m_pending) {
+            return Result::Timeout;
+        }
+        m_pending = false;
+        *data = ACK;
+        return Result::Success;
+    }
+
+    std::pair<Result, int> write(uint8_t) override
+    {
+        m_pending = true;
+        return {Result::Success, 1};
+    }
+
+    std::pair<Result, int> write(const uint8_t*, size_t size) override
+    {
+        m_pending = true;
+        return {Result::Success, static_cast<int>(size)};
+    }
+
+private:
+    bool m_pending;
+};
+
+// CPU cycles where there is a counter for them, ns of the steady clock otherwise
+uint64_t cycles()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                     std::chrono::steady_clock::now().time_since_epoch())
+                                     .count());
+#endif
+}
+
+}  // namespace
+
+// Cycles per frame of sending a message of range(0) bytes, compare the runs of
+// cpucomdaemon-benchmarks and cpucomdaemon-benchmarks-verbose
+void BM_SendCyclesPerFrame(benchmark::State& state)
+{
+    daemon::InitializeCpuComLogMessages();
+    Protocol protocol(std::make_unique<AcknowledgingPeer>());
+    const std::vector<uint8_t> message(static_cast<size_t>(state.range(0)), 0x5a);
+    const uint32_t frames = FrameEncoder(message).frameCount();
+
+    uint64_t sent = 0;
+    uint64_t total = 0;
+    for (auto _ : state) {
+        const uint64_t start = cycles();
+        benchmark::DoNotOptimize(protocol.send(message));
+        total += cycles() - start;
+        sent += frames;
+    }
+    state.SetLabel(kVerboseLogs ? "verbose logs compiled in" : "verbose logs compiled out");
+    state.counters["cycles/frame"] =
+        benchmark::Counter(static_cast<double>(total) / static_cast<double>(sent));
+    state.counters["frames"] = benchmark::Counter(sent, benchmark::Counter::kIsRate);
+    daemon::TerminateCpuComLogMessages();
+}
+
+// message size in bytes: one frame, a few frames
+BENCHMARK(BM_SendCyclesPerFrame)->Arg(16)->Arg(4096);
+
+}  // namespace impl
+}  // namespace cpucom
+}  // namespace ahu
+}  // namespace mitsubishielectric
+}  // namespace com
@@ -0,0 +1,214 @@
+/*
+ * COPYRIGHT (C) 2024 MITSUBISHI ELECTRIC CORPORATION
+ * ALL RIGHTS RESERVED
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "CpuComDaemonLog.h"
+#include "FrameEncoder.h"
+#include "LineDevice.h"
+#include "Protocol.h"
+
+namespace com {
+namespace mitsubishielectric {
+namespace ahu {
+namespace cpucom {
+namespace impl {
+
+using common::IODevice;
+using namespace frame;
+
+namespace {
+
+/**
+ * One end of a socket pair, the other end plays the peer transmitting a message:
+ * ENQ, then one frame after ACK, for every frame of the message and then again from the start.
+ * Reads through IODevice poll the descriptor before every read, like common::IODevice does.
+ * Every poll and read is counted as a syscall.
+ */
+class SocketLine : public LineDevice {
+public:
+    SocketLine(const std::vector<uint8_t>& message, uint64_t& syscalls)
+        : LineDevice("socketpair", [](int) { return true; })
+        , m_peer(-1)
+        , m_syscalls(syscalls)
+        , m_next(0)
+    {
+        FrameEncoder encoder(message);
+        for (uint32_t i = 0; i < encoder.frameCount(); ++i) {
+            const FrameEncoder::Frame frame = encoder.frame(i);
+            std::vector<uint8_t> bytes(frame.size());
+            frame.copyTo(bytes.data());
+            m_transmissions.push_back({ENQ});
+            m_transmissions.push_back(bytes);
+        }
+    }
+
+    bool open(OpenMode) override
+    {
+        int fds[2];
+        if (::socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) {
+            return false;
+        }
+        const int size = kMaxWireFrameLength * 2;
+        ::setsockopt(fds[1], SOL_SOCKET, SO_SNDBUF, &size, sizeof(size));
+        m_fd = fds[0];
+        m_peer = fds[1];
+        transmit();
+        return true;
+    }
+
+    void close() override
+    {
+        ::close(m_fd);
+        ::close(m_peer);
+    }
+
+    Result poll(std::chrono::milliseconds timeout) override
+    {
+        struct pollfd fd = {m_fd, POLLIN, 0};
+        ++m_syscalls;
+        const int ready = ::poll(&fd, 1, static_cast<int>(timeout.count()));
+        return (ready > 0) ? Result::Success : ((ready == 0) ? Result::Timeout : Result::Error);
+    }
+
+    Result read(uint8_t* data, std::chrono::milliseconds timeout) override
+    {
+        return readMulti(data, 1, timeout);
+    }
+
+    Result readMulti(uint8_t* data, size_t size, std::chrono::milliseconds timeout) override
+    {
+        size_t received = 0;
+        while (received < size) {
+            const Result result = poll(timeout);
+            if (result != Result::Success) {
+                return result;
+            }
+            ++m_syscalls;
+            const ssize_t count = ::read(m_fd, data + received, size - received);
+            if (count <= 0) {
+                return Result::Error;
+            }
+            received += count;
+        }
+        return Result::Success;
+    }
+
+    Result readAvailable(uint8_t* data,
+                         size_t size,
+                         std::chrono::milliseconds timeout,
+                         size_t& received) override
+    {
+        // LineDevice polls and then reads once
+        m_syscalls += 2;
+        return LineDevice::readAvailable(data, size, timeout, received);
+    }
+
+    Result drain(DrainTail& tail, size_t& drained) override
+    {
+        const Result result = LineDevice::drain(tail, drained);
+        // FIONREAD, a read for the pending bytes, FIONREAD again
+        m_syscalls += (drained > 0) ? 3 : 1;
+        return result;
+    }
+
+    std::pair<Result, int> write(uint8_t data) override
+    {
+        if (data == ACK) {
+            transmit();
+        }
+        return {Result::Success, 1};
+    }
+
+    std::pair<Result, int> write(const uint8_t*, size_t size) override
+    {
+        return {Result::Success, static_cast<int>(size)};
+    }
+
+private:
+    void transmit()
+    {
+        const std::vector<uint8_t>& bytes = m_transmissions[m_next];
+        m_next = (m_next + 1) % m_transmissions.size();
+        if (::write(m_peer, bytes.data(), bytes.size()) != static_cast<ssize_t>(bytes.size())) {
+            m_next = 0;
+        }
+    }
+
+    int m_peer;
+    uint64_t& m_syscalls;
+    std::vector<std::vector<uint8_t>> m_transmissions;
+    size_t m_next;
+};
+
+std::vector<uint8_t> makeMessage(size_t size)
+{
+    std::vector<uint8_t> message(size);
+    for (size_t i = 0; i < size; ++i) {
+        message[i] = static_cast<uint8_t>(i);
+    }
+    return message;
+}
+
+// A plain IODevice makes Protocol read every field by its own call
+std::unique_ptr<IODevice> perField(SocketLine* line) { return std::unique_ptr<IODevice>(line); }
+
+// The line as ILineDevice makes Protocol read through ReceiveBuffer
+std::unique_ptr<SocketLine> buffered(SocketLine* line) { return std::unique_ptr<SocketLine>(line); }
+
+template <typename Device>
+void receiveMessages(benchmark::State& state, Device (*device)(SocketLine*))
+{
+    daemon::InitializeCpuComLogMessages();
+    const std::vector<uint8_t> message = makeMessage(state.range(0));
+    uint64_t syscalls = 0;
+    uint64_t received = 0;
+    {
+        Protocol protocol(device(new SocketLine(message, syscalls)));
+        std::vector<uint8_t> data;
+        syscalls = 0;
+        for (auto _ : state) {
+            if (!protocol.receive(data) || (data.size() != message.size())) {
+                state.SkipWithError("message not received");
+                break;
+            }
+            received += data.size();
+        }
+    }
+    daemon::TerminateCpuComLogMessages();
+
+    const uint32_t frames = FrameEncoder::frameCount(message.size());
+    state.counters["syscalls/frame"] = benchmark::Counter(static_cast<double>(syscalls) / frames,
+                                                          benchmark::Counter::kAvgIterations);
+    state.counters["cpu/KB"] = benchmark::Counter(
+        received / 1024.0, benchmark::Counter::kIsRate | benchmark::Counter::kInvert);
+    state.SetBytesProcessed(received);
+}
+
+}  // namespace
+
+// Every field of a frame is read by its own call, as Protocol does for a plain IODevice
+void BM_ReceivePerField(benchmark::State& state) { receiveMessages(state, &perField); }
+
+// Fields are served from ReceiveBuffer, which reads whatever the line has available
+void BM_ReceiveBuffered(benchmark::State& state) { receiveMessages(state, &buffered); }
+
+// message size: regular, extended length and frame division frames
+BENCHMARK(BM_ReceivePerField)->Arg(16)->Arg(250)->Arg(1000)->Arg(16 << 10);
+BENCHMARK(BM_ReceiveBuffered)->Arg(16)->Arg(250)->Arg(1000)->Arg(16 << 10);
+
+}  // namespace impl
+}  // namespace cpucom
+}  // namespace ahu
+}  // namespace mitsubishielectric
+}  // namespace com
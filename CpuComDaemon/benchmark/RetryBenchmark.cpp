@@ -0,0 +1,184 @@
+/*
+ * COPYRIGHT (C) 2024 MITSUBISHI ELECTRIC CORPORATION
+ * ALL RIGHTS RESERVED
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "CpuComDaemonLog.h"
+#include "FrameFormat.h"
+#include "Protocol.h"
+#include "RetryPolicy.h"
+
+namespace com {
+namespace mitsubishielectric {
+namespace ahu {
+namespace cpucom {
+namespace impl {
+
+using common::IODevice;
+using namespace frame;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+const std::vector<uint8_t> kMessage = {1, 2, 3, 'd', 'a', 't', 'a'};
+
+// legacy retries, as Protocol does by default
+const std::chrono::milliseconds kFixedDelay(5);
+const uint32_t kFixedMaxAttempts = 240;
+const uint32_t kFixedReinitAttempts = 6;
+
+/**
+ * Peer which acknowledges every enquiry and frame, except during an outage,
+ * when every read fails at once like on a disconnected UART.
+ */
+class FlakyPeer : public IODevice {
+public:
+    FlakyPeer()
+        : m_pending(false)
+        , m_outageEnd(Clock::now())
+        , m_failedReads(0)
+        , m_reopens(0)
+    {
+    }
+
+    void startOutage(std::chrono::milliseconds duration) { m_outageEnd = Clock::now() + duration; }
+
+    uint64_t failedReads() const { return m_failedReads; }
+    uint64_t reopens() const { return m_reopens; }
+
+    bool open(OpenMode) override
+    {
+        ++m_reopens;
+        return true;
+    }
+
+    void close() override {}
+
+    Result poll(std::chrono::milliseconds) override { return Result::Success; }
+
+    Result read(uint8_t* data, std::chrono::milliseconds) override
+    {
+        if (Clock::now() < m_outageEnd) {
+            ++m_failedReads;
+            return Result::Error;
+        }
+        if (!m_pending) {
+            return Result::Timeout;
+        }
+        m_pending = false;
+        *data = ACK;
+        return Result::Success;
+    }
+
+    std::pair<Result, int> write(uint8_t) override
+    {
+        m_pending = true;
+        return {Result::Success, 1};
+    }
+
+    std::pair<Result, int> write(const uint8_t*, size_t size) override
+    {
+        m_pending = true;
+        return {Result::Success, static_cast<int>(size)};
+    }
+
+private:
+    bool m_pending;
+    Clock::time_point m_outageEnd;
+    uint64_t m_failedReads;
+    uint64_t m_reopens;
+};
+
+std::unique_ptr<IRetryPolicy> makePolicy(int64_t adaptive)
+{
+    if (adaptive != 0) {
+        return std::make_unique<AdaptiveRetryPolicy>();
+    }
+    return std::make_unique<FixedRetryPolicy>(kFixedDelay, kFixedMaxAttempts,
+                                              kFixedReinitAttempts);
+}
+
+}  // namespace
+
+// Time from the start of an outage of range(1) ms until a message gets through again,
+// the caller sends the message again whenever Protocol gives it up
+void BM_RecoveryAfterOutage(benchmark::State& state)
+{
+    daemon::InitializeCpuComLogMessages();
+    std::unique_ptr<FlakyPeer> device(new FlakyPeer());
+    FlakyPeer* peer = device.get();
+    Protocol protocol(std::move(device));
+    protocol.setRetryPolicy(makePolicy(state.range(0)));
+
+    uint64_t givenUp = 0;
+    const uint64_t reopensBefore = peer->reopens();
+    for (auto _ : state) {
+        const Clock::time_point start = Clock::now();
+        peer->startOutage(std::chrono::milliseconds(state.range(1)));
+        while (!protocol.send(kMessage)) {
+            ++givenUp;
+        }
+        state.SetIterationTime(std::chrono::duration<double>(Clock::now() - start).count());
+    }
+    state.counters["attempts"] =
+        benchmark::Counter(peer->failedReads(), benchmark::Counter::kAvgIterations);
+    state.counters["reopens"] =
+        benchmark::Counter(peer->reopens() - reopensBefore, benchmark::Counter::kAvgIterations);
+    state.counters["givenUp"] = benchmark::Counter(givenUp, benchmark::Counter::kAvgIterations);
+    daemon::TerminateCpuComLogMessages();
+}
+
+// Time one send() blocks the sender on a link which has been down for a while
+void BM_SendOnDeadLink(benchmark::State& state)
+{
+    daemon::InitializeCpuComLogMessages();
+    std::unique_ptr<FlakyPeer> device(new FlakyPeer());
+    FlakyPeer* peer = device.get();
+    Protocol protocol(std::move(device));
+    protocol.setRetryPolicy(makePolicy(state.range(0)));
+    peer->startOutage(std::chrono::hours(1));
+    // the first message finds out that the link is down
+    protocol.send(kMessage);
+
+    for (auto _ : state) {
+        const Clock::time_point start = Clock::now();
+        benchmark::DoNotOptimize(protocol.send(kMessage));
+        state.SetIterationTime(std::chrono::duration<double>(Clock::now() - start).count());
+    }
+    daemon::TerminateCpuComLogMessages();
+}
+
+// policy: 0 fixed, 1 adaptive; outage duration in ms
+void outages(benchmark::internal::Benchmark* benchmark)
+{
+    for (int64_t policy : {0, 1}) {
+        for (int64_t outage : {50, 200, 1000, 3000}) {
+            benchmark->Args({policy, outage});
+        }
+    }
+}
+
+BENCHMARK(BM_RecoveryAfterOutage)
+    ->Apply(outages)
+    ->Iterations(3)
+    ->UseManualTime()
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_SendOnDeadLink)
+    ->Arg(0)
+    ->Arg(1)
+    ->Iterations(3)
+    ->UseManualTime()
+    ->Unit(benchmark::kMillisecond);
+
+}  // namespace impl
+}  // namespace cpucom
+}  // namespace ahu
+}  // namespace mitsubishielectric
+}  // namespace com
@@ -0,0 +1,102 @@
+/*
+ * COPYRIGHT (C) 2024 MITSUBISHI ELECTRIC CORPORATION
+ * ALL RIGHTS RESERVED
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+#include "ProtocolStates.h"
+#include "StateMachine.h"
+
+namespace com {
+namespace mitsubishielectric {
+namespace ahu {
+namespace cpucom {
+namespace impl {
+
+namespace {
+
+const std::array<const char*, sending::Count> kSendStateNames = {
+    {"idle", "enquiry", "reenquiry", "ack", "frame", "ack2", "retry", "nak", "wait", "done",
+     "error", "end"}};
+
+const std::array<Event, kEventCount> kEvents = {
+    {Event::Pass, Event::Busy, Event::Wait, Event::Deny, Event::Fail, Event::Next}};
+
+// Sends a message of framesLeft frames without errors, handlers only count their calls
+struct Context {
+    uint32_t framesLeft;
+    uint64_t steps;
+};
+
+Event handle(sending::State state, Context& context)
+{
+    ++context.steps;
+    if (state == sending::Done) {
+        return (--context.framesLeft > 0) ? Event::Wait : Event::Pass;
+    }
+    return Event::Pass;
+}
+
+void reportCounters(benchmark::State& state, uint64_t steps)
+{
+    state.counters["transitions"] = benchmark::Counter(steps, benchmark::Counter::kIsRate);
+}
+
+}  // namespace
+
+// The send machine built on common::FiniteStateMachine, as Protocol did before kTransitions
+void BM_FiniteStateMachineSend(benchmark::State& state)
+{
+    common::FiniteStateMachine<Event, Context> machine;
+    for (uint32_t s = 0; s < sending::Count; ++s) {
+        const auto current = static_cast<sending::State>(s);
+        machine.addState(kSendStateNames[s], std::bind(&handle, current, std::placeholders::_1));
+        if (current == sending::kFinalState) {
+            continue;
+        }
+        for (uint32_t e = 0; e < kEventCount; ++e) {
+            machine.addTransition(kSendStateNames[s], kEvents[e],
+                                  kSendStateNames[sending::kTransitions[s].next[e]]);
+        }
+    }
+    machine.setInitialState(kSendStateNames[sending::kInitialState]);
+    machine.setFinalState(kSendStateNames[sending::kFinalState]);
+
+    uint64_t steps = 0;
+    for (auto _ : state) {
+        Context context = {static_cast<uint32_t>(state.range(0)), 0};
+        machine.run(context);
+        steps += context.steps;
+    }
+    reportCounters(state, steps);
+}
+
+// The same machine driven by sending::kTransitions
+void BM_TransitionTableSend(benchmark::State& state)
+{
+    uint64_t steps = 0;
+    for (auto _ : state) {
+        Context context = {static_cast<uint32_t>(state.range(0)), 0};
+        runStateMachine(sending::kTransitions, sending::kInitialState, sending::kFinalState,
+                        [&context](sending::State s) { return handle(s, context); });
+        benchmark::DoNotOptimize(context.steps);
+        steps += context.steps;
+    }
+    reportCounters(state, steps);
+}
+
+// number of frames in the sent message
+BENCHMARK(BM_FiniteStateMachineSend)->Arg(1)->Arg(64);
+BENCHMARK(BM_TransitionTableSend)->Arg(1)->Arg(64);
+
+}  // namespace impl
+}  // namespace cpucom
+}  // namespace ahu
+}  // namespace mitsubishielectric
+}  // namespace com
@@ -6,10 +6,12 @@
 #include "CpuComDaemon.h"
 #include "CPU.h"
 #include "CpuComDaemonLog.h"
+#include "CpuComError.h"
+#include "Probes.h"
+#include "Trace.h"
 
-#include <iomanip>
+#include <algorithm>
 #include <mutex>
-#include <sstream>
 
 namespace com {
 namespace mitsubishielectric {
@@ -17,39 +19,31 @@ namespace ahu {
 namespace cpucom {
 
 namespace {
-// LCOV_EXCL_START
-// This is excluded from a unit test coverage report because this inner function
-// that cannot be covered by unit-test
-std::string to_string(const common::CpuCommand& command,
-                      const std::vector<uint8_t>& data,
-                      size_t maxDataSizeToPrint)
-{
-    std::stringstream ss;
-    ss << "cmd=";
-    ss << std::hex << std::setw(2) << std::setfill('0') << static_cast<int>(command.first);
-    ss << std::hex << std::setw(2) << std::setfill('0') << static_cast<int>(command.second);
-    ss << ", len=";
-    ss << std::dec << std::setw(3) << std::setfill('0') << static_cast<int>(data.size());
-    if (!data.empty()) {
-        ss << ", dat=";
-        size_t size = std::min(maxDataSizeToPrint, data.size());
-        for (size_t i = 0; i < size; ++i) {
-            ss << std::hex << std::setw(2) << std::setfill('0') << static_cast<int>(data[i]);
-        }
+// how long the threads wait for work or room before isRunning() is checked again
+const std::chrono::milliseconds kReceivePollInterval(100);
+const std::chrono::milliseconds kDispatchPollInterval(100);
+const std::chrono::milliseconds kTransmitPollInterval(100);
+
+uint64_t mean(uint64_t total, uint64_t count) { return (count != 0) ? (total / count) : 0; }
+
+// the error answered to the client for a command which is not queued
+int errorOf(impl::TransmitQueue::Admission admission)
+{
+    if (admission == impl::TransmitQueue::Admission::Throttled) {
+        return ERR_THROTTLED;
     }
-    return ss.str();
+    return common::ERR_BUSY;
 }
-// LCOV_EXCL_STOP
 
-const char* const kLogTagReceive = "V->M";
-const char* const kLogTagSend = "M->V";
-const size_t kMaxDataSizeToPrint = 253;  // print max to regular frame length
+uint64_t latencyMicroseconds(const SendTrace& trace, SendTrace::Hop from, SendTrace::Hop to)
+{
+    return trace.latency(from, to) / 1000;
+}
 }  // namespace
 
 using daemon::LogID;
 
 using common::MLOGD;
-using common::MLOGD_SERIAL;
 
 using common::CpuCommand;
 using namespace std::placeholders;
@@ -57,21 +51,62 @@ using namespace std::placeholders;
 CpuComDaemon::CpuComDaemon(std::unique_ptr<impl::IMessageServer> messageServer,
                            std::unique_ptr<impl::ICPU> vcpu,
                            std::unique_ptr<common::IPeriodicTaskExecutor> periodicExecutor,
+                           std::unique_ptr<common::IPeriodicTaskExecutor> dispatchExecutor,
+                           std::unique_ptr<common::IPeriodicTaskExecutor> transmitExecutor,
                            std::unique_ptr<IMutexWrapper> subscribersMutexWrapper,
-                           std::unique_ptr<IMutexWrapper> requestsMutexWrapper)
+                           std::unique_ptr<IMutexWrapper> requestsMutexWrapper,
+                           impl::TransmitPolicy transmitPolicy,
+                           std::chrono::milliseconds requestTimeout,
+                           std::shared_ptr<impl::LinkMetrics> linkMetrics)
     : m_messageServer(std::move(messageServer))
     , m_vcpu(std::move(vcpu))
     , m_periodicExecutor(std::move(periodicExecutor))
+    , m_dispatchExecutor(std::move(dispatchExecutor))
+    , m_transmitExecutor(std::move(transmitExecutor))
     , m_subscribersMutexWrapper(std::move(subscribersMutexWrapper))
     , m_requestsMutexWrapper(std::move(requestsMutexWrapper))
+    , m_requests(requestTimeout)
+    , m_transmitQueue(std::move(transmitPolicy))
+    , m_linkMetrics(linkMetrics ? std::move(linkMetrics) : std::make_shared<impl::LinkMetrics>())
+    , m_writeStart(0)
 {
 }
 
 CpuComDaemon::~CpuComDaemon()
 {
     m_running = false;
+    m_transmitQueue.close();
+    m_transmitExecutor->stop();
     m_periodicExecutor->stop();
+    m_receiveQueue.close();
+    m_dispatchExecutor->stop();
     m_messageServer->stop();
+
+    const impl::ReceiveStatistics received = m_receiveQueue.statistics();
+    MLOGI(common::FunctionID::cpuc_daemon, LogID::ReceiveStatistics, received.received,
+          received.full, static_cast<uint64_t>(received.maxOccupancy),
+          mean(received.totalWait, received.received), received.maxWait,
+          mean(received.totalDispatch, received.dispatched), received.maxDispatch);
+
+    for (const auto& timeouts : m_requests.timeouts()) {
+        MLOGI(common::FunctionID::cpuc_daemon, LogID::RequestTimeouts, timeouts.first.first,
+              timeouts.first.second, timeouts.second);
+    }
+    for (const auto& coalesced : m_requests.coalesced()) {
+        MLOGI(common::FunctionID::cpuc_daemon, LogID::RequestsCoalesced, coalesced.first.first,
+              coalesced.first.second, coalesced.second);
+    }
+
+    for (size_t i = 0; i < impl::kTransmitClassCount; ++i) {
+        const auto transmitClass = static_cast<impl::TransmitClass>(i);
+        const impl::TransmitClassStatistics statistics =
+            m_transmitQueue.statistics(transmitClass);
+        MLOGI(common::FunctionID::cpuc_daemon, LogID::TransmitStatistics,
+              impl::toString(transmitClass), statistics.sent, statistics.rejected,
+              statistics.replaced, static_cast<uint64_t>(statistics.maxDepth),
+              mean(statistics.totalWait, statistics.sent), statistics.maxWait,
+              mean(statistics.totalService, statistics.sent), statistics.maxService);
+    }
 }
 
 bool CpuComDaemon::start()
@@ -80,6 +115,14 @@ bool CpuComDaemon::start()
         m_running = true;
         m_periodicExecutor->submit(std::bind(&CpuComDaemon::vcpuThreadFunction, this),
                                    std::bind(&CpuComDaemon::isRunning, this));
+        m_dispatchExecutor->submit(std::bind(&CpuComDaemon::dispatchThreadFunction, this),
+                                   std::bind(&CpuComDaemon::isRunning, this));
+        m_transmitExecutor->submit(std::bind(&CpuComDaemon::transmitThreadFunction, this),
+                                   std::bind(&CpuComDaemon::isRunning, this));
+    }
+    else {
+        // nothing would send the commands, they are rejected right away
+        m_transmitQueue.close();
     }
 
     m_messageServer->initialize(std::bind(&CpuComDaemon::onClientConnected, this, _1),
@@ -92,6 +135,9 @@ bool CpuComDaemon::start()
     m_messageServer->setCancelRequestMessageHandler(&CpuComDaemon::onCancelRequest, this);
     m_messageServer->setSendCommandWithDeliveryStatusMessageHandler(
         &CpuComDaemon::onSendCommandWithDeliveryStatus, this);
+    m_messageServer->setSendCommandWithTraceMessageHandler(&CpuComDaemon::onSendCommandWithTrace,
+                                                           this);
+    m_messageServer->setStatsMessageHandler(&CpuComDaemon::onStats, this);
 
     return m_messageServer->start();
 }
@@ -103,43 +149,108 @@ void CpuComDaemon::vcpuThreadFunction()
     std::pair<common::CpuCommand, std::vector<uint8_t>> result;
     bool received = m_vcpu->read(result);
     if (received) {
-        onReceiveCommand(std::move(result.first), std::move(result.second));
+        impl::ReceivedMessage message = {std::move(result.first), std::move(result.second),
+                                         std::chrono::steady_clock::now(),
+                                         m_vcpu->lastReceiveTimes()};
+        // the dispatch thread is behind, the V-CPU waits for the link meanwhile
+        while (!m_receiveQueue.push(std::move(message)) && isRunning()) {
+            m_receiveQueue.waitForRoom(kReceivePollInterval);
+        }
     }
 }
 
-void CpuComDaemon::onReceiveCommand(common::CpuCommand command, std::vector<uint8_t> data)
+void CpuComDaemon::dispatchThreadFunction()
 {
-    MLOGD_SERIAL(kLogTagReceive, to_string(command, data, kMaxDataSizeToPrint).c_str());
-    typename std::remove_reference<decltype(m_subscribers[command])>::type subscribers;
-    {
-        m_subscribersMutexWrapper->lock(m_subscribersMutex);
-        subscribers = m_subscribers[command];
-        m_subscribersMutexWrapper->unlock(m_subscribersMutex);
+    impl::ReceivedMessage message;
+    if (m_receiveQueue.pop(message, kDispatchPollInterval)) {
+        const auto dispatched = std::chrono::steady_clock::now();
+        onReceiveCommand(std::move(message.command), std::move(message.data), message.line);
+        m_receiveQueue.onDispatched(dispatched);
     }
+    expireRequests();
+}
 
-    std::for_each(subscribers.begin(), subscribers.end(),
-                  [this, &command, &data](const auto& sessionID) {
-                      m_messageServer->sendNotificationMessage(sessionID, command, data);
-                  });
+void CpuComDaemon::expireRequests()
+{
+    m_requestsMutexWrapper->lock(m_requestsMutex);
+    const std::vector<impl::PendingRequest> expired = m_requests.expire();
+    m_requestsMutexWrapper->unlock(m_requestsMutex);
 
-    bool requestIsFound = false;
-    typename decltype(m_requests)::value_type request = {};
-    {
-        auto findByCommand = [command](const auto& value) { return std::get<1>(value) == command; };
+    for (const impl::PendingRequest& request : expired) {
+        MLOGW(common::FunctionID::cpuc_daemon, LogID::RequestTimeout,
+              request.responseCommand.first, request.responseCommand.second,
+              request.id.toString());
+        // so that the client does not wait for ever
+        m_messageServer->sendRequestTimeoutMessage(request.sessionID, request.id);
+    }
+}
 
-        m_requestsMutexWrapper->lock(m_requestsMutex);
-        auto i = std::find_if(m_requests.begin(), m_requests.end(), findByCommand);
-        requestIsFound = (i != m_requests.end());
-        if (requestIsFound) {
-            request = std::move(*i);
-            m_requests.erase(i);
+void CpuComDaemon::transmitThreadFunction()
+{
+    m_transmitQueue.serve(std::bind(&CpuComDaemon::write, this, _1, _2), kTransmitPollInterval);
+}
+
+bool CpuComDaemon::write(const common::CpuCommand& command, const std::vector<uint8_t>& data)
+{
+    impl::trace(common::FunctionID::cpuc_daemon, LogID::SerialSend,
+                {command.first, command.second, data.size()}, data);
+    m_writeStart = impl::monotonicNow();
+    return m_vcpu->write(command, data);
+}
+
+impl::TransmitQueue::Admission CpuComDaemon::transmit(const SessionID& sessionID,
+                                                      common::CpuCommand command,
+                                                      std::vector<uint8_t> data,
+                                                      impl::TransmitQueue::Done done)
+{
+    const impl::TransmitClass transmitClass = m_transmitQueue.classOf(command);
+    const impl::TransmitQueue::Admission admission =
+        m_transmitQueue.push(sessionID, command, std::move(data), std::move(done));
+    switch (admission) {
+        case impl::TransmitQueue::Admission::Queued:
+            break;
+        case impl::TransmitQueue::Admission::Throttled:
+            MLOGW(common::FunctionID::cpuc_daemon, LogID::ClientThrottled, command.first,
+                  command.second);
+            break;
+        case impl::TransmitQueue::Admission::Full:
+        case impl::TransmitQueue::Admission::Closed:
+            MLOGW(common::FunctionID::cpuc_daemon, LogID::TransmitQueueFull,
+                  impl::toString(transmitClass), command.first, command.second);
+            break;
+    }
+    return admission;
+}
+
+void CpuComDaemon::onReceiveCommand(common::CpuCommand command,
+                                    std::vector<uint8_t> data,
+                                    const impl::ReceiveTimes& times)
+{
+    impl::trace(common::FunctionID::cpuc_daemon, LogID::SerialReceive,
+                {command.first, command.second, data.size()}, data);
+    const uint64_t frameChecked = impl::toSendTraceStamp(times.frameChecked);
+    {
+        const impl::SubscriberTable::Snapshot snapshot = m_subscribers.find(command);
+        CPUCOM_PROBE4(fanout, impl::probeCommand(command.first, command.second), data.size(),
+                      snapshot.subscribers().size(), frameChecked);
+        if (!snapshot.subscribers().empty()) {
+            ReceiveStamps stamps;
+            stamps.frameStart = impl::toSendTraceStamp(times.frameStart);
+            stamps.frameChecked = frameChecked;
+            m_messageServer->sendNotificationMessage(snapshot.subscribers(), command, data,
+                                                     impl::encodeReceiveStamps(stamps));
         }
-        m_requestsMutexWrapper->unlock(m_requestsMutex);
     }
-    if (requestIsFound) {
-        MLOGI(common::FunctionID::cpuc_daemon, LogID::Response, std::get<0>(request).toString());
-        m_messageServer->sendRequestResponseMessage(std::get<2>(request), std::get<0>(request),
-                                                    data);
+
+    std::vector<impl::PendingRequest> requests;
+    m_requestsMutexWrapper->lock(m_requestsMutex);
+    m_requests.take(command, requests);
+    m_requestsMutexWrapper->unlock(m_requestsMutex);
+    CPUCOM_PROBE4(request_match, impl::probeCommand(command.first, command.second), data.size(),
+                  requests.size(), frameChecked);
+    for (const impl::PendingRequest& request : requests) {
+        MLOGI(common::FunctionID::cpuc_daemon, LogID::Response, request.id.toString());
+        m_messageServer->sendRequestResponseMessage(request.sessionID, request.id, data);
     }
 }
 
@@ -149,37 +260,40 @@ void CpuComDaemon::onClientDisconnected(SessionID sessionID)
 {
     {
         m_subscribersMutexWrapper->lock(m_subscribersMutex);
-        for (auto i = m_subscribers.begin(); i != m_subscribers.end(); ++i) {
-            i->second.erase(sessionID);
-        }
+        m_subscribers.removeSession(sessionID);
         m_subscribersMutexWrapper->unlock(m_subscribersMutex);
     }
     {
-        auto findBySessionID = [sessionID](const auto& value) {
-            return std::get<2>(value) == sessionID;
-        };
         m_requestsMutexWrapper->lock(m_requestsMutex);
-        m_requests.erase(std::remove_if(m_requests.begin(), m_requests.end(), findBySessionID),
-                         m_requests.end());
+        m_requests.removeSession(sessionID);
         m_requestsMutexWrapper->unlock(m_requestsMutex);
     }
+
+    const impl::ClientConsumption consumption = m_transmitQueue.consumption(sessionID);
+    MLOGI(common::FunctionID::cpuc_daemon, LogID::ClientConsumption, consumption.commands,
+          consumption.bytes, consumption.frames, consumption.throttled);
+    m_transmitQueue.removeClient(sessionID);
 }
 
 void CpuComDaemon::onSendCommand(SessionID sessionID,
                                  common::CpuCommand command,
                                  std::vector<uint8_t> data)
 {
-    MLOGD_SERIAL(kLogTagSend, to_string(command, data, kMaxDataSizeToPrint).c_str());
-    if (m_vcpu->write(command, data) == false) {
-        m_messageServer->sendSendCommandResultMessage(sessionID, command, common::ERR_BUSY);
+    auto done = [this, sessionID, command](bool result) {
+        if (result == false) {
+            m_messageServer->sendSendCommandResultMessage(sessionID, command, common::ERR_BUSY);
+        }
+    };
+    const auto admission = transmit(sessionID, command, std::move(data), done);
+    if (admission != impl::TransmitQueue::Admission::Queued) {
+        m_messageServer->sendSendCommandResultMessage(sessionID, command, errorOf(admission));
     }
 }
 
 void CpuComDaemon::onSubscribe(SessionID sessionID, common::CpuCommand command)
 {
     m_subscribersMutexWrapper->lock(m_subscribersMutex);
-    auto& subsribers = m_subscribers[command];
-    subsribers.insert(sessionID);
+    m_subscribers.subscribe(sessionID, command);
     MLOGI(common::FunctionID::cpuc_daemon, LogID::ClientSubscribed, 0x00, command.first,
           command.second);
     m_subscribersMutexWrapper->unlock(m_subscribersMutex);
@@ -188,8 +302,7 @@ void CpuComDaemon::onSubscribe(SessionID sessionID, common::CpuCommand command)
 void CpuComDaemon::onUnsubscribe(SessionID sessionID, common::CpuCommand command)
 {
     m_subscribersMutexWrapper->lock(m_subscribersMutex);
-    auto& subscribers = m_subscribers[command];
-    subscribers.erase(sessionID);
+    m_subscribers.unsubscribe(sessionID, command);
     MLOGI(common::FunctionID::cpuc_daemon, LogID::ClientUnsubscribed, 0x00, command.first,
           command.second);
     m_subscribersMutexWrapper->unlock(m_subscribersMutex);
@@ -203,20 +316,30 @@ void CpuComDaemon::onRequest(SessionID sessionID,
 {
     MLOGI(common::FunctionID::cpuc_daemon, LogID::Request, requestID.toString());
     m_requestsMutexWrapper->lock(m_requestsMutex);
-    m_requests.emplace_back(requestID, responseCommand, sessionID);
+    const bool coalesced =
+        m_requests.add({requestID, requestCommand, responseCommand, sessionID}, requestData);
     m_requestsMutexWrapper->unlock(m_requestsMutex);
-    MLOGD_SERIAL(kLogTagSend, to_string(requestCommand, requestData, kMaxDataSizeToPrint).c_str());
-    m_vcpu->write(requestCommand, requestData);
+    if (coalesced) {
+        // the response to the identical request in flight answers this one too
+        MLOGI(common::FunctionID::cpuc_daemon, LogID::RequestCoalesced, requestID.toString());
+        return;
+    }
+    const auto admission = transmit(sessionID, requestCommand, std::move(requestData), nullptr);
+    if (admission != impl::TransmitQueue::Admission::Queued) {
+        // the request is not sent, so no response is awaited
+        m_requestsMutexWrapper->lock(m_requestsMutex);
+        m_requests.remove(requestID);
+        m_requestsMutexWrapper->unlock(m_requestsMutex);
+        m_messageServer->sendSendCommandResultMessage(sessionID, requestCommand,
+                                                      errorOf(admission));
+    }
 }
 
 void CpuComDaemon::onCancelRequest(SessionID, common::UUID requestID)
 {
-    auto findById = [requestID](const auto& value) { return std::get<0>(value) == requestID; };
     m_requestsMutexWrapper->lock(m_requestsMutex);
-    auto i = std::find_if(m_requests.begin(), m_requests.end(), findById);
-    if (i != m_requests.end()) {
+    if (m_requests.remove(requestID)) {
         MLOGI(common::FunctionID::cpuc_daemon, LogID::CancelRequest, requestID.toString());
-        m_requests.erase(i);
     }
     m_requestsMutexWrapper->unlock(m_requestsMutex);
 }
@@ -226,9 +349,73 @@ void CpuComDaemon::onSendCommandWithDeliveryStatus(SessionID sessionID,
                                                    common::CpuCommand command,
                                                    std::vector<uint8_t> data)
 {
-    MLOGD_SERIAL(kLogTagSend, to_string(command, data, kMaxDataSizeToPrint).c_str());
-    bool result = m_vcpu->write(command, data);
-    m_messageServer->sendDeliveryStatusMessage(sessionID, requestID, result);
+    auto done = [this, sessionID, requestID](bool result) {
+        m_messageServer->sendDeliveryStatusMessage(sessionID, requestID, result);
+    };
+    if (transmit(sessionID, command, std::move(data), done) !=
+        impl::TransmitQueue::Admission::Queued) {
+        m_messageServer->sendDeliveryStatusMessage(sessionID, requestID, false);
+    }
+}
+
+void CpuComDaemon::onSendCommandWithTrace(SessionID sessionID,
+                                          common::UUID requestID,
+                                          common::CpuCommand command,
+                                          std::vector<uint8_t> data,
+                                          std::vector<uint8_t> encodedTrace)
+{
+    SendTrace trace;
+    // a trace which can not be decoded is answered with the stamps of the daemon only
+    impl::decodeSendTrace(encodedTrace, trace);
+    trace.stamps[SendTrace::DaemonReceive] = impl::monotonicNow();
+
+    // called right after write() on the transmit thread, which is the only one sending,
+    // or when the command is dropped at shutdown, when the times are not those of its write()
+    auto done = [this, sessionID, requestID, trace](bool result) {
+        SendTrace sent = trace;
+        if (m_running) {
+            const impl::SendTimes times = m_vcpu->lastSendTimes();
+            sent.stamps[SendTrace::TransmitDequeue] = m_writeStart;
+            sent.stamps[SendTrace::EnquirySent] = impl::toSendTraceStamp(times.enquiry);
+            sent.stamps[SendTrace::Acknowledgement2Received] =
+                impl::toSendTraceStamp(times.acknowledgement2);
+        }
+        sendDeliveryTrace(sessionID, requestID, result, sent);
+    };
+    if (transmit(sessionID, command, std::move(data), done) !=
+        impl::TransmitQueue::Admission::Queued) {
+        sendDeliveryTrace(sessionID, requestID, false, trace);
+    }
+}
+
+void CpuComDaemon::sendDeliveryTrace(const SessionID& sessionID,
+                                     const common::UUID& requestID,
+                                     bool result,
+                                     SendTrace trace)
+{
+    trace.stamps[SendTrace::DeliveryStatusSent] = impl::monotonicNow();
+    impl::trace(common::FunctionID::cpuc_daemon, LogID::SendTraceQueued,
+                {trace.sequence,
+                 latencyMicroseconds(trace, SendTrace::ClientEnqueue, SendTrace::DaemonReceive),
+                 latencyMicroseconds(trace, SendTrace::DaemonReceive, SendTrace::TransmitDequeue)});
+    impl::trace(common::FunctionID::cpuc_daemon, LogID::SendTraceSent,
+                {trace.sequence,
+                 latencyMicroseconds(trace, SendTrace::TransmitDequeue, SendTrace::EnquirySent),
+                 latencyMicroseconds(trace, SendTrace::EnquirySent,
+                                     SendTrace::Acknowledgement2Received),
+                 latencyMicroseconds(trace, SendTrace::Acknowledgement2Received,
+                                     SendTrace::DeliveryStatusSent)});
+    m_messageServer->sendDeliveryTraceMessage(sessionID, requestID, result,
+                                              impl::encodeSendTrace(trace));
+}
+
+void CpuComDaemon::onStats(SessionID sessionID)
+{
+    m_messageServer->sendStatsMessage(
+        sessionID,
+        impl::formatLinkStats(m_linkMetrics->snapshot(), m_transmitQueue.waitHistogram()) +
+            impl::formatReceiveStats(m_receiveQueue.statistics()) +
+            impl::formatTransmitStats(m_transmitQueue));
 }
 
 }  // namespace cpucom
@@ -8,12 +8,17 @@
 
 #include <atomic>
 #include <memory>
-#include <set>
 
 #include <PeriodicTaskExecutor.h>
 
 #include "IMessageServer.h"
 #include "IMutexWrapper.h"
+#include "LinkMetrics.h"
+#include "PendingRequests.h"
+#include "ReceiveQueue.h"
+#include "SendTrace.h"
+#include "SubscriberTable.h"
+#include "TransmitQueue.h"
 
 namespace com {
 namespace mitsubishielectric {
@@ -30,8 +35,13 @@ public:
     explicit CpuComDaemon(std::unique_ptr<impl::IMessageServer> messageServer,
                           std::unique_ptr<impl::ICPU> vcpu,
                           std::unique_ptr<common::IPeriodicTaskExecutor> periodicExecutor,
+                          std::unique_ptr<common::IPeriodicTaskExecutor> dispatchExecutor,
+                          std::unique_ptr<common::IPeriodicTaskExecutor> transmitExecutor,
                           std::unique_ptr<IMutexWrapper> subscribersMutexWrapper,
-                          std::unique_ptr<IMutexWrapper> requestsMutexWrapper);
+                          std::unique_ptr<IMutexWrapper> requestsMutexWrapper,
+                          impl::TransmitPolicy transmitPolicy = impl::TransmitPolicy(),
+                          std::chrono::milliseconds requestTimeout = impl::kDefaultRequestTimeout,
+                          std::shared_ptr<impl::LinkMetrics> linkMetrics = nullptr);
     ~CpuComDaemon();
 
     bool start();
@@ -51,22 +61,53 @@ public:
                                          common::UUID requestID,
                                          common::CpuCommand command,
                                          std::vector<uint8_t> data);
+    /**
+     * Sends like onSendCommandWithDeliveryStatus() and answers with trace, an encoded SendTrace,
+     * stamped with the hops the command passed in the daemon.
+     */
+    void onSendCommandWithTrace(SessionID sessionID,
+                                common::UUID requestID,
+                                common::CpuCommand command,
+                                std::vector<uint8_t> data,
+                                std::vector<uint8_t> trace);
+    // answers with the metrics of the link, the queues and the clients as text
+    void onStats(SessionID sessionID);
 
 private:
     void vcpuThreadFunction();
-    void onReceiveCommand(common::CpuCommand command, std::vector<uint8_t> data);
+    void dispatchThreadFunction();
+    void expireRequests();
+    void transmitThreadFunction();
+    impl::TransmitQueue::Admission transmit(const SessionID& sessionID,
+                                            common::CpuCommand command,
+                                            std::vector<uint8_t> data,
+                                            impl::TransmitQueue::Done done);
+    bool write(const common::CpuCommand& command, const std::vector<uint8_t>& data);
+    void onReceiveCommand(common::CpuCommand command,
+                          std::vector<uint8_t> data,
+                          const impl::ReceiveTimes& times);
+    void sendDeliveryTrace(const SessionID& sessionID,
+                           const common::UUID& requestID,
+                           bool result,
+                           SendTrace trace);
 
     bool isRunning() const;
 
     std::unique_ptr<impl::IMessageServer> m_messageServer;
     std::unique_ptr<impl::ICPU> m_vcpu;
     std::unique_ptr<common::IPeriodicTaskExecutor> m_periodicExecutor;
+    std::unique_ptr<common::IPeriodicTaskExecutor> m_dispatchExecutor;
+    std::unique_ptr<common::IPeriodicTaskExecutor> m_transmitExecutor;
     std::unique_ptr<IMutexWrapper> m_subscribersMutexWrapper;
     std::unique_ptr<IMutexWrapper> m_requestsMutexWrapper;
-    std::map<common::CpuCommand, std::set<SessionID>> m_subscribers;
+    impl::SubscriberTable m_subscribers;  // changed under m_subscribersMutex, looked up without
     std::mutex m_subscribersMutex;
-    std::vector<std::tuple<common::UUID, common::CpuCommand, SessionID>> m_requests;
+    impl::PendingRequests m_requests;
     std::mutex m_requestsMutex;
+    impl::ReceiveQueue m_receiveQueue;
+    impl::TransmitQueue m_transmitQueue;
+    std::shared_ptr<impl::LinkMetrics> m_linkMetrics;  // recorded by the Protocols of m_vcpu
+    uint64_t m_writeStart;  // SendTrace stamp of the last write(), used on the transmit thread
     std::atomic_bool m_running;
 };
 
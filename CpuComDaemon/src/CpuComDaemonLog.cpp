@@ -15,6 +15,7 @@ namespace daemon {
 
 using common::DisplayTypeBool;
 using common::DisplayTypeDecInt32;
+using common::DisplayTypeDecUInt32;
 using common::DisplayTypeDecUInt64;
 using common::DisplayTypeHexUInt8;
 using common::DisplayTypeString;
@@ -38,6 +39,30 @@ void InitializeCpuComLogMessages()
         {LogID::Request,                    "Request received: %s\n", {DisplayTypeString(36, "Request ID")}},
         {LogID::Response,                   "Respond to request: %s\n", {DisplayTypeString(36, "Request ID")}},
         {LogID::CancelRequest,              "Cancel request: %s\n", {DisplayTypeString(36, "Request ID")}},
+        {LogID::TimeoutProfile,             "Timeouts of %s: response %d ms, field %d ms, retry %d ms, baud %d, auto-tune %d\n", {DisplayTypeString(16, "Link"), DisplayTypeDecInt32("Response"), DisplayTypeDecInt32("Field"), DisplayTypeDecInt32("Retry"), DisplayTypeDecInt32("Baud rate"), DisplayTypeBool("Auto-tune")}},
+        {LogID::InvalidTimeoutProfile,      "Invalid timeout profile of %s: %s\n", {DisplayTypeString(16, "Link"), DisplayTypeString(92, "Profile")}},
+        {LogID::PipelinedDivision,          "Pipelined frame division: %d\n", {DisplayTypeBool("Enabled")}},
+        {LogID::TransmitClasses,            "Transmit classes: %s\n", {DisplayTypeString(92, "Classes")}},
+        {LogID::InvalidTransmitClasses,     "Invalid transmit classes: %s\n", {DisplayTypeString(92, "Classes")}},
+        {LogID::CoalescedCommands,          "Coalesced commands: %s\n", {DisplayTypeString(92, "Commands")}},
+        {LogID::InvalidCoalescedCommands,   "Invalid coalesced commands: %s\n", {DisplayTypeString(92, "Commands")}},
+        {LogID::TransmitQueueFull,          "Transmit queue of %s full, rejected [%02x,%02x]\n", {DisplayTypeString(8, "Class"), DisplayTypeHexUInt8("Command"), DisplayTypeHexUInt8("Subcommand")}},
+        {LogID::QuotaProfile,               "Quota of each client: %u bytes/s, %u frames/s\n", {DisplayTypeDecUInt32("Bytes per second"), DisplayTypeDecUInt32("Frames per second")}},
+        {LogID::InvalidQuotaProfile,        "Invalid quota profile: %s\n", {DisplayTypeString(92, "Profile")}},
+        {LogID::ClientThrottled,            "Client over its quota, rejected [%02x,%02x]\n", {DisplayTypeHexUInt8("Command"), DisplayTypeHexUInt8("Subcommand")}},
+        {LogID::ClientConsumption,          "Client sent %lu commands, %lu bytes in %lu frames, throttled %lu\n", {DisplayTypeDecUInt64("Commands"), DisplayTypeDecUInt64("Bytes"), DisplayTypeDecUInt64("Frames"), DisplayTypeDecUInt64("Throttled")}},
+        {LogID::TransmitStatistics,         "Transmitted %s: sent %lu, rejected %lu, replaced %lu, max depth %lu, wait %lu/%lu us, service %lu/%lu us (mean/max)\n", {DisplayTypeString(8, "Class"), DisplayTypeDecUInt64("Sent"), DisplayTypeDecUInt64("Rejected"), DisplayTypeDecUInt64("Replaced"), DisplayTypeDecUInt64("Max depth"), DisplayTypeDecUInt64("Mean wait"), DisplayTypeDecUInt64("Max wait"), DisplayTypeDecUInt64("Mean service"), DisplayTypeDecUInt64("Max service")}},
+        {LogID::ReceiveStatistics,          "Received %lu, ring full %lu times, max occupancy %lu, wait %lu/%lu us, dispatch %lu/%lu us (mean/max)\n", {DisplayTypeDecUInt64("Received"), DisplayTypeDecUInt64("Full"), DisplayTypeDecUInt64("Max occupancy"), DisplayTypeDecUInt64("Mean wait"), DisplayTypeDecUInt64("Max wait"), DisplayTypeDecUInt64("Mean dispatch"), DisplayTypeDecUInt64("Max dispatch")}},
+        {LogID::RequestTimeout,             "Request timed out waiting for [%02x,%02x]: %s\n", {DisplayTypeHexUInt8("Command"), DisplayTypeHexUInt8("Subcommand"), DisplayTypeString(36, "Request ID")}},
+        {LogID::RequestTimeouts,            "Requests timed out waiting for [%02x,%02x]: %lu\n", {DisplayTypeHexUInt8("Command"), DisplayTypeHexUInt8("Subcommand"), DisplayTypeDecUInt64("Timeouts")}},
+        {LogID::InvalidRequestTimeout,      "Invalid request timeout %d ms, using %d ms\n", {DisplayTypeDecInt32("Given"), DisplayTypeDecInt32("Used")}},
+        {LogID::RequestCoalesced,           "Request joined an identical one in flight: %s\n", {DisplayTypeString(36, "Request ID")}},
+        {LogID::RequestsCoalesced,          "Requests [%02x,%02x] not sent again: %lu\n", {DisplayTypeHexUInt8("Command"), DisplayTypeHexUInt8("Subcommand"), DisplayTypeDecUInt64("Coalesced")}},
+        // traced, see Trace.h
+        {LogID::SerialSend,                 "M->V cmd=%02x%02x, len=%03lu, dat=%s\n", {DisplayTypeHexUInt8("Command"), DisplayTypeHexUInt8("Subcommand"), DisplayTypeDecUInt64("Length"), DisplayTypeString(88, "Data")}},
+        {LogID::SerialReceive,              "V->M cmd=%02x%02x, len=%03lu, dat=%s\n", {DisplayTypeHexUInt8("Command"), DisplayTypeHexUInt8("Subcommand"), DisplayTypeDecUInt64("Length"), DisplayTypeString(88, "Data")}},
+        {LogID::SendTraceQueued,            "Send trace %lu: client->daemon %lu us, queued %lu us\n", {DisplayTypeDecUInt64("Sequence"), DisplayTypeDecUInt64("Client to daemon"), DisplayTypeDecUInt64("Queued")}},
+        {LogID::SendTraceSent,              "Send trace %lu: dequeue->ENQ %lu us, ENQ->ACK2 %lu us, ACK2->status %lu us\n", {DisplayTypeDecUInt64("Sequence"), DisplayTypeDecUInt64("Dequeue to ENQ"), DisplayTypeDecUInt64("ENQ to ACK2"), DisplayTypeDecUInt64("ACK2 to status")}},
 
         {LogID::ReceiveFrameBegin,          "<RECV "},
         {LogID::ReceiveFrameEnd,            "RECV>\n"},
@@ -76,6 +101,8 @@ void InitializeCpuComLogMessages()
         {LogID::ChecksumDoesNotMatch,       "checksum does not match. expected - %02x, received - %02x -> ", {DisplayTypeHexUInt8("Expected"), common::DisplayTypeHexUInt8("Received")}},
         {LogID::ReceiveDone,                "done -> "},
         {LogID::ReceiveProcessNextFrame,    "done. process next frame -> "},
+        {LogID::PipelinedDivisionOffered,   "pipelined frame division offered(12) -> "},
+        {LogID::PipelinedDivisionAccepted,  "pipelined frame division accepted(13) -> "},
     };
     const common::LogMessageFormats cpuComDaemonLogErrorMessages =
     {
@@ -131,6 +158,8 @@ void InitializeCpuComLogMessages()
         {ErrorLogID::recvNak, "recvNak"},
         {ErrorLogID::recvError, "recvError"},
 
+        {ErrorLogID::FlightRecord, "flight record %s %s -%s-> after %u us, byte %02x, at %lu ns", {DisplayTypeString(8, "Machine"), DisplayTypeString(8, "State"), DisplayTypeString(8, "Event"), DisplayTypeDecUInt32("Dwell"), DisplayTypeHexUInt8("Byte"), DisplayTypeDecUInt64("Left")}},
+
     };
 
     // clang-format on
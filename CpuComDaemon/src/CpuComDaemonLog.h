@@ -27,6 +27,29 @@ enum LogID {
     Request,
     Response,
     CancelRequest,
+    TimeoutProfile,
+    InvalidTimeoutProfile,
+    PipelinedDivision,
+    TransmitClasses,
+    InvalidTransmitClasses,
+    CoalescedCommands,
+    InvalidCoalescedCommands,
+    TransmitQueueFull,
+    QuotaProfile,
+    InvalidQuotaProfile,
+    ClientThrottled,
+    ClientConsumption,
+    TransmitStatistics,
+    ReceiveStatistics,
+    RequestTimeout,
+    RequestTimeouts,
+    InvalidRequestTimeout,
+    RequestCoalesced,
+    RequestsCoalesced,
+    SerialSend,
+    SerialReceive,
+    SendTraceQueued,
+    SendTraceSent,
 
     ReceiveFrameBegin,
     ReceiveFrameEnd,
@@ -65,6 +88,8 @@ enum LogID {
     ChecksumDoesNotMatch,
     ReceiveDone,
     ReceiveProcessNextFrame,
+    PipelinedDivisionOffered,
+    PipelinedDivisionAccepted,
 };
 
 enum ErrorLogID {
@@ -118,6 +143,8 @@ enum ErrorLogID {
 
     recvNak,
     recvError,
+
+    FlightRecord,
 };
 
 void InitializeCpuComLogMessages();
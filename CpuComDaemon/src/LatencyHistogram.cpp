@@ -0,0 +1,84 @@
+/*
+ * COPYRIGHT (C) 2024 MITSUBISHI ELECTRIC CORPORATION
+ * ALL RIGHTS RESERVED
+ */
+
+#include "LatencyHistogram.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace com {
+namespace mitsubishielectric {
+namespace ahu {
+namespace cpucom {
+namespace impl {
+
+constexpr uint64_t LatencyHistogram::kMaxValue;
+
+LatencyHistogram::LatencyHistogram()
+    : m_counts()
+    , m_count(0)
+    , m_max(0)
+{
+}
+
+void LatencyHistogram::record(uint64_t value)
+{
+    value = std::min(value, kMaxValue);
+    ++m_counts[indexOf(value)];
+    ++m_count;
+    m_max = std::max(m_max, value);
+}
+
+uint64_t LatencyHistogram::count() const { return m_count; }
+
+uint64_t LatencyHistogram::max() const { return m_max; }
+
+uint64_t LatencyHistogram::percentile(double percentile) const
+{
+    if (m_count == 0) {
+        return 0;
+    }
+    const double rank = std::ceil((std::min(std::max(percentile, 0.0), 100.0) / 100.0) *
+                                  static_cast<double>(m_count));
+    const uint64_t target = std::max<uint64_t>(static_cast<uint64_t>(rank), 1);
+    uint64_t counted = 0;
+    for (size_t i = 0; i < kBucketCount; ++i) {
+        counted += m_counts[i];
+        if (counted >= target) {
+            return std::min(highestValueOf(i), m_max);
+        }
+    }
+    return m_max;  // LCOV_EXCL_LINE
+}
+
+size_t LatencyHistogram::indexOf(uint64_t value)
+{
+    if (value < kLinearBuckets) {
+        return static_cast<size_t>(value);
+    }
+    // value >> shift keeps the 5 highest bits, 16 to 31
+    size_t shift = 0;
+    while ((value >> shift) >= kLinearBuckets) {
+        ++shift;
+    }
+    return kLinearBuckets + ((shift - 1) * kSubBuckets) +
+           static_cast<size_t>((value >> shift) - kSubBuckets);
+}
+
+uint64_t LatencyHistogram::highestValueOf(size_t index)
+{
+    if (index < kLinearBuckets) {
+        return index;
+    }
+    const size_t shift = ((index - kLinearBuckets) / kSubBuckets) + 1;
+    const uint64_t high = ((index - kLinearBuckets) % kSubBuckets) + kSubBuckets;
+    return ((high + 1) << shift) - 1;
+}
+
+}  // namespace impl
+}  // namespace cpucom
+}  // namespace ahu
+}  // namespace mitsubishielectric
+}  // namespace com
@@ -0,0 +1,62 @@
+/*
+ * COPYRIGHT (C) 2024 MITSUBISHI ELECTRIC CORPORATION
+ * ALL RIGHTS RESERVED
+ */
+
+#ifndef COM_MITSUBISHIELECTRIC_AHU_CPUCOM_LATENCYHISTOGRAM_H_
+#define COM_MITSUBISHIELECTRIC_AHU_CPUCOM_LATENCYHISTOGRAM_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace com {
+namespace mitsubishielectric {
+namespace ahu {
+namespace cpucom {
+namespace impl {
+
+/**
+ * Histogram of latencies in microseconds with log-linear buckets, as HdrHistogram has them:
+ * values below 32 are counted exactly, each power of two above is split in 16 buckets,
+ * so a percentile is off by less than 1/16 of it. Values of more than 2^40 us (about
+ * 12 days) are counted as 2^40 us. Not synchronized.
+ */
+class LatencyHistogram {
+public:
+    static constexpr uint64_t kMaxValue = (static_cast<uint64_t>(1) << 40) - 1;
+
+    LatencyHistogram();
+
+    void record(uint64_t value);
+
+    uint64_t count() const;
+    uint64_t max() const;
+
+    /**
+     * @param percentile 0 to 100
+     * @return the highest value of the bucket holding the percentile, at most max(),
+     *         0 if nothing has been recorded
+     */
+    uint64_t percentile(double percentile) const;
+
+private:
+    static constexpr size_t kLinearBuckets = 32;
+    static constexpr size_t kSubBuckets = 16;  // per power of two from kLinearBuckets on
+    static constexpr size_t kBucketCount = kLinearBuckets + ((40 - 5) * kSubBuckets);
+
+    static size_t indexOf(uint64_t value);
+    static uint64_t highestValueOf(size_t index);
+
+    std::array<uint64_t, kBucketCount> m_counts;
+    uint64_t m_count;
+    uint64_t m_max;
+};
+
+}  // namespace impl
+}  // namespace cpucom
+}  // namespace ahu
+}  // namespace mitsubishielectric
+}  // namespace com
+
+#endif  // COM_MITSUBISHIELECTRIC_AHU_CPUCOM_LATENCYHISTOGRAM_H_
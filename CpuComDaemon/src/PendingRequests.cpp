@@ -0,0 +1,151 @@
+/*
+ * COPYRIGHT (C) 2024 MITSUBISHI ELECTRIC CORPORATION
+ * ALL RIGHTS RESERVED
+ */
+
+#include "PendingRequests.h"
+
+#include <algorithm>
+
+namespace com {
+namespace mitsubishielectric {
+namespace ahu {
+namespace cpucom {
+namespace impl {
+
+PendingRequests::PendingRequests(std::chrono::milliseconds timeout, Clock::time_point now)
+    : m_timeout(timeout)
+    , m_wheel(now)
+    , m_nextTimer(0)
+{
+}
+
+bool PendingRequests::add(const PendingRequest& request,
+                          const std::vector<uint8_t>& requestData,
+                          Clock::time_point now)
+{
+    remove(request.id);
+
+    // only a few transactions wait for the same response at a time
+    std::list<Transaction>& queue = m_byCommand[request.responseCommand];
+    auto transaction =
+        std::find_if(queue.begin(), queue.end(), [&](const Transaction& waiting) {
+            return (waiting.requestCommand == request.requestCommand) &&
+                   (waiting.requestData == requestData);
+        });
+    const bool joined = (transaction != queue.end());
+    if (joined) {
+        ++m_coalesced[request.requestCommand];
+    }
+    else {
+        transaction = queue.insert(queue.end(), Transaction{request.requestCommand, requestData, {}});
+    }
+    transaction->waiting.push_back(request.id);
+
+    const TimerWheel::Handle timer = m_wheel.schedule(m_nextTimer++, now + m_timeout);
+    m_byId[request.id] = {request, transaction, timer};
+    m_bySession[request.sessionID].insert(request.id);
+    m_byTimer[timer.id] = request.id;
+    return joined;
+}
+
+bool PendingRequests::take(common::CpuCommand responseCommand,
+                           std::vector<PendingRequest>& requests)
+{
+    auto queue = m_byCommand.find(responseCommand);
+    if (queue == m_byCommand.end()) {
+        return false;
+    }
+    // erase() drops the transaction with its last request
+    const std::vector<common::UUID> waiting = queue->second.front().waiting;
+    for (const common::UUID& id : waiting) {
+        auto entry = m_byId.find(id);
+        requests.push_back(entry->second.request);
+        erase(entry);
+    }
+    return true;
+}
+
+bool PendingRequests::remove(const common::UUID& id)
+{
+    auto entry = m_byId.find(id);
+    if (entry == m_byId.end()) {
+        return false;
+    }
+    erase(entry);
+    return true;
+}
+
+void PendingRequests::removeSession(const SessionID& sessionID)
+{
+    auto session = m_bySession.find(sessionID);
+    if (session == m_bySession.end()) {
+        return;
+    }
+    // erase() drops the session once its last request is gone
+    const std::set<common::UUID> ids = session->second;
+    for (const common::UUID& id : ids) {
+        remove(id);
+    }
+}
+
+std::vector<PendingRequest> PendingRequests::expire(Clock::time_point now)
+{
+    std::vector<TimerWheel::TimerID> timers;
+    m_wheel.advance(now, timers);
+
+    std::vector<PendingRequest> expired;
+    for (TimerWheel::TimerID timer : timers) {
+        // erase() cancels the timers of the requests answered or removed before
+        auto entry = m_byId.find(m_byTimer.at(timer));
+        expired.push_back(entry->second.request);
+        ++m_timeouts[entry->second.request.responseCommand];
+        erase(entry);
+    }
+    return expired;
+}
+
+const std::map<common::CpuCommand, uint64_t>& PendingRequests::timeouts() const
+{
+    return m_timeouts;
+}
+
+const std::map<common::CpuCommand, uint64_t>& PendingRequests::coalesced() const
+{
+    return m_coalesced;
+}
+
+size_t PendingRequests::size() const { return m_byId.size(); }
+
+size_t PendingRequests::timers() const { return m_wheel.size(); }
+
+void PendingRequests::erase(std::map<common::UUID, Entry>::iterator entry)
+{
+    const PendingRequest& request = entry->second.request;
+
+    std::vector<common::UUID>& waiting = entry->second.transaction->waiting;
+    waiting.erase(std::find(waiting.begin(), waiting.end(), request.id));
+    if (waiting.empty()) {
+        auto queue = m_byCommand.find(request.responseCommand);
+        queue->second.erase(entry->second.transaction);
+        if (queue->second.empty()) {
+            m_byCommand.erase(queue);
+        }
+    }
+
+    auto session = m_bySession.find(request.sessionID);
+    session->second.erase(request.id);
+    if (session->second.empty()) {
+        m_bySession.erase(session);
+    }
+
+    m_wheel.cancel(entry->second.timer);
+    m_byTimer.erase(entry->second.timer.id);
+    m_byId.erase(entry);
+}
+
+}  // namespace impl
+}  // namespace cpucom
+}  // namespace ahu
+}  // namespace mitsubishielectric
+}  // namespace com
@@ -0,0 +1,127 @@
+/*
+ * COPYRIGHT (C) 2024 MITSUBISHI ELECTRIC CORPORATION
+ * ALL RIGHTS RESERVED
+ */
+
+#ifndef COM_MITSUBISHIELECTRIC_AHU_CPUCOM_PENDINGREQUESTS_H_
+#define COM_MITSUBISHIELECTRIC_AHU_CPUCOM_PENDINGREQUESTS_H_
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <map>
+#include <set>
+#include <vector>
+
+#include "CpuCommand.h"
+#include "IMessageServer.h"
+#include "TimerWheel.h"
+#include "UUID.h"
+
+namespace com {
+namespace mitsubishielectric {
+namespace ahu {
+namespace cpucom {
+namespace impl {
+
+// how long a request waits for its response by default
+constexpr std::chrono::milliseconds kDefaultRequestTimeout(10000);
+
+/**
+ * A request sent to the V-CPU by a client, waiting for its response.
+ */
+struct PendingRequest {
+    common::UUID id;
+    common::CpuCommand requestCommand;
+    common::CpuCommand responseCommand;
+    IMessageServer::SessionID sessionID;
+};
+
+/**
+ * The requests waiting for a response, found by response command in the order they were
+ * sent, by id and by session. Requests identical to one still waiting, in request command,
+ * data and response command, join its transaction and get the same response instead of
+ * being sent again. Each request expires after a timeout. Not thread safe.
+ */
+class PendingRequests {
+public:
+    using Clock = TimerWheel::Clock;
+    using SessionID = IMessageServer::SessionID;
+
+    explicit PendingRequests(std::chrono::milliseconds timeout = kDefaultRequestTimeout,
+                             Clock::time_point now = Clock::now());
+
+    /**
+     * Adds a request, replacing one with the same id.
+     * @return true if it joined an identical request waiting, so it is not to be sent
+     */
+    bool add(const PendingRequest& request,
+             const std::vector<uint8_t>& requestData,
+             Clock::time_point now = Clock::now());
+
+    /**
+     * Removes the requests of the oldest transaction waiting for responseCommand.
+     * @param requests gets them, the first added first
+     * @return false if there is none
+     */
+    bool take(common::CpuCommand responseCommand, std::vector<PendingRequest>& requests);
+
+    /**
+     * @return false if no request has id
+     */
+    bool remove(const common::UUID& id);
+
+    void removeSession(const SessionID& sessionID);
+
+    /**
+     * Removes the requests which timed out by now.
+     * @return them, the oldest first
+     */
+    std::vector<PendingRequest> expire(Clock::time_point now = Clock::now());
+
+    // requests timed out so far, by response command
+    const std::map<common::CpuCommand, uint64_t>& timeouts() const;
+
+    // requests which joined an identical one instead of being sent, by request command
+    const std::map<common::CpuCommand, uint64_t>& coalesced() const;
+
+    size_t size() const;
+    // timers in the wheel, one per request waiting
+    size_t timers() const;
+
+private:
+    // one request sent, answered by one response
+    struct Transaction {
+        common::CpuCommand requestCommand;
+        std::vector<uint8_t> requestData;
+        std::vector<common::UUID> waiting;
+    };
+
+    struct Entry {
+        PendingRequest request;
+        std::list<Transaction>::iterator transaction;  // in m_byCommand
+        TimerWheel::Handle timer;  // cancelled when the request leaves
+    };
+
+    void erase(std::map<common::UUID, Entry>::iterator entry);
+
+private:
+    const std::chrono::milliseconds m_timeout;
+    std::map<common::UUID, Entry> m_byId;
+    std::map<common::CpuCommand, std::list<Transaction>> m_byCommand;
+    std::map<SessionID, std::set<common::UUID>> m_bySession;
+    TimerWheel m_wheel;
+    TimerWheel::TimerID m_nextTimer;
+    std::map<TimerWheel::TimerID, common::UUID> m_byTimer;
+    std::map<common::CpuCommand, uint64_t> m_timeouts;
+    std::map<common::CpuCommand, uint64_t> m_coalesced;
+};
+
+}  // namespace impl
+}  // namespace cpucom
+}  // namespace ahu
+}  // namespace mitsubishielectric
+}  // namespace com
+
+#endif  // COM_MITSUBISHIELECTRIC_AHU_CPUCOM_PENDINGREQUESTS_H_
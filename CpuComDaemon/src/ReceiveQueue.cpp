@@ -0,0 +1,169 @@
+/*
+ * COPYRIGHT (C) 2024 MITSUBISHI ELECTRIC CORPORATION
+ * ALL RIGHTS RESERVED
+ */
+
+#include "ReceiveQueue.h"
+
+#include <algorithm>
+#include <cstdio>
+
+namespace com {
+namespace mitsubishielectric {
+namespace ahu {
+namespace cpucom {
+namespace impl {
+
+namespace {
+
+uint64_t toMicroseconds(std::chrono::steady_clock::duration time)
+{
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(time).count());
+}
+
+// only one thread writes each statistic, so these need no compare and swap
+void add(std::atomic<uint64_t>& total, uint64_t value)
+{
+    total.store(total.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+
+template <typename T>
+void raise(std::atomic<T>& maximum, T value)
+{
+    if (value > maximum.load(std::memory_order_relaxed)) {
+        maximum.store(value, std::memory_order_relaxed);
+    }
+}
+
+}  // namespace
+
+constexpr size_t ReceiveQueue::kCapacity;
+
+ReceiveQueue::ReceiveQueue()
+    : m_waiting(false)
+    , m_stalled(false)
+    , m_closed(false)
+    , m_received(0)
+    , m_full(0)
+    , m_totalStall(0)
+    , m_maxStall(0)
+    , m_maxOccupancy(0)
+    , m_totalWait(0)
+    , m_maxWait(0)
+    , m_dispatched(0)
+    , m_totalDispatch(0)
+    , m_maxDispatch(0)
+{
+}
+
+bool ReceiveQueue::push(ReceivedMessage&& message)
+{
+    if (!m_ring.push(std::move(message))) {
+        return false;
+    }
+    add(m_received, 1);
+    raise(m_maxOccupancy, m_ring.size());
+    // pairs with pop(): either the dispatch thread sees the message before it sleeps
+    // or this sees it waiting and wakes it
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (m_waiting.load(std::memory_order_relaxed)) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_condition.notify_one();
+    }
+    return true;
+}
+
+void ReceiveQueue::waitForRoom(std::chrono::milliseconds timeout)
+{
+    add(m_full, 1);
+    const auto stalled = std::chrono::steady_clock::now();
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_stalled.store(true, std::memory_order_relaxed);
+        // pairs with pop() like push() does with the sleep of the dispatch thread
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        m_room.wait_for(lock, timeout,
+                        [this]() { return m_closed || (m_ring.size() < kCapacity); });
+        m_stalled.store(false, std::memory_order_relaxed);
+    }
+    const uint64_t stall = toMicroseconds(std::chrono::steady_clock::now() - stalled);
+    add(m_totalStall, stall);
+    raise(m_maxStall, stall);
+}
+
+bool ReceiveQueue::pop(ReceivedMessage& message, std::chrono::milliseconds timeout)
+{
+    if (!m_ring.pop(message)) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_waiting.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        m_condition.wait_for(lock, timeout, [this]() { return m_closed || !m_ring.empty(); });
+        m_waiting.store(false, std::memory_order_relaxed);
+        if (m_closed || !m_ring.pop(message)) {
+            return false;
+        }
+    }
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (m_stalled.load(std::memory_order_relaxed)) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_room.notify_one();
+    }
+    const uint64_t wait = toMicroseconds(std::chrono::steady_clock::now() - message.received);
+    add(m_totalWait, wait);
+    raise(m_maxWait, wait);
+    return true;
+}
+
+void ReceiveQueue::onDispatched(std::chrono::steady_clock::time_point dispatched)
+{
+    const uint64_t time = toMicroseconds(std::chrono::steady_clock::now() - dispatched);
+    add(m_dispatched, 1);
+    add(m_totalDispatch, time);
+    raise(m_maxDispatch, time);
+}
+
+void ReceiveQueue::close()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_closed = true;
+    m_condition.notify_all();
+    m_room.notify_all();
+}
+
+size_t ReceiveQueue::occupancy() const { return m_ring.size(); }
+
+ReceiveStatistics ReceiveQueue::statistics() const
+{
+    ReceiveStatistics statistics = {};
+    statistics.received = m_received.load(std::memory_order_relaxed);
+    statistics.full = m_full.load(std::memory_order_relaxed);
+    statistics.totalStall = m_totalStall.load(std::memory_order_relaxed);
+    statistics.maxStall = m_maxStall.load(std::memory_order_relaxed);
+    statistics.maxOccupancy = m_maxOccupancy.load(std::memory_order_relaxed);
+    statistics.totalWait = m_totalWait.load(std::memory_order_relaxed);
+    statistics.maxWait = m_maxWait.load(std::memory_order_relaxed);
+    statistics.dispatched = m_dispatched.load(std::memory_order_relaxed);
+    statistics.totalDispatch = m_totalDispatch.load(std::memory_order_relaxed);
+    statistics.maxDispatch = m_maxDispatch.load(std::memory_order_relaxed);
+    return statistics;
+}
+
+std::string formatReceiveStats(const ReceiveStatistics& statistics)
+{
+    char text[160] = {};
+    std::snprintf(text, sizeof(text),
+                  "received %llu, max occupancy %zu, full %llu, stalled us %llu,"
+                  " max stall us %llu\n",
+                  static_cast<unsigned long long>(statistics.received), statistics.maxOccupancy,
+                  static_cast<unsigned long long>(statistics.full),
+                  static_cast<unsigned long long>(statistics.totalStall),
+                  static_cast<unsigned long long>(statistics.maxStall));
+    return text;
+}
+
+}  // namespace impl
+}  // namespace cpucom
+}  // namespace ahu
+}  // namespace mitsubishielectric
+}  // namespace com
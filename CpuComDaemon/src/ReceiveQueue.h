@@ -0,0 +1,125 @@
+/*
+ * COPYRIGHT (C) 2024 MITSUBISHI ELECTRIC CORPORATION
+ * ALL RIGHTS RESERVED
+ */
+
+#ifndef COM_MITSUBISHIELECTRIC_AHU_CPUCOM_RECEIVEQUEUE_H_
+#define COM_MITSUBISHIELECTRIC_AHU_CPUCOM_RECEIVEQUEUE_H_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "CpuCommand.h"
+#include "ReceiveTimes.h"
+#include "SpscRing.h"
+
+namespace com {
+namespace mitsubishielectric {
+namespace ahu {
+namespace cpucom {
+namespace impl {
+
+/**
+ * A message received from the V-CPU on its way to the clients.
+ */
+struct ReceivedMessage {
+    common::CpuCommand command;
+    std::vector<uint8_t> data;
+    std::chrono::steady_clock::time_point received;
+    ReceiveTimes line;  // when it arrived on the line, before received
+};
+
+/**
+ * How messages went through the ReceiveQueue. The times are in microseconds.
+ */
+struct ReceiveStatistics {
+    uint64_t received;       // messages pushed
+    uint64_t full;           // times the receive thread found the ring full
+    uint64_t totalStall;     // the receive thread waited for the dispatch thread to make room
+    uint64_t maxStall;
+    size_t maxOccupancy;     // messages in the ring at most
+    uint64_t totalWait;      // from being received to being taken by the dispatch thread
+    uint64_t maxWait;
+    uint64_t dispatched;     // messages delivered to the clients
+    uint64_t totalDispatch;  // taken delivering to the clients
+    uint64_t maxDispatch;
+};
+
+/**
+ * Hands the messages received by the receive thread to the dispatch thread,
+ * through a SpscRing which the receive thread never waits for a lock on while there is room.
+ * The dispatch thread sleeps while there is nothing to dispatch, and the receive thread
+ * while the ring is full.
+ */
+class ReceiveQueue {
+public:
+    static constexpr size_t kCapacity = 256;
+
+    ReceiveQueue();
+
+    /**
+     * Only called by the receive thread.
+     * @return false without moving from message if the ring is full
+     */
+    bool push(ReceivedMessage&& message);
+    /**
+     * Only called by the receive thread after a push() which failed as the ring was full.
+     * Counts the stall and waits up to timeout for the dispatch thread to pop a message.
+     */
+    void waitForRoom(std::chrono::milliseconds timeout);
+
+    /**
+     * Only called by the dispatch thread. Waits up to timeout for a message.
+     * @return false if there was none
+     */
+    bool pop(ReceivedMessage& message, std::chrono::milliseconds timeout);
+    // a message popped was delivered to the clients, started at dispatched
+    void onDispatched(std::chrono::steady_clock::time_point dispatched);
+
+    // wakes pop() and waitForRoom() for good
+    void close();
+
+    size_t occupancy() const;
+    ReceiveStatistics statistics() const;
+
+private:
+    SpscRing<ReceivedMessage, kCapacity> m_ring;
+    std::atomic_bool m_waiting;  // the dispatch thread is about to sleep or sleeping
+    std::atomic_bool m_stalled;  // the receive thread is about to sleep or sleeping
+    bool m_closed;
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    std::condition_variable m_room;
+
+    // written only by the receive thread
+    std::atomic<uint64_t> m_received;
+    std::atomic<uint64_t> m_full;
+    std::atomic<uint64_t> m_totalStall;
+    std::atomic<uint64_t> m_maxStall;
+    std::atomic<size_t> m_maxOccupancy;
+    // written only by the dispatch thread
+    std::atomic<uint64_t> m_totalWait;
+    std::atomic<uint64_t> m_maxWait;
+    std::atomic<uint64_t> m_dispatched;
+    std::atomic<uint64_t> m_totalDispatch;
+    std::atomic<uint64_t> m_maxDispatch;
+};
+
+/**
+ * Formats the statistics of the receive queue as text, for CpuComId::Stats.
+ */
+std::string formatReceiveStats(const ReceiveStatistics& statistics);
+
+}  // namespace impl
+}  // namespace cpucom
+}  // namespace ahu
+}  // namespace mitsubishielectric
+}  // namespace com
+
+#endif  // COM_MITSUBISHIELECTRIC_AHU_CPUCOM_RECEIVEQUEUE_H_
@@ -0,0 +1,95 @@
+/*
+ * COPYRIGHT (C) 2024 MITSUBISHI ELECTRIC CORPORATION
+ * ALL RIGHTS RESERVED
+ */
+
+#ifndef COM_MITSUBISHIELECTRIC_AHU_CPUCOM_SPSCRING_H_
+#define COM_MITSUBISHIELECTRIC_AHU_CPUCOM_SPSCRING_H_
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+namespace com {
+namespace mitsubishielectric {
+namespace ahu {
+namespace cpucom {
+namespace impl {
+
+/**
+ * Lock free ring of up to Capacity elements, for one thread which push()es
+ * and one other thread which pop()s.
+ */
+template <typename T, size_t Capacity>
+class SpscRing {
+    static_assert((Capacity != 0) && ((Capacity & (Capacity - 1)) == 0),
+                  "Capacity must be a power of 2");
+
+public:
+    SpscRing()
+        : m_head(0)
+        , m_tail(0)
+        , m_slots()
+    {
+    }
+
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    /**
+     * Only called by the producer.
+     * @return false without moving from value if the ring is full
+     */
+    bool push(T&& value)
+    {
+        const size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail - m_head.load(std::memory_order_acquire) == Capacity) {
+            return false;
+        }
+        m_slots[tail & (Capacity - 1)] = std::move(value);
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Only called by the consumer.
+     * @return false if the ring is empty
+     */
+    bool pop(T& value)
+    {
+        const size_t head = m_head.load(std::memory_order_relaxed);
+        if (head == m_tail.load(std::memory_order_acquire)) {
+            return false;
+        }
+        value = std::move(m_slots[head & (Capacity - 1)]);
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // exact only when called by the producer or the consumer while the other one is idle
+    size_t size() const
+    {
+        return m_tail.load(std::memory_order_acquire) - m_head.load(std::memory_order_acquire);
+    }
+
+    bool empty() const { return size() == 0; }
+
+    static constexpr size_t capacity() { return Capacity; }
+
+private:
+    static constexpr size_t kCacheLineSize = 64;
+
+    // each index on its own cache line, so that the threads do not invalidate each other's
+    alignas(kCacheLineSize) std::atomic<size_t> m_head;  // written by the consumer
+    alignas(kCacheLineSize) std::atomic<size_t> m_tail;  // written by the producer
+    alignas(kCacheLineSize) std::array<T, Capacity> m_slots;
+};
+
+}  // namespace impl
+}  // namespace cpucom
+}  // namespace ahu
+}  // namespace mitsubishielectric
+}  // namespace com
+
+#endif  // COM_MITSUBISHIELECTRIC_AHU_CPUCOM_SPSCRING_H_
@@ -0,0 +1,185 @@
+/*
+ * COPYRIGHT (C) 2024 MITSUBISHI ELECTRIC CORPORATION
+ * ALL RIGHTS RESERVED
+ */
+
+#include "SubscriberTable.h"
+
+#include <algorithm>
+#include <thread>
+
+namespace com {
+namespace mitsubishielectric {
+namespace ahu {
+namespace cpucom {
+namespace impl {
+
+namespace {
+
+const SubscriberTable::Subscribers kNoSubscribers;
+
+}  // namespace
+
+constexpr size_t SubscriberTable::kSlotCount;
+
+SubscriberTable::Snapshot::Snapshot(std::atomic<uint32_t>* readers,
+                                    const Subscribers* subscribers)
+    : m_readers(readers)
+    , m_subscribers(subscribers)
+{
+}
+
+SubscriberTable::Snapshot::Snapshot(Snapshot&& other)
+    : m_readers(other.m_readers)
+    , m_subscribers(other.m_subscribers)
+{
+    other.m_readers = nullptr;
+}
+
+SubscriberTable::Snapshot::~Snapshot()
+{
+    if (m_readers != nullptr) {
+        m_readers->fetch_sub(1, std::memory_order_release);
+    }
+}
+
+SubscriberTable::SubscriberTable()
+    : m_slots(new std::atomic<const Subscribers*>[kSlotCount]())
+    , m_epoch(0)
+    , m_readers()
+    , m_commandCount(0)
+{
+}
+
+SubscriberTable::~SubscriberTable()
+{
+    for (size_t i = 0; i < kSlotCount; ++i) {
+        delete m_slots[i].load(std::memory_order_relaxed);
+    }
+}
+
+SubscriberTable::Snapshot SubscriberTable::find(common::CpuCommand command) const
+{
+    // registers in the current epoch, again if synchronize() moved on meanwhile
+    std::atomic<uint32_t>* readers = nullptr;
+    for (;;) {
+        const uint32_t epoch = m_epoch.load();
+        readers = &m_readers[epoch & 1];
+        readers->fetch_add(1);
+        if (m_epoch.load() == epoch) {
+            break;
+        }
+        readers->fetch_sub(1, std::memory_order_release);
+    }
+    const Subscribers* subscribers = m_slots[slotOf(command)].load(std::memory_order_acquire);
+    return Snapshot(readers, (subscribers != nullptr) ? subscribers : &kNoSubscribers);
+}
+
+bool SubscriberTable::subscribe(const SessionID& sessionID, common::CpuCommand command)
+{
+    if (!m_commands[sessionID].insert(command).second) {
+        return false;
+    }
+    const size_t slot = slotOf(command);
+    const Subscribers* current = m_slots[slot].load(std::memory_order_relaxed);
+    auto subscribers = (current != nullptr) ? std::make_unique<Subscribers>(*current)
+                                            : std::make_unique<Subscribers>();
+    subscribers->push_back(sessionID);
+    if (current == nullptr) {
+        ++m_commandCount;
+    }
+    release({publish(slot, subscribers.release())});
+    return true;
+}
+
+bool SubscriberTable::unsubscribe(const SessionID& sessionID, common::CpuCommand command)
+{
+    auto session = m_commands.find(sessionID);
+    if ((session == m_commands.end()) || (session->second.erase(command) == 0)) {
+        return false;
+    }
+    if (session->second.empty()) {
+        m_commands.erase(session);
+    }
+
+    const size_t slot = slotOf(command);
+    const Subscribers* current = m_slots[slot].load(std::memory_order_relaxed);
+    std::unique_ptr<Subscribers> subscribers;
+    if (current->size() > 1) {
+        subscribers = std::make_unique<Subscribers>(*current);
+        subscribers->erase(std::find(subscribers->begin(), subscribers->end(), sessionID));
+    }
+    else {
+        --m_commandCount;
+    }
+    release({publish(slot, subscribers.release())});
+    return true;
+}
+
+void SubscriberTable::removeSession(const SessionID& sessionID)
+{
+    auto session = m_commands.find(sessionID);
+    if (session == m_commands.end()) {
+        return;
+    }
+
+    std::vector<const Subscribers*> retired;
+    for (const common::CpuCommand& command : session->second) {
+        const size_t slot = slotOf(command);
+        const Subscribers* current = m_slots[slot].load(std::memory_order_relaxed);
+        std::unique_ptr<Subscribers> subscribers;
+        if (current->size() > 1) {
+            subscribers = std::make_unique<Subscribers>(*current);
+            subscribers->erase(std::find(subscribers->begin(), subscribers->end(), sessionID));
+        }
+        else {
+            --m_commandCount;
+        }
+        retired.push_back(publish(slot, subscribers.release()));
+    }
+    m_commands.erase(session);
+    // one grace period for all the commands
+    release(retired);
+}
+
+size_t SubscriberTable::commandCount() const { return m_commandCount; }
+
+size_t SubscriberTable::slotOf(common::CpuCommand command)
+{
+    return (static_cast<size_t>(command.first) << 8) | command.second;
+}
+
+const SubscriberTable::Subscribers* SubscriberTable::publish(size_t slot,
+                                                             const Subscribers* subscribers)
+{
+    return m_slots[slot].exchange(subscribers, std::memory_order_acq_rel);
+}
+
+void SubscriberTable::synchronize()
+{
+    // a find() after this sees what was published before; one before it is counted in
+    // the readers of the previous epoch, which are waited for
+    const uint32_t epoch = m_epoch.fetch_add(1);
+    std::atomic<uint32_t>& readers = m_readers[epoch & 1];
+    while (readers.load(std::memory_order_acquire) != 0) {
+        std::this_thread::yield();
+    }
+}
+
+void SubscriberTable::release(const std::vector<const Subscribers*>& retired)
+{
+    if (std::all_of(retired.begin(), retired.end(),
+                    [](const Subscribers* subscribers) { return subscribers == nullptr; })) {
+        return;
+    }
+    synchronize();
+    for (const Subscribers* subscribers : retired) {
+        delete subscribers;
+    }
+}
+
+}  // namespace impl
+}  // namespace cpucom
+}  // namespace ahu
+}  // namespace mitsubishielectric
+}  // namespace com
@@ -0,0 +1,119 @@
+/*
+ * COPYRIGHT (C) 2024 MITSUBISHI ELECTRIC CORPORATION
+ * ALL RIGHTS RESERVED
+ */
+
+#ifndef COM_MITSUBISHIELECTRIC_AHU_CPUCOM_SUBSCRIBERTABLE_H_
+#define COM_MITSUBISHIELECTRIC_AHU_CPUCOM_SUBSCRIBERTABLE_H_
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <set>
+#include <vector>
+
+#include "CpuCommand.h"
+#include "IMessageServer.h"
+
+namespace com {
+namespace mitsubishielectric {
+namespace ahu {
+namespace cpucom {
+namespace impl {
+
+/**
+ * The sessions subscribed to each command, in a slot per command.
+ *
+ * A slot holds an array of sessions which is never changed once published: a change
+ * publishes a new array and frees the old one only when no find() may still be using it,
+ * read-copy-update style. find() takes no lock and allocates nothing.
+ * The other members change the table and must not be called concurrently with each other.
+ */
+class SubscriberTable {
+public:
+    using SessionID = IMessageServer::SessionID;
+    using Subscribers = std::vector<SessionID>;
+
+    static constexpr size_t kSlotCount = 65536;
+
+    /**
+     * The subscribers of a command as they were when it was looked up.
+     * Keeps them from being freed until it is destroyed, so should not be kept for long.
+     */
+    class Snapshot {
+    public:
+        Snapshot(Snapshot&& other);
+        ~Snapshot();
+
+        Snapshot(const Snapshot&) = delete;
+        Snapshot& operator=(const Snapshot&) = delete;
+        Snapshot& operator=(Snapshot&&) = delete;
+
+        const Subscribers& subscribers() const { return *m_subscribers; }
+
+    private:
+        friend class SubscriberTable;
+
+        Snapshot(std::atomic<uint32_t>* readers, const Subscribers* subscribers);
+
+    private:
+        std::atomic<uint32_t>* m_readers;  // of the epoch it was taken in
+        const Subscribers* m_subscribers;
+    };
+
+    SubscriberTable();
+    ~SubscriberTable();
+
+    SubscriberTable(const SubscriberTable&) = delete;
+    SubscriberTable& operator=(const SubscriberTable&) = delete;
+
+    // may be called from any thread at any time
+    Snapshot find(common::CpuCommand command) const;
+
+    /**
+     * @return false if sessionID was subscribed to command already
+     */
+    bool subscribe(const SessionID& sessionID, common::CpuCommand command);
+
+    /**
+     * @return false if sessionID was not subscribed to command
+     */
+    bool unsubscribe(const SessionID& sessionID, common::CpuCommand command);
+
+    // unsubscribes sessionID from all its commands
+    void removeSession(const SessionID& sessionID);
+
+    // commands somebody is subscribed to
+    size_t commandCount() const;
+
+private:
+    static size_t slotOf(common::CpuCommand command);
+
+    /**
+     * Publishes subscribers in slot, nullptr if there are none.
+     * @return the array which was there, to be freed after synchronize()
+     */
+    const Subscribers* publish(size_t slot, const Subscribers* subscribers);
+    // waits until no find() started before it may still use an array replaced before it
+    void synchronize();
+    void release(const std::vector<const Subscribers*>& retired);
+
+private:
+    std::unique_ptr<std::atomic<const Subscribers*>[]> m_slots;
+    std::atomic<uint32_t> m_epoch;
+    mutable std::array<std::atomic<uint32_t>, 2> m_readers;  // snapshots alive, by epoch parity
+
+    std::map<SessionID, std::set<common::CpuCommand>> m_commands;  // what each session is in
+    size_t m_commandCount;
+};
+
+}  // namespace impl
+}  // namespace cpucom
+}  // namespace ahu
+}  // namespace mitsubishielectric
+}  // namespace com
+
+#endif  // COM_MITSUBISHIELECTRIC_AHU_CPUCOM_SUBSCRIBERTABLE_H_
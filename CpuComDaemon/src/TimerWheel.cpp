@@ -0,0 +1,121 @@
+/*
+ * COPYRIGHT (C) 2024 MITSUBISHI ELECTRIC CORPORATION
+ * ALL RIGHTS RESERVED
+ */
+
+#include "TimerWheel.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace com {
+namespace mitsubishielectric {
+namespace ahu {
+namespace cpucom {
+namespace impl {
+
+constexpr std::chrono::milliseconds TimerWheel::kTick;
+constexpr size_t TimerWheel::kNearSlots;
+constexpr size_t TimerWheel::kFarSlots;
+
+TimerWheel::TimerWheel(Clock::time_point now)
+    : m_start(now)
+    , m_tick(0)
+    , m_size(0)
+{
+}
+
+TimerWheel::Handle TimerWheel::schedule(TimerID id, Clock::time_point deadline)
+{
+    uint64_t tick = 0;
+    if (deadline > m_start) {
+        // the first tick at or after the deadline
+        const auto elapsed = deadline - m_start;
+        tick = static_cast<uint64_t>((elapsed + kTick - Clock::duration(1)) / kTick);
+    }
+    const Timer timer = {id, std::max(tick, m_tick + 1)};
+    place(timer);
+    ++m_size;
+    return timer;
+}
+
+void TimerWheel::cancel(const Handle& handle)
+{
+    if (handle.tick <= m_tick) {
+        return;
+    }
+    // place() put it in one of these, cascading moves it down from the far wheel on time
+    std::vector<Timer>* slots[] = {&m_near[handle.tick % kNearSlots],
+                                   &m_far[(handle.tick / kNearSlots) % kFarSlots], &m_overflow};
+    for (std::vector<Timer>* slot : slots) {
+        auto timer = std::find_if(slot->begin(), slot->end(),
+                                  [&handle](const Timer& t) { return t.id == handle.id; });
+        if (timer != slot->end()) {
+            // erased in place, the timers due at the same tick keep their order
+            slot->erase(timer);
+            --m_size;
+            return;
+        }
+    }
+}
+
+void TimerWheel::advance(Clock::time_point now, std::vector<TimerID>& expired)
+{
+    const uint64_t target = tickOf(now);
+    while ((m_tick < target) && (m_size > 0)) {
+        const uint64_t tick = m_tick + 1;
+        if ((tick % kNearSlots) == 0) {
+            // a new turn of the near wheel, the timers of its ticks move down to it
+            const uint64_t turn = tick / kNearSlots;
+            if ((turn % kFarSlots) == 0) {
+                std::vector<Timer> overflow;
+                overflow.swap(m_overflow);
+                for (const Timer& timer : overflow) {
+                    place(timer);
+                }
+            }
+            std::vector<Timer> far;
+            far.swap(m_far[turn % kFarSlots]);
+            for (const Timer& timer : far) {
+                place(timer);
+            }
+        }
+
+        m_tick = tick;
+        std::vector<Timer>& slot = m_near[tick % kNearSlots];
+        for (const Timer& timer : slot) {
+            expired.push_back(timer.id);
+        }
+        m_size -= slot.size();
+        slot.clear();
+    }
+    // nothing is waiting for the ticks left
+    m_tick = std::max(m_tick, target);
+}
+
+size_t TimerWheel::size() const { return m_size; }
+
+uint64_t TimerWheel::tickOf(Clock::time_point time) const
+{
+    return (time > m_start) ? static_cast<uint64_t>((time - m_start) / kTick) : 0;
+}
+
+void TimerWheel::place(const Timer& timer)
+{
+    // each slot is done once within the ticks or turns from now it may be given
+    if ((timer.tick - m_tick) <= kNearSlots) {
+        m_near[timer.tick % kNearSlots].push_back(timer);
+    }
+    else if (((timer.tick / kNearSlots) - (m_tick / kNearSlots)) <= kFarSlots) {
+        m_far[(timer.tick / kNearSlots) % kFarSlots].push_back(timer);
+    }
+    else {
+        m_overflow.push_back(timer);
+    }
+}
+
+}  // namespace impl
+}  // namespace cpucom
+}  // namespace ahu
+}  // namespace mitsubishielectric
+}  // namespace com
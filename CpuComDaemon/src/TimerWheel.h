@@ -0,0 +1,83 @@
+/*
+ * COPYRIGHT (C) 2024 MITSUBISHI ELECTRIC CORPORATION
+ * ALL RIGHTS RESERVED
+ */
+
+#ifndef COM_MITSUBISHIELECTRIC_AHU_CPUCOM_TIMERWHEEL_H_
+#define COM_MITSUBISHIELECTRIC_AHU_CPUCOM_TIMERWHEEL_H_
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace com {
+namespace mitsubishielectric {
+namespace ahu {
+namespace cpucom {
+namespace impl {
+
+/**
+ * Deadlines of timers in two wheels of slots: the near one a tick per slot, the far one
+ * a turn of the near one per slot. Timers beyond the far wheel wait in an overflow list.
+ * Scheduling takes constant time, a tick moves at most one slot of the far wheel down.
+ * A timer expires at the first tick at or after its deadline, unless it is cancelled before.
+ * Not thread safe.
+ */
+class TimerWheel {
+public:
+    using Clock = std::chrono::steady_clock;
+    using TimerID = uint64_t;
+
+    static constexpr std::chrono::milliseconds kTick{10};
+    static constexpr size_t kNearSlots = 256;  // 2.56 s
+    static constexpr size_t kFarSlots = 64;    // 163.84 s
+
+    explicit TimerWheel(Clock::time_point now = Clock::now());
+
+    // a timer scheduled, as needed to cancel it
+    struct Handle {
+        TimerID id;
+        uint64_t tick;  // due
+    };
+
+    Handle schedule(TimerID id, Clock::time_point deadline);
+
+    /**
+     * Removes a timer which has not expired yet, searching only the slot it is in.
+     * A timer which expired already is left alone.
+     */
+    void cancel(const Handle& handle);
+
+    /**
+     * Moves the wheels on to now.
+     * @param expired gets the timers due meanwhile appended, soonest first
+     */
+    void advance(Clock::time_point now, std::vector<TimerID>& expired);
+
+    // timers scheduled and not expired yet
+    size_t size() const;
+
+private:
+    using Timer = Handle;
+
+    uint64_t tickOf(Clock::time_point time) const;
+    void place(const Timer& timer);
+
+private:
+    const Clock::time_point m_start;
+    uint64_t m_tick;  // last one done
+    size_t m_size;
+    std::array<std::vector<Timer>, kNearSlots> m_near;
+    std::array<std::vector<Timer>, kFarSlots> m_far;
+    std::vector<Timer> m_overflow;
+};
+
+}  // namespace impl
+}  // namespace cpucom
+}  // namespace ahu
+}  // namespace mitsubishielectric
+}  // namespace com
+
+#endif  // COM_MITSUBISHIELECTRIC_AHU_CPUCOM_TIMERWHEEL_H_
@@ -0,0 +1,354 @@
+/*
+ * COPYRIGHT (C) 2024 MITSUBISHI ELECTRIC CORPORATION
+ * ALL RIGHTS RESERVED
+ */
+
+#include "TransmitQueue.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <iterator>
+#include <sstream>
+
+namespace com {
+namespace mitsubishielectric {
+namespace ahu {
+namespace cpucom {
+namespace impl {
+
+namespace {
+
+const size_t kCommandDigits = 4;
+
+bool parseCommand(const std::string& text, common::CpuCommand& command)
+{
+    if ((text.size() != kCommandDigits) ||
+        !std::all_of(text.begin(), text.end(), ::isxdigit)) {
+        return false;
+    }
+    const unsigned long value = std::strtoul(text.c_str(), nullptr, 16);
+    command = std::make_pair(static_cast<uint8_t>(value >> 8), static_cast<uint8_t>(value));
+    return true;
+}
+
+bool parseClass(const std::string& text, TransmitClass& transmitClass)
+{
+    for (size_t i = 0; i < kTransmitClassCount; ++i) {
+        if (text == toString(static_cast<TransmitClass>(i))) {
+            transmitClass = static_cast<TransmitClass>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+uint64_t toMicroseconds(std::chrono::steady_clock::duration time)
+{
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(time).count());
+}
+
+}  // namespace
+
+constexpr size_t TransmitQueue::kDefaultCapacity;
+
+const char* toString(TransmitClass transmitClass)
+{
+    switch (transmitClass) {
+        case TransmitClass::Control:
+            return "control";
+        case TransmitClass::Normal:
+            return "normal";
+        case TransmitClass::Bulk:
+            return "bulk";
+    }
+    return "";  // LCOV_EXCL_LINE
+}
+
+TransmitClassTable defaultTransmitClassTable()
+{
+    return {
+        {std::make_pair(0xfd, 0x01), TransmitClass::Bulk},
+    };
+}
+
+bool parseTransmitClassTable(const std::string& text, TransmitClassTable& table)
+{
+    TransmitClassTable parsed = table;
+    std::istringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        const size_t separator = item.find('=');
+        common::CpuCommand command;
+        TransmitClass transmitClass = TransmitClass::Normal;
+        if ((separator == std::string::npos) ||
+            !parseCommand(item.substr(0, separator), command) ||
+            !parseClass(item.substr(separator + 1), transmitClass)) {
+            return false;
+        }
+        parsed[command] = transmitClass;
+    }
+    table = std::move(parsed);
+    return true;
+}
+
+bool parseCoalescedCommands(const std::string& text, CoalescedCommands& commands)
+{
+    CoalescedCommands parsed = commands;
+    std::istringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        common::CpuCommand command;
+        if (!parseCommand(item, command)) {
+            return false;
+        }
+        parsed.insert(command);
+    }
+    commands = std::move(parsed);
+    return true;
+}
+
+TransmitQueue::Client::Client(const QuotaProfile& quota, Clock::time_point now)
+    : bytes(quota.bytesPerSecond, now)
+    , frames(quota.framesPerSecond, now)
+    , finish()
+    , consumption()
+{
+}
+
+TransmitQueue::TransmitQueue(TransmitPolicy policy, size_t capacity)
+    : m_policy(std::move(policy))
+    , m_capacity(capacity)
+    , m_entries()
+    , m_virtualTime()
+    , m_clients()
+    , m_statistics()
+    , m_wait()
+    , m_closed(false)
+{
+}
+
+TransmitClass TransmitQueue::classOf(const common::CpuCommand& command) const
+{
+    auto i = m_policy.classes.find(command);
+    return (i != m_policy.classes.end()) ? i->second : TransmitClass::Normal;
+}
+
+TransmitQueue::Admission TransmitQueue::push(const ClientID& client,
+                                             common::CpuCommand command,
+                                             std::vector<uint8_t> data,
+                                             Done done)
+{
+    const size_t index = static_cast<size_t>(classOf(command));
+    const bool coalesced = (m_policy.coalesced.count(command) != 0);
+    const Clock::time_point now = Clock::now();
+    std::lock_guard<std::mutex> lock(m_mutex);
+    TransmitClassStatistics& statistics = m_statistics[index];
+    std::deque<Entry>& entries = m_entries[index];
+    if (m_closed) {
+        ++statistics.rejected;
+        return Admission::Closed;
+    }
+    auto waiting = entries.end();
+    if (coalesced) {
+        waiting = std::find_if(entries.begin(), entries.end(), [&client, &command](const Entry& e) {
+            return (e.client == client) && (e.command == command);
+        });
+    }
+    if ((waiting == entries.end()) && (entries.size() >= m_capacity)) {
+        ++statistics.rejected;
+        return Admission::Full;
+    }
+
+    Client& state = m_clients.emplace(client, Client(m_policy.quota, now)).first->second;
+    const uint32_t frames = framesOf(data.size());
+    if (!state.bytes.has(data.size(), now) || !state.frames.has(frames, now)) {
+        ++state.consumption.throttled;
+        ++statistics.rejected;
+        return Admission::Throttled;
+    }
+    state.bytes.take(data.size(), now);
+    state.frames.take(frames, now);
+    ++state.consumption.commands;
+    state.consumption.bytes += data.size();
+    state.consumption.frames += frames;
+    // a command costs at least a byte, so that the commands of a client keep their order
+    const uint64_t cost = std::max<uint64_t>(data.size(), 1);
+
+    if (waiting != entries.end()) {
+        // the commands of the client from the replaced one on finish by its new size,
+        // the last of them is the last command of the client queued in the class
+        const uint64_t oldCost = std::max<uint64_t>(waiting->data.size(), 1);
+        for (auto e = waiting; e != entries.end(); ++e) {
+            if (e->client == client) {
+                e->finish = e->finish - oldCost + cost;
+                state.finish[index] = e->finish;
+            }
+        }
+        waiting->data = std::move(data);
+        if (done) {
+            waiting->done.push_back(std::move(done));
+        }
+        ++statistics.replaced;
+        return Admission::Queued;
+    }
+
+    const uint64_t start = std::max(m_virtualTime[index], state.finish[index]);
+    const uint64_t finish = start + cost;
+    state.finish[index] = finish;
+
+    std::vector<Done> dones;
+    if (done) {
+        dones.push_back(std::move(done));
+    }
+    entries.push_back(
+        {client, std::move(command), std::move(data), std::move(dones), now, finish});
+    statistics.depth = entries.size();
+    statistics.maxDepth = std::max(statistics.maxDepth, statistics.depth);
+    m_condition.notify_one();
+    return Admission::Queued;
+}
+
+bool TransmitQueue::serve(const Send& send, std::chrono::milliseconds timeout)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    if (!m_condition.wait_for(lock, timeout, [this]() { return m_closed || !empty(); }) ||
+        m_closed) {
+        return false;
+    }
+    auto entries = std::find_if(m_entries.begin(), m_entries.end(),
+                                [](const std::deque<Entry>& e) { return !e.empty(); });
+    const size_t index = entries - m_entries.begin();
+    TransmitClassStatistics& statistics = m_statistics[index];
+    // the first of the commands finishing first, which is the oldest of its client
+    auto next = std::min_element(entries->begin(), entries->end(),
+                                 [](const Entry& a, const Entry& b) { return a.finish < b.finish; });
+    Entry entry = std::move(*next);
+    entries->erase(next);
+    m_virtualTime[index] = entry.finish;
+    statistics.depth = entries->size();
+    const Clock::time_point taken = Clock::now();
+    const uint64_t wait = toMicroseconds(taken - entry.queued);
+    statistics.totalWait += wait;
+    statistics.maxWait = std::max(statistics.maxWait, wait);
+    m_wait.record(wait);
+    lock.unlock();
+
+    const bool result = send(entry.command, entry.data);
+
+    const uint64_t service = toMicroseconds(Clock::now() - taken);
+    lock.lock();
+    ++statistics.sent;
+    statistics.totalService += service;
+    statistics.maxService = std::max(statistics.maxService, service);
+    lock.unlock();
+
+    for (const Done& done : entry.done) {
+        done(result);
+    }
+    return true;
+}
+
+void TransmitQueue::close()
+{
+    std::vector<Done> dropped;
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_closed = true;
+    for (size_t i = 0; i < kTransmitClassCount; ++i) {
+        for (Entry& entry : m_entries[i]) {
+            std::move(entry.done.begin(), entry.done.end(), std::back_inserter(dropped));
+        }
+        m_entries[i].clear();
+        m_statistics[i].depth = 0;
+    }
+    m_condition.notify_all();
+    lock.unlock();
+
+    // the clients waiting for the result are told that the commands were not sent
+    for (const Done& done : dropped) {
+        done(false);
+    }
+}
+
+TransmitClassStatistics TransmitQueue::statistics(TransmitClass transmitClass) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_statistics[static_cast<size_t>(transmitClass)];
+}
+
+LatencyHistogram TransmitQueue::waitHistogram() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_wait;
+}
+
+ClientConsumption TransmitQueue::consumption(const ClientID& client) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto i = m_clients.find(client);
+    return (i != m_clients.end()) ? i->second.consumption : ClientConsumption();
+}
+
+std::map<TransmitQueue::ClientID, ClientConsumption> TransmitQueue::consumptions() const
+{
+    std::map<ClientID, ClientConsumption> consumptions;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (const auto& client : m_clients) {
+        consumptions.emplace(client.first, client.second.consumption);
+    }
+    return consumptions;
+}
+
+void TransmitQueue::removeClient(const ClientID& client)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_clients.erase(client);
+}
+
+bool TransmitQueue::empty() const
+{
+    return std::all_of(m_entries.begin(), m_entries.end(),
+                       [](const std::deque<Entry>& entries) { return entries.empty(); });
+}
+
+std::string formatTransmitStats(const TransmitQueue& queue)
+{
+    std::string text =
+        "transmit  depth max depth       sent   rejected   replaced  wait us   max wait"
+        " service us max service\n";
+    char line[160] = {};
+    for (size_t i = 0; i < kTransmitClassCount; ++i) {
+        const auto transmitClass = static_cast<TransmitClass>(i);
+        const TransmitClassStatistics statistics = queue.statistics(transmitClass);
+        const uint64_t sent = std::max<uint64_t>(statistics.sent, 1);
+        std::snprintf(line, sizeof(line),
+                      "%-8s %6zu %9zu %10llu %10llu %10llu %8llu %10llu %10llu %11llu\n",
+                      toString(transmitClass), statistics.depth, statistics.maxDepth,
+                      static_cast<unsigned long long>(statistics.sent),
+                      static_cast<unsigned long long>(statistics.rejected),
+                      static_cast<unsigned long long>(statistics.replaced),
+                      static_cast<unsigned long long>(statistics.totalWait / sent),
+                      static_cast<unsigned long long>(statistics.maxWait),
+                      static_cast<unsigned long long>(statistics.totalService / sent),
+                      static_cast<unsigned long long>(statistics.maxService));
+        text += line;
+    }
+    text += "client                     commands      bytes     frames  throttled\n";
+    for (const auto& client : queue.consumptions()) {
+        std::snprintf(line, sizeof(line), "%-24s %10llu %10llu %10llu %10llu\n",
+                      client.first.c_str(),
+                      static_cast<unsigned long long>(client.second.commands),
+                      static_cast<unsigned long long>(client.second.bytes),
+                      static_cast<unsigned long long>(client.second.frames),
+                      static_cast<unsigned long long>(client.second.throttled));
+        text += line;
+    }
+    return text;
+}
+
+}  // namespace impl
+}  // namespace cpucom
+}  // namespace ahu
+}  // namespace mitsubishielectric
+}  // namespace com
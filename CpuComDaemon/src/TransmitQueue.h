@@ -0,0 +1,208 @@
+/*
+ * COPYRIGHT (C) 2024 MITSUBISHI ELECTRIC CORPORATION
+ * ALL RIGHTS RESERVED
+ */
+
+#ifndef COM_MITSUBISHIELECTRIC_AHU_CPUCOM_TRANSMITQUEUE_H_
+#define COM_MITSUBISHIELECTRIC_AHU_CPUCOM_TRANSMITQUEUE_H_
+
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "CpuCommand.h"
+#include "IMessageServer.h"
+#include "LatencyHistogram.h"
+#include "TransmitQuota.h"
+
+namespace com {
+namespace mitsubishielectric {
+namespace ahu {
+namespace cpucom {
+namespace impl {
+
+/**
+ * Priority class of a command to be sent, a command of a lower class is only sent
+ * while no command of a higher class is waiting.
+ */
+enum class TransmitClass : uint8_t {
+    Control = 0,  // highest
+    Normal,
+    Bulk,  // lowest
+};
+
+constexpr size_t kTransmitClassCount = 3;
+
+const char* toString(TransmitClass transmitClass);
+
+/**
+ * Classes of commands, commands which are not in the table are TransmitClass::Normal.
+ */
+using TransmitClassTable = std::map<common::CpuCommand, TransmitClass>;
+
+// the commands of the stability test tools are sent after anything else
+TransmitClassTable defaultTransmitClassTable();
+
+/**
+ * Parses a table like "fd01=bulk,1100=control", a command is given by 4 hex digits
+ * and a class by control, normal or bulk. Commands which are not given keep their class.
+ * @return false if text is malformed, table is not changed then
+ */
+bool parseTransmitClassTable(const std::string& text, TransmitClassTable& table);
+
+/**
+ * Commands of which only the latest data is sent, see TransmitQueue::push().
+ */
+using CoalescedCommands = std::set<common::CpuCommand>;
+
+/**
+ * Parses commands like "1100,1101", each given by 4 hex digits.
+ * @return false if text is malformed, commands is not changed then
+ */
+bool parseCoalescedCommands(const std::string& text, CoalescedCommands& commands);
+
+/**
+ * What happened to the commands of one class. The times are in microseconds.
+ */
+struct TransmitClassStatistics {
+    size_t depth;           // commands waiting now
+    size_t maxDepth;        // commands waiting at most
+    uint64_t sent;          // commands taken from the queue and sent, successfully or not
+    uint64_t rejected;      // commands not queued, the class was full or the client throttled
+    uint64_t replaced;      // commands whose data was replaced by newer data before being sent
+    uint64_t totalWait;     // from being queued to being taken from the queue
+    uint64_t maxWait;
+    uint64_t totalService;  // from being taken from the queue to being sent
+    uint64_t maxService;
+};
+
+/**
+ * How commands are queued.
+ */
+struct TransmitPolicy {
+    TransmitClassTable classes;
+    CoalescedCommands coalesced;
+    QuotaProfile quota = kDefaultQuotaProfile;  // of each client
+};
+
+/**
+ * Commands waiting to be sent to the V-CPU, bounded per TransmitClass.
+ * The message server thread push()es the commands of the clients
+ * and the transmit thread serve()s them one by one.
+ *
+ * Each client is held to TransmitPolicy::quota by token buckets. Within a class the clients
+ * share the line fairly by the bytes they send: the command served next is the one
+ * that finishes first in self-clocked fair queueing, so a client queueing a burst
+ * does not hold up the commands of the others behind it.
+ */
+class TransmitQueue {
+public:
+    static constexpr size_t kDefaultCapacity = 32;  // per class
+
+    using ClientID = IMessageServer::SessionID;
+    using Send = std::function<bool(const common::CpuCommand&, const std::vector<uint8_t>&)>;
+    // called with the result of sending on the transmit thread,
+    // or with false by close() for a command it drops
+    using Done = std::function<void(bool)>;
+
+    enum class Admission {
+        Queued,
+        Full,       // the class of the command is full
+        Throttled,  // the client is over its quota
+        Closed,
+    };
+
+    explicit TransmitQueue(TransmitPolicy policy = TransmitPolicy(),
+                           size_t capacity = kDefaultCapacity);
+
+    TransmitClass classOf(const common::CpuCommand& command) const;
+
+    /**
+     * A coalesced command of client which is still waiting gets data instead of being queued
+     * again, it keeps its place and the time it was queued. Its done is called with the result
+     * of sending the latest data, after the one given here. The new data is charged to the quota
+     * like a command queued, and the command finishes by its new size in fair queueing.
+     * @return whether the command was queued, done is not called if not
+     */
+    Admission push(const ClientID& client,
+                   common::CpuCommand command,
+                   std::vector<uint8_t> data,
+                   Done done);
+
+    /**
+     * Waits up to timeout for a command and sends the oldest command of the highest class.
+     * @return false if there was no command to send
+     */
+    bool serve(const Send& send, std::chrono::milliseconds timeout);
+
+    // rejects any further command, drops the waiting ones and wakes serve()
+    void close();
+
+    TransmitClassStatistics statistics(TransmitClass transmitClass) const;
+    // us from being queued to being taken from the queue, of the commands of all classes
+    LatencyHistogram waitHistogram() const;
+
+    ClientConsumption consumption(const ClientID& client) const;
+    // of every client which has not been removed
+    std::map<ClientID, ClientConsumption> consumptions() const;
+    // forgets the quota and consumption of client, its waiting commands are still sent
+    void removeClient(const ClientID& client);
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Entry {
+        ClientID client;
+        common::CpuCommand command;
+        std::vector<uint8_t> data;
+        std::vector<Done> done;
+        Clock::time_point queued;
+        uint64_t finish;  // virtual time, in bytes
+    };
+
+    struct Client {
+        explicit Client(const QuotaProfile& quota, Clock::time_point now);
+
+        TokenBucket bytes;
+        TokenBucket frames;
+        std::array<uint64_t, kTransmitClassCount> finish;  // of the last command queued
+        ClientConsumption consumption;
+    };
+
+    bool empty() const;
+
+private:
+    const TransmitPolicy m_policy;
+    const size_t m_capacity;
+    std::array<std::deque<Entry>, kTransmitClassCount> m_entries;
+    std::array<uint64_t, kTransmitClassCount> m_virtualTime;  // finish of the last command served
+    std::map<ClientID, Client> m_clients;
+    std::array<TransmitClassStatistics, kTransmitClassCount> m_statistics;
+    LatencyHistogram m_wait;
+    bool m_closed;
+    mutable std::mutex m_mutex;
+    std::condition_variable m_condition;
+};
+
+/**
+ * Formats the statistics of every class of queue and the consumption of every client as tables,
+ * for CpuComId::Stats.
+ */
+std::string formatTransmitStats(const TransmitQueue& queue);
+
+}  // namespace impl
+}  // namespace cpucom
+}  // namespace ahu
+}  // namespace mitsubishielectric
+}  // namespace com
+
+#endif  // COM_MITSUBISHIELECTRIC_AHU_CPUCOM_TRANSMITQUEUE_H_
@@ -0,0 +1,118 @@
+/*
+ * COPYRIGHT (C) 2024 MITSUBISHI ELECTRIC CORPORATION
+ * ALL RIGHTS RESERVED
+ */
+
+#include "TransmitQuota.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <sstream>
+
+#include "FrameEncoder.h"
+
+namespace com {
+namespace mitsubishielectric {
+namespace ahu {
+namespace cpucom {
+namespace impl {
+
+namespace {
+
+const uint64_t kMicrosecondsPerSecond = 1000000;
+
+bool parseNumber(const std::string& text, uint32_t& value)
+{
+    if (text.empty() || !std::all_of(text.begin(), text.end(), ::isdigit)) {
+        return false;
+    }
+    value = static_cast<uint32_t>(std::strtoul(text.c_str(), nullptr, 10));
+    return true;
+}
+
+}  // namespace
+
+bool parseQuotaProfile(const std::string& text, QuotaProfile& profile)
+{
+    QuotaProfile parsed = profile;
+    std::istringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        const size_t separator = item.find('=');
+        uint32_t value = 0;
+        if ((separator == std::string::npos) || !parseNumber(item.substr(separator + 1), value)) {
+            return false;
+        }
+        const std::string key = item.substr(0, separator);
+        if (key == "bytes") {
+            parsed.bytesPerSecond = value;
+        }
+        else if (key == "frames") {
+            parsed.framesPerSecond = value;
+        }
+        else {
+            return false;
+        }
+    }
+    profile = parsed;
+    return true;
+}
+
+uint32_t framesOf(size_t size) { return FrameEncoder::frameCount(size + frame::kCmdLength); }
+
+TokenBucket::TokenBucket(uint32_t rate, Clock::time_point now)
+    : m_rate(rate)
+    , m_tokens(rate)
+    , m_fraction(0)
+    , m_updated(now)
+{
+}
+
+bool TokenBucket::take(uint64_t amount, Clock::time_point now)
+{
+    if (!has(amount, now)) {
+        return false;
+    }
+    if (m_rate != 0) {
+        m_tokens -= amount;
+    }
+    return true;
+}
+
+bool TokenBucket::has(uint64_t amount, Clock::time_point now)
+{
+    if (m_rate == 0) {
+        return true;
+    }
+    refill(now);
+    return m_tokens >= amount;
+}
+
+void TokenBucket::refill(Clock::time_point now)
+{
+    if (now <= m_updated) {
+        return;
+    }
+    const uint64_t elapsed = static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(now - m_updated).count());
+    m_updated = now;
+    // a second or more fills the bucket, which also keeps the product below from overflowing
+    if (elapsed >= kMicrosecondsPerSecond) {
+        m_tokens = m_rate;
+        m_fraction = 0;
+        return;
+    }
+    m_fraction += elapsed * m_rate;
+    m_tokens += m_fraction / kMicrosecondsPerSecond;
+    m_fraction %= kMicrosecondsPerSecond;
+    if (m_tokens >= m_rate) {
+        m_tokens = m_rate;
+        m_fraction = 0;
+    }
+}
+
+}  // namespace impl
+}  // namespace cpucom
+}  // namespace ahu
+}  // namespace mitsubishielectric
+}  // namespace com
@@ -0,0 +1,85 @@
+/*
+ * COPYRIGHT (C) 2024 MITSUBISHI ELECTRIC CORPORATION
+ * ALL RIGHTS RESERVED
+ */
+
+#ifndef COM_MITSUBISHIELECTRIC_AHU_CPUCOM_TRANSMITQUOTA_H_
+#define COM_MITSUBISHIELECTRIC_AHU_CPUCOM_TRANSMITQUOTA_H_
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace com {
+namespace mitsubishielectric {
+namespace ahu {
+namespace cpucom {
+namespace impl {
+
+/**
+ * What one client may send to the V-CPU, 0 for no limit. A client may send a second
+ * worth of either at once, after that it is held to the rates.
+ */
+struct QuotaProfile {
+    uint32_t bytesPerSecond;   // of the data of the commands
+    uint32_t framesPerSecond;  // the commands are divided into
+};
+
+// a client gets about two thirds of a 1 Mbaud line, which carries some 90 KB/s
+constexpr QuotaProfile kDefaultQuotaProfile = {60000, 300};
+
+/**
+ * Parses a profile like "bytes=60000,frames=300", keys which are not given keep their value.
+ * @return false if text is malformed, profile is not changed then
+ */
+bool parseQuotaProfile(const std::string& text, QuotaProfile& profile);
+
+// frames a command with size bytes of data is sent in
+uint32_t framesOf(size_t size);
+
+/**
+ * Tokens filled in at a rate per second up to a second worth of them, starting full.
+ * Not thread safe.
+ */
+class TokenBucket {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // a rate of 0 never runs out of tokens
+    explicit TokenBucket(uint32_t rate = 0, Clock::time_point now = Clock::now());
+
+    /**
+     * @return false without taking any token if there are less than amount
+     */
+    bool take(uint64_t amount, Clock::time_point now);
+
+    bool has(uint64_t amount, Clock::time_point now);
+
+private:
+    void refill(Clock::time_point now);
+
+private:
+    uint32_t m_rate;
+    uint64_t m_tokens;
+    uint64_t m_fraction;  // of a token, in millionths
+    Clock::time_point m_updated;
+};
+
+/**
+ * What one client has sent, or was not allowed to.
+ */
+struct ClientConsumption {
+    uint64_t commands;   // queued
+    uint64_t bytes;      // of the data of the commands queued
+    uint64_t frames;     // the commands queued are sent in
+    uint64_t throttled;  // commands rejected because the client was over its quota
+};
+
+}  // namespace impl
+}  // namespace cpucom
+}  // namespace ahu
+}  // namespace mitsubishielectric
+}  // namespace com
+
+#endif  // COM_MITSUBISHIELECTRIC_AHU_CPUCOM_TRANSMITQUOTA_H_
@@ -0,0 +1,42 @@
+/*
+ * COPYRIGHT (C) 2024 MITSUBISHI ELECTRIC CORPORATION
+ * ALL RIGHTS RESERVED
+ */
+
+#ifndef COM_MITSUBISHIELECTRIC_AHU_CPUCOM_VERBOSELOG_H_
+#define COM_MITSUBISHIELECTRIC_AHU_CPUCOM_VERBOSELOG_H_
+
+#include "Log.h"
+
+// debuggable builds define CPUCOM_VERBOSE_LOGS=1, see Android.bp
+#ifndef CPUCOM_VERBOSE_LOGS
+#define CPUCOM_VERBOSE_LOGS 0
+#endif
+
+namespace com {
+namespace mitsubishielectric {
+namespace ahu {
+namespace cpucom {
+namespace impl {
+
+// whether verbose logs are compiled in; warnings and errors always are
+constexpr bool kVerboseLogs = (CPUCOM_VERBOSE_LOGS != 0);
+
+}  // namespace impl
+}  // namespace cpucom
+}  // namespace ahu
+}  // namespace mitsubishielectric
+}  // namespace com
+
+/**
+ * MLOGV compiled out unless kVerboseLogs, arguments included. It is still compiled, so
+ * that it keeps building either way.
+ */
+#define CPUCOM_MLOGV(...)                                                   \
+    do {                                                                    \
+        if (::com::mitsubishielectric::ahu::cpucom::impl::kVerboseLogs) {   \
+            ::com::mitsubishielectric::ahu::common::MLOGV(__VA_ARGS__);     \
+        }                                                                   \
+    } while (false)
+
+#endif  // COM_MITSUBISHIELECTRIC_AHU_CPUCOM_VERBOSELOG_H_
@@ -3,10 +3,20 @@
  * ALL RIGHTS RESERVED
  */
 
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstring>
+#include <fstream>
 #include <memory>
 #include <string>
+#include <thread>
 #include <unordered_set>
 
+#include <fcntl.h>
+#include <pthread.h>
+#include <unistd.h>
+
 #include <cutils/properties.h>
 
 #include "CpuComMessageServer.h"
@@ -17,9 +27,12 @@
 #include "DeviceConfigurations.h"
 #include "EmulatorSocketDevice.h"
 #include "IODevice.h"
+#include "LineDevice.h"
 #include "MultipleCPU.h"
 #include "MutexWrapper.h"
 #include "Protocol.h"
+#include "Trace.h"
+#include "TransmitQueue.h"
 #include "UARTDevice.h"
 #include "socket/SlaveDevice.h"
 
@@ -53,6 +66,194 @@ constexpr bool kUse2Uart = true;
 #else
 constexpr bool kUse2Uart = false;
 #endif
+
+const char* const kTimeoutsProperty = "vendor.cpucomdaemon.timeouts";
+const char* const kPipelinedDivisionProperty = "vendor.cpucomdaemon.pipelined";
+const char* const kTransmitClassesProperty = "vendor.cpucomdaemon.txclasses";
+const char* const kCoalescedCommandsProperty = "vendor.cpucomdaemon.coalesce";
+const char* const kQuotaProperty = "vendor.cpucomdaemon.quota";
+const char* const kRequestTimeoutProperty = "vendor.cpucomdaemon.requesttimeout";
+const char* const kTraceFileProperty = "vendor.cpucomdaemon.tracefile";
+
+/**
+ * Timeouts of the link over device. vendor.cpucomdaemon.timeouts applies to every link and
+ * vendor.cpucomdaemon.timeouts.<device name>, e.g. .ttyHS4, overrides it for one of them.
+ * Both hold profiles as parsed by parseTimeoutProfile().
+ */
+impl::TimeoutProfile getTimeoutProfile(const char* device,
+                                       impl::TimeoutProfile profile = impl::kDefaultTimeoutProfile)
+{
+    const char* separator = std::strrchr(device, '/');
+    const std::string link = (separator != nullptr) ? separator + 1 : device;
+    const std::string keys[] = {kTimeoutsProperty, kTimeoutsProperty + ("." + link)};
+    for (const std::string& key : keys) {
+        char value[PROPERTY_VALUE_MAX] = {};
+        if ((property_get(key.c_str(), value, "") > 0) &&
+            !impl::parseTimeoutProfile(value, profile)) {
+            MLOGW(common::FunctionID::cpuc_daemon, cpucom::daemon::LogID::InvalidTimeoutProfile,
+                  link.c_str(), value);
+        }
+    }
+    MLOGD(common::FunctionID::cpuc_daemon, cpucom::daemon::LogID::TimeoutProfile, link.c_str(),
+          static_cast<int32_t>(profile.response.count()),
+          static_cast<int32_t>(profile.field.count()), static_cast<int32_t>(profile.retry.count()),
+          static_cast<int32_t>(profile.baudRate), profile.autoTune);
+    return profile;
+}
+
+/**
+ * Whether divided messages are pipelined, see Protocol::setPipelinedDivision(),
+ * off unless vendor.cpucomdaemon.pipelined is true.
+ */
+bool getPipelinedDivision()
+{
+    const bool enabled = static_cast<bool>(property_get_bool(kPipelinedDivisionProperty, 0));
+    MLOGD(common::FunctionID::cpuc_daemon, cpucom::daemon::LogID::PipelinedDivision, enabled);
+    return enabled;
+}
+
+/**
+ * Transmit classes of the commands, vendor.cpucomdaemon.txclasses overrides the defaults
+ * with a table as parsed by parseTransmitClassTable().
+ */
+impl::TransmitClassTable getTransmitClassTable()
+{
+    impl::TransmitClassTable table = impl::defaultTransmitClassTable();
+    char value[PROPERTY_VALUE_MAX] = {};
+    if (property_get(kTransmitClassesProperty, value, "") > 0) {
+        if (impl::parseTransmitClassTable(value, table)) {
+            MLOGD(common::FunctionID::cpuc_daemon, cpucom::daemon::LogID::TransmitClasses, value);
+        }
+        else {
+            MLOGW(common::FunctionID::cpuc_daemon,
+                  cpucom::daemon::LogID::InvalidTransmitClasses, value);
+        }
+    }
+    return table;
+}
+
+/**
+ * Commands of which only the latest data is sent, none unless vendor.cpucomdaemon.coalesce
+ * lists them as parsed by parseCoalescedCommands().
+ */
+impl::CoalescedCommands getCoalescedCommands()
+{
+    impl::CoalescedCommands commands;
+    char value[PROPERTY_VALUE_MAX] = {};
+    if (property_get(kCoalescedCommandsProperty, value, "") > 0) {
+        if (impl::parseCoalescedCommands(value, commands)) {
+            MLOGD(common::FunctionID::cpuc_daemon, cpucom::daemon::LogID::CoalescedCommands,
+                  value);
+        }
+        else {
+            MLOGW(common::FunctionID::cpuc_daemon,
+                  cpucom::daemon::LogID::InvalidCoalescedCommands, value);
+        }
+    }
+    return commands;
+}
+
+/**
+ * Quota of each client, vendor.cpucomdaemon.quota overrides the default
+ * with a profile as parsed by parseQuotaProfile().
+ */
+impl::QuotaProfile getQuotaProfile()
+{
+    impl::QuotaProfile profile = impl::kDefaultQuotaProfile;
+    char value[PROPERTY_VALUE_MAX] = {};
+    if ((property_get(kQuotaProperty, value, "") > 0) &&
+        !impl::parseQuotaProfile(value, profile)) {
+        MLOGW(common::FunctionID::cpuc_daemon, cpucom::daemon::LogID::InvalidQuotaProfile, value);
+    }
+    MLOGD(common::FunctionID::cpuc_daemon, cpucom::daemon::LogID::QuotaProfile,
+          profile.bytesPerSecond, profile.framesPerSecond);
+    return profile;
+}
+
+/**
+ * How long a request waits for its response, vendor.cpucomdaemon.requesttimeout overrides
+ * the default with a time in milliseconds.
+ */
+std::chrono::milliseconds getRequestTimeout()
+{
+    const int32_t defaultTimeout = static_cast<int32_t>(impl::kDefaultRequestTimeout.count());
+    const int32_t timeout = property_get_int32(kRequestTimeoutProperty, defaultTimeout);
+    if (timeout <= 0) {
+        MLOGW(common::FunctionID::cpuc_daemon, cpucom::daemon::LogID::InvalidRequestTimeout,
+              timeout, defaultTimeout);
+        return impl::kDefaultRequestTimeout;
+    }
+    return std::chrono::milliseconds(timeout);
+}
+
+// the file vendor.cpucomdaemon.tracefile names, read once for the signal handlers
+char gTracePath[PROPERTY_VALUE_MAX] = {};
+
+// the signals after which the daemon dies, and what they did before the trace was hooked in
+constexpr int kFatalSignals[] = {SIGABRT, SIGBUS, SIGFPE, SIGILL, SIGSEGV};
+struct sigaction gPreviousActions[sizeof(kFatalSignals) / sizeof(kFatalSignals[0])];
+
+/**
+ * Writes the trace of the daemon to the trace file, if any, for cpucom_trace_decoder.
+ */
+void writeTraceFile()
+{
+    if (gTracePath[0] != '\0') {
+        std::ofstream file(gTracePath, std::ios_base::binary | std::ios_base::trunc);
+        impl::writeTrace(file);
+    }
+}
+
+/**
+ * Writes the trace file before the daemon dies of signal, then lets the previous action,
+ * e.g. that of debuggerd, handle it when the fault recurs or abort() raises it again.
+ */
+void onFatalSignal(int signal)
+{
+    const int error = errno;
+    for (size_t i = 0; i < (sizeof(kFatalSignals) / sizeof(kFatalSignals[0])); ++i) {
+        if (kFatalSignals[i] == signal) {
+            sigaction(signal, &gPreviousActions[i], nullptr);
+        }
+    }
+    const int fd = open(gTracePath, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0640);
+    if (fd >= 0) {
+        impl::writeTraceFromSignal(fd);
+        close(fd);
+    }
+    errno = error;
+}
+
+/**
+ * Has the trace file written on SIGUSR1, e.g. by "kill -USR1" when the daemon misbehaves,
+ * and before the daemon dies of a fatal signal. Called before any thread is started, so that
+ * they all inherit SIGUSR1 blocked and only the thread waiting for it takes it.
+ */
+void hookTraceFile()
+{
+    if (property_get(kTraceFileProperty, gTracePath, "") <= 0) {
+        return;
+    }
+
+    sigset_t dumpSignals;
+    sigemptyset(&dumpSignals);
+    sigaddset(&dumpSignals, SIGUSR1);
+    pthread_sigmask(SIG_BLOCK, &dumpSignals, nullptr);
+    std::thread([dumpSignals]() {
+        int signal = 0;
+        while (sigwait(&dumpSignals, &signal) == 0) {
+            writeTraceFile();
+        }
+    }).detach();
+
+    struct sigaction action = {};
+    action.sa_handler = onFatalSignal;
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = SA_ONSTACK;
+    for (size_t i = 0; i < (sizeof(kFatalSignals) / sizeof(kFatalSignals[0])); ++i) {
+        sigaction(kFatalSignals[i], &action, &gPreviousActions[i]);
+    }
+}
 }  // namespace
 
 void onCpuComDaemonStarted()
@@ -68,33 +269,57 @@ void onCpuComDaemonStarted()
     }
 }
 
-std::unique_ptr<impl::CPU> getVcpuEmu(impl::EmulatorSocketDevice& emulatorDevice)
+std::unique_ptr<impl::CPU> getVcpuEmu(impl::EmulatorSocketDevice& emulatorDevice,
+                                      bool pipelinedDivision,
+                                      const std::shared_ptr<impl::LinkMetrics>& linkMetrics)
 {
     cpucom::DeviceConfigureEmulatorSocket configureEmulatorSocket(emulatorDevice);
 
     auto device{std::make_unique<socket::SlaveDevice>(impl::kVCPUEmulatorSocketName,
                                                       configureEmulatorSocket)};
     auto protocol = std::make_unique<impl::Protocol>(std::move(device));
+    // bytes take no time on the wire of a socket
+    impl::TimeoutProfile profile = impl::kDefaultTimeoutProfile;
+    profile.baudRate = 0;
+    protocol->setTimeoutProfile(getTimeoutProfile(impl::kVCPUEmulatorSocketName, profile));
+    protocol->setPipelinedDivision(pipelinedDivision);
+    protocol->setLinkMetrics(linkMetrics);
     return std::make_unique<impl::CPU>(std::move(protocol), impl::kAddressVCPU);
 }
 
-std::unique_ptr<impl::ICPU> getRealCpu(impl::UARTDevice& uartDevice)
+std::unique_ptr<impl::ICPU> getRealCpu(impl::UARTDevice& uartDevice,
+                                       bool pipelinedDivision,
+                                       const std::shared_ptr<impl::LinkMetrics>& linkMetrics)
 {
     cpucom::DeviceConfigureUART configureUART(uartDevice);
     std::unique_ptr<impl::ICPU> vcpu;
     if (kUse2Uart) {
-        auto deviceReceive{std::make_unique<common::IODevice>("/dev/ttyHS4", configureUART)};
-        auto deviceTransmit{std::make_unique<common::IODevice>("/dev/ttyHS6", configureUART)};
+        const char* const receiveDeviceName = "/dev/ttyHS4";
+        const char* const transmitDeviceName = "/dev/ttyHS6";
+        auto deviceReceive{std::make_unique<impl::LineDevice>(receiveDeviceName, configureUART)};
+        auto deviceTransmit{std::make_unique<impl::LineDevice>(transmitDeviceName, configureUART)};
 
-        auto protocolReceive = std::make_unique<impl::Protocol>(std::move(deviceReceive));
-        auto protocolTransmit = std::make_unique<impl::Protocol>(std::move(deviceTransmit));
+        auto protocolReceive =
+            std::make_unique<impl::ReceiveOnlyProtocol>(std::move(deviceReceive));
+        protocolReceive->setTimeoutProfile(getTimeoutProfile(receiveDeviceName));
+        protocolReceive->setPipelinedDivision(pipelinedDivision);
+        protocolReceive->setLinkMetrics(linkMetrics);
+        auto protocolTransmit = std::make_unique<impl::SendOnlyProtocol>(std::move(deviceTransmit));
+        protocolTransmit->setTimeoutProfile(getTimeoutProfile(transmitDeviceName));
+        protocolTransmit->setPipelinedDivision(pipelinedDivision);
+        protocolTransmit->setRetryPolicy(std::make_unique<impl::AdaptiveRetryPolicy>());
+        protocolTransmit->setLinkMetrics(linkMetrics);
 
         vcpu = std::make_unique<impl::MultipleCPU>(std::move(protocolReceive),
                                                    std::move(protocolTransmit), impl::kAddressVCPU);
     }
     else {
-        auto device{std::make_unique<common::IODevice>(impl::kUartDeviceName, configureUART)};
+        auto device{std::make_unique<impl::LineDevice>(impl::kUartDeviceName, configureUART)};
         auto protocol = std::make_unique<impl::Protocol>(std::move(device));
+        protocol->setTimeoutProfile(getTimeoutProfile(impl::kUartDeviceName));
+        protocol->setPipelinedDivision(pipelinedDivision);
+        protocol->setRetryPolicy(std::make_unique<impl::AdaptiveRetryPolicy>());
+        protocol->setLinkMetrics(linkMetrics);
         vcpu = std::make_unique<impl::CPU>(std::move(protocol), impl::kAddressVCPU);
     }
 
@@ -108,6 +333,7 @@ void onCpuComDaemonStopped()
 
 int main()
 {
+    hookTraceFile();
     common::InitializeCommonLogMessages();
     cpucom::daemon::InitializeCpuComLogMessages();
     vehiclepwrmgrLib::InitializeLibVehiclePwrLogMessages();
@@ -115,15 +341,19 @@ int main()
     bool useSocketDevice = static_cast<bool>(property_get_bool("vendor.vcpuemulator", 0));
 
     std::unique_ptr<impl::ICPU> vcpu;
+    // read once for the Protocols of every link
+    const bool pipelinedDivision = getPipelinedDivision();
+    // both UARTs are recorded in the same metrics, queried by CpuComId::Stats
+    auto linkMetrics = std::make_shared<impl::LinkMetrics>();
 
     impl::UARTDevice uartDevice;
     impl::EmulatorSocketDevice emulatorDevice;
 
     if (useSocketDevice) {
-        vcpu = getVcpuEmu(emulatorDevice);
+        vcpu = getVcpuEmu(emulatorDevice, pipelinedDivision, linkMetrics);
     }
     else {
-        vcpu = getRealCpu(uartDevice);
+        vcpu = getRealCpu(uartDevice, pipelinedDivision, linkMetrics);
     }
 
     std::unique_ptr<IExecutor> incomingExecutor = std::make_unique<SingleThreadExecutor>();
@@ -137,14 +367,27 @@ int main()
 
     SingleThreadExecutor singleExecutor;
     auto periodicExecutor = std::make_unique<PeriodicTaskExecutor>(singleExecutor);
+    SingleThreadExecutor dispatchThreadExecutor;
+    auto dispatchExecutor = std::make_unique<PeriodicTaskExecutor>(dispatchThreadExecutor);
+    SingleThreadExecutor transmitThreadExecutor;
+    auto transmitExecutor = std::make_unique<PeriodicTaskExecutor>(transmitThreadExecutor);
 
     auto subscribersMutexWrapper = std::make_unique<cpucom::MutexWrapper>();
     auto requestsMutexWrapper = std::make_unique<cpucom::MutexWrapper>();
 
+    impl::TransmitPolicy transmitPolicy;
+    transmitPolicy.classes = getTransmitClassTable();
+    transmitPolicy.coalesced = getCoalescedCommands();
+    transmitPolicy.quota = getQuotaProfile();
+
     cpucom::CpuComDaemon daemon(std::move(messageServer), std::move(vcpu),
-                                std::move(periodicExecutor), std::move(subscribersMutexWrapper),
-                                std::move(requestsMutexWrapper));
+                                std::move(periodicExecutor), std::move(dispatchExecutor),
+                                std::move(transmitExecutor),
+                                std::move(subscribersMutexWrapper),
+                                std::move(requestsMutexWrapper), std::move(transmitPolicy),
+                                getRequestTimeout(), linkMetrics);
     bool result = daemon.start();
+    writeTraceFile();
 
     vehiclepwrmgrLib::TerminateLibVehiclePwrLogMessages();
     cpucom::daemon::TerminateCpuComLogMessages();
@@ -79,11 +79,28 @@ void CpuComMessageServer::setSendCommandWithDeliveryStatusMessageHandler(
     mMessageServer->setMessageHandler(CpuComId::SendCommandWithDeliveryStatus, handler, daemon);
 }
 
-void CpuComMessageServer::sendNotificationMessage(SessionID sessionId,
+void CpuComMessageServer::setSendCommandWithTraceMessageHandler(
+    OnSendCommandWithTraceHandler handler,
+    CpuComDaemon* daemon)
+{
+    mMessageServer->setMessageHandler(CpuComId::SendCommandWithTrace, handler, daemon);
+}
+
+void CpuComMessageServer::setStatsMessageHandler(OnStatsHandler handler, CpuComDaemon* daemon)
+{
+    mMessageServer->setMessageHandler(CpuComId::Stats, handler, daemon);
+}
+
+void CpuComMessageServer::sendNotificationMessage(const std::vector<SessionID>& sessionIds,
                                                   common::CpuCommand command,
-                                                  std::vector<uint8_t>& data)
+                                                  const std::vector<uint8_t>& data,
+                                                  const std::vector<uint8_t>& stamps)
 {
-    mMessageServer->sendMessage(sessionId, CpuComId::Notification, command, data);
+    // MessageServer builds the message inside sendMessage() and takes no message built before,
+    // so every session still gets its own
+    for (const SessionID& sessionId : sessionIds) {
+        mMessageServer->sendMessage(sessionId, CpuComId::Notification, command, data, stamps);
+    }
 }
 
 void CpuComMessageServer::sendRequestResponseMessage(SessionID sessionId,
@@ -93,9 +110,14 @@ void CpuComMessageServer::sendRequestResponseMessage(SessionID sessionId,
     mMessageServer->sendMessage(sessionId, CpuComId::RequestResponse, uuid, data);
 }
 
+void CpuComMessageServer::sendRequestTimeoutMessage(SessionID sessionId, common::UUID uuid)
+{
+    mMessageServer->sendMessage(sessionId, CpuComId::RequestTimeout, uuid);
+}
+
 void CpuComMessageServer::sendSendCommandResultMessage(SessionID sessionId,
                                                        common::CpuCommand command,
-                                                       common::Error error)
+                                                       int error)
 {
     mMessageServer->sendMessage(sessionId, CpuComId::SendCommandResult, command, error);
 }
@@ -107,6 +129,19 @@ void CpuComMessageServer::sendDeliveryStatusMessage(SessionID sessionId,
     mMessageServer->sendMessage(sessionId, CpuComId::DeliveryStatus, uuid, result);
 }
 
+void CpuComMessageServer::sendDeliveryTraceMessage(SessionID sessionId,
+                                                   common::UUID uuid,
+                                                   bool result,
+                                                   const std::vector<uint8_t>& trace)
+{
+    mMessageServer->sendMessage(sessionId, CpuComId::DeliveryTrace, uuid, result, trace);
+}
+
+void CpuComMessageServer::sendStatsMessage(SessionID sessionId, const std::string& report)
+{
+    mMessageServer->sendMessage(sessionId, CpuComId::Stats, report);
+}
+
 }  // namespace impl
 }  // namespace cpucom
 }  // namespace ahu
@@ -54,20 +54,35 @@ public:
         OnSendCommandWithDeliveryStatusHandler handler,
         CpuComDaemon* daemon) override;
 
-    void sendNotificationMessage(SessionID sessionId,
+    void setSendCommandWithTraceMessageHandler(OnSendCommandWithTraceHandler handler,
+                                               CpuComDaemon* daemon) override;
+
+    void setStatsMessageHandler(OnStatsHandler handler, CpuComDaemon* daemon) override;
+
+    void sendNotificationMessage(const std::vector<SessionID>& sessionIds,
                                  common::CpuCommand command,
-                                 std::vector<uint8_t>& data) override;
+                                 const std::vector<uint8_t>& data,
+                                 const std::vector<uint8_t>& stamps) override;
 
     void sendRequestResponseMessage(SessionID sessionId,
                                     common::UUID uuid,
                                     std::vector<uint8_t>& data) override;
 
+    void sendRequestTimeoutMessage(SessionID sessionId, common::UUID uuid) override;
+
     void sendSendCommandResultMessage(SessionID sessionId,
                                       common::CpuCommand command,
-                                      common::Error error) override;
+                                      int error) override;
 
     void sendDeliveryStatusMessage(SessionID sessionId, common::UUID uuid, bool result) override;
 
+    void sendDeliveryTraceMessage(SessionID sessionId,
+                                  common::UUID uuid,
+                                  bool result,
+                                  const std::vector<uint8_t>& trace) override;
+
+    void sendStatsMessage(SessionID sessionId, const std::string& report) override;
+
 private:
     std::unique_ptr<IMessageServer::MessageServer> mMessageServer;
 };
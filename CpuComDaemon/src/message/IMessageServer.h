@@ -12,6 +12,7 @@
 #include "UUID.h"
 
 #include <messenger/MessageServer.h>
+#include <string>
 #include <vector>
 
 namespace com {
@@ -74,19 +75,47 @@ public:
         OnSendCommandWithDeliveryStatusHandler handler,
         CpuComDaemon* daemon) = 0;
 
-    virtual void sendNotificationMessage(SessionID sessionId,
+    using OnSendCommandWithTraceHandler = void (CpuComDaemon::*)(SessionID,
+                                                                 common::UUID,
+                                                                 common::CpuCommand,
+                                                                 std::vector<uint8_t>,
+                                                                 std::vector<uint8_t>);
+    virtual void setSendCommandWithTraceMessageHandler(OnSendCommandWithTraceHandler handler,
+                                                       CpuComDaemon* daemon) = 0;
+
+    using OnStatsHandler = void (CpuComDaemon::*)(SessionID);
+    virtual void setStatsMessageHandler(OnStatsHandler handler, CpuComDaemon* daemon) = 0;
+
+    /**
+     * Sends one notification to every session of sessionIds, from the same command and data.
+     * stamps are the ReceiveStamps of the message as encoded by encodeReceiveStamps().
+     */
+    virtual void sendNotificationMessage(const std::vector<SessionID>& sessionIds,
                                          common::CpuCommand command,
-                                         std::vector<uint8_t>& data) = 0;
+                                         const std::vector<uint8_t>& data,
+                                         const std::vector<uint8_t>& stamps) = 0;
 
     virtual void sendRequestResponseMessage(SessionID sessionId,
                                             common::UUID uuid,
                                             std::vector<uint8_t>& data) = 0;
 
+    // the request uuid got no response within the request timeout
+    virtual void sendRequestTimeoutMessage(SessionID sessionId, common::UUID uuid) = 0;
+
+    // error is a common::Error or a CpuComError
     virtual void sendSendCommandResultMessage(SessionID sessionId,
                                               common::CpuCommand command,
-                                              common::Error error) = 0;
+                                              int error) = 0;
 
     virtual void sendDeliveryStatusMessage(SessionID sessionId, common::UUID uuid, bool result) = 0;
+
+    // trace is a SendTrace as encoded by encodeSendTrace()
+    virtual void sendDeliveryTraceMessage(SessionID sessionId,
+                                          common::UUID uuid,
+                                          bool result,
+                                          const std::vector<uint8_t>& trace) = 0;
+
+    virtual void sendStatsMessage(SessionID sessionId, const std::string& report) = 0;
 };
 
 }  // namespace impl
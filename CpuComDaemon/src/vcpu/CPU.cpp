@@ -47,6 +47,10 @@ bool CPU::write(const common::CpuCommand& command, const std::vector<uint8_t>& d
     return m_protocol->send(pack(command, m_sendCodebit, data));
 }
 
+SendTimes CPU::lastSendTimes() const { return m_protocol->lastSendTimes(); }
+
+ReceiveTimes CPU::lastReceiveTimes() const { return m_protocol->lastReceiveTimes(); }
+
 }  // namespace impl
 }  // namespace cpucom
 }  // namespace ahu
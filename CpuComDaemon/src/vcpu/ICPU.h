@@ -11,6 +11,8 @@
 #include <vector>
 
 #include "CpuCommand.h"
+#include "ReceiveTimes.h"
+#include "SendTimes.h"
 
 namespace com {
 namespace mitsubishielectric {
@@ -28,6 +30,10 @@ public:
     virtual bool initialize() = 0;
     virtual bool read(std::pair<common::CpuCommand, std::vector<uint8_t>>& value) = 0;
     virtual bool write(const common::CpuCommand& command, const std::vector<uint8_t>& data) = 0;
+    // when the handshake of the last write() happened on the line, read on its thread
+    virtual SendTimes lastSendTimes() const = 0;
+    // when the message of the last read() arrived on the line, read on its thread
+    virtual ReceiveTimes lastReceiveTimes() const = 0;
 };
 
 }  // namespace impl
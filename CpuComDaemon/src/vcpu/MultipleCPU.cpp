@@ -46,6 +46,13 @@ bool MultipleCPU::write(const common::CpuCommand& command, const std::vector<uin
     return mProtocolTransmit->send(pack(command, m_sendCodebit, data));
 }
 
+SendTimes MultipleCPU::lastSendTimes() const { return mProtocolTransmit->lastSendTimes(); }
+
+ReceiveTimes MultipleCPU::lastReceiveTimes() const
+{
+    return mProtocolReceive->lastReceiveTimes();
+}
+
 }  // namespace impl
 }  // namespace cpucom
 }  // namespace ahu
@@ -32,6 +32,8 @@ public:
     bool initialize() override;
     bool read(std::pair<common::CpuCommand, std::vector<uint8_t>>& value) override;
     bool write(const common::CpuCommand& command, const std::vector<uint8_t>& data) override;
+    SendTimes lastSendTimes() const override;
+    ReceiveTimes lastReceiveTimes() const override;
 
 private:
     std::unique_ptr<Protocol> mProtocolReceive;
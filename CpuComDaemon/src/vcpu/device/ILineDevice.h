@@ -0,0 +1,87 @@
+/*
+ * COPYRIGHT (C) 2024 MITSUBISHI ELECTRIC CORPORATION
+ * ALL RIGHTS RESERVED
+ */
+
+#ifndef COM_MITSUBISHIELECTRIC_AHU_CPUCOM_ILINEDEVICE_H_
+#define COM_MITSUBISHIELECTRIC_AHU_CPUCOM_ILINEDEVICE_H_
+
+#include <sys/uio.h>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+#include "IODevice.h"
+
+namespace com {
+namespace mitsubishielectric {
+namespace ahu {
+namespace cpucom {
+namespace impl {
+
+/**
+ * ILineDevice is the interface for bulk operations on a serial line which are not
+ * provided by common::IODevice. Protocol uses them when its device implements this
+ * interface, otherwise it falls back to the common::IODevice primitives.
+ */
+class ILineDevice {
+public:
+    // LCOV_EXCL_START
+    virtual ~ILineDevice() = default;
+    // LCOV_EXCL_STOP
+
+    /**
+     * Writes all the buffers described by iov to the line with a single gather write.
+     * @param iov - buffers to be written, in order
+     * @param count - number of elements in iov
+     * @param timeout - time to wait for the line to take more bytes when it takes none
+     */
+    virtual common::IODevice::Result writeVector(const struct iovec* iov,
+                                                 int count,
+                                                 std::chrono::milliseconds timeout) = 0;
+
+    /**
+     * Waits until at least one byte is available and reads all available bytes,
+     * but not more than size, with a single read.
+     * @param data - buffer for the read bytes
+     * @param size - capacity of data
+     * @param timeout - time to wait for the first byte
+     * @param received - number of bytes stored in data
+     */
+    virtual common::IODevice::Result readAvailable(uint8_t* data,
+                                                   size_t size,
+                                                   std::chrono::milliseconds timeout,
+                                                   size_t& received) = 0;
+
+    // the last bytes discarded by drain(), the most recent one last
+    using DrainTail = std::array<uint8_t, 2>;
+
+    /**
+     * Discards all bytes waiting on the line, including those arriving while it drains.
+     * @param tail - the discarded bytes are shifted into it, the entries which are not reached
+     *               keep their values
+     * @param drained - number of discarded bytes
+     * @return Timeout if the line was empty, Success if bytes were discarded
+     */
+    virtual common::IODevice::Result drain(DrainTail& tail, size_t& drained) = 0;
+};
+
+// shifts count bytes into tail, as drain() does with the discarded bytes
+inline void shiftIntoTail(ILineDevice::DrainTail& tail, const uint8_t* bytes, size_t count)
+{
+    for (size_t i = (count > tail.size()) ? (count - tail.size()) : 0; i < count; ++i) {
+        std::copy(tail.begin() + 1, tail.end(), tail.begin());
+        tail.back() = bytes[i];
+    }
+}
+
+}  // namespace impl
+}  // namespace cpucom
+}  // namespace ahu
+}  // namespace mitsubishielectric
+}  // namespace com
+
+#endif  // COM_MITSUBISHIELECTRIC_AHU_CPUCOM_ILINEDEVICE_H_
@@ -0,0 +1,158 @@
+/*
+ * COPYRIGHT (C) 2024 MITSUBISHI ELECTRIC CORPORATION
+ * ALL RIGHTS RESERVED
+ */
+// LCOV_EXCL_START
+// This is excluded from a unit test coverage report because this class has system-dependency code
+// that cannot be covered by unit-test
+
+#include "LineDevice.h"
+
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+
+namespace com {
+namespace mitsubishielectric {
+namespace ahu {
+namespace cpucom {
+namespace impl {
+
+namespace {
+// frames are described by header, payload and footer buffers
+const int kMaxVectorLength = 4;
+const size_t kDrainChunkLength = 4096;
+}  // namespace
+
+common::IODevice::Result LineDevice::writeVector(const struct iovec* iov,
+                                                 int count,
+                                                 std::chrono::milliseconds timeout)
+{
+    if ((m_fd < 0) || (count > kMaxVectorLength)) {
+        return Result::Error;
+    }
+
+    std::array<struct iovec, kMaxVectorLength> pending;
+    std::copy(iov, iov + count, pending.begin());
+    struct iovec* current = pending.data();
+    int left = count;
+    const int timeoutMs = (timeout.count() < 0) ? -1 : static_cast<int>(timeout.count());
+
+    while (left > 0) {
+        ssize_t written = ::writev(m_fd, current, left);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if ((errno == EAGAIN) || (errno == EWOULDBLOCK)) {
+                struct pollfd fds = {m_fd, POLLOUT, 0};
+                if (::poll(&fds, 1, timeoutMs) > 0) {
+                    continue;
+                }
+                return Result::Timeout;
+            }
+            return Result::Error;
+        }
+
+        // skip the buffers which have been written completely, adjust the partially written one
+        size_t done = static_cast<size_t>(written);
+        while ((left > 0) && (done >= current->iov_len)) {
+            done -= current->iov_len;
+            ++current;
+            --left;
+        }
+        if (left > 0) {
+            current->iov_base = static_cast<uint8_t*>(current->iov_base) + done;
+            current->iov_len -= done;
+        }
+    }
+    return Result::Success;
+}
+
+common::IODevice::Result LineDevice::readAvailable(uint8_t* data,
+                                                   size_t size,
+                                                   std::chrono::milliseconds timeout,
+                                                   size_t& received)
+{
+    received = 0;
+    if (m_fd < 0) {
+        return Result::Error;
+    }
+
+    struct pollfd fds = {m_fd, POLLIN, 0};
+    const int timeoutMs = (timeout.count() < 0) ? -1 : static_cast<int>(timeout.count());
+    int ready = 0;
+    do {
+        ready = ::poll(&fds, 1, timeoutMs);
+    } while ((ready < 0) && (errno == EINTR));
+
+    if (ready == 0) {
+        return Result::Timeout;
+    }
+    if ((ready < 0) || ((fds.revents & POLLIN) == 0)) {
+        return Result::Error;
+    }
+
+    ssize_t count = 0;
+    do {
+        count = ::read(m_fd, data, size);
+    } while ((count < 0) && (errno == EINTR));
+
+    if (count < 0) {
+        return ((errno == EAGAIN) || (errno == EWOULDBLOCK)) ? Result::Timeout : Result::Error;
+    }
+    if (count == 0) {
+        // the other end has been closed
+        return Result::Error;
+    }
+    received = static_cast<size_t>(count);
+    return Result::Success;
+}
+
+common::IODevice::Result LineDevice::drain(DrainTail& tail, size_t& drained)
+{
+    drained = 0;
+    if (m_fd < 0) {
+        return Result::Error;
+    }
+
+    std::array<uint8_t, kDrainChunkLength> chunk;
+    while (true) {
+        int pending = 0;
+        if (::ioctl(m_fd, FIONREAD, &pending) < 0) {
+            return Result::Error;
+        }
+        if (pending <= 0) {
+            break;
+        }
+
+        ssize_t count = ::read(m_fd, chunk.data(), std::min<size_t>(pending, chunk.size()));
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if ((errno == EAGAIN) || (errno == EWOULDBLOCK)) {
+                break;
+            }
+            return Result::Error;
+        }
+        if (count == 0) {
+            return Result::Error;
+        }
+        shiftIntoTail(tail, chunk.data(), count);
+        drained += static_cast<size_t>(count);
+    }
+    return (drained > 0) ? Result::Success : Result::Timeout;
+}
+
+}  // namespace impl
+}  // namespace cpucom
+}  // namespace ahu
+}  // namespace mitsubishielectric
+}  // namespace com
+
+// LCOV_EXCL_STOP
@@ -0,0 +1,43 @@
+/*
+ * COPYRIGHT (C) 2024 MITSUBISHI ELECTRIC CORPORATION
+ * ALL RIGHTS RESERVED
+ */
+
+#ifndef COM_MITSUBISHIELECTRIC_AHU_CPUCOM_LINEDEVICE_H_
+#define COM_MITSUBISHIELECTRIC_AHU_CPUCOM_LINEDEVICE_H_
+
+#include "ILineDevice.h"
+#include "IODevice.h"
+
+namespace com {
+namespace mitsubishielectric {
+namespace ahu {
+namespace cpucom {
+namespace impl {
+
+/**
+ * LineDevice is an IODevice which implements the ILineDevice bulk operations
+ * directly on its file descriptor.
+ */
+class LineDevice : public common::IODevice, public ILineDevice {  // LCOV_EXCL_LINE
+    // exclude all possible destructors, that cannot be covered by unit-test
+public:
+    using IODevice::IODevice;
+
+    common::IODevice::Result writeVector(const struct iovec* iov,
+                                         int count,
+                                         std::chrono::milliseconds timeout) override;
+    common::IODevice::Result readAvailable(uint8_t* data,
+                                           size_t size,
+                                           std::chrono::milliseconds timeout,
+                                           size_t& received) override;
+    common::IODevice::Result drain(DrainTail& tail, size_t& drained) override;
+};
+
+}  // namespace impl
+}  // namespace cpucom
+}  // namespace ahu
+}  // namespace mitsubishielectric
+}  // namespace com
+
+#endif  // COM_MITSUBISHIELECTRIC_AHU_CPUCOM_LINEDEVICE_H_
@@ -6,7 +6,7 @@
 #ifndef COM_MITSUBISHIELECTRIC_AHU_CPUCOM_SOCKET_SLAVE_DEVICE_H_
 #define COM_MITSUBISHIELECTRIC_AHU_CPUCOM_SOCKET_SLAVE_DEVICE_H_
 
-#include "IODevice.h"
+#include "LineDevice.h"
 
 #include <memory>
 #include <string>
@@ -18,9 +18,9 @@ namespace cpucom {
 namespace impl {
 namespace socket {
 
-class SlaveDevice : public common::IODevice {
+class SlaveDevice : public LineDevice {
 public:
-    using IODevice::IODevice;
+    using LineDevice::LineDevice;
     virtual bool open(OpenMode mode) override;
 };
 
@@ -0,0 +1,196 @@
+/*
+ * COPYRIGHT (C) 2024 MITSUBISHI ELECTRIC CORPORATION
+ * ALL RIGHTS RESERVED
+ */
+
+#include "FlightRecorder.h"
+
+#include "ProtocolStates.h"
+
+namespace com {
+namespace mitsubishielectric {
+namespace ahu {
+namespace cpucom {
+namespace impl {
+
+constexpr size_t FlightRecorder::kCapacity;
+
+namespace {
+
+uint64_t toNanoseconds(std::chrono::steady_clock::time_point time)
+{
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count());
+}
+
+uint32_t toDwell(std::chrono::steady_clock::duration duration)
+{
+    const auto dwell = std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+    if (dwell <= 0) {
+        return 0;
+    }
+    return (static_cast<uint64_t>(dwell) > UINT32_MAX) ? UINT32_MAX : static_cast<uint32_t>(dwell);
+}
+
+}  // namespace
+
+FlightRecorder::FlightRecorder()
+    : m_next(0)
+    , m_slots()
+{
+    for (Slot& slot : m_slots) {
+        slot.sequence.store(0, std::memory_order_relaxed);
+        slot.left.store(0, std::memory_order_relaxed);
+        slot.fields.store(0, std::memory_order_relaxed);
+    }
+}
+
+void FlightRecorder::record(Machine machine,
+                            uint8_t state,
+                            uint8_t event,
+                            uint8_t byte,
+                            std::chrono::steady_clock::time_point entered,
+                            std::chrono::steady_clock::time_point left)
+{
+    const uint64_t index = m_next.fetch_add(1, std::memory_order_relaxed);
+    Slot& slot = m_slots[index % kCapacity];
+    // a reader which sees the slot while it is written finds its sequence changed
+    slot.sequence.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.left.store(toNanoseconds(left), std::memory_order_relaxed);
+    slot.fields.store((static_cast<uint64_t>(toDwell(left - entered)) << 32) |
+                          (static_cast<uint64_t>(machine) << 24) |
+                          (static_cast<uint64_t>(state) << 16) |
+                          (static_cast<uint64_t>(event) << 8) | byte,
+                      std::memory_order_relaxed);
+    slot.sequence.store(index + 1, std::memory_order_release);
+}
+
+std::vector<FlightRecorder::Transition> FlightRecorder::transitions() const
+{
+    const uint64_t next = m_next.load(std::memory_order_acquire);
+    const uint64_t first = (next > kCapacity) ? (next - kCapacity) : 0;
+    std::vector<Transition> result;
+    result.reserve(next - first);
+    for (uint64_t index = first; index < next; ++index) {
+        const Slot& slot = m_slots[index % kCapacity];
+        const uint64_t sequence = slot.sequence.load(std::memory_order_acquire);
+        const uint64_t left = slot.left.load(std::memory_order_relaxed);
+        const uint64_t fields = slot.fields.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if ((sequence != index + 1) ||
+            (slot.sequence.load(std::memory_order_relaxed) != sequence)) {
+            continue;  // not written yet or being overwritten
+        }
+        Transition transition;
+        transition.left = left;
+        transition.dwell = static_cast<uint32_t>(fields >> 32);
+        transition.machine = static_cast<Machine>((fields >> 24) & 0xff);
+        transition.state = static_cast<uint8_t>(fields >> 16);
+        transition.event = static_cast<uint8_t>(fields >> 8);
+        transition.byte = static_cast<uint8_t>(fields);
+        result.push_back(transition);
+    }
+    return result;
+}
+
+const char* FlightRecorder::stateName(Machine machine, uint8_t state)
+{
+    if (machine == Sending) {
+        switch (state) {
+        case sending::Idle:
+            return "idle";
+        case sending::Enquiry:
+            return "enq";
+        case sending::Reenquiry:
+            return "reenq";
+        case sending::Ack:
+            return "ack";
+        case sending::Frame:
+            return "frame";
+        case sending::Ack2:
+            return "ack2";
+        case sending::Retry:
+            return "retry";
+        case sending::Nak:
+            return "nak";
+        case sending::Wait:
+            return "wait";
+        case sending::Done:
+            return "done";
+        case sending::Error:
+            return "error";
+        case sending::End:
+            return "end";
+        default:
+            return "other";
+        }
+    }
+    switch (state) {
+    case receiving::Idle:
+        return "idle";
+    case receiving::Poll:
+        return "poll";
+    case receiving::Repoll:
+        return "repoll";
+    case receiving::Enquiry:
+        return "enq";
+    case receiving::Ack:
+        return "ack";
+    case receiving::Stx:
+        return "stx";
+    case receiving::Len:
+        return "len";
+    case receiving::DataCommand:
+        return "cmd";
+    case receiving::DataExtLen:
+        return "extlen";
+    case receiving::DataFrameNumber:
+        return "frameno";
+    case receiving::Data:
+        return "data";
+    case receiving::Etx:
+        return "etx";
+    case receiving::Checksum:
+        return "cs";
+    case receiving::Ack2:
+        return "ack2";
+    case receiving::Nak:
+        return "nak";
+    case receiving::Retry:
+        return "retry";
+    case receiving::Done:
+        return "done";
+    case receiving::Error:
+        return "error";
+    case receiving::End:
+        return "end";
+    default:
+        return "other";
+    }
+}
+
+const char* FlightRecorder::eventName(uint8_t event)
+{
+    switch (static_cast<Event>(event)) {
+    case Event::Pass:
+        return "pass";
+    case Event::Busy:
+        return "busy";
+    case Event::Wait:
+        return "wait";
+    case Event::Deny:
+        return "deny";
+    case Event::Fail:
+        return "fail";
+    case Event::Next:
+        return "next";
+    }
+    return "other";  // LCOV_EXCL_LINE
+}
+
+}  // namespace impl
+}  // namespace cpucom
+}  // namespace ahu
+}  // namespace mitsubishielectric
+}  // namespace com
@@ -0,0 +1,81 @@
+/*
+ * COPYRIGHT (C) 2024 MITSUBISHI ELECTRIC CORPORATION
+ * ALL RIGHTS RESERVED
+ */
+
+#ifndef COM_MITSUBISHIELECTRIC_AHU_CPUCOM_FLIGHTRECORDER_H_
+#define COM_MITSUBISHIELECTRIC_AHU_CPUCOM_FLIGHTRECORDER_H_
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace com {
+namespace mitsubishielectric {
+namespace ahu {
+namespace cpucom {
+namespace impl {
+
+/**
+ * Ring of the last kCapacity state transitions of the send and receive machines of Protocol,
+ * which is dumped when a message fails. record() is lock free and may be called by the
+ * threads of both machines at once, transitions() may be called from any thread.
+ */
+class FlightRecorder {
+public:
+    static constexpr size_t kCapacity = 256;
+
+    enum Machine : uint8_t { Sending, Receiving };
+
+    struct Transition {
+        uint64_t left;    // ns of the steady clock when the state was left
+        uint32_t dwell;   // us spent in the state, at most UINT32_MAX
+        Machine machine;  // whose state it was
+        uint8_t state;    // a sending::State or receiving::State
+        uint8_t event;    // the Event the state was left with
+        uint8_t byte;     // the last byte read from the line by then
+    };
+
+    FlightRecorder();
+
+    FlightRecorder(const FlightRecorder&) = delete;
+    FlightRecorder& operator=(const FlightRecorder&) = delete;
+
+    void record(Machine machine,
+                uint8_t state,
+                uint8_t event,
+                uint8_t byte,
+                std::chrono::steady_clock::time_point entered,
+                std::chrono::steady_clock::time_point left);
+
+    /**
+     * @return the transitions in the ring, oldest first, skipping those being overwritten
+     */
+    std::vector<Transition> transitions() const;
+
+    // of a state of machine in dumps and statistics
+    static const char* stateName(Machine machine, uint8_t state);
+    static const char* eventName(uint8_t event);
+
+private:
+    // a transition packed in two words, valid while sequence is the index it was recorded at + 1
+    struct Slot {
+        std::atomic<uint64_t> sequence;
+        std::atomic<uint64_t> left;
+        std::atomic<uint64_t> fields;
+    };
+
+    std::atomic<uint64_t> m_next;  // index of the next transition recorded
+    std::array<Slot, kCapacity> m_slots;
+};
+
+}  // namespace impl
+}  // namespace cpucom
+}  // namespace ahu
+}  // namespace mitsubishielectric
+}  // namespace com
+
+#endif  // COM_MITSUBISHIELECTRIC_AHU_CPUCOM_FLIGHTRECORDER_H_
@@ -0,0 +1,162 @@
+/*
+ * COPYRIGHT (C) 2024 MITSUBISHI ELECTRIC CORPORATION
+ * ALL RIGHTS RESERVED
+ */
+
+#include "FrameChecksum.h"
+
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+#include "FrameFormat.h"
+
+namespace com {
+namespace mitsubishielectric {
+namespace ahu {
+namespace cpucom {
+namespace impl {
+
+namespace {
+
+// the checksum of the bytes of a word
+uint8_t fold(uint64_t word)
+{
+    word ^= word >> 32;
+    word ^= word >> 16;
+    word ^= word >> 8;
+    return static_cast<uint8_t>(word);
+}
+
+#if defined(__SSE2__)
+using Vector = __m128i;
+
+Vector load(const uint8_t* data) { return _mm_loadu_si128(reinterpret_cast<const Vector*>(data)); }
+void store(uint8_t* data, Vector vector)
+{
+    _mm_storeu_si128(reinterpret_cast<Vector*>(data), vector);
+}
+Vector zero() { return _mm_setzero_si128(); }
+Vector combine(Vector a, Vector b) { return _mm_xor_si128(a, b); }
+
+uint8_t fold(Vector vector)
+{
+    uint64_t words[2];
+    store(reinterpret_cast<uint8_t*>(words), vector);
+    return fold(words[0] ^ words[1]);
+}
+#elif defined(__ARM_NEON)
+using Vector = uint8x16_t;
+
+Vector load(const uint8_t* data) { return vld1q_u8(data); }
+void store(uint8_t* data, Vector vector) { vst1q_u8(data, vector); }
+Vector zero() { return vdupq_n_u8(0); }
+Vector combine(Vector a, Vector b) { return veorq_u8(a, b); }
+
+uint8_t fold(Vector vector)
+{
+    const uint64x2_t words = vreinterpretq_u64_u8(vector);
+    return fold(vgetq_lane_u64(words, 0) ^ vgetq_lane_u64(words, 1));
+}
+#endif
+
+// most fields of a frame are a few bytes long, which is not worth setting up words for
+uint8_t byteChecksum(const uint8_t* data, size_t length, uint8_t seed)
+{
+    for (size_t i = 0; i < length; ++i) {
+        seed ^= data[i];
+    }
+    return seed;
+}
+
+}  // namespace
+
+uint8_t frameChecksum(const uint8_t* header,
+                      uint32_t headerLength,
+                      const uint8_t* payload,
+                      uint32_t payloadLength)
+{
+    const uint8_t checksum = blockChecksum(header + frame::kStxLength,
+                                           headerLength - frame::kStxLength);
+    return blockChecksum(payload, payloadLength, checksum) ^ ETX;
+}
+
+uint8_t wordChecksum(const uint8_t* data, size_t length, uint8_t seed)
+{
+    if (length < sizeof(uint64_t)) {
+        return byteChecksum(data, length, seed);
+    }
+    uint64_t words = 0;
+    size_t i = 0;
+    for (; i + sizeof(words) <= length; i += sizeof(words)) {
+        uint64_t word = 0;
+        std::memcpy(&word, data + i, sizeof(word));
+        words ^= word;
+    }
+    return byteChecksum(data + i, length - i, seed ^ fold(words));
+}
+
+#if defined(__SSE2__) || defined(__ARM_NEON)
+uint8_t blockChecksum(const uint8_t* data, size_t length, uint8_t seed)
+{
+    const size_t kVectorSize = sizeof(Vector);
+    if (length < kVectorSize) {
+        return wordChecksum(data, length, seed);
+    }
+    // two accumulators keep two loads in flight
+    Vector even = zero();
+    Vector odd = zero();
+    size_t i = 0;
+    for (; i + 2 * kVectorSize <= length; i += 2 * kVectorSize) {
+        even = combine(even, load(data + i));
+        odd = combine(odd, load(data + i + kVectorSize));
+    }
+    if (i + kVectorSize <= length) {
+        even = combine(even, load(data + i));
+        i += kVectorSize;
+    }
+    return wordChecksum(data + i, length - i, seed ^ fold(combine(even, odd)));
+}
+
+uint8_t copyWithChecksum(uint8_t* destination, const uint8_t* source, size_t length, uint8_t seed)
+{
+    const size_t kVectorSize = sizeof(Vector);
+    if (length < kVectorSize) {
+        for (size_t i = 0; i < length; ++i) {
+            destination[i] = source[i];
+            seed ^= source[i];
+        }
+        return seed;
+    }
+    Vector vectors = zero();
+    size_t i = 0;
+    for (; i + kVectorSize <= length; i += kVectorSize) {
+        const Vector vector = load(source + i);
+        store(destination + i, vector);
+        vectors = combine(vectors, vector);
+    }
+    std::memcpy(destination + i, source + i, length - i);
+    return wordChecksum(source + i, length - i, seed ^ fold(vectors));
+}
+#else
+uint8_t blockChecksum(const uint8_t* data, size_t length, uint8_t seed)
+{
+    return wordChecksum(data, length, seed);
+}
+
+uint8_t copyWithChecksum(uint8_t* destination, const uint8_t* source, size_t length, uint8_t seed)
+{
+    std::memcpy(destination, source, length);
+    return wordChecksum(source, length, seed);
+}
+#endif
+
+}  // namespace impl
+}  // namespace cpucom
+}  // namespace ahu
+}  // namespace mitsubishielectric
+}  // namespace com
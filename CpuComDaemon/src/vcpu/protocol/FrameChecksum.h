@@ -0,0 +1,59 @@
+/*
+ * COPYRIGHT (C) 2024 MITSUBISHI ELECTRIC CORPORATION
+ * ALL RIGHTS RESERVED
+ */
+
+#ifndef COM_MITSUBISHIELECTRIC_AHU_CPUCOM_FRAMECHECKSUM_H_
+#define COM_MITSUBISHIELECTRIC_AHU_CPUCOM_FRAMECHECKSUM_H_
+
+#include <cstddef>
+#include <cstdint>
+
+namespace com {
+namespace mitsubishielectric {
+namespace ahu {
+namespace cpucom {
+namespace impl {
+
+/**
+ * Calculates the checksum of a frame, which covers its [LEN]..[ETX] range,
+ * from the separately stored header and payload. ETX is implied.
+ * @param header - frame header, starting with STX
+ * @param headerLength - number of bytes in header
+ * @param payload - frame data which follows the header
+ * @param payloadLength - number of bytes in payload
+ */
+uint8_t frameChecksum(const uint8_t* header,
+                      uint32_t headerLength,
+                      const uint8_t* payload,
+                      uint32_t payloadLength);
+
+/**
+ * Calculates the same checksum as common::checksum(), the XOR of all bytes, 16 bytes at a time
+ * with SSE2 or NEON and a machine word at a time on other targets.
+ * @param seed - checksum of the bytes preceding data, which lets a range be checksummed in parts
+ */
+uint8_t blockChecksum(const uint8_t* data, size_t length, uint8_t seed = 0);
+
+/**
+ * The portable kernel of blockChecksum(), which also handles the bytes left over by SIMD.
+ */
+uint8_t wordChecksum(const uint8_t* data, size_t length, uint8_t seed = 0);
+
+/**
+ * Copies length bytes from source to destination and calculates their checksum on the way,
+ * so that received bytes need not be read again to check the frame.
+ * @return blockChecksum(source, length, seed)
+ */
+uint8_t copyWithChecksum(uint8_t* destination,
+                         const uint8_t* source,
+                         size_t length,
+                         uint8_t seed = 0);
+
+}  // namespace impl
+}  // namespace cpucom
+}  // namespace ahu
+}  // namespace mitsubishielectric
+}  // namespace com
+
+#endif  // COM_MITSUBISHIELECTRIC_AHU_CPUCOM_FRAMECHECKSUM_H_
@@ -0,0 +1,125 @@
+/*
+ * COPYRIGHT (C) 2024 MITSUBISHI ELECTRIC CORPORATION
+ * ALL RIGHTS RESERVED
+ */
+
+#include "FrameEncoder.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+#include "FrameChecksum.h"
+
+namespace com {
+namespace mitsubishielectric {
+namespace ahu {
+namespace cpucom {
+namespace impl {
+
+using namespace frame;
+
+constexpr int32_t FrameEncoder::kVectorLength;
+
+std::array<struct iovec, FrameEncoder::kVectorLength> FrameEncoder::Frame::iov() const
+{
+    // iovec is shared by readv and writev, so its base is not const
+    return {{
+        {const_cast<uint8_t*>(header.data()), headerLength},
+        {const_cast<uint8_t*>(payload), payloadLength},
+        {const_cast<uint8_t*>(footer.data()), footer.size()},
+    }};
+}
+
+void FrameEncoder::Frame::copyTo(uint8_t* destination) const
+{
+    std::memcpy(destination, header.data(), headerLength);
+    std::memcpy(destination + headerLength, payload, payloadLength);
+    std::memcpy(destination + headerLength + payloadLength, footer.data(), footer.size());
+}
+
+uint32_t FrameEncoder::frameCount(size_t dataSize)
+{
+    if (dataSize <= static_cast<size_t>(kMaxExtendedLengthFrameLength - kFrameFooterLength)) {
+        return 1;
+    }
+    uint32_t actualDataLength = dataSize - kCmdLength;
+    return (actualDataLength / kMaxActualDataLength) +
+           ((actualDataLength % kMaxActualDataLength) > 0);
+}
+
+FrameEncoder::FrameEncoder(const std::vector<uint8_t>& data)
+    : m_data(data)
+    , m_layout((data.size() <= static_cast<size_t>(kMaxFrameLength - kFrameFooterLength))
+                   ? Layout::Regular
+                   : ((data.size() <= static_cast<size_t>(kMaxExtendedLengthFrameLength -
+                                                          kFrameFooterLength))
+                          ? Layout::ExtendedLength
+                          : Layout::ExtendedLengthWithFrameDivision))
+    , m_frameCount(frameCount(data.size()))
+{
+    assert((data.size() >= static_cast<size_t>(kCmdLength)) && "data.size() >= kCmdLength");
+}
+
+FrameEncoder::Frame FrameEncoder::frame(uint32_t index) const
+{
+    assert(index < m_frameCount);
+
+    Frame result;
+    uint8_t* header = result.header.data();
+    header[0] = STX;
+
+    if (m_layout == Layout::Regular) {
+        header[1] = m_data.size() + kFrameFooterLength;
+        result.headerLength = kFrameHeaderLength;
+        result.payload = m_data.data();
+        result.payloadLength = m_data.size();
+    }
+    else {
+        uint8_t codebit = m_data[2];
+        uint32_t offset = kCmdLength;
+        uint32_t length = m_data.size() - kCmdLength;
+        uint32_t frameLength = kCmdLength + kExtLenLength + kFrameFooterLength;
+        if (m_layout == Layout::ExtendedLengthWithFrameDivision) {
+            // split, 0x02 - next frame present, 0x03 - last frame
+            codebit |= (index == m_frameCount - 1) ? 0x03 : 0x02;
+            offset += index * kMaxActualDataLength;
+            length = std::min<uint32_t>(m_data.size() - offset, kMaxActualDataLength);
+            frameLength += kFrameNumberLength + kTotalFramesLength;
+        }
+        frameLength += length;
+
+        header[1] = EXT_LEN;
+        header[2] = m_data[0];  // command
+        header[3] = m_data[1];  // sub command
+        header[4] = codebit;
+        header[5] = (frameLength >> 16) & 0x000000ff;
+        header[6] = (frameLength >> 8) & 0x000000ff;
+        header[7] = frameLength & 0x000000ff;
+        result.headerLength = kFrameHeaderLength + kCmdLength + kExtLenLength;
+
+        if (m_layout == Layout::ExtendedLengthWithFrameDivision) {
+            header[8] = (index >> 8) & 0x000000ff;
+            header[9] = index & 0x000000ff;
+            header[10] = (m_frameCount >> 8) & 0x000000ff;
+            header[11] = m_frameCount & 0x000000ff;
+            result.headerLength += kFrameNumberLength + kTotalFramesLength;
+        }
+
+        result.payload = m_data.data() + offset;
+        result.payloadLength = length;
+    }
+
+    result.footer[0] = ETX;
+
+    // calculate checksum for [LEN]..[ETX] range
+    result.footer[1] =
+        frameChecksum(header, result.headerLength, result.payload, result.payloadLength);
+    return result;
+}
+
+}  // namespace impl
+}  // namespace cpucom
+}  // namespace ahu
+}  // namespace mitsubishielectric
+}  // namespace com
@@ -0,0 +1,77 @@
+/*
+ * COPYRIGHT (C) 2024 MITSUBISHI ELECTRIC CORPORATION
+ * ALL RIGHTS RESERVED
+ */
+
+#ifndef COM_MITSUBISHIELECTRIC_AHU_CPUCOM_FRAMEENCODER_H_
+#define COM_MITSUBISHIELECTRIC_AHU_CPUCOM_FRAMEENCODER_H_
+
+#include <sys/uio.h>
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "FrameFormat.h"
+
+namespace com {
+namespace mitsubishielectric {
+namespace ahu {
+namespace cpucom {
+namespace impl {
+
+/**
+ * FrameEncoder splits a message into protocol frames without copying it.
+ * Each frame is described as a header, a slice of the message and a footer,
+ * so that it can be handed to the device with a single gather write.
+ * The message must outlive the encoder and the frames obtained from it.
+ */
+class FrameEncoder {
+public:
+    static constexpr int32_t kVectorLength = 3;
+
+    struct Frame {
+        std::array<uint8_t, frame::kMaxFrameHeaderLength> header;  // STX, LEN[, CMD, EXT_LEN[, FN, TF]]
+        uint32_t headerLength;
+        const uint8_t* payload;  // points into the encoded message
+        uint32_t payloadLength;
+        std::array<uint8_t, frame::kFrameFooterLength> footer;  // ETX, CS
+
+        uint32_t size() const { return headerLength + payloadLength + footer.size(); }
+        std::array<struct iovec, kVectorLength> iov() const;
+        void copyTo(uint8_t* destination) const;
+    };
+
+    /**
+     * @param data - [CMD][SUBCMD][CODEBIT][DATA...], at least kCmdLength bytes
+     */
+    explicit FrameEncoder(const std::vector<uint8_t>& data);
+
+    uint32_t frameCount() const { return m_frameCount; }
+
+    /**
+     * Describes the frame with the given index, the checksum is calculated here.
+     */
+    Frame frame(uint32_t index) const;
+
+    static uint32_t frameCount(size_t dataSize);
+
+private:
+    enum class Layout {
+        Regular,
+        ExtendedLength,
+        ExtendedLengthWithFrameDivision,
+    };
+
+    const std::vector<uint8_t>& m_data;
+    const Layout m_layout;
+    const uint32_t m_frameCount;
+};
+
+}  // namespace impl
+}  // namespace cpucom
+}  // namespace ahu
+}  // namespace mitsubishielectric
+}  // namespace com
+
+#endif  // COM_MITSUBISHIELECTRIC_AHU_CPUCOM_FRAMEENCODER_H_
@@ -0,0 +1,66 @@
+/*
+ * COPYRIGHT (C) 2024 MITSUBISHI ELECTRIC CORPORATION
+ * ALL RIGHTS RESERVED
+ */
+
+#ifndef COM_MITSUBISHIELECTRIC_AHU_CPUCOM_FRAMEFORMAT_H_
+#define COM_MITSUBISHIELECTRIC_AHU_CPUCOM_FRAMEFORMAT_H_
+
+#include <cstdint>
+
+namespace com {
+namespace mitsubishielectric {
+namespace ahu {
+namespace cpucom {
+namespace impl {
+
+// Data transmission control codes
+enum ControlCode {
+    STX = 0x02,
+    ETX = 0x03,
+    ENQ = 0x05,
+    ACK = 0x06,
+    DC2 = 0x12,  // offers pipelined frame division before ENQ
+    DC3 = 0x13,  // accepts the offer of DC2 instead of ACK, read as XOFF if IXON is set
+    NAK = 0x15,
+    EXT_LEN = 0xfe,
+};
+
+namespace frame {
+
+// Lengths of the message fields
+constexpr int32_t kStxLength = 1;
+constexpr int32_t kLenLength = 1;
+constexpr int32_t kCmdLength = 3;
+constexpr int32_t kExtLenLength = 3;
+constexpr int32_t kFrameNumberLength = 2;
+constexpr int32_t kTotalFramesLength = 2;
+constexpr int32_t kEtxLength = 1;
+constexpr int32_t kCsLength = 1;
+constexpr int32_t kFrameHeaderLength = kStxLength + kLenLength;
+constexpr int32_t kFrameFooterLength = kEtxLength + kCsLength;
+
+// The longest frame header: STX, LEN, CMD, EXT_LEN, frame number and total frames
+constexpr int32_t kMaxFrameHeaderLength = kFrameHeaderLength + kCmdLength + kExtLenLength +
+                                          kFrameNumberLength + kTotalFramesLength;
+
+// Frame length limitations
+constexpr int32_t kMinFrameLength = 5;
+constexpr int32_t kMaxFrameLength = 253;
+constexpr int32_t kMaxActualDataLength = 1024;
+constexpr int32_t kMaxExtendedLengthFrameLength = 1032;
+constexpr int32_t kMaxExtendedLengthFrameDivisionFrameLength = 1036;
+
+// The longest frame on the wire, STX and LEN included
+constexpr int32_t kMaxWireFrameLength =
+    kFrameHeaderLength + kMaxExtendedLengthFrameDivisionFrameLength;
+
+}  // namespace frame
+
+}  // namespace impl
+}  // namespace cpucom
+}  // namespace ahu
+}  // namespace mitsubishielectric
+}  // namespace com
+
+#endif  // COM_MITSUBISHIELECTRIC_AHU_CPUCOM_FRAMEFORMAT_H_
@@ -0,0 +1,204 @@
+/*
+ * COPYRIGHT (C) 2024 MITSUBISHI ELECTRIC CORPORATION
+ * ALL RIGHTS RESERVED
+ */
+
+#include "LinkMetrics.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <utility>
+
+#include "ProtocolStates.h"
+
+namespace com {
+namespace mitsubishielectric {
+namespace ahu {
+namespace cpucom {
+namespace impl {
+
+namespace {
+
+uint64_t toMicroseconds(std::chrono::microseconds duration)
+{
+    return (duration.count() > 0) ? static_cast<uint64_t>(duration.count()) : 0;
+}
+
+void appendLatencies(std::string& text, const char* name, const LatencyHistogram& histogram)
+{
+    char line[128] = {};
+    std::snprintf(line, sizeof(line), "%-12s %10llu %9llu %9llu %9llu %9llu %9llu\n", name,
+                  static_cast<unsigned long long>(histogram.count()),
+                  static_cast<unsigned long long>(histogram.percentile(50)),
+                  static_cast<unsigned long long>(histogram.percentile(90)),
+                  static_cast<unsigned long long>(histogram.percentile(99)),
+                  static_cast<unsigned long long>(histogram.percentile(99.9)),
+                  static_cast<unsigned long long>(histogram.max()));
+    text += line;
+}
+
+void appendDwells(std::string& text,
+                  FlightRecorder::Machine machine,
+                  const std::vector<LatencyHistogram>& histograms)
+{
+    char name[16] = {};
+    for (size_t state = 0; state < histograms.size(); ++state) {
+        if (histograms[state].count() != 0) {
+            std::snprintf(name, sizeof(name), "%s %s",
+                          (machine == FlightRecorder::Sending) ? "tx" : "rx",
+                          FlightRecorder::stateName(machine, static_cast<uint8_t>(state)));
+            appendLatencies(text, name, histograms[state]);
+        }
+    }
+}
+
+}  // namespace
+
+constexpr size_t StateDwells::kCapacity;
+
+LinkMetrics::LinkMetrics()
+    : m_snapshot()
+{
+    m_snapshot.receiveTimeouts.resize(receiving::Count);
+    m_snapshot.sendDwell.resize(sending::Count);
+    m_snapshot.receiveDwell.resize(receiving::Count);
+}
+
+void LinkMetrics::onFrameSent(const common::CpuCommand& command,
+                              size_t bytes,
+                              std::chrono::microseconds handshake)
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    CommandCounters& counters = m_snapshot.commands[command];
+    ++counters.framesSent;
+    counters.bytesSent += bytes;
+    m_snapshot.handshake.record(toMicroseconds(handshake));
+}
+
+void LinkMetrics::onMessageSent(const common::CpuCommand& command,
+                                uint32_t retries,
+                                std::chrono::microseconds wireTime)
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    CommandCounters& counters = m_snapshot.commands[command];
+    counters.retries += retries;
+    counters.wireTime += toMicroseconds(wireTime);
+    m_snapshot.wire.record(toMicroseconds(wireTime));
+}
+
+void LinkMetrics::onNakReceived(const common::CpuCommand& command)
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    ++m_snapshot.commands[command].naksReceived;
+}
+
+void LinkMetrics::onFrameReceived(const common::CpuCommand& command, size_t bytes)
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    CommandCounters& counters = m_snapshot.commands[command];
+    ++counters.framesReceived;
+    counters.bytesReceived += bytes;
+}
+
+void LinkMetrics::onChecksumMismatch(const common::CpuCommand& command)
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    ++m_snapshot.commands[command].checksumMismatches;
+}
+
+void LinkMetrics::onNakSent()
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    ++m_snapshot.naksSent;
+}
+
+void LinkMetrics::onReceiveTimeout(uint8_t state)
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    if (state < m_snapshot.receiveTimeouts.size()) {
+        ++m_snapshot.receiveTimeouts[state];
+    }
+}
+
+void LinkMetrics::onStatesLeft(FlightRecorder::Machine machine, StateDwells& dwells)
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    std::vector<LatencyHistogram>& histograms = (machine == FlightRecorder::Sending)
+                                                    ? m_snapshot.sendDwell
+                                                    : m_snapshot.receiveDwell;
+    for (size_t i = 0; i < dwells.m_size; ++i) {
+        const StateDwells::Dwell& dwell = dwells.m_dwells[i];
+        if (dwell.state < histograms.size()) {
+            histograms[dwell.state].record(toMicroseconds(dwell.dwell));
+        }
+    }
+    dwells.m_size = 0;
+}
+
+LinkMetrics::Snapshot LinkMetrics::snapshot() const
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    return m_snapshot;
+}
+
+std::string formatLinkStats(const LinkMetrics::Snapshot& link, const LatencyHistogram& queueWait)
+{
+    using Entry = std::pair<common::CpuCommand, LinkMetrics::CommandCounters>;
+    std::vector<Entry> commands(link.commands.begin(), link.commands.end());
+    std::stable_sort(commands.begin(), commands.end(), [](const Entry& a, const Entry& b) {
+        return (a.second.bytesSent + a.second.bytesReceived) >
+               (b.second.bytesSent + b.second.bytesReceived);
+    });
+
+    std::string text =
+        "command   tx frames   tx bytes rx frames   rx bytes  retries  naks rx cs errors"
+        "   wire ms\n";
+    char line[160] = {};
+    for (const Entry& entry : commands) {
+        const LinkMetrics::CommandCounters& counters = entry.second;
+        std::snprintf(line, sizeof(line),
+                      "0x%02x/0x%02x %9llu %10llu %9llu %10llu %8llu %8llu %9llu %9llu\n",
+                      entry.first.first, entry.first.second,
+                      static_cast<unsigned long long>(counters.framesSent),
+                      static_cast<unsigned long long>(counters.bytesSent),
+                      static_cast<unsigned long long>(counters.framesReceived),
+                      static_cast<unsigned long long>(counters.bytesReceived),
+                      static_cast<unsigned long long>(counters.retries),
+                      static_cast<unsigned long long>(counters.naksReceived),
+                      static_cast<unsigned long long>(counters.checksumMismatches),
+                      static_cast<unsigned long long>(counters.wireTime / 1000));
+        text += line;
+    }
+
+    std::snprintf(line, sizeof(line), "naks sent: %llu\nreceive timeouts:",
+                  static_cast<unsigned long long>(link.naksSent));
+    text += line;
+    bool timedOut = false;
+    for (size_t state = 0; state < link.receiveTimeouts.size(); ++state) {
+        if (link.receiveTimeouts[state] != 0) {
+            std::snprintf(line, sizeof(line), " %s %llu",
+                          FlightRecorder::stateName(FlightRecorder::Receiving,
+                                                    static_cast<uint8_t>(state)),
+                          static_cast<unsigned long long>(link.receiveTimeouts[state]));
+            text += line;
+            timedOut = true;
+        }
+    }
+    text += timedOut ? "\n" : " none\n";
+
+    text += "latency us        count       p50       p90       p99     p99.9       max\n";
+    appendLatencies(text, "queue wait", queueWait);
+    appendLatencies(text, "wire", link.wire);
+    appendLatencies(text, "enq-ack2", link.handshake);
+
+    text += "dwell us          count       p50       p90       p99     p99.9       max\n";
+    appendDwells(text, FlightRecorder::Sending, link.sendDwell);
+    appendDwells(text, FlightRecorder::Receiving, link.receiveDwell);
+    return text;
+}
+
+}  // namespace impl
+}  // namespace cpucom
+}  // namespace ahu
+}  // namespace mitsubishielectric
+}  // namespace com
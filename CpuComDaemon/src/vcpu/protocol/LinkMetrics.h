@@ -0,0 +1,125 @@
+/*
+ * COPYRIGHT (C) 2024 MITSUBISHI ELECTRIC CORPORATION
+ * ALL RIGHTS RESERVED
+ */
+
+#ifndef COM_MITSUBISHIELECTRIC_AHU_CPUCOM_LINKMETRICS_H_
+#define COM_MITSUBISHIELECTRIC_AHU_CPUCOM_LINKMETRICS_H_
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "CpuCommand.h"
+#include "FlightRecorder.h"
+#include "LatencyHistogram.h"
+
+namespace com {
+namespace mitsubishielectric {
+namespace ahu {
+namespace cpucom {
+namespace impl {
+
+/**
+ * Time spent in the states one machine left, kept by the machine without a lock until folded
+ * into LinkMetrics by onStatesLeft(), when its message ends or once full.
+ */
+class StateDwells {
+public:
+    static constexpr size_t kCapacity = 64;
+
+    StateDwells()
+        : m_size(0)
+    {
+    }
+
+    // @return false once full
+    bool add(uint8_t state, std::chrono::microseconds dwell)
+    {
+        m_dwells[m_size++] = {state, dwell};
+        return m_size < kCapacity;
+    }
+
+private:
+    friend class LinkMetrics;
+
+    struct Dwell {
+        uint8_t state;
+        std::chrono::microseconds dwell;
+    };
+
+    std::array<Dwell, kCapacity> m_dwells;
+    size_t m_size;
+};
+
+/**
+ * Traffic of the link per command and latencies of sending, recorded by Protocol.
+ * One instance may be shared by the Protocols of both UARTs and is read from any thread.
+ */
+class LinkMetrics {
+public:
+    struct CommandCounters {
+        uint64_t framesSent;  // acknowledged by ACK2
+        uint64_t bytesSent;   // of the frames sent, as they are on the wire
+        uint64_t framesReceived;
+        uint64_t bytesReceived;
+        uint64_t retries;  // failed attempts of the messages sent
+        uint64_t naksReceived;
+        uint64_t checksumMismatches;  // of the frames received
+        uint64_t wireTime;            // us in send(), retries included
+    };
+
+    struct Snapshot {
+        std::map<common::CpuCommand, CommandCounters> commands;
+        uint64_t naksSent;  // the command of a frame answered by NAK is often unknown
+        std::vector<uint64_t> receiveTimeouts;  // per receiving::State
+        LatencyHistogram wire;       // us of a message in send(), retries included
+        LatencyHistogram handshake;  // us from ENQ, or a pipelined frame, to its ACK2
+        std::vector<LatencyHistogram> sendDwell;     // us spent in each sending::State
+        std::vector<LatencyHistogram> receiveDwell;  // us spent in each receiving::State
+    };
+
+    LinkMetrics();
+
+    void onFrameSent(const common::CpuCommand& command,
+                     size_t bytes,
+                     std::chrono::microseconds handshake);
+    void onMessageSent(const common::CpuCommand& command,
+                       uint32_t retries,
+                       std::chrono::microseconds wireTime);
+    void onNakReceived(const common::CpuCommand& command);
+
+    void onFrameReceived(const common::CpuCommand& command, size_t bytes);
+    void onChecksumMismatch(const common::CpuCommand& command);
+    void onNakSent();
+    // state is a receiving::State
+    void onReceiveTimeout(uint8_t state);
+
+    // the states of machine in dwells were left, dwells is emptied
+    void onStatesLeft(FlightRecorder::Machine machine, StateDwells& dwells);
+
+    Snapshot snapshot() const;
+
+private:
+    mutable std::mutex m_lock;
+    Snapshot m_snapshot;
+};
+
+/**
+ * Formats link as the table answering CpuComId::Stats, the commands taking the most bytes
+ * of the line first, followed by the latencies of link and those of queueWait
+ * and by the time spent in each state of the machines which was entered.
+ */
+std::string formatLinkStats(const LinkMetrics::Snapshot& link, const LatencyHistogram& queueWait);
+
+}  // namespace impl
+}  // namespace cpucom
+}  // namespace ahu
+}  // namespace mitsubishielectric
+}  // namespace com
+
+#endif  // COM_MITSUBISHIELECTRIC_AHU_CPUCOM_LINKMETRICS_H_
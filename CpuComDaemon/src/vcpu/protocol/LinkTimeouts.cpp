@@ -0,0 +1,195 @@
+/*
+ * COPYRIGHT (C) 2024 MITSUBISHI ELECTRIC CORPORATION
+ * ALL RIGHTS RESERVED
+ */
+
+#include "LinkTimeouts.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <sstream>
+
+namespace com {
+namespace mitsubishielectric {
+namespace ahu {
+namespace cpucom {
+namespace impl {
+
+namespace {
+
+// start bit, 8 data bits, parity bit and stop bit, as configured by DeviceConfigureUART
+const uint64_t kBitsPerByte = 11;
+
+bool parseNumber(const std::string& text, uint32_t& value)
+{
+    if (text.empty() || !std::all_of(text.begin(), text.end(), ::isdigit)) {
+        return false;
+    }
+    value = static_cast<uint32_t>(std::strtoul(text.c_str(), nullptr, 10));
+    return true;
+}
+
+std::chrono::milliseconds roundUp(std::chrono::microseconds time)
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(time +
+                                                                 std::chrono::microseconds(999));
+}
+
+}  // namespace
+
+constexpr size_t LatencyWindow::kSize;
+constexpr size_t LatencyWindow::kUpdateInterval;
+constexpr size_t LatencyWindow::kMinSamples;
+constexpr uint32_t LatencyWindow::kPercentile;
+constexpr uint32_t LinkTimeouts::kMargin;
+constexpr std::chrono::milliseconds LinkTimeouts::kMinTimeout;
+
+bool parseTimeoutProfile(const std::string& text, TimeoutProfile& profile)
+{
+    TimeoutProfile parsed = profile;
+    std::istringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        const size_t separator = item.find('=');
+        uint32_t value = 0;
+        if ((separator == std::string::npos) || !parseNumber(item.substr(separator + 1), value)) {
+            return false;
+        }
+        const std::string key = item.substr(0, separator);
+        if (key == "response") {
+            parsed.response = std::chrono::milliseconds(value);
+        }
+        else if (key == "field") {
+            parsed.field = std::chrono::milliseconds(value);
+        }
+        else if (key == "retry") {
+            parsed.retry = std::chrono::milliseconds(value);
+        }
+        else if (key == "baud") {
+            parsed.baudRate = value;
+        }
+        else if (key == "autotune") {
+            parsed.autoTune = (value != 0);
+        }
+        else {
+            return false;
+        }
+    }
+    profile = parsed;
+    return true;
+}
+
+LatencyWindow::LatencyWindow()
+    : m_samples()
+    , m_count(0)
+    , m_next(0)
+    , m_percentile(0)
+{
+}
+
+void LatencyWindow::add(std::chrono::microseconds sample)
+{
+    m_samples[m_next] = static_cast<uint32_t>(std::max<std::chrono::microseconds::rep>(
+        0, std::min<std::chrono::microseconds::rep>(sample.count(), UINT32_MAX)));
+    m_next = (m_next + 1) % kSize;
+    ++m_count;
+    if ((m_count % kUpdateInterval) == 0) {
+        update();
+    }
+}
+
+void LatencyWindow::clear()
+{
+    m_count = 0;
+    m_next = 0;
+    m_percentile = 0;
+}
+
+bool LatencyWindow::ready() const { return m_count >= kMinSamples; }
+
+std::chrono::microseconds LatencyWindow::percentile() const
+{
+    return std::chrono::microseconds(m_percentile);
+}
+
+void LatencyWindow::update()
+{
+    const size_t size = std::min(m_count, kSize);
+    std::array<uint32_t, kSize> samples = m_samples;
+    const auto nth = samples.begin() + (size - 1) * kPercentile / 100;
+    std::nth_element(samples.begin(), nth, samples.begin() + size);
+    m_percentile = *nth;
+}
+
+LinkTimeouts::LinkTimeouts(const TimeoutProfile& profile)
+    : m_profile(profile)
+{
+}
+
+void LinkTimeouts::setProfile(const TimeoutProfile& profile)
+{
+    m_profile = profile;
+    m_responses.clear();
+    m_fields.clear();
+}
+
+const TimeoutProfile& LinkTimeouts::profile() const { return m_profile; }
+
+std::chrono::milliseconds LinkTimeouts::response(size_t sentLength) const
+{
+    return timeout(m_responses, m_profile.response, sentLength);
+}
+
+std::chrono::milliseconds LinkTimeouts::field(size_t length) const
+{
+    return timeout(m_fields, m_profile.field, length);
+}
+
+std::chrono::milliseconds LinkTimeouts::retry() const { return m_profile.retry; }
+
+std::chrono::milliseconds LinkTimeouts::write(size_t length) const
+{
+    return std::max(roundUp(m_profile.field + timeOnWire(length)), kMinTimeout);
+}
+
+void LinkTimeouts::onResponse(size_t sentLength, std::chrono::microseconds elapsed)
+{
+    add(m_responses, sentLength, elapsed);
+}
+
+void LinkTimeouts::onField(size_t length, std::chrono::microseconds elapsed)
+{
+    add(m_fields, length, elapsed);
+}
+
+std::chrono::microseconds LinkTimeouts::timeOnWire(size_t length) const
+{
+    if (m_profile.baudRate == 0) {
+        return std::chrono::microseconds(0);
+    }
+    return std::chrono::microseconds(length * kBitsPerByte * 1000000 / m_profile.baudRate);
+}
+
+std::chrono::milliseconds LinkTimeouts::timeout(const LatencyWindow& window,
+                                                std::chrono::milliseconds configured,
+                                                size_t length) const
+{
+    std::chrono::microseconds latency = configured;
+    if (m_profile.autoTune && window.ready()) {
+        latency = std::min<std::chrono::microseconds>(window.percentile() * kMargin, configured);
+    }
+    return std::max(roundUp(latency + timeOnWire(length)), kMinTimeout);
+}
+
+void LinkTimeouts::add(LatencyWindow& window, size_t length, std::chrono::microseconds elapsed)
+{
+    if (m_profile.autoTune) {
+        window.add(elapsed - timeOnWire(length));
+    }
+}
+
+}  // namespace impl
+}  // namespace cpucom
+}  // namespace ahu
+}  // namespace mitsubishielectric
+}  // namespace com
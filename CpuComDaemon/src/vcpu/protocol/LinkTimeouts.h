@@ -0,0 +1,121 @@
+/*
+ * COPYRIGHT (C) 2024 MITSUBISHI ELECTRIC CORPORATION
+ * ALL RIGHTS RESERVED
+ */
+
+#ifndef COM_MITSUBISHIELECTRIC_AHU_CPUCOM_LINKTIMEOUTS_H_
+#define COM_MITSUBISHIELECTRIC_AHU_CPUCOM_LINKTIMEOUTS_H_
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace com {
+namespace mitsubishielectric {
+namespace ahu {
+namespace cpucom {
+namespace impl {
+
+/**
+ * Timeouts of one link. The time the expected bytes need on the wire is added to them.
+ */
+struct TimeoutProfile {
+    std::chrono::milliseconds response;  // T3: a response of the peer to ENQ, ACK or a frame
+    std::chrono::milliseconds field;     // T4: a field of a frame being received
+    std::chrono::milliseconds retry;     // T5: before the next enquiry
+    uint32_t baudRate;                   // of the line, 0 when bytes take no time on the wire
+    bool autoTune;                       // tighten the timeouts to the latencies observed
+};
+
+constexpr TimeoutProfile kDefaultTimeoutProfile = {std::chrono::milliseconds(50),
+                                                   std::chrono::milliseconds(50),
+                                                   std::chrono::milliseconds(5), 1000000, false};
+
+/**
+ * Parses a profile like "response=20,field=5,retry=2,baud=1000000,autotune=1".
+ * The timeouts are in milliseconds, keys which are not given keep their value in profile.
+ * @return false if text is malformed, profile is not changed then
+ */
+bool parseTimeoutProfile(const std::string& text, TimeoutProfile& profile);
+
+/**
+ * The last kSize latencies of one kind and a high percentile of them,
+ * which is recalculated every kUpdateInterval samples.
+ */
+class LatencyWindow {
+public:
+    static constexpr size_t kSize = 256;
+    static constexpr size_t kUpdateInterval = 32;
+    static constexpr size_t kMinSamples = 64;  // before that the percentile is not used
+    static constexpr uint32_t kPercentile = 99;
+
+    LatencyWindow();
+
+    void add(std::chrono::microseconds sample);
+    void clear();
+
+    bool ready() const;
+    std::chrono::microseconds percentile() const;
+
+private:
+    void update();
+
+private:
+    std::array<uint32_t, kSize> m_samples;  // in microseconds
+    size_t m_count;
+    size_t m_next;
+    uint32_t m_percentile;
+};
+
+/**
+ * Timeouts Protocol waits for the peer with, as set by a TimeoutProfile.
+ * With TimeoutProfile::autoTune the latencies observed are added by onResponse() and onField()
+ * and the timeouts are set to kMargin times their percentile, never above the profile.
+ * Not thread safe, Protocol only uses it while it holds the line.
+ */
+class LinkTimeouts {
+public:
+    static constexpr uint32_t kMargin = 2;
+    static constexpr std::chrono::milliseconds kMinTimeout = std::chrono::milliseconds(2);
+
+    explicit LinkTimeouts(const TimeoutProfile& profile = kDefaultTimeoutProfile);
+
+    // drops the latencies observed so far
+    void setProfile(const TimeoutProfile& profile);
+    const TimeoutProfile& profile() const;
+
+    /**
+     * @param sentLength bytes sent right before, which have to reach the peer first
+     */
+    std::chrono::milliseconds response(size_t sentLength) const;
+    std::chrono::milliseconds field(size_t length) const;
+    std::chrono::milliseconds retry() const;
+    // a write of length bytes stalled on the line, T4 never tuned as the peer is not involved
+    std::chrono::milliseconds write(size_t length) const;
+
+    void onResponse(size_t sentLength, std::chrono::microseconds elapsed);
+    void onField(size_t length, std::chrono::microseconds elapsed);
+
+    std::chrono::microseconds timeOnWire(size_t length) const;
+
+private:
+    std::chrono::milliseconds timeout(const LatencyWindow& window,
+                                      std::chrono::milliseconds configured,
+                                      size_t length) const;
+    void add(LatencyWindow& window, size_t length, std::chrono::microseconds elapsed);
+
+private:
+    TimeoutProfile m_profile;
+    LatencyWindow m_responses;  // without the time on wire
+    LatencyWindow m_fields;     // without the time on wire
+};
+
+}  // namespace impl
+}  // namespace cpucom
+}  // namespace ahu
+}  // namespace mitsubishielectric
+}  // namespace com
+
+#endif  // COM_MITSUBISHIELECTRIC_AHU_CPUCOM_LINKTIMEOUTS_H_
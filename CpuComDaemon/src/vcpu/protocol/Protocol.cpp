@@ -5,21 +5,18 @@
 
 #include "Protocol.h"
 
-#include <poll.h>
-#include <termios.h>
-#include <unistd.h>
-
 #include <algorithm>
 #include <array>
-#include <iomanip>
-#include <iterator>
-#include <sstream>
+#include <cassert>
 #include <thread>
 
-#include "Checksum.h"
 #include "CpuComDaemonLog.h"
+#include "FrameEncoder.h"
 #include "IODevice.h"
 #include "Log.h"
+#include "Probes.h"
+#include "ProtocolStates.h"
+#include "VerboseLog.h"
 
 namespace com {
 namespace mitsubishielectric {
@@ -27,148 +24,28 @@ namespace ahu {
 namespace cpucom {
 namespace impl {
 
+using namespace frame;
+
 namespace {
 
-// Lengths of the message fields
-const int32_t kStxLength = 1;
-const int32_t kLenLength = 1;
-const int32_t kCmdLength = 3;
-const int32_t kExtLenLength = 3;
-const int32_t kFrameNumberLength = 2;
-const int32_t kTotalFramesLength = 2;
-const int32_t kEtxLength = 1;
-const int32_t kCsLength = 1;
-const int32_t kFrameHeaderLength = kStxLength + kLenLength;
-const int32_t kFrameFooterLength = kEtxLength + kCsLength;
-
-// Frame length limitations
-const int32_t kMinFrameLength = 5;
-const int32_t kMaxFrameLength = 253;
-const int32_t kMaxActualDataLength = 1024;
-const int32_t kMaxExtendedLengthFrameLength = 1032;
-const int32_t kMaxExtendedLengthFrameDivisionFrameLength = 1036;
-
-// Timeouts
+// Timeouts, T3 to T5 are set by TimeoutProfile
 // const std::chrono::milliseconds kTimeout1 = std::chrono::milliseconds(3);
 // const std::chrono::milliseconds kTimeout2 = std::chrono::milliseconds(3);
-const std::chrono::milliseconds kTimeout3 = std::chrono::milliseconds(50);
-const std::chrono::milliseconds kTimeout4 = std::chrono::milliseconds(50);
-const std::chrono::milliseconds kTimeout5 = std::chrono::milliseconds(5);
 // const std::chrono::milliseconds kTimeout6 = std::chrono::milliseconds(30);
 
 // Error handling settings
-const int32_t kMaxNumberOfSendAttempts = 240;
+const uint32_t kMaxNumberOfSendAttempts = 240;
 const int32_t kMaxNumberOfRecvAttempts = 5;
 
-const int32_t kSendAttemptsForPortReinit = 6;
+const uint32_t kSendAttemptsForPortReinit = 6;
 
-std::vector<std::vector<uint8_t>> prepareFrames(const std::vector<uint8_t>& d)
-{
-    std::vector<uint8_t> data = d;
-    std::vector<std::vector<uint8_t>> frames;
-    if (data.size() <= kMaxFrameLength - kFrameFooterLength) {
-        // regular frame
-        std::vector<uint8_t> frame;
-        frame.reserve(kFrameHeaderLength + kMaxFrameLength);
-        frame.push_back(STX);
-        frame.push_back(data.size() + kFrameFooterLength);
-        frame.insert(frame.end(), data.begin(), data.end());
-        frame.push_back(ETX);
-        // calculate checksum for [LEN]..[ETX] range
-        uint8_t cs = common::checksum(std::next(frame.begin()), frame.end());
-        frame.push_back(cs);
-        frames.push_back(frame);
-    }
-    else if (data.size() <= (kMaxExtendedLengthFrameLength - kFrameFooterLength)) {
-        // extended length, no frame division
-        std::vector<uint8_t> frame;
-        frame.reserve(kFrameHeaderLength + kMaxExtendedLengthFrameLength);
-        frame.push_back(STX);
-        frame.push_back(EXT_LEN);
-        frame.push_back(data.at(0));  // command
-        frame.push_back(data.at(1));  // sub command
-        frame.push_back(data.at(2));  // codebit
-
-        uint32_t length = data.size() + kExtLenLength + kFrameFooterLength;
-        uint8_t length1 = (length >> 16) & 0x000000ff;
-        uint8_t length2 = (length >> 8) & 0x000000ff;
-        uint8_t length3 = length & 0x000000ff;
-        frame.push_back(length1);
-        frame.push_back(length2);
-        frame.push_back(length3);
-        frame.insert(frame.end(), std::next(data.begin(), 3), data.end());
-        frame.push_back(ETX);
-        // calculate checksum for [LEN]..[ETX] range
-        uint8_t cs = common::checksum(std::next(frame.begin()), frame.end());
-        frame.push_back(cs);
-        frames.push_back(frame);
-    }
-    else {
-        // extended length, frame division enabled
-        uint32_t actualDataLength = data.size() - kCmdLength;
-        uint32_t framesCount = (actualDataLength / kMaxActualDataLength) +
-                               ((actualDataLength % kMaxActualDataLength) > 0);
-        assert(framesCount > 1);
-
-        uint8_t command = data.at(0);
-        uint8_t subCommand = data.at(1);
-        uint8_t codebit = data.at(2);
-
-        for (uint32_t i = 0; i < framesCount; ++i) {
-            std::vector<uint8_t> frame;
-            frame.reserve(kFrameHeaderLength + kMaxExtendedLengthFrameDivisionFrameLength);
-            frame.push_back(STX);
-            frame.push_back(EXT_LEN);
-            frame.push_back(command);
-            frame.push_back(subCommand);
-            if (i == framesCount - 1) {
-                codebit |= 0x03;  // split, last frame
-            }
-            else {
-                codebit |= 0x02;  // split, next frame present
-            }
-            frame.push_back(codebit);
-
-            uint32_t length = std::min<uint32_t>(actualDataLength, kMaxActualDataLength);
-            actualDataLength -= length;
-            length += kCmdLength + kExtLenLength + kFrameNumberLength + kTotalFramesLength +
-                      kFrameFooterLength;
-            uint8_t length1 = (length >> 16) & 0x000000ff;
-            uint8_t length2 = (length >> 8) & 0x000000ff;
-            uint8_t length3 = length & 0x000000ff;
-            frame.push_back(length1);
-            frame.push_back(length2);
-            frame.push_back(length3);
-            uint8_t frameNumber1 = (i >> 8) & 0x000000ff;
-            uint8_t frameNumber2 = i & 0x000000ff;
-            frame.push_back(frameNumber1);
-            frame.push_back(frameNumber2);
-            uint8_t framesCount1 = (framesCount >> 8) & 0x000000ff;
-            uint8_t framesCount2 = framesCount & 0x000000ff;
-            frame.push_back(framesCount1);
-            frame.push_back(framesCount2);
-            auto begin = (i == 0) ? std::next(data.begin(), 3) : data.begin();
-            const uint32_t dataLength = std::min<uint32_t>(kMaxActualDataLength, data.size());
-            frame.insert(frame.end(), begin, std::next(begin, dataLength));
-            frame.push_back(ETX);
-            // calculate checksum for [LEN]..[ETX] range
-            uint8_t cs = common::checksum(std::next(frame.begin()), frame.end());
-            frame.push_back(cs);
-            frames.push_back(frame);
-            data.erase(data.begin(),
-                       std::next(data.begin(), dataLength + ((i == 0) ? kCmdLength : 0)));
-        }
-        assert(actualDataLength == 0);
-    }
-    return frames;
-}
-}  // namespace
+// transitions of the failed machine logged from the flight recorder
+const size_t kFlightRecordDumpLength = 32;
 
-enum class Event { Pass, Busy, Wait, Deny, Fail };
+}  // namespace
 
 using common::IODevice;
 using common::MLOGD;
-using common::MLOGV;
 using common::MLOGW;
 
 class Context {
@@ -176,42 +53,97 @@ public:
     explicit Context()
         : m_currentFrame(0)
         , m_result(false)
+        , m_pipeliningOffered(false)
+        , m_pipelined(false)
+        , m_stateEntered(std::chrono::steady_clock::now())
+        , m_dwells()
+        , m_lastByte(0)
     {
     }
 
     virtual ~Context() = default;
 
 public:
-    std::vector<uint8_t>& currentFrame() { return m_frames.at(m_currentFrame); }
     bool result() const { return m_result; }
     void setResult(bool result) { m_result = result; }
 
-    const std::vector<std::vector<uint8_t>>& frames() const { return m_frames; }
+    virtual void onFrameCompleted() { ++m_currentFrame; }
 
-    virtual void onFrameCompleted()
-    {
-        ++m_currentFrame;
-        assert(m_currentFrame < m_frames.size());
-    }
+    // DC2 has been sent/received with the last ENQ
+    bool pipeliningOffered() const { return m_pipeliningOffered; }
+    void setPipeliningOffered(bool offered) { m_pipeliningOffered = offered; }
+
+    // the rest of the message is transmitted without ENQ before every frame
+    bool pipelined() const { return m_pipelined; }
+    void setPipelined(bool pipelined) { m_pipelined = pipelined; }
+
+    // the current state of the machine was entered
+    std::chrono::steady_clock::time_point stateEntered() const { return m_stateEntered; }
+    void setStateEntered(std::chrono::steady_clock::time_point time) { m_stateEntered = time; }
+
+    // the states left, until folded into the LinkMetrics
+    StateDwells& dwells() { return m_dwells; }
+
+    // read from the line last by the machine
+    uint8_t lastByte() const { return m_lastByte; }
+    void setLastByte(uint8_t byte) { m_lastByte = byte; }
 
 protected:
     uint32_t m_currentFrame;
-    std::vector<std::vector<uint8_t>> m_frames;
     bool m_result;
+    bool m_pipeliningOffered;
+    bool m_pipelined;
+    std::chrono::steady_clock::time_point m_stateEntered;
+    StateDwells m_dwells;
+    uint8_t m_lastByte;
 };
 
 class SendContext : public Context {
 public:
     explicit SendContext(const std::vector<uint8_t>& data)
         : Context()
+        , m_command(data[0], data[1])
+        , m_encoder(data)
+        , m_frame(m_encoder.frame(0))
     {
-        m_frames = prepareFrames(data);
     }
 
     virtual ~SendContext() = default;
 
 public:
-    bool hasFramesToSend() const { return m_currentFrame < (m_frames.size() - 1); }
+    const common::CpuCommand& command() const { return m_command; }
+    const FrameEncoder::Frame& currentFrame() const { return m_frame; }
+
+    virtual void onFrameCompleted() override
+    {
+        Context::onFrameCompleted();
+        assert(m_currentFrame < m_encoder.frameCount());
+        m_frame = m_encoder.frame(m_currentFrame);
+    }
+
+    bool hasFramesToSend() const { return m_currentFrame < (m_encoder.frameCount() - 1); }
+
+    bool isFirstFrameOfDivision() const
+    {
+        return (m_currentFrame == 0) && (m_encoder.frameCount() > 1);
+    }
+
+    void setFirstFailure(std::chrono::steady_clock::time_point time) { m_firstFailure = time; }
+    std::chrono::steady_clock::time_point firstFailure() const { return m_firstFailure; }
+
+    // the current frame has been offered by ENQ, or follows the previous one when pipelined
+    void setHandshakeStart(std::chrono::steady_clock::time_point time) { m_handshakeStart = time; }
+    std::chrono::steady_clock::time_point handshakeStart() const { return m_handshakeStart; }
+
+    SendTimes& times() { return m_times; }
+
+private:
+    const common::CpuCommand m_command;
+    FrameEncoder m_encoder;
+    FrameEncoder::Frame m_frame;
+    std::chrono::steady_clock::time_point m_firstFailure;
+    std::chrono::steady_clock::time_point m_handshakeStart;
+    SendTimes m_times;
 };
 
 class RecvContext : public Context {
@@ -223,24 +155,80 @@ public:
         ExtendedLengthWithFrameDivision,
     };
 
-    explicit RecvContext()
+    explicit RecvContext(std::vector<uint8_t>& payload)
         : Context()
+        , m_payload(payload)
+        , m_committedLength(kCmdLength)
+        , m_headerLength(0)
         , m_transmitionType(TransmitionType::NotDefinedYet)
         , m_dataLength(0)
         , m_frameNumber(0)
         , m_totalFrames(0)
     {
-        m_frames.push_back(std::vector<uint8_t>());
-        m_frames.front().reserve(kFrameHeaderLength + kMaxExtendedLengthFrameDivisionFrameLength);
+        // [CMD][SUBCMD][CODEBIT] of the first frame are placed in front of the data
+        m_payload.clear();
+        m_payload.reserve(kCmdLength + kMaxActualDataLength);
+        m_payload.resize(kCmdLength);
     }
 
     virtual ~RecvContext() = default;
 
 public:
+    /**
+     * Extends the header of the current frame by length bytes.
+     * @return pointer to the added bytes
+     */
+    uint8_t* extendHeader(uint32_t length)
+    {
+        assert(m_headerLength + length <= m_header.size());
+        uint8_t* result = &m_header[m_headerLength];
+        m_headerLength += length;
+        return result;
+    }
+
+    /**
+     * Extends the data of the current frame by length bytes,
+     * which are placed in the payload right after the data of the previous frames.
+     * @return pointer to the added bytes
+     */
+    uint8_t* extendData(uint32_t length)
+    {
+        if (m_transmitionType == TransmitionType::ExtendedLengthWithFrameDivision) {
+            m_payload.reserve(kCmdLength + m_totalFrames * kMaxActualDataLength);
+        }
+        m_payload.resize(m_committedLength + length);
+        return &m_payload[m_committedLength];
+    }
+
+    // drops the received part of the current frame, so that it can be received again
+    void discardFrame()
+    {
+        m_headerLength = 0;
+        m_payload.resize(m_committedLength);
+    }
+
+    // of the current frame, known once its header has been received up to [SUBCMD]
+    common::CpuCommand command() const
+    {
+        return (m_headerLength >= (kFrameHeaderLength + 2))
+                   ? common::CpuCommand(m_header[kFrameHeaderLength],
+                                        m_header[kFrameHeaderLength + 1])
+                   : common::CpuCommand(0, 0);
+    }
+
+    // bytes of the current frame on the wire, [STX] to [CS]
+    size_t frameLength() const
+    {
+        return m_headerLength + (m_payload.size() - m_committedLength) + kFrameFooterLength;
+    }
+
     virtual void onFrameCompleted() override
     {
-        m_frames.push_back(std::vector<uint8_t>());
-        m_frames.back().reserve(kFrameHeaderLength + kMaxExtendedLengthFrameDivisionFrameLength);
+        if (m_currentFrame == 0) {
+            std::copy_n(&m_header[kFrameHeaderLength], kCmdLength, m_payload.begin());
+        }
+        m_committedLength = m_payload.size();
+        m_headerLength = 0;
         Context::onFrameCompleted();
     }
 
@@ -254,258 +242,45 @@ public:
     void setFrameNumber(uint32_t value) { m_frameNumber = value; }
     uint32_t frameNumber() const { return m_frameNumber; }
 
+    ReceiveTimes& times() { return m_times; }
+
 private:
+    std::vector<uint8_t>& m_payload;  // reassembled [CMD][SUBCMD][CODEBIT][DATA...]
+    uint32_t m_committedLength;       // payload bytes of the completed frames
+    std::array<uint8_t, kMaxFrameHeaderLength> m_header;  // header of the current frame
+    uint32_t m_headerLength;
     TransmitionType m_transmitionType;
     uint32_t m_dataLength;  // data length when transmition type == Regular
     // frame number and total frames count when transmition type == ExtendedLengthWithFrameDivision
     uint32_t m_frameNumber;
     uint32_t m_totalFrames;
+    ReceiveTimes m_times;
 };
 
 Protocol::Protocol(std::unique_ptr<IODevice> device)
-    : m_device(std::move(device))
-    , m_sendMachine(new FiniteStateMachine<Event, SendContext>())
-    , m_recvMachine(new FiniteStateMachine<Event, RecvContext>())
+    : Protocol(LineDeviceHandle(std::move(device), nullptr), Direction::Both)
+{
+}
+
+Protocol::Protocol(LineDeviceHandle device, Direction direction)
+    : m_device(std::move(device.first))
+    , m_line(device.second)
+    , m_input(*m_device, m_line)
+    , m_accessLock((direction == Direction::Both) ? std::make_unique<std::mutex>() : nullptr)
     , m_r1(0)
     , m_r2(0)
+    , m_pipelinedDivision(false)
+    , m_timeouts(kDefaultTimeoutProfile)
+    , m_retryPolicy(makeDefaultRetryPolicy(m_timeouts.retry()))
+    , m_defaultRetryPolicy(true)
+    , m_linkMetrics(std::make_shared<LinkMetrics>())
+    , m_lastSendTimes()
+    , m_lastReceiveTimes()
+    , m_flightRecorder()
 {
-    // this is (almost) a copy of a state machine implemented in syscon_uart.c
-    // the only differences are:
-    // 1. the 'end' state, which is used as a final state,
-    // 'done' and 'error'(which are the final states in syscon_uart.c) pass on to the 'end' state.
-    // 2. done ---WAIT--> idle transitions which are used to send/receive extended length messages
-    // with frame division enabled
-    m_sendMachine->addState("idle", std::bind(&Protocol::sendIdle, this, std::placeholders::_1));
-    m_sendMachine->addState("enquiry",
-                            std::bind(&Protocol::sendEnquiry, this, std::placeholders::_1));
-    m_sendMachine->addState("reenquiry",
-                            std::bind(&Protocol::sendReenquiry, this, std::placeholders::_1));
-    m_sendMachine->addState("ack",
-                            std::bind(&Protocol::sendAcknowledgement, this, std::placeholders::_1));
-    m_sendMachine->addState("frame", std::bind(&Protocol::sendFrame, this, std::placeholders::_1));
-    m_sendMachine->addState(
-        "ack2", std::bind(&Protocol::sendAcknowledgement2, this, std::placeholders::_1));
-    m_sendMachine->addState("retry", std::bind(&Protocol::sendRetry, this, std::placeholders::_1));
-    m_sendMachine->addState("nak", std::bind(&Protocol::sendNak, this, std::placeholders::_1));
-    m_sendMachine->addState("wait", std::bind(&Protocol::sendWait, this, std::placeholders::_1));
-    m_sendMachine->addState("done", std::bind(&Protocol::sendDone, this, std::placeholders::_1));
-    m_sendMachine->addState("error", std::bind(&Protocol::sendError, this, std::placeholders::_1));
-    m_sendMachine->addState("end", std::bind(&Protocol::sendEnd, this, std::placeholders::_1));
-
-    m_sendMachine->setInitialState("idle");
-    m_sendMachine->setFinalState("end");
-
-    m_sendMachine->addTransition("idle", Event::Pass, "enquiry");
-    m_sendMachine->addTransition("idle", Event::Busy, "retry");
-    m_sendMachine->addTransition("idle", Event::Wait, "retry");
-    m_sendMachine->addTransition("idle", Event::Deny, "retry");
-    m_sendMachine->addTransition("idle", Event::Fail, "retry");
-
-    m_sendMachine->addTransition("enquiry", Event::Pass, "reenquiry");
-    m_sendMachine->addTransition("enquiry", Event::Busy, "retry");
-    m_sendMachine->addTransition("enquiry", Event::Wait, "retry");
-    m_sendMachine->addTransition("enquiry", Event::Deny, "retry");
-    m_sendMachine->addTransition("enquiry", Event::Fail, "retry");
-
-    m_sendMachine->addTransition("reenquiry", Event::Pass, "ack");
-    m_sendMachine->addTransition("reenquiry", Event::Busy, "retry");
-    m_sendMachine->addTransition("reenquiry", Event::Wait, "nak");
-    m_sendMachine->addTransition("reenquiry", Event::Deny, "retry");
-    m_sendMachine->addTransition("reenquiry", Event::Fail, "retry");
-
-    m_sendMachine->addTransition("ack", Event::Pass, "frame");
-    m_sendMachine->addTransition("ack", Event::Busy, "reenquiry");
-    m_sendMachine->addTransition("ack", Event::Wait, "nak");
-    m_sendMachine->addTransition("ack", Event::Deny, "retry");
-    m_sendMachine->addTransition("ack", Event::Fail, "retry");
-
-    m_sendMachine->addTransition("frame", Event::Pass, "ack2");
-    m_sendMachine->addTransition("frame", Event::Busy, "retry");
-    m_sendMachine->addTransition("frame", Event::Wait, "retry");
-    m_sendMachine->addTransition("frame", Event::Deny, "retry");
-    m_sendMachine->addTransition("frame", Event::Fail, "retry");
-
-    m_sendMachine->addTransition("ack2", Event::Pass, "done");
-    m_sendMachine->addTransition("ack2", Event::Busy, "retry");
-    m_sendMachine->addTransition("ack2", Event::Wait, "retry");
-    m_sendMachine->addTransition("ack2", Event::Deny, "retry");
-    m_sendMachine->addTransition("ack2", Event::Fail, "retry");
-
-    m_sendMachine->addTransition("retry", Event::Pass, "enquiry");
-    m_sendMachine->addTransition("retry", Event::Busy, "retry");
-    m_sendMachine->addTransition("retry", Event::Wait, "retry");
-    m_sendMachine->addTransition("retry", Event::Deny, "retry");
-    m_sendMachine->addTransition("retry", Event::Fail, "error");
-
-    m_sendMachine->addTransition("nak", Event::Pass, "wait");
-    m_sendMachine->addTransition("nak", Event::Busy, "retry");
-    m_sendMachine->addTransition("nak", Event::Wait, "retry");
-    m_sendMachine->addTransition("nak", Event::Deny, "retry");
-    m_sendMachine->addTransition("nak", Event::Fail, "retry");
-
-    m_sendMachine->addTransition("wait", Event::Pass, "enquiry");
-    m_sendMachine->addTransition("wait", Event::Busy, "retry");
-    m_sendMachine->addTransition("wait", Event::Wait, "retry");
-    m_sendMachine->addTransition("wait", Event::Deny, "retry");
-    m_sendMachine->addTransition("wait", Event::Fail, "retry");
-
-    m_sendMachine->addTransition("done", Event::Pass, "end");
-    m_sendMachine->addTransition("done", Event::Busy, "end");
-    m_sendMachine->addTransition("done", Event::Wait,
-                                 "reenquiry");  // this transition is used to send extended length
-                                                // messages with frame divisions
-    m_sendMachine->addTransition("done", Event::Deny, "end");
-    m_sendMachine->addTransition("done", Event::Fail, "end");
-
-    m_sendMachine->addTransition("error", Event::Pass, "end");
-    m_sendMachine->addTransition("error", Event::Busy, "end");
-    m_sendMachine->addTransition("error", Event::Wait, "end");
-    m_sendMachine->addTransition("error", Event::Deny, "end");
-    m_sendMachine->addTransition("error", Event::Fail, "end");
-
-    m_recvMachine->addState("idle", std::bind(&Protocol::recvIdle, this, std::placeholders::_1));
-    m_recvMachine->addState("poll", std::bind(&Protocol::recvPoll, this, std::placeholders::_1));
-    m_recvMachine->addState("repoll",
-                            std::bind(&Protocol::recvRepoll, this, std::placeholders::_1));
-    m_recvMachine->addState("enquiry",
-                            std::bind(&Protocol::recvEnquiry, this, std::placeholders::_1));
-    m_recvMachine->addState("ack",
-                            std::bind(&Protocol::recvAcknowledgement, this, std::placeholders::_1));
-    m_recvMachine->addState(
-        "stx", std::bind(&Protocol::recvControlCode, this, STX, std::placeholders::_1));
-    m_recvMachine->addState("len", std::bind(&Protocol::recvLength, this, std::placeholders::_1));
-    m_recvMachine->addState("datacmd",
-                            std::bind(&Protocol::recvDataCommand, this, std::placeholders::_1));
-    m_recvMachine->addState("dataextlen",
-                            std::bind(&Protocol::recvDataExtLen, this, std::placeholders::_1));
-    m_recvMachine->addState("dataframenumber",
-                            std::bind(&Protocol::recvDataFrameNumber, this, std::placeholders::_1));
-    m_recvMachine->addState("data", std::bind(&Protocol::recvData, this, std::placeholders::_1));
-    m_recvMachine->addState(
-        "etx", std::bind(&Protocol::recvControlCode, this, ETX, std::placeholders::_1));
-    m_recvMachine->addState("cs", std::bind(&Protocol::recvChecksum, this, std::placeholders::_1));
-    m_recvMachine->addState(
-        "ack2", std::bind(&Protocol::recvAcknowledgement2, this, std::placeholders::_1));
-    m_recvMachine->addState("nak", std::bind(&Protocol::recvNak, this, std::placeholders::_1));
-    m_recvMachine->addState("retry", std::bind(&Protocol::recvRetry, this, std::placeholders::_1));
-    m_recvMachine->addState("done", std::bind(&Protocol::recvDone, this, std::placeholders::_1));
-    m_recvMachine->addState("error", std::bind(&Protocol::recvError, this, std::placeholders::_1));
-    m_recvMachine->addState("end", std::bind(&Protocol::recvEnd, this, std::placeholders::_1));
-
-    m_recvMachine->setInitialState("idle");
-    m_recvMachine->setFinalState("end");
-
-    m_recvMachine->addTransition("idle", Event::Pass, "poll");
-    m_recvMachine->addTransition("idle", Event::Busy, "error");
-    m_recvMachine->addTransition("idle", Event::Wait, "error");
-    m_recvMachine->addTransition("idle", Event::Deny, "error");
-    m_recvMachine->addTransition("idle", Event::Fail, "error");
-
-    m_recvMachine->addTransition("poll", Event::Pass, "enquiry");
-    m_recvMachine->addTransition("poll", Event::Busy, "error");
-    m_recvMachine->addTransition("poll", Event::Wait, "error");
-    m_recvMachine->addTransition("poll", Event::Deny, "error");
-    m_recvMachine->addTransition("poll", Event::Fail, "error");
-
-    m_recvMachine->addTransition("repoll", Event::Pass, "poll");
-    m_recvMachine->addTransition("repoll", Event::Busy, "error");
-    m_recvMachine->addTransition("repoll", Event::Wait, "error");
-    m_recvMachine->addTransition("repoll", Event::Deny, "error");
-    m_recvMachine->addTransition("repoll", Event::Fail, "error");
-
-    m_recvMachine->addTransition("enquiry", Event::Pass, "ack");
-    m_recvMachine->addTransition("enquiry", Event::Busy, "repoll");
-    m_recvMachine->addTransition("enquiry", Event::Wait, "error");
-    m_recvMachine->addTransition("enquiry", Event::Deny, "retry");
-    m_recvMachine->addTransition("enquiry", Event::Fail, "error");
-
-    m_recvMachine->addTransition("ack", Event::Pass, "stx");
-    m_recvMachine->addTransition("ack", Event::Busy, "error");
-    m_recvMachine->addTransition("ack", Event::Wait, "error");
-    m_recvMachine->addTransition("ack", Event::Deny, "error");
-    m_recvMachine->addTransition("ack", Event::Fail, "error");
-
-    m_recvMachine->addTransition("stx", Event::Pass, "len");
-    m_recvMachine->addTransition("stx", Event::Busy, "error");
-    m_recvMachine->addTransition("stx", Event::Wait, "error");
-    m_recvMachine->addTransition("stx", Event::Deny, "nak");
-    m_recvMachine->addTransition("stx", Event::Fail, "error");
-
-    m_recvMachine->addTransition("len", Event::Pass, "datacmd");
-    m_recvMachine->addTransition("len", Event::Busy, "error");
-    m_recvMachine->addTransition("len", Event::Wait, "error");
-    m_recvMachine->addTransition("len", Event::Deny, "nak");
-    m_recvMachine->addTransition("len", Event::Fail, "error");
-
-    m_recvMachine->addTransition("datacmd", Event::Pass, "dataextlen");
-    m_recvMachine->addTransition("datacmd", Event::Busy, "error");
-    m_recvMachine->addTransition("datacmd", Event::Wait, "error");
-    m_recvMachine->addTransition("datacmd", Event::Deny, "nak");
-    m_recvMachine->addTransition("datacmd", Event::Fail, "error");
-
-    m_recvMachine->addTransition("dataextlen", Event::Pass, "dataframenumber");
-    m_recvMachine->addTransition("dataextlen", Event::Busy, "error");
-    m_recvMachine->addTransition("dataextlen", Event::Wait, "error");
-    m_recvMachine->addTransition("dataextlen", Event::Deny, "nak");
-    m_recvMachine->addTransition("dataextlen", Event::Fail, "error");
-
-    m_recvMachine->addTransition("dataframenumber", Event::Pass, "data");
-    m_recvMachine->addTransition("dataframenumber", Event::Busy, "error");
-    m_recvMachine->addTransition("dataframenumber", Event::Wait, "error");
-    m_recvMachine->addTransition("dataframenumber", Event::Deny, "nak");
-    m_recvMachine->addTransition("dataframenumber", Event::Fail, "error");
-
-    m_recvMachine->addTransition("data", Event::Pass, "etx");
-    m_recvMachine->addTransition("data", Event::Busy, "error");
-    m_recvMachine->addTransition("data", Event::Wait, "error");
-    m_recvMachine->addTransition("data", Event::Deny, "nak");
-    m_recvMachine->addTransition("data", Event::Fail, "error");
-
-    m_recvMachine->addTransition("etx", Event::Pass, "cs");
-    m_recvMachine->addTransition("etx", Event::Busy, "error");
-    m_recvMachine->addTransition("etx", Event::Wait, "error");
-    m_recvMachine->addTransition("etx", Event::Deny, "nak");
-    m_recvMachine->addTransition("etx", Event::Fail, "error");
-
-    m_recvMachine->addTransition("cs", Event::Pass, "ack2");
-    m_recvMachine->addTransition("cs", Event::Busy, "error");
-    m_recvMachine->addTransition("cs", Event::Wait, "error");
-    m_recvMachine->addTransition("cs", Event::Deny, "nak");
-    m_recvMachine->addTransition("cs", Event::Fail,
-                                 "nak");  // in syscon_uart.c cs ---FAIL--> idle,
-                                          // I think it's wrong, I changed it to cs ---FAIL--> nak
-
-    m_recvMachine->addTransition("ack2", Event::Pass, "done");
-    m_recvMachine->addTransition("ack2", Event::Busy, "error");
-    m_recvMachine->addTransition("ack2", Event::Wait, "error");
-    m_recvMachine->addTransition("ack2", Event::Deny, "error");
-    m_recvMachine->addTransition("ack2", Event::Fail, "error");
-
-    m_recvMachine->addTransition("nak", Event::Pass, "retry");
-    m_recvMachine->addTransition("nak", Event::Busy, "error");
-    m_recvMachine->addTransition("nak", Event::Wait, "error");
-    m_recvMachine->addTransition("nak", Event::Deny, "error");
-    m_recvMachine->addTransition("nak", Event::Fail, "error");
-
-    m_recvMachine->addTransition("retry", Event::Pass, "repoll");
-    m_recvMachine->addTransition("retry", Event::Busy, "error");
-    m_recvMachine->addTransition("retry", Event::Wait, "error");
-    m_recvMachine->addTransition("retry", Event::Deny, "error");
-    m_recvMachine->addTransition("retry", Event::Fail, "error");
-
-    m_recvMachine->addTransition("done", Event::Pass, "end");
-    m_recvMachine->addTransition("done", Event::Busy, "end");
-    m_recvMachine->addTransition("done", Event::Wait,
-                                 "enquiry");  // this transition is used to receive extended length
-                                              // messages with frame divisions
-    m_recvMachine->addTransition("done", Event::Deny, "end");
-    m_recvMachine->addTransition("done", Event::Fail, "end");
-
-    m_recvMachine->addTransition("error", Event::Pass, "end");
-    m_recvMachine->addTransition("error", Event::Busy, "end");
-    m_recvMachine->addTransition("error", Event::Wait, "end");
-    m_recvMachine->addTransition("error", Event::Deny, "end");
-    m_recvMachine->addTransition("error", Event::Fail, "end");
+    if ((m_line == nullptr) && (direction != Direction::ReceiveOnly)) {
+        m_frameBuffer.reserve(kMaxWireFrameLength);
+    }
 
     m_device->open(IODevice::OpenMode::ReadWrite);
 }
@@ -514,73 +289,309 @@ Protocol::~Protocol() { m_device->close(); }
 
 bool Protocol::receive(std::vector<uint8_t>& data)
 {
-    RecvContext context;
-    MLOGV(common::FunctionID::cpuc_daemon, daemon::LogID::ReceiveFrameBegin);
-    m_recvMachine->run(context);
-    MLOGV(common::FunctionID::cpuc_daemon, daemon::LogID::ReceiveFrameEnd);
-    if (context.result() == true) {
-        data.reserve(kMaxActualDataLength * context.totalFrames() + kCmdLength);
-        if (context.transmitionType() ==
-            RecvContext::TransmitionType::ExtendedLengthWithFrameDivision) {
-            for (uint32_t i = 0; i < context.totalFrames(); ++i) {
-                if (i == 0) {
-                    data = context.frames().at(i);
-                    auto extendedLengthBegin =
-                        std::next(data.begin(), kStxLength + kLenLength + kCmdLength);
-                    auto totalFramesEnd =
-                        std::next(extendedLengthBegin,
-                                  kExtLenLength + kFrameNumberLength + kTotalFramesLength);
-                    data.erase(extendedLengthBegin, totalFramesEnd);
-                    data.erase(std::prev(data.end(), kCsLength + kEtxLength), data.end());
-                }
-                else {
-                    std::vector<uint8_t> frame = context.frames().at(i);
-                    auto actualDataBegin = std::next(
-                        frame.begin(), kStxLength + kLenLength + kCmdLength + kExtLenLength +
-                                           kFrameNumberLength + kTotalFramesLength);
-                    auto actualDataEnd = std::prev(frame.end(), kCsLength + kEtxLength);
-                    if (i == (context.totalFrames() - 1)) {
-                        actualDataEnd = frame.end();
-                    }
-                    data.insert(data.end(), actualDataBegin, actualDataEnd);
-                }
-            }
-        }
-        else if (context.transmitionType() == RecvContext::TransmitionType::ExtendedLength) {
-            data = context.currentFrame();
-            auto extendedLengthBegin =
-                std::next(data.begin(), kStxLength + kLenLength + kCmdLength);
-            auto extendedLengthEnd = std::next(extendedLengthBegin, kExtLenLength);
-            data.erase(extendedLengthBegin, extendedLengthEnd);
-        }
-        else {
-            data = context.currentFrame();
-        }
-
-        // only uart Protocol knows about STX, LEN, ETX and CS.
-        data.erase(data.begin(), std::next(data.begin(), kStxLength + kLenLength));
-        data.erase(std::prev(data.end(), kCsLength + kEtxLength), data.end());
-        return true;
-    }
-    else {
-        return false;
+    // frames are reassembled directly in data
+    RecvContext context(data);
+    CPUCOM_MLOGV(common::FunctionID::cpuc_daemon, daemon::LogID::ReceiveFrameBegin);
+    runStateMachine(receiving::kTransitions, receiving::kInitialState, receiving::kFinalState,
+                    [this, &context](receiving::State state) { return dispatch(state, context); });
+    CPUCOM_MLOGV(common::FunctionID::cpuc_daemon, daemon::LogID::ReceiveFrameEnd);
+    m_linkMetrics->onStatesLeft(FlightRecorder::Receiving, context.dwells());
+    if (context.result() == false) {
+        data.clear();
     }
+    m_lastReceiveTimes = context.times();
+    return context.result();
 }
 
 bool Protocol::send(const std::vector<uint8_t>& data)
 {
     assert((data.size() > 2) && "data.size() > 2");
     SendContext context(data);
-    MLOGV(common::FunctionID::cpuc_daemon, daemon::LogID::SendFrameBegin, data[0], data[1]);
-    m_sendMachine->run(context);
-    MLOGV(common::FunctionID::cpuc_daemon, daemon::LogID::SendFrameEnd);
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    CPUCOM_MLOGV(common::FunctionID::cpuc_daemon, daemon::LogID::SendFrameBegin, data[0], data[1]);
+    CPUCOM_PROBE2(send_begin, probeCommand(data[0], data[1]), data.size());
+    runStateMachine(sending::kTransitions, sending::kInitialState, sending::kFinalState,
+                    [this, &context](sending::State state) { return dispatch(state, context); });
+    CPUCOM_MLOGV(common::FunctionID::cpuc_daemon, daemon::LogID::SendFrameEnd);
+    const std::chrono::steady_clock::duration elapsed = std::chrono::steady_clock::now() - start;
+    CPUCOM_PROBE4(send_end, probeCommand(data[0], data[1]), data.size(), context.result(),
+                  std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+    m_lastSendTimes = context.times();
+    m_linkMetrics->onStatesLeft(FlightRecorder::Sending, context.dwells());
+    m_linkMetrics->onMessageSent(context.command(), m_r2,
+                                 std::chrono::duration_cast<std::chrono::microseconds>(elapsed));
+    if (m_r2 > 0) {
+        m_retryStatistics.record(common::CpuCommand(data[0], data[1]), m_r2,
+                                 std::chrono::duration_cast<std::chrono::milliseconds>(
+                                     std::chrono::steady_clock::now() - context.firstFailure()),
+                                 context.result());
+    }
     return context.result();
 }
 
+Event Protocol::dispatch(sending::State state, SendContext& context)
+{
+    const Event event = handle(state, context);
+    recordTransition(FlightRecorder::Sending, state, event, context);
+    return event;
+}
+
+Event Protocol::dispatch(receiving::State state, RecvContext& context)
+{
+    const Event event = handle(state, context);
+    recordTransition(FlightRecorder::Receiving, state, event, context);
+    return event;
+}
+
+void Protocol::recordTransition(FlightRecorder::Machine machine,
+                                uint8_t state,
+                                Event event,
+                                Context& context)
+{
+    const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    m_flightRecorder.record(machine, state, static_cast<uint8_t>(event),
+                            context.lastByte(), context.stateEntered(), now);
+    const std::chrono::microseconds dwell =
+        std::chrono::duration_cast<std::chrono::microseconds>(now - context.stateEntered());
+    if (!context.dwells().add(state, dwell)) {
+        m_linkMetrics->onStatesLeft(machine, context.dwells());
+    }
+    CPUCOM_PROBE4(state_exit, machine, state, static_cast<uint8_t>(event), dwell.count());
+    context.setStateEntered(now);
+}
+
+void Protocol::dumpFlightRecord(FlightRecorder::Machine machine) const
+{
+    const std::vector<FlightRecorder::Transition> transitions = m_flightRecorder.transitions();
+    size_t dumped = 0;
+    auto first = transitions.end();
+    while ((first != transitions.begin()) && (dumped < kFlightRecordDumpLength)) {
+        --first;
+        if (first->machine == machine) {
+            ++dumped;
+        }
+    }
+    for (auto i = first; i != transitions.end(); ++i) {
+        if (i->machine == machine) {
+            MLOGW(common::FunctionID::cpuc_daemon_error, daemon::ErrorLogID::FlightRecord,
+                  (machine == FlightRecorder::Sending) ? "tx" : "rx",
+                  FlightRecorder::stateName(machine, i->state),
+                  FlightRecorder::eventName(i->event), i->dwell, i->byte, i->left);
+        }
+    }
+}
+
+Event Protocol::handle(sending::State state, SendContext& context)
+{
+    switch (state) {
+    case sending::Idle:
+        return sendIdle(context);
+    case sending::Enquiry:
+        return sendEnquiry(context);
+    case sending::Reenquiry:
+        return sendReenquiry(context);
+    case sending::Ack:
+        return sendAcknowledgement(context);
+    case sending::Frame:
+        return sendFrame(context);
+    case sending::Ack2:
+        return sendAcknowledgement2(context);
+    case sending::Retry:
+        return sendRetry(context);
+    case sending::Nak:
+        return sendNak(context);
+    case sending::Wait:
+        return sendWait(context);
+    case sending::Done:
+        return sendDone(context);
+    case sending::Error:
+        return sendError(context);
+    case sending::End:
+        return sendEnd(context);
+    case sending::Count:
+        break;
+    }
+    assert(false && "Should never happen");
+    return Event::Fail;
+}
+
+Event Protocol::handle(receiving::State state, RecvContext& context)
+{
+    switch (state) {
+    case receiving::Idle:
+        return recvIdle(context);
+    case receiving::Poll:
+        return recvPoll(context);
+    case receiving::Repoll:
+        return recvRepoll(context);
+    case receiving::Enquiry:
+        return recvEnquiry(context);
+    case receiving::Ack:
+        return recvAcknowledgement(context);
+    case receiving::Stx:
+        return recvControlCode(STX, context);
+    case receiving::Len:
+        return recvLength(context);
+    case receiving::DataCommand:
+        return recvDataCommand(context);
+    case receiving::DataExtLen:
+        return recvDataExtLen(context);
+    case receiving::DataFrameNumber:
+        return recvDataFrameNumber(context);
+    case receiving::Data:
+        return recvData(context);
+    case receiving::Etx:
+        return recvControlCode(ETX, context);
+    case receiving::Checksum:
+        return recvChecksum(context);
+    case receiving::Ack2:
+        return recvAcknowledgement2(context);
+    case receiving::Nak:
+        return recvNak(context);
+    case receiving::Retry:
+        return recvRetry(context);
+    case receiving::Done:
+        return recvDone(context);
+    case receiving::Error:
+        return recvError(context);
+    case receiving::End:
+        return recvEnd(context);
+    case receiving::Count:
+        break;
+    }
+    assert(false && "Should never happen");
+    return Event::Fail;
+}
+
 uint32_t Protocol::r1() const { return m_r1; }
 
 uint32_t Protocol::r2() const { return m_r2; }
 
+void Protocol::setPipelinedDivision(bool enabled) { m_pipelinedDivision = enabled; }
+
+void Protocol::setRetryPolicy(std::unique_ptr<IRetryPolicy> policy)
+{
+    m_retryPolicy = std::move(policy);
+    m_defaultRetryPolicy = false;
+}
+
+void Protocol::setTimeoutProfile(const TimeoutProfile& profile)
+{
+    m_timeouts.setProfile(profile);
+    if (m_defaultRetryPolicy) {
+        m_retryPolicy = makeDefaultRetryPolicy(m_timeouts.retry());
+    }
+}
+
+const LinkTimeouts& Protocol::timeouts() const { return m_timeouts; }
+
+std::unique_ptr<IRetryPolicy> Protocol::makeDefaultRetryPolicy(std::chrono::milliseconds delay)
+{
+    return std::make_unique<FixedRetryPolicy>(delay, kMaxNumberOfSendAttempts,
+                                              kSendAttemptsForPortReinit);
+}
+
+IODevice::Result Protocol::readResponse(Context& context, uint8_t* data, size_t sentLength)
+{
+    if (!m_timeouts.profile().autoTune) {
+        return observed(context, m_input.read(data, m_timeouts.response(sentLength)), data, 1);
+    }
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    const IODevice::Result result =
+        observed(context, m_input.read(data, m_timeouts.response(sentLength)), data, 1);
+    if (result == IODevice::Result::Success) {
+        m_timeouts.onResponse(sentLength,
+                              std::chrono::duration_cast<std::chrono::microseconds>(
+                                  std::chrono::steady_clock::now() - start));
+    }
+    return result;
+}
+
+IODevice::Result Protocol::readField(Context& context, uint8_t* data, size_t size)
+{
+    const std::chrono::milliseconds timeout = m_timeouts.field(size);
+    if (!m_timeouts.profile().autoTune) {
+        return observed(
+            context, (size == 1) ? m_input.read(data, timeout) : m_input.readMulti(data, size, timeout),
+            data, size);
+    }
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    const IODevice::Result result = observed(
+        context, (size == 1) ? m_input.read(data, timeout) : m_input.readMulti(data, size, timeout),
+        data, size);
+    if (result == IODevice::Result::Success) {
+        m_timeouts.onField(size, std::chrono::duration_cast<std::chrono::microseconds>(
+                                     std::chrono::steady_clock::now() - start));
+    }
+    return result;
+}
+
+IODevice::Result Protocol::observed(Context& context,
+                                    IODevice::Result result,
+                                    const uint8_t* data,
+                                    size_t size)
+{
+    if ((result == IODevice::Result::Success) && (size != 0)) {
+        context.setLastByte(data[size - 1]);
+    }
+    return result;
+}
+
+const RetryStatistics& Protocol::retryStatistics() const { return m_retryStatistics; }
+
+void Protocol::setLinkMetrics(std::shared_ptr<LinkMetrics> metrics)
+{
+    m_linkMetrics = std::move(metrics);
+}
+
+const LinkMetrics& Protocol::linkMetrics() const { return *m_linkMetrics; }
+
+const SendTimes& Protocol::lastSendTimes() const { return m_lastSendTimes; }
+
+const ReceiveTimes& Protocol::lastReceiveTimes() const { return m_lastReceiveTimes; }
+
+const FlightRecorder& Protocol::flightRecorder() const { return m_flightRecorder; }
+
+void Protocol::lockLine()
+{
+    if (m_accessLock) {
+        CPUCOM_MLOGV(common::FunctionID::cpuc_daemon, daemon::LogID::LockDevice);
+        m_accessLock->lock();
+    }
+}
+
+void Protocol::unlockLine()
+{
+    if (m_accessLock) {
+        CPUCOM_MLOGV(common::FunctionID::cpuc_daemon, daemon::LogID::UnlockDevice);
+        m_accessLock->unlock();
+    }
+}
+
+IODevice::Result Protocol::awaitInput()
+{
+    for (;;) {
+        lockLine();
+        // bytes read in advance are not reported by poll() any more
+        if (!m_input.empty()) {
+            return IODevice::Result::Success;
+        }
+        // when send() shares the line it may read ahead while this thread polls,
+        // so m_input is checked again well within the response time of the peer
+        const std::chrono::milliseconds timeout =
+            m_accessLock ? std::max(m_timeouts.retry(), LinkTimeouts::kMinTimeout)
+                         : IODevice::kTimeoutInfinite;
+        unlockLine();
+        const IODevice::Result deviceResult = m_device->poll(timeout);
+        if (deviceResult != IODevice::Result::Timeout) {
+            if (deviceResult == IODevice::Result::Success) {
+                lockLine();
+            }
+            return deviceResult;
+        }
+    }
+}
+
 Event Protocol::sendIdle(SendContext&)
 {
     m_r2 = 0;
@@ -589,25 +600,34 @@ Event Protocol::sendIdle(SendContext&)
 
 Event Protocol::sendEnquiry(SendContext&)
 {
-    MLOGV(common::FunctionID::cpuc_daemon, daemon::LogID::LockDevice);
-    m_accessLock.lock();
+    lockLine();
     return Event::Pass;
 }
 
-Event Protocol::sendReenquiry(SendContext&)
+Event Protocol::sendReenquiry(SendContext& context)
 {
-    MLOGV(common::FunctionID::cpuc_daemon, daemon::LogID::Enquiry);
-    uint8_t data = 0;
+    CPUCOM_MLOGV(common::FunctionID::cpuc_daemon, daemon::LogID::Enquiry);
+    ILineDevice::DrainTail tail = {};
+    size_t drained = 0;
     Event result = Event::Fail;
 
-    IODevice::Result deviceResult = IODevice::Result::Success;
-    while (deviceResult == IODevice::Result::Success) {
-        deviceResult = m_device->read(&data, IODevice::kTimeoutImmediate);
-    }
-
-    if (deviceResult == IODevice::Result::Timeout) {
-        IODevice::Result deviceResult = std::get<IODevice::Result>(m_device->write(ENQ));
+    // an empty line and a drained one are the same for a new enquiry
+    IODevice::Result deviceResult = m_input.drain(tail, drained);
+    if (deviceResult != IODevice::Result::Error) {
+        context.setPipeliningOffered(m_pipelinedDivision && context.isFirstFrameOfDivision());
+        if (context.pipeliningOffered()) {
+            CPUCOM_MLOGV(common::FunctionID::cpuc_daemon, daemon::LogID::PipelinedDivisionOffered);
+            const uint8_t offer[] = {DC2, ENQ};
+            deviceResult = std::get<IODevice::Result>(m_device->write(offer, sizeof(offer)));
+        }
+        else {
+            deviceResult = std::get<IODevice::Result>(m_device->write(ENQ));
+        }
         if (deviceResult == IODevice::Result::Success) {
+            context.setHandshakeStart(std::chrono::steady_clock::now());
+            if (context.times().enquiry == std::chrono::steady_clock::time_point()) {
+                context.times().enquiry = context.handshakeStart();
+            }
             result = Event::Pass;
         }
         else {
@@ -623,25 +643,46 @@ Event Protocol::sendReenquiry(SendContext&)
     return result;
 }
 
-Event Protocol::sendAcknowledgement(SendContext&)
+Event Protocol::sendAcknowledgement(SendContext& context)
+{
+    // answers the enquiry, preceded by DC2 when pipelining is offered
+    return awaitAcknowledgement(context, context.pipeliningOffered() ? 2 : 1);
+}
+
+Event Protocol::awaitAcknowledgement(SendContext& context, size_t sentLength)
 {
-    MLOGV(common::FunctionID::cpuc_daemon, daemon::LogID::WaitForACK);
+    CPUCOM_MLOGV(common::FunctionID::cpuc_daemon, daemon::LogID::WaitForACK);
     uint8_t data = 0;
     Event result = Event::Fail;
-    IODevice::Result deviceResult = m_device->read(&data, kTimeout3);
+    IODevice::Result deviceResult = readResponse(context, &data, sentLength);
 
     switch (deviceResult) {
     case IODevice::Result::Success:
-        MLOGV(common::FunctionID::cpuc_daemon, daemon::LogID::ByteReceived, data);
+        CPUCOM_MLOGV(common::FunctionID::cpuc_daemon, daemon::LogID::ByteReceived, data);
         switch (data) {
         case ACK:
             result = Event::Pass;
             break;
+        case DC3:
+            if (context.pipeliningOffered()) {
+                CPUCOM_MLOGV(common::FunctionID::cpuc_daemon,
+                             daemon::LogID::PipelinedDivisionAccepted);
+                context.setPipelined(true);
+                result = Event::Pass;
+            }
+            else {
+                MLOGW(common::FunctionID::cpuc_daemon_error,
+                      daemon::ErrorLogID::sendAcknowledgement_ackConflict_Deny, data);
+                result = Event::Deny;
+            }
+            break;
         case NAK:
             MLOGW(common::FunctionID::cpuc_daemon_error,
                   daemon::ErrorLogID::sendAcknowledgement_ackConflict_Busy);
+            m_linkMetrics->onNakReceived(context.command());
             result = Event::Busy;
             break;
+        case DC2:  // the peer offers a message of its own, its ENQ follows
         case ENQ:
             MLOGW(common::FunctionID::cpuc_daemon_error,
                   daemon::ErrorLogID::sendAcknowledgement_ackConflict_Wait);
@@ -657,7 +698,7 @@ Event Protocol::sendAcknowledgement(SendContext&)
     case IODevice::Result::Timeout:
         MLOGW(common::FunctionID::cpuc_daemon_error,
               daemon::ErrorLogID::sendAcknowledgement_timeout);
-        MLOGV(common::FunctionID::cpuc_daemon, daemon::LogID::Timeout);
+        CPUCOM_MLOGV(common::FunctionID::cpuc_daemon, daemon::LogID::Timeout);
         result = Event::Deny;
         break;
     default:
@@ -673,40 +714,67 @@ Event Protocol::sendFrame(SendContext& context)
 {
     IODevice::Result deviceResult = IODevice::Result::Success;
     Event result = Event::Fail;
-    deviceResult = std::get<IODevice::Result>(
-        m_device->write(context.currentFrame().data(), context.currentFrame().size()));
+    const FrameEncoder::Frame& frame = context.currentFrame();
+    if (m_line != nullptr) {
+        const auto iov = frame.iov();
+        deviceResult = m_line->writeVector(iov.data(), iov.size(), m_timeouts.write(frame.size()));
+    }
+    else {
+        m_frameBuffer.resize(frame.size());
+        frame.copyTo(m_frameBuffer.data());
+        deviceResult =
+            std::get<IODevice::Result>(m_device->write(m_frameBuffer.data(), m_frameBuffer.size()));
+    }
     if (deviceResult == IODevice::Result::Success) {
-        MLOGV(common::FunctionID::cpuc_daemon, daemon::LogID::FrameSent);
+        CPUCOM_MLOGV(common::FunctionID::cpuc_daemon, daemon::LogID::FrameSent);
         result = Event::Pass;
     }
     else {
-        MLOGV(common::FunctionID::cpuc_daemon, daemon::LogID::SendFrameFailed);
+        CPUCOM_MLOGV(common::FunctionID::cpuc_daemon, daemon::LogID::SendFrameFailed);
         MLOGW(common::FunctionID::cpuc_daemon_error, daemon::ErrorLogID::sendFrame_writeError);
         result = Event::Fail;
     }
     return result;
 }
 
-Event Protocol::sendAcknowledgement2(SendContext& context) { return sendAcknowledgement(context); }
+Event Protocol::sendAcknowledgement2(SendContext& context)
+{
+    // DC3 only answers the enquiry
+    context.setPipeliningOffered(false);
+    const Event result = awaitAcknowledgement(context, context.currentFrame().size());
+    if (result == Event::Pass) {
+        context.times().acknowledgement2 = std::chrono::steady_clock::now();
+        m_linkMetrics->onFrameSent(context.command(), context.currentFrame().size(),
+                                   std::chrono::duration_cast<std::chrono::microseconds>(
+                                       context.times().acknowledgement2 -
+                                       context.handshakeStart()));
+    }
+    return result;
+}
 
-Event Protocol::sendRetry(SendContext&)
+Event Protocol::sendRetry(SendContext& context)
 {
     ++m_r2;
+    if (m_r2 == 1) {
+        context.setFirstFailure(std::chrono::steady_clock::now());
+    }
 
     Event result = Event::Fail;
-    if (m_r2 < kMaxNumberOfSendAttempts) {
-        MLOGV(common::FunctionID::cpuc_daemon, daemon::LogID::UnlockDevice);
-        m_accessLock.unlock();
-        MLOGV(common::FunctionID::cpuc_daemon, daemon::LogID::WaitT5);
-        std::this_thread::sleep_for(kTimeout5);
-        MLOGV(common::FunctionID::cpuc_daemon, daemon::LogID::Retrying);
-
-        if ((m_r2 % kSendAttemptsForPortReinit) == 0) {
+    const RetryDecision decision = m_retryPolicy->onFailure(m_r2);
+    if (decision.retry) {
+        CPUCOM_PROBE2(send_retry, probeCommand(context.command().first, context.command().second),
+                      m_r2);
+        unlockLine();
+        CPUCOM_MLOGV(common::FunctionID::cpuc_daemon, daemon::LogID::WaitT5);
+        std::this_thread::sleep_for(decision.delay);
+        CPUCOM_MLOGV(common::FunctionID::cpuc_daemon, daemon::LogID::Retrying);
+
+        if (decision.reinit) {
             m_device->close();
             bool result = m_device->open(IODevice::OpenMode::ReadWrite);
             MLOGE(common::FunctionID::cpuc_daemon_error,
-                  daemon::ErrorLogID::SendMaxRetryCountRecovery, kSendAttemptsForPortReinit,
-                  result);
+                  daemon::ErrorLogID::SendMaxRetryCountRecovery, m_r2, result);
+            CPUCOM_PROBE2(port_reinit, m_r2, result);
         }
 
         result = Event::Pass;
@@ -720,7 +788,7 @@ Event Protocol::sendRetry(SendContext&)
 
 Event Protocol::sendNak(SendContext&)
 {
-    MLOGV(common::FunctionID::cpuc_daemon, daemon::LogID::SendNAK);
+    CPUCOM_MLOGV(common::FunctionID::cpuc_daemon, daemon::LogID::SendNAK);
     const auto result =
         std::get<IODevice::Result>(m_device->write(NAK)) == IODevice::Result::Success;
 
@@ -733,10 +801,9 @@ Event Protocol::sendNak(SendContext&)
 
 Event Protocol::sendWait(SendContext&)
 {
-    MLOGV(common::FunctionID::cpuc_daemon, daemon::LogID::UnlockDevice);
-    m_accessLock.unlock();
-    MLOGV(common::FunctionID::cpuc_daemon, daemon::LogID::WaitT5);
-    std::this_thread::sleep_for(kTimeout5);
+    unlockLine();
+    CPUCOM_MLOGV(common::FunctionID::cpuc_daemon, daemon::LogID::WaitT5);
+    std::this_thread::sleep_for(m_timeouts.retry());
     return Event::Pass;
 }
 
@@ -744,11 +811,17 @@ Event Protocol::sendDone(SendContext& context)
 {
     if (context.hasFramesToSend()) {
         context.onFrameCompleted();
-        MLOGV(common::FunctionID::cpuc_daemon, daemon::LogID::ProcessNextFrame);
+        CPUCOM_MLOGV(common::FunctionID::cpuc_daemon, daemon::LogID::ProcessNextFrame);
+        if (context.pipelined()) {
+            // no ENQ offers the next frame
+            context.setHandshakeStart(std::chrono::steady_clock::now());
+            return Event::Next;
+        }
         return Event::Wait;
     }
 
-    MLOGV(common::FunctionID::cpuc_daemon, daemon::LogID::SendDone);
+    CPUCOM_MLOGV(common::FunctionID::cpuc_daemon, daemon::LogID::SendDone);
+    m_retryPolicy->onSuccess(m_r2);
     context.setResult(true);
     return Event::Pass;
 }
@@ -757,31 +830,44 @@ Event Protocol::sendError(SendContext& context)
 {
     MLOGE(common::FunctionID::cpuc_daemon_error,
           daemon::ErrorLogID::SendCommunicationErrorRecovery);
+    dumpFlightRecord(FlightRecorder::Sending);
 
-    MLOGV(common::FunctionID::cpuc_daemon, daemon::LogID::Error);
+    CPUCOM_MLOGV(common::FunctionID::cpuc_daemon, daemon::LogID::Error);
     context.setResult(false);
     return Event::Pass;
 }
 
 Event Protocol::sendEnd(SendContext&)
 {
-    MLOGV(common::FunctionID::cpuc_daemon, daemon::LogID::UnlockDevice);
-    m_accessLock.unlock();
+    unlockLine();
     return Event::Pass;
 }
 
 Event Protocol::recvControlCode(uint8_t code, RecvContext& context)
 {
-    MLOGV(common::FunctionID::cpuc_daemon, daemon::LogID::WaitForControlCode,
-          code == STX ? "STX" : "ETX", code);
+    CPUCOM_MLOGV(common::FunctionID::cpuc_daemon, daemon::LogID::WaitForControlCode,
+                 code == STX ? "STX" : "ETX", code);
     uint8_t b = 0;
     Event result = Event::Fail;
-    IODevice::Result deviceResult = m_device->read(&b, kTimeout3);
+    if (code == STX) {
+        m_input.setExpected(kStxLength + kLenLength);
+    }
+    // STX answers our ACK, ETX is the next field of the frame
+    IODevice::Result deviceResult =
+        (code == STX) ? readResponse(context, &b, 1) : readField(context, &b, kEtxLength);
     switch (deviceResult) {
     case IODevice::Result::Success:
-        MLOGV(common::FunctionID::cpuc_daemon, daemon::LogID::ByteReceived, b);
+        CPUCOM_MLOGV(common::FunctionID::cpuc_daemon, daemon::LogID::ByteReceived, b);
         if (b == code) {
-            context.currentFrame().push_back(b);
+            if (code == STX) {
+                // a frame sent again after NAK keeps the time its first attempt started
+                if (context.times().frameStart == std::chrono::steady_clock::time_point()) {
+                    context.times().frameStart = std::chrono::steady_clock::now();
+                }
+                *context.extendHeader(kStxLength) = b;
+                // the checksum covers the frame from LEN on
+                m_input.resetChecksum();
+            }
             result = Event::Pass;
         }
         else {
@@ -792,6 +878,7 @@ Event Protocol::recvControlCode(uint8_t code, RecvContext& context)
         break;
     case IODevice::Result::Timeout:
         MLOGW(common::FunctionID::cpuc_daemon_error, daemon::ErrorLogID::recvControlCode_Timeout);
+        m_linkMetrics->onReceiveTimeout((code == STX) ? receiving::Stx : receiving::Etx);
         result = Event::Deny;
         break;
     default:
@@ -811,11 +898,8 @@ Event Protocol::recvIdle(RecvContext&)
 Event Protocol::recvPoll(RecvContext&)
 {
     Event result = Event::Fail;
-    MLOGV(common::FunctionID::cpuc_daemon, daemon::LogID::WaitForENQ);
-    IODevice::Result deviceResult = m_device->poll(IODevice::kTimeoutInfinite);
-    if (deviceResult == IODevice::Result::Success) {
-        MLOGV(common::FunctionID::cpuc_daemon, daemon::LogID::LockDevice);
-        m_accessLock.lock();
+    CPUCOM_MLOGV(common::FunctionID::cpuc_daemon, daemon::LogID::WaitForENQ);
+    if (awaitInput() == IODevice::Result::Success) {
         result = Event::Pass;
     }
     else {
@@ -827,33 +911,27 @@ Event Protocol::recvPoll(RecvContext&)
 
 Event Protocol::recvRepoll(RecvContext&)
 {
-    MLOGV(common::FunctionID::cpuc_daemon, daemon::LogID::UnlockDevice);
-    m_accessLock.unlock();
+    unlockLine();
     return Event::Pass;
 }
 
-Event Protocol::recvEnquiry(RecvContext&)
+Event Protocol::recvEnquiry(RecvContext& context)
 {
-    uint8_t b = 0;
+    ILineDevice::DrainTail tail = {};
+    size_t drained = 0;
     Event result = Event::Fail;
-    IODevice::Result deviceResult = m_device->read(&b, IODevice::kTimeoutImmediate);
-    uint32_t bytesRead = 1;
-    IODevice::Result r = deviceResult;
-    while (r == IODevice::Result::Success) {
-        r = m_device->read(&b, IODevice::kTimeoutImmediate);
-        if (r == IODevice::Result::Timeout) {
-            deviceResult = IODevice::Result::Success;
-        }
-        else {
-            ++bytesRead;
-            deviceResult = r;
-        }
-    }
+    // only the last byte received matters, the ones before it are stale,
+    // except DC2 right before ENQ, which offers pipelined frame division
+    IODevice::Result deviceResult = m_input.drain(tail, drained);
+    const uint32_t bytesRead = drained;
+    const uint8_t b = tail.back();
+    context.setPipeliningOffered((drained >= tail.size()) && (tail.front() == DC2));
 
     switch (deviceResult) {
     case IODevice::Result::Success:
         if (b == ENQ) {
-            MLOGV(common::FunctionID::cpuc_daemon, daemon::LogID::ReceiveEnquiryENQ, bytesRead);
+            CPUCOM_MLOGV(common::FunctionID::cpuc_daemon, daemon::LogID::ReceiveEnquiryENQ,
+                         bytesRead);
             result = Event::Pass;
         }
         else if (b == NAK) {
@@ -869,6 +947,7 @@ Event Protocol::recvEnquiry(RecvContext&)
         break;
     case IODevice::Result::Timeout:
         MLOGW(common::FunctionID::cpuc_daemon_error, daemon::ErrorLogID::recvEnquiry_Timeout);
+        m_linkMetrics->onReceiveTimeout(receiving::Enquiry);
         result = Event::Busy;
         break;
     default:
@@ -879,10 +958,18 @@ Event Protocol::recvEnquiry(RecvContext&)
     return result;
 }
 
-Event Protocol::recvAcknowledgement(RecvContext&)
+Event Protocol::recvAcknowledgement(RecvContext& context)
 {
-    MLOGV(common::FunctionID::cpuc_daemon, daemon::LogID::SendACK);
-    return (std::get<IODevice::Result>(m_device->write(ACK)) == IODevice::Result::Success)
+    uint8_t response = ACK;
+    if (m_pipelinedDivision && context.pipeliningOffered()) {
+        CPUCOM_MLOGV(common::FunctionID::cpuc_daemon, daemon::LogID::PipelinedDivisionAccepted);
+        context.setPipelined(true);
+        response = DC3;
+    }
+    else {
+        CPUCOM_MLOGV(common::FunctionID::cpuc_daemon, daemon::LogID::SendACK);
+    }
+    return (std::get<IODevice::Result>(m_device->write(response)) == IODevice::Result::Success)
                ? Event::Pass
                : Event::Fail;
 }
@@ -891,21 +978,23 @@ Event Protocol::recvLength(RecvContext& context)
 {
     uint8_t b = 0;
     Event result = Event::Fail;
-    MLOGV(common::FunctionID::cpuc_daemon, daemon::LogID::StartReceiveFrame);
-    IODevice::Result deviceResult = m_device->read(&b, kTimeout4);
+    CPUCOM_MLOGV(common::FunctionID::cpuc_daemon, daemon::LogID::StartReceiveFrame);
+    IODevice::Result deviceResult = readField(context, &b, kLenLength);
     switch (deviceResult) {
     case IODevice::Result::Success:
         if (b == EXT_LEN) {
-            MLOGV(common::FunctionID::cpuc_daemon, daemon::LogID::ReceivedExtLen);
-            context.currentFrame().push_back(b);
+            CPUCOM_MLOGV(common::FunctionID::cpuc_daemon, daemon::LogID::ReceivedExtLen);
+            *context.extendHeader(kLenLength) = b;
+            m_input.setExpected(kCmdLength + kExtLenLength);
             result = Event::Pass;
         }
         else {
             if ((b >= kMinFrameLength) && (b <= kMaxFrameLength)) {
-                MLOGV(common::FunctionID::cpuc_daemon, daemon::LogID::FrameLength, b);
+                CPUCOM_MLOGV(common::FunctionID::cpuc_daemon, daemon::LogID::FrameLength, b);
                 context.setTransmitionType(RecvContext::TransmitionType::Regular);
                 context.setDataLength(b - kFrameFooterLength);
-                context.currentFrame().push_back(b);
+                *context.extendHeader(kLenLength) = b;
+                m_input.setExpected(b);
                 result = Event::Pass;
             }
             else {
@@ -917,6 +1006,7 @@ Event Protocol::recvLength(RecvContext& context)
         break;
     case IODevice::Result::Timeout:
         MLOGW(common::FunctionID::cpuc_daemon_error, daemon::ErrorLogID::recvLength_Timeout);
+        m_linkMetrics->onReceiveTimeout(receiving::Len);
         result = Event::Deny;
         break;
     default:
@@ -930,19 +1020,19 @@ Event Protocol::recvLength(RecvContext& context)
 Event Protocol::recvDataCommand(RecvContext& context)
 {
     Event result = Event::Pass;
-    auto& frame = context.currentFrame();
-    size_t filledSize = frame.size();
-    frame.resize(filledSize + kCmdLength);
-    IODevice::Result deviceResult = m_device->readMulti(&frame[filledSize], kCmdLength, kTimeout4);
-    uint8_t& command = frame[filledSize];
-    uint8_t& subcommand = frame[filledSize + 1];
+    uint8_t* cmd = context.extendHeader(kCmdLength);
+    IODevice::Result deviceResult = readField(context, cmd, kCmdLength);
+    uint8_t& command = cmd[0];
+    uint8_t& subcommand = cmd[1];
 
     switch (deviceResult) {
     case IODevice::Result::Success:
-        MLOGV(common::FunctionID::cpuc_daemon, daemon::LogID::ReceiveCommand, command, subcommand);
+        CPUCOM_MLOGV(common::FunctionID::cpuc_daemon, daemon::LogID::ReceiveCommand, command,
+                     subcommand);
         break;
     case IODevice::Result::Timeout:
         MLOGW(common::FunctionID::cpuc_daemon_error, daemon::ErrorLogID::recvDataCommand_Timeout);
+        m_linkMetrics->onReceiveTimeout(receiving::DataCommand);
         result = Event::Deny;
         break;
     default:
@@ -958,12 +1048,8 @@ Event Protocol::recvDataExtLen(RecvContext& context)
 {
     Event result = Event::Pass;
     if (context.transmitionType() != RecvContext::TransmitionType::Regular) {
-        auto& frame = context.currentFrame();
-        size_t filledSize = frame.size();
-        frame.resize(filledSize + kExtLenLength);
-        IODevice::Result deviceResult =
-            m_device->readMulti(&frame[filledSize], kExtLenLength, kTimeout4);
-        uint8_t* lengthdata = &frame[filledSize];
+        uint8_t* lengthdata = context.extendHeader(kExtLenLength);
+        IODevice::Result deviceResult = readField(context, lengthdata, kExtLenLength);
 
         switch (deviceResult) {
         case IODevice::Result::Success:
@@ -971,6 +1057,7 @@ Event Protocol::recvDataExtLen(RecvContext& context)
         case IODevice::Result::Timeout:
             MLOGW(common::FunctionID::cpuc_daemon_error,
                   daemon::ErrorLogID::recvDataExtLen_Timeout);
+            m_linkMetrics->onReceiveTimeout(receiving::DataExtLen);
             result = Event::Deny;
             break;
         default:
@@ -983,8 +1070,9 @@ Event Protocol::recvDataExtLen(RecvContext& context)
                               ((lengthdata[1] << 8) & 0x0000ff00) + ((lengthdata[2]) & 0x000000ff);
 
             context.setDataLength(length - kFrameFooterLength);
-            MLOGV(common::FunctionID::cpuc_daemon, daemon::LogID::ExtendedLength,
-                  context.getDataLength());
+            m_input.setExpected(length - kCmdLength - kExtLenLength);
+            CPUCOM_MLOGV(common::FunctionID::cpuc_daemon, daemon::LogID::ExtendedLength,
+                         context.getDataLength());
 
             if ((length > kMaxExtendedLengthFrameLength) ||
                 context.transmitionType() ==
@@ -1005,12 +1093,9 @@ Event Protocol::recvDataFrameNumber(RecvContext& context)
     Event result = Event::Pass;
     if (context.transmitionType() ==
         RecvContext::TransmitionType::ExtendedLengthWithFrameDivision) {
-        auto& frame = context.currentFrame();
-        size_t filledSize = frame.size();
-        frame.resize(filledSize + kFrameNumberLength + kTotalFramesLength);
-        IODevice::Result deviceResult = m_device->readMulti(
-            &frame[filledSize], kFrameNumberLength + kTotalFramesLength, kTimeout4);
-        uint8_t* framesdata = &frame[filledSize];
+        uint8_t* framesdata = context.extendHeader(kFrameNumberLength + kTotalFramesLength);
+        IODevice::Result deviceResult =
+            readField(context, framesdata, kFrameNumberLength + kTotalFramesLength);
 
         switch (deviceResult) {
         case IODevice::Result::Success:
@@ -1018,6 +1103,7 @@ Event Protocol::recvDataFrameNumber(RecvContext& context)
         case IODevice::Result::Timeout:
             MLOGW(common::FunctionID::cpuc_daemon_error,
                   daemon::ErrorLogID::recvDataFrameNumber_Timeout);
+            m_linkMetrics->onReceiveTimeout(receiving::DataFrameNumber);
             result = Event::Deny;
             break;
         default:
@@ -1031,8 +1117,8 @@ Event Protocol::recvDataFrameNumber(RecvContext& context)
             uint16_t totalFrames = ((framesdata[2] << 8) & 0xff00) + (framesdata[3] & 0x00ff);
             context.setTotalFrames(totalFrames);
             context.setFrameNumber(frameNumber);
-            MLOGV(common::FunctionID::cpuc_daemon, daemon::LogID::ReceiveFrameNumber,
-                  context.frameNumber(), context.totalFrames());
+            CPUCOM_MLOGV(common::FunctionID::cpuc_daemon, daemon::LogID::ReceiveFrameNumber,
+                         context.frameNumber(), context.totalFrames());
         }
     }
     return result;
@@ -1052,16 +1138,14 @@ Event Protocol::recvData(RecvContext& context)
         size -= (kCmdLength + kExtLenLength + kFrameNumberLength + kTotalFramesLength);
     }
 
-    auto& frame = context.currentFrame();
-    size_t filledSize = frame.size();
-    frame.resize(filledSize + size);
-    IODevice::Result deviceResult = m_device->readMulti(&frame[filledSize], size, kTimeout4);
+    IODevice::Result deviceResult = readField(context, context.extendData(size), size);
 
     switch (deviceResult) {
     case IODevice::Result::Success:
         break;
     case IODevice::Result::Timeout: {
         MLOGW(common::FunctionID::cpuc_daemon_error, daemon::ErrorLogID::recvData_Timeout);
+        m_linkMetrics->onReceiveTimeout(receiving::Data);
         result = Event::Deny;
         break;
     }
@@ -1072,33 +1156,35 @@ Event Protocol::recvData(RecvContext& context)
     }
 
     if (result == Event::Pass) {
-        MLOGV(common::FunctionID::cpuc_daemon, daemon::LogID::FrameReceived);
+        CPUCOM_MLOGV(common::FunctionID::cpuc_daemon, daemon::LogID::FrameReceived);
     }
     return result;
 }
 
 Event Protocol::recvChecksum(RecvContext& context)
 {
-    uint8_t calculated = common::checksum(std::next(std::begin(context.currentFrame())),
-                                          std::end(context.currentFrame()));
+    // accumulated by m_input while [LEN]..[ETX] was read
+    uint8_t calculated = m_input.checksum();
     uint8_t b = 0;
     Event result = Event::Fail;
-    IODevice::Result deviceResult = m_device->read(&b, kTimeout4);
+    IODevice::Result deviceResult = readField(context, &b, kCsLength);
     switch (deviceResult) {
     case IODevice::Result::Success:
         if (b == calculated) {
-            MLOGV(common::FunctionID::cpuc_daemon, daemon::LogID::ChecksumOK, b);
-            context.currentFrame().push_back(b);
+            CPUCOM_MLOGV(common::FunctionID::cpuc_daemon, daemon::LogID::ChecksumOK, b);
+            context.times().frameChecked = std::chrono::steady_clock::now();
             result = Event::Pass;
         }
         else {
             MLOGW(common::FunctionID::cpuc_daemon_error, daemon::ErrorLogID::recvChecksum_Mismatch,
                   calculated, b);
+            m_linkMetrics->onChecksumMismatch(context.command());
             result = Event::Deny;
         }
         break;
     case IODevice::Result::Timeout:
         MLOGW(common::FunctionID::cpuc_daemon_error, daemon::ErrorLogID::recvChecksum_Timeout);
+        m_linkMetrics->onReceiveTimeout(receiving::Checksum);
         result = Event::Deny;
         break;
     default:
@@ -1109,11 +1195,17 @@ Event Protocol::recvChecksum(RecvContext& context)
     return result;
 }
 
-Event Protocol::recvAcknowledgement2(RecvContext& context) { return recvAcknowledgement(context); }
+Event Protocol::recvAcknowledgement2(RecvContext& context)
+{
+    // DC3 only answers the enquiry
+    context.setPipeliningOffered(false);
+    return recvAcknowledgement(context);
+}
 
 Event Protocol::recvNak(RecvContext&)
 {
     MLOGW(common::FunctionID::cpuc_daemon_error, daemon::ErrorLogID::recvNak);
+    m_linkMetrics->onNakSent();
     return (std::get<IODevice::Result>(m_device->write(NAK)) == IODevice::Result::Success)
                ? Event::Pass
                : Event::Fail;
@@ -1122,10 +1214,10 @@ Event Protocol::recvNak(RecvContext&)
 Event Protocol::recvRetry(RecvContext& context)
 {
     ++m_r1;
-    context.currentFrame().clear();
+    context.discardFrame();
     Event result = Event::Fail;
     if (m_r1 < kMaxNumberOfRecvAttempts) {
-        MLOGV(common::FunctionID::cpuc_daemon, daemon::LogID::Retrying);
+        CPUCOM_MLOGV(common::FunctionID::cpuc_daemon, daemon::LogID::Retrying);
         result = Event::Pass;
     }
     else {
@@ -1138,29 +1230,30 @@ Event Protocol::recvRetry(RecvContext& context)
 Event Protocol::recvDone(RecvContext& context)
 {
     Event result = Event::Fail;
+    m_linkMetrics->onFrameReceived(context.command(), context.frameLength());
     // check for frame division, if there are more frames - go to recvIdle
     if (context.transmitionType() == RecvContext::TransmitionType::Regular) {
+        context.onFrameCompleted();
         context.setResult(true);
         result = Event::Pass;
     }
     else if (context.transmitionType() == RecvContext::TransmitionType::ExtendedLength) {
+        context.onFrameCompleted();
         context.setResult(true);
         result = Event::Pass;
     }
     else if (context.transmitionType() ==
              RecvContext::TransmitionType::ExtendedLengthWithFrameDivision) {
+        context.onFrameCompleted();
         if (context.frameNumber() == context.totalFrames() - 1) {
             // done. we received all frames
             context.setResult(true);
             result = Event::Pass;
         }
         else {
-            // receive next frames
-            context.onFrameCompleted();
-            // XXX: I do not want to introduce new Event and make state machine more complicated.
-            // For now I just use Wait event to move back to idle state and receive rest of the
-            // frames
-            result = Event::Wait;
+            // receive next frames, Wait moves back to the enquiry,
+            // Next receives the frame right away when pipelined frame division is used
+            result = context.pipelined() ? Event::Next : Event::Wait;
         }
     }
     else {
@@ -1169,10 +1262,10 @@ Event Protocol::recvDone(RecvContext& context)
     }
 
     if (result == Event::Pass) {
-        MLOGV(common::FunctionID::cpuc_daemon, daemon::LogID::ReceiveDone);
+        CPUCOM_MLOGV(common::FunctionID::cpuc_daemon, daemon::LogID::ReceiveDone);
     }
-    else if (result == Event::Wait) {
-        MLOGV(common::FunctionID::cpuc_daemon, daemon::LogID::ReceiveProcessNextFrame);
+    else if ((result == Event::Wait) || (result == Event::Next)) {
+        CPUCOM_MLOGV(common::FunctionID::cpuc_daemon, daemon::LogID::ReceiveProcessNextFrame);
     }
     else {
         assert(false && "Should never happen");
@@ -1183,17 +1276,35 @@ Event Protocol::recvDone(RecvContext& context)
 Event Protocol::recvError(RecvContext& context)
 {
     MLOGW(common::FunctionID::cpuc_daemon_error, daemon::ErrorLogID::recvError);
+    dumpFlightRecord(FlightRecorder::Receiving);
     context.setResult(false);
     return Event::Pass;
 }
 
 Event Protocol::recvEnd(RecvContext&)
 {
-    MLOGV(common::FunctionID::cpuc_daemon, daemon::LogID::UnlockDevice);
-    m_accessLock.unlock();
+    unlockLine();
     return Event::Pass;
 }
 
+SendOnlyProtocol::SendOnlyProtocol(std::unique_ptr<IODevice> device)
+    : Protocol(LineDeviceHandle(std::move(device), nullptr), Direction::SendOnly)
+{
+}
+
+bool SendOnlyProtocol::receive(std::vector<uint8_t>& data)
+{
+    data.clear();
+    return false;
+}
+
+ReceiveOnlyProtocol::ReceiveOnlyProtocol(std::unique_ptr<IODevice> device)
+    : Protocol(LineDeviceHandle(std::move(device), nullptr), Direction::ReceiveOnly)
+{
+}
+
+bool ReceiveOnlyProtocol::send(const std::vector<uint8_t>&) { return false; }
+
 }  // namespace impl
 }  // namespace cpucom
 }  // namespace ahu
@@ -6,45 +6,67 @@
 #ifndef COM_MITSUBISHIELECTRIC_AHU_CPUCOM_UART_H_
 #define COM_MITSUBISHIELECTRIC_AHU_CPUCOM_UART_H_
 
+#include <atomic>
+#include <chrono>
 #include <cstdint>
 #include <memory>
 #include <mutex>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 #include "CpuCommand.h"
-#include "StateMachine.h"
+#include "FlightRecorder.h"
+#include "FrameFormat.h"
+#include "ILineDevice.h"
+#include "LinkMetrics.h"
+#include "LinkTimeouts.h"
+#include "ReceiveBuffer.h"
+#include "ReceiveTimes.h"
+#include "RetryPolicy.h"
+#include "RetryStatistics.h"
+#include "SendTimes.h"
 
 namespace com {
 namespace mitsubishielectric {
 namespace ahu {
-namespace common {
-class IODevice;
-}
 namespace cpucom {
 namespace impl {
 
 const char* const kUartDeviceName = "/dev/ttySC7";
 const char* const kVCPUEmulatorSocketName = "emulator";
 
-using common::FiniteStateMachine;
-
 enum class Event;
+namespace sending {
+enum State : uint8_t;
+}
+namespace receiving {
+enum State : uint8_t;
+}
+class Context;
 class SendContext;
 class RecvContext;
 
-// Data transmission control codes
-enum ControlCode {
-    STX = 0x02,
-    ETX = 0x03,
-    ENQ = 0x05,
-    ACK = 0x06,
-    NAK = 0x15,
-    EXT_LEN = 0xfe,
-};
+// selects the constructors of devices which also implement ILineDevice
+template <typename Device>
+using EnableIfLineDevice =
+    typename std::enable_if<std::is_base_of<common::IODevice, Device>::value &&
+                            std::is_base_of<ILineDevice, Device>::value>::type;
 
 class Protocol {
 public:
     explicit Protocol(std::unique_ptr<common::IODevice> device);
+
+    /**
+     * Creates Protocol over a device which also implements ILineDevice,
+     * so that its bulk operations are used instead of the per-byte ones.
+     */
+    template <typename Device, typename = EnableIfLineDevice<Device>>
+    explicit Protocol(std::unique_ptr<Device> device)
+        : Protocol(splitLineDevice(std::move(device)), Direction::Both)
+    {
+    }
+
     virtual ~Protocol();
 
 public:
@@ -54,12 +76,108 @@ public:
     uint32_t r1() const;
     uint32_t r2() const;
 
+    /**
+     * Enables pipelined transmission of divided messages. When enabled, send() offers it to
+     * the peer with DC2 before the first ENQ of a divided message and receive() accepts such
+     * an offer by answering DC3 instead of ACK. Once accepted, the remaining frames of the
+     * message are sent one after another without ENQ, each still acknowledged by ACK or NAK.
+     * A peer which does not know DC2 ignores the offer, so the message is sent as before.
+     * When both ends offer at once, the DC2 of the peer collides with the ENQ like an ENQ.
+     * Disabled by default.
+     */
+    void setPipelinedDivision(bool enabled);
+
+    /**
+     * Replaces the policy deciding how failed attempts of send() are retried.
+     * By default every attempt is retried after 5 ms, up to 240 times,
+     * reopening the device every 6 attempts.
+     */
+    void setRetryPolicy(std::unique_ptr<IRetryPolicy> policy);
+
+    /**
+     * Sets the timeouts of the link, kDefaultTimeoutProfile by default.
+     * The retry timeout is also the delay of the default retry policy,
+     * a policy set by setRetryPolicy() keeps its own delays.
+     * Must not be called while send() or receive() is running.
+     */
+    void setTimeoutProfile(const TimeoutProfile& profile);
+    const LinkTimeouts& timeouts() const;
+
+    // retries of the messages sent so far, may be read from any thread
+    const RetryStatistics& retryStatistics() const;
+
+    /**
+     * Replaces the metrics the traffic of the link is recorded in, e.g. to share them with
+     * the Protocol of the other UART. Each Protocol has metrics of its own by default.
+     * Must not be called while send() or receive() is running.
+     */
+    void setLinkMetrics(std::shared_ptr<LinkMetrics> metrics);
+    const LinkMetrics& linkMetrics() const;
+
+    // when the handshake of the message sent last happened, read on the thread of send()
+    const SendTimes& lastSendTimes() const;
+
+    // when the message received last arrived on the line, read on the thread of receive()
+    const ReceiveTimes& lastReceiveTimes() const;
+
+    /**
+     * Every state transition of send() and receive() is recorded in the flight recorder,
+     * and the last ones of the machine are logged when a message fails.
+     * The time spent in each state is also counted in the link metrics.
+     */
+    const FlightRecorder& flightRecorder() const;
+
+protected:
+    // directions in which the protocol is used, send() and receive() share the line only in Both
+    enum class Direction { Both, SendOnly, ReceiveOnly };
+
+    using LineDeviceHandle = std::pair<std::unique_ptr<common::IODevice>, ILineDevice*>;
+
+    template <typename Device>
+    static LineDeviceHandle splitLineDevice(std::unique_ptr<Device> device)
+    {
+        ILineDevice* line = device.get();
+        return LineDeviceHandle(std::move(device), line);
+    }
+
+    Protocol(LineDeviceHandle device, Direction direction);
+
 private:
+    // serialize send() and receive(), nothing is done when m_accessLock is not needed
+    void lockLine();
+    void unlockLine();
+    // waits for bytes in m_input or on m_device, the line is locked when it succeeds
+    common::IODevice::Result awaitInput();
+
+    static std::unique_ptr<IRetryPolicy> makeDefaultRetryPolicy(std::chrono::milliseconds delay);
+
+    // read with the timeouts of m_timeouts, which learns from them when auto-tuning
+    common::IODevice::Result readResponse(Context& context, uint8_t* data, size_t sentLength);
+    common::IODevice::Result readField(Context& context, uint8_t* data, size_t size);
+    // keeps the last byte of a successful read in context for the flight recorder
+    static common::IODevice::Result observed(Context& context,
+                                             common::IODevice::Result result,
+                                             const uint8_t* data,
+                                             size_t size);
+
+private:
+    // calls the handler of the state
+    Event dispatch(sending::State state, SendContext& context);
+    Event dispatch(receiving::State state, RecvContext& context);
+    Event handle(sending::State state, SendContext& context);
+    Event handle(receiving::State state, RecvContext& context);
+    void recordTransition(FlightRecorder::Machine machine,
+                          uint8_t state,
+                          Event event,
+                          Context& context);
+    void dumpFlightRecord(FlightRecorder::Machine machine) const;
+
     // send states
     Event sendIdle(SendContext& context);
     Event sendReenquiry(SendContext& context);
     Event sendEnquiry(SendContext& context);
     Event sendAcknowledgement(SendContext& context);
+    Event awaitAcknowledgement(SendContext& context, size_t sentLength);
     Event sendFrame(SendContext& context);
     Event sendAcknowledgement2(SendContext& context);
     Event sendRetry(SendContext& context);
@@ -91,11 +209,57 @@ private:
 
 private:
     std::unique_ptr<common::IODevice> m_device;
-    std::mutex m_accessLock;
-    std::unique_ptr<FiniteStateMachine<Event, SendContext>> m_sendMachine;
-    std::unique_ptr<FiniteStateMachine<Event, RecvContext>> m_recvMachine;
+    ILineDevice* m_line;  // m_device as ILineDevice, nullptr if it does not implement it
+    std::vector<uint8_t> m_frameBuffer;  // used to send a frame when m_line is not available
+    ReceiveBuffer m_input;               // every byte received from m_device is read through it
+    std::unique_ptr<std::mutex> m_accessLock;  // nullptr unless Direction::Both
     uint32_t m_r1;
     uint32_t m_r2;
+    bool m_pipelinedDivision;
+    LinkTimeouts m_timeouts;
+    std::unique_ptr<IRetryPolicy> m_retryPolicy;
+    bool m_defaultRetryPolicy;  // m_retryPolicy follows the retry timeout of m_timeouts
+    RetryStatistics m_retryStatistics;
+    std::shared_ptr<LinkMetrics> m_linkMetrics;
+    SendTimes m_lastSendTimes;
+    ReceiveTimes m_lastReceiveTimes;
+    FlightRecorder m_flightRecorder;
+};
+
+/**
+ * Protocol which is only used to send, e.g. over the transmit UART of MultipleCPU.
+ * It does not lock the line, since nothing receives from it, and receive() always fails.
+ */
+class SendOnlyProtocol : public Protocol {
+public:
+    explicit SendOnlyProtocol(std::unique_ptr<common::IODevice> device);
+
+    template <typename Device, typename = EnableIfLineDevice<Device>>
+    explicit SendOnlyProtocol(std::unique_ptr<Device> device)
+        : Protocol(splitLineDevice(std::move(device)), Direction::SendOnly)
+    {
+    }
+
+public:
+    bool receive(std::vector<uint8_t>& data) override;
+};
+
+/**
+ * Protocol which is only used to receive, e.g. over the receive UART of MultipleCPU.
+ * It does not lock the line, since nothing sends over it, and send() always fails.
+ */
+class ReceiveOnlyProtocol : public Protocol {
+public:
+    explicit ReceiveOnlyProtocol(std::unique_ptr<common::IODevice> device);
+
+    template <typename Device, typename = EnableIfLineDevice<Device>>
+    explicit ReceiveOnlyProtocol(std::unique_ptr<Device> device)
+        : Protocol(splitLineDevice(std::move(device)), Direction::ReceiveOnly)
+    {
+    }
+
+public:
+    bool send(const std::vector<uint8_t>& data) override;
 };
 
 }  // namespace impl
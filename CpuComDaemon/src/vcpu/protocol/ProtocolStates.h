@@ -0,0 +1,149 @@
+/*
+ * COPYRIGHT (C) 2024 MITSUBISHI ELECTRIC CORPORATION
+ * ALL RIGHTS RESERVED
+ */
+
+#ifndef COM_MITSUBISHIELECTRIC_AHU_CPUCOM_PROTOCOLSTATES_H_
+#define COM_MITSUBISHIELECTRIC_AHU_CPUCOM_PROTOCOLSTATES_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "TransitionTable.h"
+
+namespace com {
+namespace mitsubishielectric {
+namespace ahu {
+namespace cpucom {
+namespace impl {
+
+// Next continues a divided message with its next frame, without a new enquiry,
+// when pipelined frame division has been negotiated for the message
+enum class Event { Pass, Busy, Wait, Deny, Fail, Next };
+
+constexpr std::size_t kEventCount = static_cast<std::size_t>(Event::Next) + 1;
+
+// These are (almost) copies of the state machines implemented in syscon_uart.c
+// the only differences are:
+// 1. the 'end' state, which is used as a final state,
+// 'done' and 'error'(which are the final states in syscon_uart.c) pass on to the 'end' state.
+// 2. done ---WAIT--> idle transitions which are used to send/receive extended length messages
+// with frame division enabled
+// 3. done ---NEXT--> frame/stx transitions which skip the enquiry between divided frames
+// Rows follow the order of the states, next states follow the order of the events.
+
+namespace sending {
+
+// states of Protocol::send()
+enum State : uint8_t {
+    Idle,
+    Enquiry,
+    Reenquiry,
+    Ack,
+    Frame,
+    Ack2,
+    Retry,
+    Nak,
+    Wait,
+    Done,
+    Error,
+    End,
+    Count,
+};
+
+constexpr State kInitialState = Idle;
+constexpr State kFinalState = End;
+
+// clang-format off
+constexpr Transitions<State, kEventCount> kTransitions[] = {
+    //          state      Pass       Busy       Wait       Deny   Fail   Next
+    transitions(Idle,      Enquiry,   Retry,     Retry,     Retry, Retry, Retry),
+    transitions(Enquiry,   Reenquiry, Retry,     Retry,     Retry, Retry, Retry),
+    transitions(Reenquiry, Ack,       Retry,     Nak,       Retry, Retry, Retry),
+    transitions(Ack,       Frame,     Reenquiry, Nak,       Retry, Retry, Retry),
+    transitions(Frame,     Ack2,      Retry,     Retry,     Retry, Retry, Retry),
+    transitions(Ack2,      Done,      Retry,     Retry,     Retry, Retry, Retry),
+    transitions(Retry,     Enquiry,   Retry,     Retry,     Retry, Error, Error),
+    transitions(Nak,       Wait,      Retry,     Retry,     Retry, Retry, Retry),
+    transitions(Wait,      Enquiry,   Retry,     Retry,     Retry, Retry, Retry),
+    // done ---WAIT--> reenquiry is used to send extended length messages with frame divisions,
+    // done ---NEXT--> frame when pipelined frame division has been negotiated
+    transitions(Done,      End,       End,       Reenquiry, End,   End,   Frame),
+    transitions(Error,     End,       End,       End,       End,   End,   End),
+    transitions(End,       End,       End,       End,       End,   End,   End),
+};
+// clang-format on
+
+static_assert(isComplete(kTransitions), "every state needs one row of transitions");
+
+}  // namespace sending
+
+namespace receiving {
+
+// states of Protocol::receive()
+enum State : uint8_t {
+    Idle,
+    Poll,
+    Repoll,
+    Enquiry,
+    Ack,
+    Stx,
+    Len,
+    DataCommand,
+    DataExtLen,
+    DataFrameNumber,
+    Data,
+    Etx,
+    Checksum,
+    Ack2,
+    Nak,
+    Retry,
+    Done,
+    Error,
+    End,
+    Count,
+};
+
+constexpr State kInitialState = Idle;
+constexpr State kFinalState = End;
+
+// clang-format off
+constexpr Transitions<State, kEventCount> kTransitions[] = {
+    //          state            Pass             Busy    Wait     Deny   Fail   Next
+    transitions(Idle,            Poll,            Error,  Error,   Error, Error, Error),
+    transitions(Poll,            Enquiry,         Error,  Error,   Error, Error, Error),
+    transitions(Repoll,          Poll,            Error,  Error,   Error, Error, Error),
+    transitions(Enquiry,         Ack,             Repoll, Error,   Retry, Error, Error),
+    transitions(Ack,             Stx,             Error,  Error,   Error, Error, Error),
+    transitions(Stx,             Len,             Error,  Error,   Nak,   Error, Error),
+    transitions(Len,             DataCommand,     Error,  Error,   Nak,   Error, Error),
+    transitions(DataCommand,     DataExtLen,      Error,  Error,   Nak,   Error, Error),
+    transitions(DataExtLen,      DataFrameNumber, Error,  Error,   Nak,   Error, Error),
+    transitions(DataFrameNumber, Data,            Error,  Error,   Nak,   Error, Error),
+    transitions(Data,            Etx,             Error,  Error,   Nak,   Error, Error),
+    transitions(Etx,             Checksum,        Error,  Error,   Nak,   Error, Error),
+    // in syscon_uart.c cs ---FAIL--> idle,
+    // I think it's wrong, I changed it to cs ---FAIL--> nak
+    transitions(Checksum,        Ack2,            Error,  Error,   Nak,   Nak,   Nak),
+    transitions(Ack2,            Done,            Error,  Error,   Error, Error, Error),
+    transitions(Nak,             Retry,           Error,  Error,   Error, Error, Error),
+    transitions(Retry,           Repoll,          Error,  Error,   Error, Error, Error),
+    // done ---WAIT--> enquiry is used to receive extended length messages with frame divisions,
+    // done ---NEXT--> stx when pipelined frame division has been negotiated
+    transitions(Done,            End,             End,    Enquiry, End,   End,   Stx),
+    transitions(Error,           End,             End,    End,     End,   End,   End),
+    transitions(End,             End,             End,    End,     End,   End,   End),
+};
+// clang-format on
+
+static_assert(isComplete(kTransitions), "every state needs one row of transitions");
+
+}  // namespace receiving
+
+}  // namespace impl
+}  // namespace cpucom
+}  // namespace ahu
+}  // namespace mitsubishielectric
+}  // namespace com
+
+#endif  // COM_MITSUBISHIELECTRIC_AHU_CPUCOM_PROTOCOLSTATES_H_
@@ -0,0 +1,141 @@
+/*
+ * COPYRIGHT (C) 2024 MITSUBISHI ELECTRIC CORPORATION
+ * ALL RIGHTS RESERVED
+ */
+
+#include "ReceiveBuffer.h"
+
+#include <algorithm>
+
+#include "FrameChecksum.h"
+
+namespace com {
+namespace mitsubishielectric {
+namespace ahu {
+namespace cpucom {
+namespace impl {
+
+using common::IODevice;
+
+constexpr size_t ReceiveBuffer::kCapacity;
+
+ReceiveBuffer::ReceiveBuffer(IODevice& device, ILineDevice* line)
+    : m_device(device)
+    , m_line(line)
+    , m_begin(0)
+    , m_end(0)
+    , m_expected(0)
+    , m_checksum(0)
+{
+}
+
+IODevice::Result ReceiveBuffer::read(uint8_t* data, std::chrono::milliseconds timeout)
+{
+    if (m_line == nullptr) {
+        const IODevice::Result result = m_device.read(data, timeout);
+        if (result == IODevice::Result::Success) {
+            m_checksum ^= *data;
+        }
+        return result;
+    }
+    return readMulti(data, 1, timeout);
+}
+
+IODevice::Result ReceiveBuffer::readMulti(uint8_t* data,
+                                          size_t size,
+                                          std::chrono::milliseconds timeout)
+{
+    if (m_line == nullptr) {
+        const IODevice::Result result = m_device.readMulti(data, size, timeout);
+        if (result == IODevice::Result::Success) {
+            m_checksum = blockChecksum(data, size, m_checksum);
+        }
+        return result;
+    }
+
+    size_t copied = take(data, size);
+    const bool waitForever = timeout == IODevice::kTimeoutInfinite;
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (copied < size) {
+        std::chrono::milliseconds left = timeout;
+        if (!waitForever) {
+            left = std::max(std::chrono::duration_cast<std::chrono::milliseconds>(
+                                deadline - std::chrono::steady_clock::now()),
+                            std::chrono::milliseconds::zero());
+        }
+
+        const size_t wanted = size - copied;
+        size_t received = 0;
+        IODevice::Result result = IODevice::Result::Success;
+        if (m_expected <= wanted) {
+            // nothing to read in advance, the bytes go straight to the caller
+            result = m_line->readAvailable(data + copied, wanted, left, received);
+            m_checksum = blockChecksum(data + copied, received, m_checksum);
+            copied += received;
+            m_expected -= std::min(m_expected, received);
+        }
+        else {
+            result = m_line->readAvailable(m_buffer.data(), std::min(m_expected, kCapacity),
+                                           left, received);
+            m_begin = 0;
+            m_end = received;
+            copied += take(data + copied, wanted);
+        }
+
+        if (result != IODevice::Result::Success) {
+            return result;
+        }
+    }
+    return IODevice::Result::Success;
+}
+
+void ReceiveBuffer::setExpected(size_t bytes) { m_expected = bytes; }
+
+IODevice::Result ReceiveBuffer::drain(ILineDevice::DrainTail& tail, size_t& drained)
+{
+    drained = m_end - m_begin;
+    shiftIntoTail(tail, &m_buffer[m_begin], drained);
+    m_begin = 0;
+    m_end = 0;
+    m_expected = 0;
+
+    IODevice::Result result = IODevice::Result::Success;
+    if (m_line != nullptr) {
+        size_t count = 0;
+        result = m_line->drain(tail, count);
+        drained += count;
+    }
+    else {
+        // byte by byte, until the device has nothing more to read
+        uint8_t b = 0;
+        while ((result = m_device.read(&b, IODevice::kTimeoutImmediate)) ==
+               IODevice::Result::Success) {
+            shiftIntoTail(tail, &b, 1);
+            ++drained;
+        }
+    }
+
+    if (result == IODevice::Result::Error) {
+        return result;
+    }
+    return (drained > 0) ? IODevice::Result::Success : IODevice::Result::Timeout;
+}
+
+size_t ReceiveBuffer::take(uint8_t* data, size_t size)
+{
+    const size_t count = std::min(size, m_end - m_begin);
+    m_checksum = copyWithChecksum(data, &m_buffer[m_begin], count, m_checksum);
+    m_begin += count;
+    if (m_begin == m_end) {
+        m_begin = 0;
+        m_end = 0;
+    }
+    m_expected -= std::min(m_expected, count);
+    return count;
+}
+
+}  // namespace impl
+}  // namespace cpucom
+}  // namespace ahu
+}  // namespace mitsubishielectric
+}  // namespace com
@@ -0,0 +1,84 @@
+/*
+ * COPYRIGHT (C) 2024 MITSUBISHI ELECTRIC CORPORATION
+ * ALL RIGHTS RESERVED
+ */
+
+#ifndef COM_MITSUBISHIELECTRIC_AHU_CPUCOM_RECEIVEBUFFER_H_
+#define COM_MITSUBISHIELECTRIC_AHU_CPUCOM_RECEIVEBUFFER_H_
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+#include "FrameFormat.h"
+#include "ILineDevice.h"
+#include "IODevice.h"
+
+namespace com {
+namespace mitsubishielectric {
+namespace ahu {
+namespace cpucom {
+namespace impl {
+
+/**
+ * ReceiveBuffer provides the read primitives of common::IODevice to Protocol.
+ * When the device implements ILineDevice, the bytes expected for the current frame are read
+ * with as few reads as possible and the following fields are served from the buffer.
+ * Otherwise every call is passed on to the device.
+ * The timeout of every call applies as before: it limits the wait for the whole field.
+ */
+class ReceiveBuffer {
+public:
+    static constexpr size_t kCapacity = frame::kMaxWireFrameLength;
+
+    ReceiveBuffer(common::IODevice& device, ILineDevice* line);
+
+    common::IODevice::Result read(uint8_t* data, std::chrono::milliseconds timeout);
+    common::IODevice::Result readMulti(uint8_t* data,
+                                       size_t size,
+                                       std::chrono::milliseconds timeout);
+
+    /**
+     * Sets the number of bytes which are expected to follow on the line as a part of
+     * the current frame. Up to this number of bytes may be read from the device in advance,
+     * so that no byte of the next transmission is taken from the device.
+     */
+    void setExpected(size_t bytes);
+
+    /**
+     * Discards the buffered bytes and all bytes waiting on the line.
+     * @param tail - the discarded bytes are shifted into it, see ILineDevice::drain()
+     * @param drained - number of discarded bytes
+     * @return Timeout if there was nothing to discard, Error if the device failed
+     */
+    common::IODevice::Result drain(ILineDevice::DrainTail& tail, size_t& drained);
+
+    bool empty() const { return m_begin == m_end; }
+
+    /**
+     * Checksum of the bytes returned by read() and readMulti() since resetChecksum(),
+     * calculated while they are copied out, so that a frame is checked without another pass.
+     */
+    void resetChecksum() { m_checksum = 0; }
+    uint8_t checksum() const { return m_checksum; }
+
+private:
+    size_t take(uint8_t* data, size_t size);
+
+    common::IODevice& m_device;
+    ILineDevice* m_line;
+    std::array<uint8_t, kCapacity> m_buffer;
+    size_t m_begin;  // first unread byte in m_buffer
+    size_t m_end;    // end of the read bytes in m_buffer
+    size_t m_expected;
+    uint8_t m_checksum;
+};
+
+}  // namespace impl
+}  // namespace cpucom
+}  // namespace ahu
+}  // namespace mitsubishielectric
+}  // namespace com
+
+#endif  // COM_MITSUBISHIELECTRIC_AHU_CPUCOM_RECEIVEBUFFER_H_
@@ -0,0 +1,32 @@
+/*
+ * COPYRIGHT (C) 2024 MITSUBISHI ELECTRIC CORPORATION
+ * ALL RIGHTS RESERVED
+ */
+
+#ifndef COM_MITSUBISHIELECTRIC_AHU_CPUCOM_RECEIVETIMES_H_
+#define COM_MITSUBISHIELECTRIC_AHU_CPUCOM_RECEIVETIMES_H_
+
+#include <chrono>
+
+namespace com {
+namespace mitsubishielectric {
+namespace ahu {
+namespace cpucom {
+namespace impl {
+
+/**
+ * When a message received by Protocol::receive() arrived on the line.
+ * A time which was not reached, e.g. because receiving failed, is the epoch of the clock.
+ */
+struct ReceiveTimes {
+    std::chrono::steady_clock::time_point frameStart;    // STX of the first frame was read
+    std::chrono::steady_clock::time_point frameChecked;  // CS of the last frame was correct
+};
+
+}  // namespace impl
+}  // namespace cpucom
+}  // namespace ahu
+}  // namespace mitsubishielectric
+}  // namespace com
+
+#endif  // COM_MITSUBISHIELECTRIC_AHU_CPUCOM_RECEIVETIMES_H_
@@ -0,0 +1,123 @@
+/*
+ * COPYRIGHT (C) 2024 MITSUBISHI ELECTRIC CORPORATION
+ * ALL RIGHTS RESERVED
+ */
+
+#include "RetryPolicy.h"
+
+#include <algorithm>
+
+namespace com {
+namespace mitsubishielectric {
+namespace ahu {
+namespace cpucom {
+namespace impl {
+
+namespace {
+
+// health lost by every failed attempt and gained by every sent message
+const uint32_t kFailurePenalty = 5;
+const uint32_t kSuccessGain = 25;
+
+// the delay doubles at most this many times, which is far beyond any sensible maxDelay
+const uint32_t kMaxBackoffShift = 16;
+
+}  // namespace
+
+constexpr uint32_t AdaptiveRetryPolicy::kMaxHealth;
+constexpr AdaptiveRetryPolicy::Settings AdaptiveRetryPolicy::kDefaultSettings;
+
+FixedRetryPolicy::FixedRetryPolicy(std::chrono::milliseconds delay,
+                                   uint32_t maxAttempts,
+                                   uint32_t reinitAttempts)
+    : m_delay(delay)
+    , m_maxAttempts(maxAttempts)
+    , m_reinitAttempts(reinitAttempts)
+{
+}
+
+RetryDecision FixedRetryPolicy::onFailure(uint32_t attempt)
+{
+    if (attempt >= m_maxAttempts) {
+        return {false, std::chrono::milliseconds(0), false};
+    }
+    return {true, m_delay, (attempt % m_reinitAttempts) == 0};
+}
+
+void FixedRetryPolicy::onSuccess(uint32_t) {}
+
+AdaptiveRetryPolicy::AdaptiveRetryPolicy(const Settings& settings)
+    : AdaptiveRetryPolicy(settings, std::random_device()())
+{
+}
+
+AdaptiveRetryPolicy::AdaptiveRetryPolicy(const Settings& settings, uint32_t seed)
+    : m_settings(settings)
+    , m_random(seed)
+    , m_health(kMaxHealth)
+    , m_probing(false)
+    , m_delayed(0)
+    , m_sinceReinit(0)
+{
+}
+
+RetryDecision AdaptiveRetryPolicy::onFailure(uint32_t attempt)
+{
+    if (attempt == 1) {
+        // a message started on a dead link only gets a few probes
+        m_probing = dead();
+        m_delayed = std::chrono::milliseconds(0);
+    }
+    m_health -= std::min(m_health, kFailurePenalty);
+    ++m_sinceReinit;
+
+    const std::chrono::milliseconds delay = backoff(attempt);
+    const bool giveUp = (attempt >= m_settings.maxAttempts) ||
+                        (m_probing && (attempt >= m_settings.deadAttempts)) ||
+                        (m_delayed + delay > m_settings.budget);
+    if (giveUp) {
+        m_health = 0;
+        return {false, std::chrono::milliseconds(0), false};
+    }
+
+    m_delayed += delay;
+    // failed attempts add up over the messages given up, so a dead link is reopened regularly
+    const bool reinit = m_sinceReinit >= reinitAttempts();
+    if (reinit) {
+        m_sinceReinit = 0;
+    }
+    return {true, delay, reinit};
+}
+
+void AdaptiveRetryPolicy::onSuccess(uint32_t)
+{
+    m_sinceReinit = 0;
+    m_health = std::min(kMaxHealth, m_health + kSuccessGain);
+}
+
+uint32_t AdaptiveRetryPolicy::health() const { return m_health; }
+
+bool AdaptiveRetryPolicy::dead() const { return m_health == 0; }
+
+std::chrono::milliseconds AdaptiveRetryPolicy::backoff(uint32_t attempt)
+{
+    const uint32_t shift = std::min(attempt - 1, kMaxBackoffShift);
+    const auto ceiling =
+        std::min<std::chrono::milliseconds::rep>(m_settings.initialDelay.count() << shift,
+                                                 m_settings.maxDelay.count());
+    // equal jitter: at least half of the delay, so that attempts never follow back to back
+    std::uniform_int_distribution<std::chrono::milliseconds::rep> jitter(ceiling / 2, ceiling);
+    return std::chrono::milliseconds(jitter(m_random));
+}
+
+uint32_t AdaptiveRetryPolicy::reinitAttempts() const
+{
+    const uint32_t range = m_settings.healthyReinitAttempts - m_settings.unhealthyReinitAttempts;
+    return std::max<uint32_t>(1, m_settings.unhealthyReinitAttempts + range * m_health / kMaxHealth);
+}
+
+}  // namespace impl
+}  // namespace cpucom
+}  // namespace ahu
+}  // namespace mitsubishielectric
+}  // namespace com
@@ -0,0 +1,127 @@
+/*
+ * COPYRIGHT (C) 2024 MITSUBISHI ELECTRIC CORPORATION
+ * ALL RIGHTS RESERVED
+ */
+
+#ifndef COM_MITSUBISHIELECTRIC_AHU_CPUCOM_RETRYPOLICY_H_
+#define COM_MITSUBISHIELECTRIC_AHU_CPUCOM_RETRYPOLICY_H_
+
+#include <chrono>
+#include <cstdint>
+#include <random>
+
+namespace com {
+namespace mitsubishielectric {
+namespace ahu {
+namespace cpucom {
+namespace impl {
+
+/**
+ * What Protocol does after a failed attempt to send a message.
+ */
+struct RetryDecision {
+    bool retry;                       // false gives the message up
+    std::chrono::milliseconds delay;  // before the next attempt, the line is released meanwhile
+    bool reinit;                      // reopen the device before the next attempt
+};
+
+/**
+ * Decides how Protocol::send() retries failed attempts.
+ * Called from the sending thread only.
+ */
+class IRetryPolicy {
+public:
+    // LCOV_EXCL_START - exclude compiler generated d-tors which are impossible to trigger
+    virtual ~IRetryPolicy() = default;
+    // LCOV_EXCL_STOP
+
+public:
+    /**
+     * @param attempt number of failed attempts of the current message, starting with 1
+     */
+    virtual RetryDecision onFailure(uint32_t attempt) = 0;
+
+    /**
+     * The current message has been sent.
+     * @param attempts number of failed attempts before it, 0 when none
+     */
+    virtual void onSuccess(uint32_t attempts) = 0;
+};
+
+/**
+ * The same delay before every attempt, the device is reopened every reinitAttempts attempts.
+ * This is how Protocol has always retried.
+ */
+class FixedRetryPolicy : public IRetryPolicy {
+public:
+    FixedRetryPolicy(std::chrono::milliseconds delay, uint32_t maxAttempts, uint32_t reinitAttempts);
+
+public:
+    RetryDecision onFailure(uint32_t attempt) override;
+    void onSuccess(uint32_t attempts) override;
+
+private:
+    const std::chrono::milliseconds m_delay;
+    const uint32_t m_maxAttempts;
+    const uint32_t m_reinitAttempts;
+};
+
+/**
+ * Exponential backoff with jitter, adapted to the health of the link.
+ *
+ * Health is a score in [0, kMaxHealth]: sent messages raise it, failed attempts lower it
+ * and a message given up drops it to 0. The device is reopened sooner the lower the score is.
+ * A link with no health left is considered dead: messages started on it are given up after
+ * deadAttempts attempts instead of waiting out the whole retry budget, until one gets through.
+ */
+class AdaptiveRetryPolicy : public IRetryPolicy {
+public:
+    struct Settings {
+        std::chrono::milliseconds initialDelay;  // before the second attempt
+        std::chrono::milliseconds maxDelay;      // the delay stops doubling here
+        std::chrono::milliseconds budget;        // total delay of one message before giving up
+        uint32_t maxAttempts;
+        uint32_t healthyReinitAttempts;    // attempts between reopening the device at kMaxHealth
+        uint32_t unhealthyReinitAttempts;  // and with no health left
+        uint32_t deadAttempts;             // attempts of a message while the link is dead
+    };
+
+    static constexpr uint32_t kMaxHealth = 100;
+    static constexpr Settings kDefaultSettings = {std::chrono::milliseconds(5),
+                                                  std::chrono::milliseconds(80),
+                                                  std::chrono::milliseconds(1200),
+                                                  240,
+                                                  12,
+                                                  3,
+                                                  2};
+
+    explicit AdaptiveRetryPolicy(const Settings& settings = kDefaultSettings);
+    AdaptiveRetryPolicy(const Settings& settings, uint32_t seed);
+
+public:
+    RetryDecision onFailure(uint32_t attempt) override;
+    void onSuccess(uint32_t attempts) override;
+
+    uint32_t health() const;
+    bool dead() const;
+
+private:
+    std::chrono::milliseconds backoff(uint32_t attempt);
+    uint32_t reinitAttempts() const;
+
+private:
+    const Settings m_settings;
+    std::minstd_rand m_random;
+    uint32_t m_health;
+    bool m_probing;                       // the current message was started on a dead link
+    std::chrono::milliseconds m_delayed;  // total delay of the current message
+    uint32_t m_sinceReinit;               // failed attempts since reopening or the last success
+};
+
+}  // namespace impl
+}  // namespace cpucom
+}  // namespace ahu
+}  // namespace mitsubishielectric
+}  // namespace com
+
+#endif  // COM_MITSUBISHIELECTRIC_AHU_CPUCOM_RETRYPOLICY_H_
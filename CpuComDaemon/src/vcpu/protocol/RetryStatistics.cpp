@@ -0,0 +1,43 @@
+/*
+ * COPYRIGHT (C) 2024 MITSUBISHI ELECTRIC CORPORATION
+ * ALL RIGHTS RESERVED
+ */
+
+#include "RetryStatistics.h"
+
+#include <algorithm>
+
+namespace com {
+namespace mitsubishielectric {
+namespace ahu {
+namespace cpucom {
+namespace impl {
+
+void RetryStatistics::record(const common::CpuCommand& command,
+                             uint32_t failedAttempts,
+                             std::chrono::milliseconds retryTime,
+                             bool sent)
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    Entry& entry = m_entries[command];
+    ++entry.retriedMessages;
+    if (!sent) {
+        ++entry.failedMessages;
+    }
+    entry.failedAttempts += failedAttempts;
+    entry.maxFailedAttempts = std::max(entry.maxFailedAttempts, failedAttempts);
+    entry.retryTime += retryTime;
+    entry.maxRetryTime = std::max(entry.maxRetryTime, retryTime);
+}
+
+RetryStatistics::Entries RetryStatistics::entries() const
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    return m_entries;
+}
+
+}  // namespace impl
+}  // namespace cpucom
+}  // namespace ahu
+}  // namespace mitsubishielectric
+}  // namespace com
@@ -0,0 +1,61 @@
+/*
+ * COPYRIGHT (C) 2024 MITSUBISHI ELECTRIC CORPORATION
+ * ALL RIGHTS RESERVED
+ */
+
+#ifndef COM_MITSUBISHIELECTRIC_AHU_CPUCOM_RETRYSTATISTICS_H_
+#define COM_MITSUBISHIELECTRIC_AHU_CPUCOM_RETRYSTATISTICS_H_
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+
+#include "CpuCommand.h"
+
+namespace com {
+namespace mitsubishielectric {
+namespace ahu {
+namespace cpucom {
+namespace impl {
+
+/**
+ * Retries of the sent messages per command. Only messages which needed a retry are recorded,
+ * so the lock is never taken on the path of a message sent at the first attempt.
+ */
+class RetryStatistics {
+public:
+    struct Entry {
+        uint32_t retriedMessages;  // messages which needed at least one retry
+        uint32_t failedMessages;   // messages given up
+        uint32_t failedAttempts;   // attempts of all messages which did not get through
+        uint32_t maxFailedAttempts;
+        std::chrono::milliseconds retryTime;  // from the first failed attempt to the result
+        std::chrono::milliseconds maxRetryTime;
+    };
+
+    using Entries = std::map<common::CpuCommand, Entry>;
+
+    /**
+     * @param failedAttempts number of failed attempts of the message, at least 1
+     * @param sent whether the message got through in the end
+     */
+    void record(const common::CpuCommand& command,
+                uint32_t failedAttempts,
+                std::chrono::milliseconds retryTime,
+                bool sent);
+
+    Entries entries() const;
+
+private:
+    mutable std::mutex m_lock;
+    Entries m_entries;
+};
+
+}  // namespace impl
+}  // namespace cpucom
+}  // namespace ahu
+}  // namespace mitsubishielectric
+}  // namespace com
+
+#endif  // COM_MITSUBISHIELECTRIC_AHU_CPUCOM_RETRYSTATISTICS_H_
@@ -0,0 +1,32 @@
+/*
+ * COPYRIGHT (C) 2024 MITSUBISHI ELECTRIC CORPORATION
+ * ALL RIGHTS RESERVED
+ */
+
+#ifndef COM_MITSUBISHIELECTRIC_AHU_CPUCOM_SENDTIMES_H_
+#define COM_MITSUBISHIELECTRIC_AHU_CPUCOM_SENDTIMES_H_
+
+#include <chrono>
+
+namespace com {
+namespace mitsubishielectric {
+namespace ahu {
+namespace cpucom {
+namespace impl {
+
+/**
+ * When the handshake of a message sent by Protocol::send() happened on the line.
+ * A time which was not reached, e.g. because sending failed, is the epoch of the clock.
+ */
+struct SendTimes {
+    std::chrono::steady_clock::time_point enquiry;           // the first ENQ was written
+    std::chrono::steady_clock::time_point acknowledgement2;  // ACK2 of the last frame was read
+};
+
+}  // namespace impl
+}  // namespace cpucom
+}  // namespace ahu
+}  // namespace mitsubishielectric
+}  // namespace com
+
+#endif  // COM_MITSUBISHIELECTRIC_AHU_CPUCOM_SENDTIMES_H_
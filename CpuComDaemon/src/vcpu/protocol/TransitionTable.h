@@ -0,0 +1,87 @@
+/*
+ * COPYRIGHT (C) 2024 MITSUBISHI ELECTRIC CORPORATION
+ * ALL RIGHTS RESERVED
+ */
+
+#ifndef COM_MITSUBISHIELECTRIC_AHU_CPUCOM_TRANSITIONTABLE_H_
+#define COM_MITSUBISHIELECTRIC_AHU_CPUCOM_TRANSITIONTABLE_H_
+
+#include <cstddef>
+
+namespace com {
+namespace mitsubishielectric {
+namespace ahu {
+namespace cpucom {
+namespace impl {
+
+/**
+ * Row of a transition table: a state and the next state for every event,
+ * indexed by the event value.
+ */
+template <typename State, std::size_t kEventCount>
+struct Transitions {
+    State state;
+    State next[kEventCount];
+};
+
+/**
+ * Makes a row of a transition table. The next states are given in the order of the events,
+ * a row with a missing event does not fit into the table and fails to compile.
+ */
+template <typename State, typename... Next>
+constexpr Transitions<State, sizeof...(Next)> transitions(State state, Next... next)
+{
+    return {state, {next...}};
+}
+
+/**
+ * Checks that the table has exactly one row per state, in the order of State values,
+ * and that every transition leads to a valid state. State must end with a Count enumerator.
+ */
+template <typename State, std::size_t kEventCount, std::size_t kRows>
+constexpr bool isComplete(const Transitions<State, kEventCount> (&table)[kRows])
+{
+    if (kRows != static_cast<std::size_t>(State::Count)) {
+        return false;
+    }
+    for (std::size_t row = 0; row < kRows; ++row) {
+        if (static_cast<std::size_t>(table[row].state) != row) {
+            return false;
+        }
+        for (std::size_t event = 0; event < kEventCount; ++event) {
+            if (static_cast<std::size_t>(table[row].next[event]) >= kRows) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+/**
+ * Runs a state machine described by the table. handler(state) is called for every
+ * state entered and returns the event which selects the next state.
+ * The machine stops after the handler of the final state has been called.
+ */
+template <typename State, std::size_t kEventCount, std::size_t kRows, typename Handler>
+void runStateMachine(const Transitions<State, kEventCount> (&table)[kRows],
+                     State initial,
+                     State final,
+                     Handler&& handler)
+{
+    State state = initial;
+    while (true) {
+        const auto event = handler(state);
+        if (state == final) {
+            break;
+        }
+        state = table[static_cast<std::size_t>(state)].next[static_cast<std::size_t>(event)];
+    }
+}
+
+}  // namespace impl
+}  // namespace cpucom
+}  // namespace ahu
+}  // namespace mitsubishielectric
+}  // namespace com
+
+#endif  // COM_MITSUBISHIELECTRIC_AHU_CPUCOM_TRANSITIONTABLE_H_
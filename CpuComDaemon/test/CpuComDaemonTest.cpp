@@ -5,6 +5,7 @@
 
 #include "CpuComDaemon.h"
 #include "CPUCommon.h"
+#include "CpuComError.h"
 
 #include "MockICPU.h"
 #include "MockIMessageServer.h"
@@ -13,6 +14,7 @@
 
 #include <gtest/gtest.h>
 #include <memory>
+#include <thread>
 
 namespace com {
 namespace mitsubishielectric {
@@ -24,11 +26,14 @@ using ::testing::_;
 using ::testing::An;
 using ::testing::ByMove;
 using ::testing::DoAll;
+using ::testing::ElementsAre;
+using ::testing::InSequence;
 using ::testing::NiceMock;
 using ::testing::Return;
 using ::testing::SaveArg;
 using ::testing::SetArgReferee;
 using ::testing::Test;
+using ::testing::UnorderedElementsAre;
 
 class CpuComDaemonTest : public Test {
 protected:
@@ -59,8 +64,14 @@ protected:
 
     std::function<void(void)> mTaskCallable;
     std::function<bool(void)> mPredicateCallable;
+    std::function<void(void)> mDispatchCallable;
+    std::function<bool(void)> mDispatchPredicateCallable;
+    std::function<void(void)> mTransmitCallable;
+    std::function<bool(void)> mTransmitPredicateCallable;
 
     std::promise<void> p;
+    std::promise<void> dispatchPromise;
+    std::promise<void> transmitPromise;
 };
 
 CpuComDaemonTest::CpuComDaemonTest()
@@ -94,10 +105,13 @@ TEST_F(CpuComDaemonTest, vcpuInitializeFailedTest)
     auto vcpu = std::make_unique<NiceMock<MockICPU>>();
     NiceMock<MockICPU>* vcpuRaw = vcpu.get();
     auto periodicExecutor = std::make_unique<NiceMock<common::mock_IPeriodicTaskExecutor>>();
+    auto dispatchExecutor = std::make_unique<NiceMock<common::mock_IPeriodicTaskExecutor>>();
+    auto transmitExecutor = std::make_unique<NiceMock<common::mock_IPeriodicTaskExecutor>>();
     auto subscribersMutexWrapper = std::make_unique<NiceMock<MockMutexWrapper>>();
     auto requestsMutexWrapper = std::make_unique<NiceMock<MockMutexWrapper>>();
 
     CpuComDaemon daemon{std::move(messageServer), std::move(vcpu), std::move(periodicExecutor),
+                        std::move(dispatchExecutor), std::move(transmitExecutor),
                         std::move(subscribersMutexWrapper), std::move(requestsMutexWrapper)};
 
     EXPECT_CALL(*vcpuRaw, initialize()).WillOnce(Return(false));
@@ -116,6 +130,11 @@ TEST_F(CpuComDaemonTest, vcpuInitializeFailedTest)
     EXPECT_CALL(*messageServerRaw,
                 setSendCommandWithDeliveryStatusMessageHandler(
                     An<IMessageServer::OnSendCommandWithDeliveryStatusHandler>(), &daemon));
+    EXPECT_CALL(*messageServerRaw,
+                setSendCommandWithTraceMessageHandler(
+                    An<IMessageServer::OnSendCommandWithTraceHandler>(), &daemon));
+    EXPECT_CALL(*messageServerRaw,
+                setStatsMessageHandler(An<IMessageServer::OnStatsHandler>(), &daemon));
     daemon.start();
 }
 
@@ -126,16 +145,27 @@ TEST_F(CpuComDaemonTest, isDaemonStoppedTest)
     NiceMock<MockICPU>* vcpuRaw = vcpu.get();
     auto periodicExecutor = std::make_unique<NiceMock<common::mock_IPeriodicTaskExecutor>>();
     NiceMock<common::mock_IPeriodicTaskExecutor>* periodicExecutorRaw = periodicExecutor.get();
+    auto dispatchExecutor = std::make_unique<NiceMock<common::mock_IPeriodicTaskExecutor>>();
+    NiceMock<common::mock_IPeriodicTaskExecutor>* dispatchExecutorRaw = dispatchExecutor.get();
+    auto transmitExecutor = std::make_unique<NiceMock<common::mock_IPeriodicTaskExecutor>>();
+    NiceMock<common::mock_IPeriodicTaskExecutor>* transmitExecutorRaw = transmitExecutor.get();
     auto subscribersMutexWrapper = std::make_unique<NiceMock<MockMutexWrapper>>();
     auto requestsMutexWrapper = std::make_unique<NiceMock<MockMutexWrapper>>();
 
     CpuComDaemon daemon{std::move(messageServer), std::move(vcpu), std::move(periodicExecutor),
+                        std::move(dispatchExecutor), std::move(transmitExecutor),
                         std::move(subscribersMutexWrapper), std::move(requestsMutexWrapper)};
 
     EXPECT_CALL(*vcpuRaw, initialize()).WillOnce(Return(true));
     EXPECT_CALL(*periodicExecutorRaw, submit(_, _))
         .WillOnce(DoAll(SaveArg<0>(&mTaskCallable), SaveArg<1>(&mPredicateCallable),
                         Return(ByMove(p.get_future()))));
+    EXPECT_CALL(*dispatchExecutorRaw, submit(_, _))
+        .WillOnce(DoAll(SaveArg<0>(&mDispatchCallable), SaveArg<1>(&mDispatchPredicateCallable),
+                        Return(ByMove(dispatchPromise.get_future()))));
+    EXPECT_CALL(*transmitExecutorRaw, submit(_, _))
+        .WillOnce(DoAll(SaveArg<0>(&mTransmitCallable), SaveArg<1>(&mTransmitPredicateCallable),
+                        Return(ByMove(transmitPromise.get_future()))));
 
     daemon.start();
     mPredicateCallable();
@@ -149,23 +179,43 @@ TEST_F(CpuComDaemonTest, handleSubscribeMessageTest)
     NiceMock<MockICPU>* vcpuRaw = vcpu.get();
     auto periodicExecutor = std::make_unique<NiceMock<common::mock_IPeriodicTaskExecutor>>();
     NiceMock<common::mock_IPeriodicTaskExecutor>* periodicExecutorRaw = periodicExecutor.get();
+    auto dispatchExecutor = std::make_unique<NiceMock<common::mock_IPeriodicTaskExecutor>>();
+    NiceMock<common::mock_IPeriodicTaskExecutor>* dispatchExecutorRaw = dispatchExecutor.get();
+    auto transmitExecutor = std::make_unique<NiceMock<common::mock_IPeriodicTaskExecutor>>();
+    NiceMock<common::mock_IPeriodicTaskExecutor>* transmitExecutorRaw = transmitExecutor.get();
     auto subscribersMutexWrapper = std::make_unique<NiceMock<MockMutexWrapper>>();
     auto requestsMutexWrapper = std::make_unique<NiceMock<MockMutexWrapper>>();
 
     CpuComDaemon daemon{std::move(messageServer), std::move(vcpu), std::move(periodicExecutor),
+                        std::move(dispatchExecutor), std::move(transmitExecutor),
                         std::move(subscribersMutexWrapper), std::move(requestsMutexWrapper)};
 
     EXPECT_CALL(*vcpuRaw, initialize()).WillOnce(Return(true));
     EXPECT_CALL(*periodicExecutorRaw, submit(_, _))
         .WillOnce(DoAll(SaveArg<0>(&mTaskCallable), SaveArg<1>(&mPredicateCallable),
                         Return(ByMove(p.get_future()))));
+    EXPECT_CALL(*dispatchExecutorRaw, submit(_, _))
+        .WillOnce(DoAll(SaveArg<0>(&mDispatchCallable), SaveArg<1>(&mDispatchPredicateCallable),
+                        Return(ByMove(dispatchPromise.get_future()))));
+    EXPECT_CALL(*transmitExecutorRaw, submit(_, _))
+        .WillOnce(DoAll(SaveArg<0>(&mTransmitCallable), SaveArg<1>(&mTransmitPredicateCallable),
+                        Return(ByMove(transmitPromise.get_future()))));
     ON_CALL(*vcpuRaw, read(_)).WillByDefault(DoAll(SetArgReferee<0>(mSubscribeData), Return(true)));
+    ReceiveTimes times;
+    times.frameStart = std::chrono::steady_clock::time_point(std::chrono::microseconds(1000));
+    times.frameChecked = std::chrono::steady_clock::time_point(std::chrono::microseconds(1250));
+    ON_CALL(*vcpuRaw, lastReceiveTimes()).WillByDefault(Return(times));
+    ReceiveStamps stamps;
+    stamps.frameStart = 1000000;
+    stamps.frameChecked = 1250000;
     EXPECT_CALL(*messageServerRaw,
-                sendNotificationMessage(mSessionSubscribeId, mSubscribeCommand, mSubscribeRawData));
+                sendNotificationMessage(ElementsAre(mSessionSubscribeId), mSubscribeCommand,
+                                        mSubscribeRawData, encodeReceiveStamps(stamps)));
 
     daemon.onSubscribe(mSessionSubscribeId, mSubscribeCommand);
     daemon.start();
     mTaskCallable();
+    mDispatchCallable();
     daemon.onUnsubscribe(mSessionSubscribeId, mSubscribeCommand);
 }
 
@@ -177,25 +227,38 @@ TEST_F(CpuComDaemonTest, handleSubscribeMessageFailedTest)
     NiceMock<MockICPU>* vcpuRaw = vcpu.get();
     auto periodicExecutor = std::make_unique<NiceMock<common::mock_IPeriodicTaskExecutor>>();
     NiceMock<common::mock_IPeriodicTaskExecutor>* periodicExecutorRaw = periodicExecutor.get();
+    auto dispatchExecutor = std::make_unique<NiceMock<common::mock_IPeriodicTaskExecutor>>();
+    NiceMock<common::mock_IPeriodicTaskExecutor>* dispatchExecutorRaw = dispatchExecutor.get();
+    auto transmitExecutor = std::make_unique<NiceMock<common::mock_IPeriodicTaskExecutor>>();
+    NiceMock<common::mock_IPeriodicTaskExecutor>* transmitExecutorRaw = transmitExecutor.get();
     auto subscribersMutexWrapper = std::make_unique<NiceMock<MockMutexWrapper>>();
     auto requestsMutexWrapper = std::make_unique<NiceMock<MockMutexWrapper>>();
 
     CpuComDaemon daemon{std::move(messageServer), std::move(vcpu), std::move(periodicExecutor),
+                        std::move(dispatchExecutor), std::move(transmitExecutor),
                         std::move(subscribersMutexWrapper), std::move(requestsMutexWrapper)};
 
     EXPECT_CALL(*vcpuRaw, initialize()).WillOnce(Return(true));
     EXPECT_CALL(*periodicExecutorRaw, submit(_, _))
         .WillOnce(DoAll(SaveArg<0>(&mTaskCallable), SaveArg<1>(&mPredicateCallable),
                         Return(ByMove(p.get_future()))));
+    EXPECT_CALL(*dispatchExecutorRaw, submit(_, _))
+        .WillOnce(DoAll(SaveArg<0>(&mDispatchCallable), SaveArg<1>(&mDispatchPredicateCallable),
+                        Return(ByMove(dispatchPromise.get_future()))));
+    EXPECT_CALL(*transmitExecutorRaw, submit(_, _))
+        .WillOnce(DoAll(SaveArg<0>(&mTransmitCallable), SaveArg<1>(&mTransmitPredicateCallable),
+                        Return(ByMove(transmitPromise.get_future()))));
     ON_CALL(*vcpuRaw, read(_))
         .WillByDefault(DoAll(SetArgReferee<0>(mSubscribeData), Return(false)));
     EXPECT_CALL(*messageServerRaw,
-                sendNotificationMessage(mSessionSubscribeId, mSubscribeCommand, mSubscribeRawData))
+                sendNotificationMessage(ElementsAre(mSessionSubscribeId), mSubscribeCommand,
+                                        mSubscribeRawData, _))
         .Times(0);
 
     daemon.onSubscribe(mSessionSubscribeId, mSubscribeCommand);
     daemon.start();
     mTaskCallable();
+    mDispatchCallable();
     daemon.onUnsubscribe(mSessionSubscribeId, mSubscribeCommand);
 }
 
@@ -207,16 +270,27 @@ TEST_F(CpuComDaemonTest, handleRequestMessageTest)
     NiceMock<MockICPU>* vcpuRaw = vcpu.get();
     auto periodicExecutor = std::make_unique<NiceMock<common::mock_IPeriodicTaskExecutor>>();
     NiceMock<common::mock_IPeriodicTaskExecutor>* periodicExecutorRaw = periodicExecutor.get();
+    auto dispatchExecutor = std::make_unique<NiceMock<common::mock_IPeriodicTaskExecutor>>();
+    NiceMock<common::mock_IPeriodicTaskExecutor>* dispatchExecutorRaw = dispatchExecutor.get();
+    auto transmitExecutor = std::make_unique<NiceMock<common::mock_IPeriodicTaskExecutor>>();
+    NiceMock<common::mock_IPeriodicTaskExecutor>* transmitExecutorRaw = transmitExecutor.get();
     auto subscribersMutexWrapper = std::make_unique<NiceMock<MockMutexWrapper>>();
     auto requestsMutexWrapper = std::make_unique<NiceMock<MockMutexWrapper>>();
 
     CpuComDaemon daemon{std::move(messageServer), std::move(vcpu), std::move(periodicExecutor),
+                        std::move(dispatchExecutor), std::move(transmitExecutor),
                         std::move(subscribersMutexWrapper), std::move(requestsMutexWrapper)};
 
     EXPECT_CALL(*vcpuRaw, initialize()).WillOnce(Return(true));
     EXPECT_CALL(*periodicExecutorRaw, submit(_, _))
         .WillOnce(DoAll(SaveArg<0>(&mTaskCallable), SaveArg<1>(&mPredicateCallable),
                         Return(ByMove(p.get_future()))));
+    EXPECT_CALL(*dispatchExecutorRaw, submit(_, _))
+        .WillOnce(DoAll(SaveArg<0>(&mDispatchCallable), SaveArg<1>(&mDispatchPredicateCallable),
+                        Return(ByMove(dispatchPromise.get_future()))));
+    EXPECT_CALL(*transmitExecutorRaw, submit(_, _))
+        .WillOnce(DoAll(SaveArg<0>(&mTransmitCallable), SaveArg<1>(&mTransmitPredicateCallable),
+                        Return(ByMove(transmitPromise.get_future()))));
     EXPECT_CALL(*vcpuRaw, read(_)).WillOnce(DoAll(SetArgReferee<0>(mResponseData), Return(true)));
     EXPECT_CALL(*vcpuRaw, write(mRequestCommand, mRequestRawData)).WillOnce(Return(true));
     EXPECT_CALL(*messageServerRaw,
@@ -225,7 +299,9 @@ TEST_F(CpuComDaemonTest, handleRequestMessageTest)
     daemon.onRequest(mSessionRequestId, mRequestUUID, mRequestCommand, mRequestRawData,
                      mResponseCommand);
     daemon.start();
+    mTransmitCallable();
     mTaskCallable();
+    mDispatchCallable();
     daemon.onCancelRequest(mSessionRequestId, mRequestUUID);
 }
 
@@ -236,16 +312,27 @@ TEST_F(CpuComDaemonTest, handleClientConnectionMessageTest)
     NiceMock<MockICPU>* vcpuRaw = vcpu.get();
     auto periodicExecutor = std::make_unique<NiceMock<common::mock_IPeriodicTaskExecutor>>();
     NiceMock<common::mock_IPeriodicTaskExecutor>* periodicExecutorRaw = periodicExecutor.get();
+    auto dispatchExecutor = std::make_unique<NiceMock<common::mock_IPeriodicTaskExecutor>>();
+    NiceMock<common::mock_IPeriodicTaskExecutor>* dispatchExecutorRaw = dispatchExecutor.get();
+    auto transmitExecutor = std::make_unique<NiceMock<common::mock_IPeriodicTaskExecutor>>();
+    NiceMock<common::mock_IPeriodicTaskExecutor>* transmitExecutorRaw = transmitExecutor.get();
     auto subscribersMutexWrapper = std::make_unique<NiceMock<MockMutexWrapper>>();
     auto requestsMutexWrapper = std::make_unique<NiceMock<MockMutexWrapper>>();
 
     CpuComDaemon daemon{std::move(messageServer), std::move(vcpu), std::move(periodicExecutor),
+                        std::move(dispatchExecutor), std::move(transmitExecutor),
                         std::move(subscribersMutexWrapper), std::move(requestsMutexWrapper)};
 
     EXPECT_CALL(*vcpuRaw, initialize()).WillOnce(Return(true));
     EXPECT_CALL(*periodicExecutorRaw, submit(_, _))
         .WillOnce(DoAll(SaveArg<0>(&mTaskCallable), SaveArg<1>(&mPredicateCallable),
                         Return(ByMove(p.get_future()))));
+    EXPECT_CALL(*dispatchExecutorRaw, submit(_, _))
+        .WillOnce(DoAll(SaveArg<0>(&mDispatchCallable), SaveArg<1>(&mDispatchPredicateCallable),
+                        Return(ByMove(dispatchPromise.get_future()))));
+    EXPECT_CALL(*transmitExecutorRaw, submit(_, _))
+        .WillOnce(DoAll(SaveArg<0>(&mTransmitCallable), SaveArg<1>(&mTransmitPredicateCallable),
+                        Return(ByMove(transmitPromise.get_future()))));
     ON_CALL(*vcpuRaw, read(_)).WillByDefault(DoAll(SetArgReferee<0>(mRequestData), Return(true)));
 
     daemon.onSubscribe(mSessionSubscribeId, mSubscribeCommand);
@@ -254,6 +341,7 @@ TEST_F(CpuComDaemonTest, handleClientConnectionMessageTest)
     daemon.onClientConnected(mSessionConnectId);
     daemon.start();
     mTaskCallable();
+    mDispatchCallable();
     daemon.onClientDisconnected(mSessionConnectId);
     daemon.onCancelRequest(mSessionRequestId, mRequestUUID);
     daemon.onUnsubscribe(mSessionSubscribeId, mSubscribeCommand);
@@ -267,16 +355,27 @@ TEST_F(CpuComDaemonTest, handleSendCommandMessageSuccessfullyTest)
     NiceMock<MockICPU>* vcpuRaw = vcpu.get();
     auto periodicExecutor = std::make_unique<NiceMock<common::mock_IPeriodicTaskExecutor>>();
     NiceMock<common::mock_IPeriodicTaskExecutor>* periodicExecutorRaw = periodicExecutor.get();
+    auto dispatchExecutor = std::make_unique<NiceMock<common::mock_IPeriodicTaskExecutor>>();
+    NiceMock<common::mock_IPeriodicTaskExecutor>* dispatchExecutorRaw = dispatchExecutor.get();
+    auto transmitExecutor = std::make_unique<NiceMock<common::mock_IPeriodicTaskExecutor>>();
+    NiceMock<common::mock_IPeriodicTaskExecutor>* transmitExecutorRaw = transmitExecutor.get();
     auto subscribersMutexWrapper = std::make_unique<NiceMock<MockMutexWrapper>>();
     auto requestsMutexWrapper = std::make_unique<NiceMock<MockMutexWrapper>>();
 
     CpuComDaemon daemon{std::move(messageServer), std::move(vcpu), std::move(periodicExecutor),
+                        std::move(dispatchExecutor), std::move(transmitExecutor),
                         std::move(subscribersMutexWrapper), std::move(requestsMutexWrapper)};
 
     EXPECT_CALL(*vcpuRaw, initialize()).WillOnce(Return(true));
     EXPECT_CALL(*periodicExecutorRaw, submit(_, _))
         .WillOnce(DoAll(SaveArg<0>(&mTaskCallable), SaveArg<1>(&mPredicateCallable),
                         Return(ByMove(p.get_future()))));
+    EXPECT_CALL(*dispatchExecutorRaw, submit(_, _))
+        .WillOnce(DoAll(SaveArg<0>(&mDispatchCallable), SaveArg<1>(&mDispatchPredicateCallable),
+                        Return(ByMove(dispatchPromise.get_future()))));
+    EXPECT_CALL(*transmitExecutorRaw, submit(_, _))
+        .WillOnce(DoAll(SaveArg<0>(&mTransmitCallable), SaveArg<1>(&mTransmitPredicateCallable),
+                        Return(ByMove(transmitPromise.get_future()))));
     ON_CALL(*vcpuRaw, read(_)).WillByDefault(DoAll(SetArgReferee<0>(mRequestData), Return(true)));
     ON_CALL(*vcpuRaw, write(mSendCommand, mSendRawData)).WillByDefault(Return(true));
     EXPECT_CALL(*messageServerRaw,
@@ -285,7 +384,9 @@ TEST_F(CpuComDaemonTest, handleSendCommandMessageSuccessfullyTest)
 
     daemon.onSendCommand(mSessionSendId, mSendCommand, mSendRawData);
     daemon.start();
+    mTransmitCallable();
     mTaskCallable();
+    mDispatchCallable();
 }
 
 TEST_F(CpuComDaemonTest, handleSendCommandMessageFailedTest)
@@ -296,16 +397,27 @@ TEST_F(CpuComDaemonTest, handleSendCommandMessageFailedTest)
     NiceMock<MockICPU>* vcpuRaw = vcpu.get();
     auto periodicExecutor = std::make_unique<NiceMock<common::mock_IPeriodicTaskExecutor>>();
     NiceMock<common::mock_IPeriodicTaskExecutor>* periodicExecutorRaw = periodicExecutor.get();
+    auto dispatchExecutor = std::make_unique<NiceMock<common::mock_IPeriodicTaskExecutor>>();
+    NiceMock<common::mock_IPeriodicTaskExecutor>* dispatchExecutorRaw = dispatchExecutor.get();
+    auto transmitExecutor = std::make_unique<NiceMock<common::mock_IPeriodicTaskExecutor>>();
+    NiceMock<common::mock_IPeriodicTaskExecutor>* transmitExecutorRaw = transmitExecutor.get();
     auto subscribersMutexWrapper = std::make_unique<NiceMock<MockMutexWrapper>>();
     auto requestsMutexWrapper = std::make_unique<NiceMock<MockMutexWrapper>>();
 
     CpuComDaemon daemon{std::move(messageServer), std::move(vcpu), std::move(periodicExecutor),
+                        std::move(dispatchExecutor), std::move(transmitExecutor),
                         std::move(subscribersMutexWrapper), std::move(requestsMutexWrapper)};
 
     EXPECT_CALL(*vcpuRaw, initialize()).WillOnce(Return(true));
     EXPECT_CALL(*periodicExecutorRaw, submit(_, _))
         .WillOnce(DoAll(SaveArg<0>(&mTaskCallable), SaveArg<1>(&mPredicateCallable),
                         Return(ByMove(p.get_future()))));
+    EXPECT_CALL(*dispatchExecutorRaw, submit(_, _))
+        .WillOnce(DoAll(SaveArg<0>(&mDispatchCallable), SaveArg<1>(&mDispatchPredicateCallable),
+                        Return(ByMove(dispatchPromise.get_future()))));
+    EXPECT_CALL(*transmitExecutorRaw, submit(_, _))
+        .WillOnce(DoAll(SaveArg<0>(&mTransmitCallable), SaveArg<1>(&mTransmitPredicateCallable),
+                        Return(ByMove(transmitPromise.get_future()))));
     ON_CALL(*vcpuRaw, read(_)).WillByDefault(DoAll(SetArgReferee<0>(mRequestData), Return(true)));
     ON_CALL(*vcpuRaw, write(mSendCommand, mSendRawData)).WillByDefault(Return(false));
     EXPECT_CALL(*messageServerRaw,
@@ -313,7 +425,9 @@ TEST_F(CpuComDaemonTest, handleSendCommandMessageFailedTest)
 
     daemon.onSendCommand(mSessionSendId, mSendCommand, mSendRawData);
     daemon.start();
+    mTransmitCallable();
     mTaskCallable();
+    mDispatchCallable();
 }
 
 TEST_F(CpuComDaemonTest, handleSendCommandWithDeliveryStatusTest)
@@ -324,16 +438,27 @@ TEST_F(CpuComDaemonTest, handleSendCommandWithDeliveryStatusTest)
     NiceMock<MockICPU>* vcpuRaw = vcpu.get();
     auto periodicExecutor = std::make_unique<NiceMock<common::mock_IPeriodicTaskExecutor>>();
     NiceMock<common::mock_IPeriodicTaskExecutor>* periodicExecutorRaw = periodicExecutor.get();
+    auto dispatchExecutor = std::make_unique<NiceMock<common::mock_IPeriodicTaskExecutor>>();
+    NiceMock<common::mock_IPeriodicTaskExecutor>* dispatchExecutorRaw = dispatchExecutor.get();
+    auto transmitExecutor = std::make_unique<NiceMock<common::mock_IPeriodicTaskExecutor>>();
+    NiceMock<common::mock_IPeriodicTaskExecutor>* transmitExecutorRaw = transmitExecutor.get();
     auto subscribersMutexWrapper = std::make_unique<NiceMock<MockMutexWrapper>>();
     auto requestsMutexWrapper = std::make_unique<NiceMock<MockMutexWrapper>>();
 
     CpuComDaemon daemon{std::move(messageServer), std::move(vcpu), std::move(periodicExecutor),
+                        std::move(dispatchExecutor), std::move(transmitExecutor),
                         std::move(subscribersMutexWrapper), std::move(requestsMutexWrapper)};
 
     EXPECT_CALL(*vcpuRaw, initialize()).WillOnce(Return(true));
     EXPECT_CALL(*periodicExecutorRaw, submit(_, _))
         .WillOnce(DoAll(SaveArg<0>(&mTaskCallable), SaveArg<1>(&mPredicateCallable),
                         Return(ByMove(p.get_future()))));
+    EXPECT_CALL(*dispatchExecutorRaw, submit(_, _))
+        .WillOnce(DoAll(SaveArg<0>(&mDispatchCallable), SaveArg<1>(&mDispatchPredicateCallable),
+                        Return(ByMove(dispatchPromise.get_future()))));
+    EXPECT_CALL(*transmitExecutorRaw, submit(_, _))
+        .WillOnce(DoAll(SaveArg<0>(&mTransmitCallable), SaveArg<1>(&mTransmitPredicateCallable),
+                        Return(ByMove(transmitPromise.get_future()))));
     ON_CALL(*vcpuRaw, read(_)).WillByDefault(DoAll(SetArgReferee<0>(mRequestData), Return(true)));
     ON_CALL(*vcpuRaw, write(mSendCommand, mSendRawData)).WillByDefault(Return(true));
     ON_CALL(*messageServerRaw,
@@ -342,7 +467,472 @@ TEST_F(CpuComDaemonTest, handleSendCommandWithDeliveryStatusTest)
     daemon.onSendCommandWithDeliveryStatus(mSessionSendWithDeliveryStatusId, mSendUUID,
                                            mSendCommandWithDeliveryStatus, mSendRawData);
     daemon.start();
+    mTransmitCallable();
+    mTaskCallable();
+    mDispatchCallable();
+}
+
+TEST_F(CpuComDaemonTest, commandsAreRejectedWhenTransmitQueueIsFullTest)
+{
+    auto messageServer = std::make_unique<NiceMock<MockIMessageServer>>();
+    NiceMock<MockIMessageServer>* messageServerRaw = messageServer.get();
+    auto vcpu = std::make_unique<NiceMock<MockICPU>>();
+    NiceMock<MockICPU>* vcpuRaw = vcpu.get();
+    auto periodicExecutor = std::make_unique<NiceMock<common::mock_IPeriodicTaskExecutor>>();
+    auto dispatchExecutor = std::make_unique<NiceMock<common::mock_IPeriodicTaskExecutor>>();
+    auto transmitExecutor = std::make_unique<NiceMock<common::mock_IPeriodicTaskExecutor>>();
+    auto subscribersMutexWrapper = std::make_unique<NiceMock<MockMutexWrapper>>();
+    auto requestsMutexWrapper = std::make_unique<NiceMock<MockMutexWrapper>>();
+
+    CpuComDaemon daemon{std::move(messageServer), std::move(vcpu), std::move(periodicExecutor),
+                        std::move(dispatchExecutor), std::move(transmitExecutor),
+                        std::move(subscribersMutexWrapper), std::move(requestsMutexWrapper)};
+
+    // the transmit thread is not started, so nothing is taken from the queue
+    EXPECT_CALL(*vcpuRaw, write(_, _)).Times(0);
+    EXPECT_CALL(*messageServerRaw,
+                sendSendCommandResultMessage(mSessionSendId, mSendCommand, common::ERR_BUSY));
+    EXPECT_CALL(*messageServerRaw,
+                sendSendCommandResultMessage(mSessionRequestId, mRequestCommand, common::ERR_BUSY));
+    EXPECT_CALL(*messageServerRaw,
+                sendDeliveryStatusMessage(mSessionSendWithDeliveryStatusId, mSendUUID, false));
+
+    for (size_t i = 0; i < TransmitQueue::kDefaultCapacity + 1; ++i) {
+        daemon.onSendCommand(mSessionSendId, mSendCommand, mSendRawData);
+    }
+    daemon.onRequest(mSessionRequestId, mRequestUUID, mRequestCommand, mRequestRawData,
+                     mResponseCommand);
+    daemon.onSendCommandWithDeliveryStatus(mSessionSendWithDeliveryStatusId, mSendUUID,
+                                           mSendCommand, mSendRawData);
+    ::testing::Mock::VerifyAndClearExpectations(messageServerRaw);
+
+    // the queued commands are answered as not sent when the daemon stops
+    EXPECT_CALL(*messageServerRaw,
+                sendSendCommandResultMessage(mSessionSendId, mSendCommand, common::ERR_BUSY))
+        .Times(TransmitQueue::kDefaultCapacity);
+}
+
+TEST_F(CpuComDaemonTest, commandsAreRejectedWhenVcpuInitializeFailedTest)
+{
+    auto messageServer = std::make_unique<NiceMock<MockIMessageServer>>();
+    NiceMock<MockIMessageServer>* messageServerRaw = messageServer.get();
+    auto vcpu = std::make_unique<NiceMock<MockICPU>>();
+    NiceMock<MockICPU>* vcpuRaw = vcpu.get();
+    auto periodicExecutor = std::make_unique<NiceMock<common::mock_IPeriodicTaskExecutor>>();
+    auto dispatchExecutor = std::make_unique<NiceMock<common::mock_IPeriodicTaskExecutor>>();
+    auto transmitExecutor = std::make_unique<NiceMock<common::mock_IPeriodicTaskExecutor>>();
+    NiceMock<common::mock_IPeriodicTaskExecutor>* transmitExecutorRaw = transmitExecutor.get();
+    auto subscribersMutexWrapper = std::make_unique<NiceMock<MockMutexWrapper>>();
+    auto requestsMutexWrapper = std::make_unique<NiceMock<MockMutexWrapper>>();
+
+    CpuComDaemon daemon{std::move(messageServer), std::move(vcpu), std::move(periodicExecutor),
+                        std::move(dispatchExecutor), std::move(transmitExecutor),
+                        std::move(subscribersMutexWrapper), std::move(requestsMutexWrapper)};
+
+    EXPECT_CALL(*vcpuRaw, initialize()).WillOnce(Return(false));
+    EXPECT_CALL(*transmitExecutorRaw, submit(_, _)).Times(0);
+    EXPECT_CALL(*vcpuRaw, write(_, _)).Times(0);
+    EXPECT_CALL(*messageServerRaw,
+                sendSendCommandResultMessage(mSessionSendId, mSendCommand, common::ERR_BUSY));
+    EXPECT_CALL(*messageServerRaw,
+                sendDeliveryStatusMessage(mSessionSendWithDeliveryStatusId, mSendUUID, false));
+    std::vector<uint8_t> encodedTrace;
+    EXPECT_CALL(*messageServerRaw,
+                sendDeliveryTraceMessage(mSessionSendWithDeliveryStatusId, mSendUUID, false, _))
+        .WillOnce(SaveArg<3>(&encodedTrace));
+
+    daemon.start();
+    daemon.onSendCommand(mSessionSendId, mSendCommand, mSendRawData);
+    daemon.onSendCommandWithDeliveryStatus(mSessionSendWithDeliveryStatusId, mSendUUID,
+                                           mSendCommand, mSendRawData);
+    daemon.onSendCommandWithTrace(mSessionSendWithDeliveryStatusId, mSendUUID, mSendCommand,
+                                  mSendRawData, encodeSendTrace(SendTrace()));
+
+    SendTrace trace;
+    ASSERT_TRUE(decodeSendTrace(encodedTrace, trace));
+    EXPECT_NE(0u, trace.stamps[SendTrace::DaemonReceive]);
+    EXPECT_EQ(0u, trace.stamps[SendTrace::TransmitDequeue]);
+    EXPECT_NE(0u, trace.stamps[SendTrace::DeliveryStatusSent]);
+}
+
+TEST_F(CpuComDaemonTest, commandsAreSentByTransmitClassTest)
+{
+    auto messageServer = std::make_unique<NiceMock<MockIMessageServer>>();
+    auto vcpu = std::make_unique<NiceMock<MockICPU>>();
+    NiceMock<MockICPU>* vcpuRaw = vcpu.get();
+    auto periodicExecutor = std::make_unique<NiceMock<common::mock_IPeriodicTaskExecutor>>();
+    NiceMock<common::mock_IPeriodicTaskExecutor>* periodicExecutorRaw = periodicExecutor.get();
+    auto dispatchExecutor = std::make_unique<NiceMock<common::mock_IPeriodicTaskExecutor>>();
+    NiceMock<common::mock_IPeriodicTaskExecutor>* dispatchExecutorRaw = dispatchExecutor.get();
+    auto transmitExecutor = std::make_unique<NiceMock<common::mock_IPeriodicTaskExecutor>>();
+    NiceMock<common::mock_IPeriodicTaskExecutor>* transmitExecutorRaw = transmitExecutor.get();
+    auto subscribersMutexWrapper = std::make_unique<NiceMock<MockMutexWrapper>>();
+    auto requestsMutexWrapper = std::make_unique<NiceMock<MockMutexWrapper>>();
+    TransmitPolicy transmitPolicy;
+    transmitPolicy.classes = {{mSendCommand, TransmitClass::Bulk},
+                              {mRequestCommand, TransmitClass::Control}};
+
+    CpuComDaemon daemon{std::move(messageServer), std::move(vcpu), std::move(periodicExecutor),
+                        std::move(dispatchExecutor), std::move(transmitExecutor),
+                        std::move(subscribersMutexWrapper), std::move(requestsMutexWrapper),
+                        std::move(transmitPolicy)};
+
+    EXPECT_CALL(*vcpuRaw, initialize()).WillOnce(Return(true));
+    EXPECT_CALL(*periodicExecutorRaw, submit(_, _))
+        .WillOnce(DoAll(SaveArg<0>(&mTaskCallable), SaveArg<1>(&mPredicateCallable),
+                        Return(ByMove(p.get_future()))));
+    EXPECT_CALL(*dispatchExecutorRaw, submit(_, _))
+        .WillOnce(DoAll(SaveArg<0>(&mDispatchCallable), SaveArg<1>(&mDispatchPredicateCallable),
+                        Return(ByMove(dispatchPromise.get_future()))));
+    EXPECT_CALL(*transmitExecutorRaw, submit(_, _))
+        .WillOnce(DoAll(SaveArg<0>(&mTransmitCallable), SaveArg<1>(&mTransmitPredicateCallable),
+                        Return(ByMove(transmitPromise.get_future()))));
+    {
+        InSequence sequence;
+        EXPECT_CALL(*vcpuRaw, write(mRequestCommand, mRequestRawData)).WillOnce(Return(true));
+        EXPECT_CALL(*vcpuRaw, write(mSendCommandWithDeliveryStatus, mSendRawData))
+            .WillOnce(Return(true));
+        EXPECT_CALL(*vcpuRaw, write(mSendCommand, mSendRawData)).WillOnce(Return(true));
+    }
+
+    daemon.onSendCommand(mSessionSendId, mSendCommand, mSendRawData);
+    daemon.onSendCommand(mSessionSendId, mSendCommandWithDeliveryStatus, mSendRawData);
+    daemon.onRequest(mSessionRequestId, mRequestUUID, mRequestCommand, mRequestRawData,
+                     mResponseCommand);
+    daemon.start();
+    EXPECT_TRUE(mTransmitPredicateCallable());
+    mTransmitCallable();
+    mTransmitCallable();
+    mTransmitCallable();
+}
+
+TEST_F(CpuComDaemonTest, clientOverItsQuotaIsThrottledTest)
+{
+    auto messageServer = std::make_unique<NiceMock<MockIMessageServer>>();
+    NiceMock<MockIMessageServer>* messageServerRaw = messageServer.get();
+    auto vcpu = std::make_unique<NiceMock<MockICPU>>();
+    auto periodicExecutor = std::make_unique<NiceMock<common::mock_IPeriodicTaskExecutor>>();
+    auto dispatchExecutor = std::make_unique<NiceMock<common::mock_IPeriodicTaskExecutor>>();
+    auto transmitExecutor = std::make_unique<NiceMock<common::mock_IPeriodicTaskExecutor>>();
+    auto subscribersMutexWrapper = std::make_unique<NiceMock<MockMutexWrapper>>();
+    auto requestsMutexWrapper = std::make_unique<NiceMock<MockMutexWrapper>>();
+    TransmitPolicy transmitPolicy;
+    transmitPolicy.quota = {3, 0};
+
+    CpuComDaemon daemon{std::move(messageServer), std::move(vcpu), std::move(periodicExecutor),
+                        std::move(dispatchExecutor), std::move(transmitExecutor),
+                        std::move(subscribersMutexWrapper), std::move(requestsMutexWrapper),
+                        std::move(transmitPolicy)};
+
+    // unlike a full queue, a throttled client is told that it is over its quota
+    EXPECT_CALL(*messageServerRaw,
+                sendSendCommandResultMessage(mSessionSendId, mSendCommand, ERR_THROTTLED));
+    EXPECT_CALL(*messageServerRaw, sendSendCommandResultMessage(mSessionRequestId, _, _))
+        .Times(0);
+
+    daemon.onSendCommand(mSessionSendId, mSendCommand, mSendRawData);
+    daemon.onSendCommand(mSessionSendId, mSendCommand, mSendRawData);
+    // another client is not held back by it
+    daemon.onSendCommand(mSessionRequestId, mSendCommand, mSendRawData);
+    // nor is a client which reconnects with the same session
+    daemon.onClientDisconnected(mSessionSendId);
+    daemon.onSendCommand(mSessionSendId, mSendCommand, mSendRawData);
+    // the commands still queued are answered as not sent when the daemon stops
+    ::testing::Mock::VerifyAndClearExpectations(messageServerRaw);
+}
+
+TEST_F(CpuComDaemonTest, receivedCommandsAreDeliveredByDispatchThreadTest)
+{
+    auto messageServer = std::make_unique<NiceMock<MockIMessageServer>>();
+    NiceMock<MockIMessageServer>* messageServerRaw = messageServer.get();
+    auto vcpu = std::make_unique<NiceMock<MockICPU>>();
+    NiceMock<MockICPU>* vcpuRaw = vcpu.get();
+    auto periodicExecutor = std::make_unique<NiceMock<common::mock_IPeriodicTaskExecutor>>();
+    NiceMock<common::mock_IPeriodicTaskExecutor>* periodicExecutorRaw = periodicExecutor.get();
+    auto dispatchExecutor = std::make_unique<NiceMock<common::mock_IPeriodicTaskExecutor>>();
+    NiceMock<common::mock_IPeriodicTaskExecutor>* dispatchExecutorRaw = dispatchExecutor.get();
+    auto transmitExecutor = std::make_unique<NiceMock<common::mock_IPeriodicTaskExecutor>>();
+    auto subscribersMutexWrapper = std::make_unique<NiceMock<MockMutexWrapper>>();
+    auto requestsMutexWrapper = std::make_unique<NiceMock<MockMutexWrapper>>();
+
+    CpuComDaemon daemon{std::move(messageServer), std::move(vcpu), std::move(periodicExecutor),
+                        std::move(dispatchExecutor), std::move(transmitExecutor),
+                        std::move(subscribersMutexWrapper), std::move(requestsMutexWrapper)};
+
+    EXPECT_CALL(*vcpuRaw, initialize()).WillOnce(Return(true));
+    EXPECT_CALL(*periodicExecutorRaw, submit(_, _))
+        .WillOnce(DoAll(SaveArg<0>(&mTaskCallable), SaveArg<1>(&mPredicateCallable),
+                        Return(ByMove(p.get_future()))));
+    EXPECT_CALL(*dispatchExecutorRaw, submit(_, _))
+        .WillOnce(DoAll(SaveArg<0>(&mDispatchCallable), SaveArg<1>(&mDispatchPredicateCallable),
+                        Return(ByMove(dispatchPromise.get_future()))));
+    EXPECT_CALL(*vcpuRaw, read(_))
+        .Times(2)
+        .WillRepeatedly(DoAll(SetArgReferee<0>(mSubscribeData), Return(true)));
+
+    daemon.onSubscribe(mSessionSubscribeId, mSubscribeCommand);
+    daemon.start();
+    EXPECT_TRUE(mDispatchPredicateCallable());
+
+    // the receive thread only hands the commands over
+    EXPECT_CALL(*messageServerRaw, sendNotificationMessage(_, _, _, _)).Times(0);
+    mTaskCallable();
+    mTaskCallable();
+    ::testing::Mock::VerifyAndClearExpectations(messageServerRaw);
+
+    EXPECT_CALL(*messageServerRaw,
+                sendNotificationMessage(ElementsAre(mSessionSubscribeId), mSubscribeCommand,
+                                        mSubscribeRawData, _))
+        .Times(2);
+    mDispatchCallable();
+    mDispatchCallable();
+}
+
+TEST_F(CpuComDaemonTest, notificationIsSentToAllSubscribersAtOnceTest)
+{
+    auto messageServer = std::make_unique<NiceMock<MockIMessageServer>>();
+    NiceMock<MockIMessageServer>* messageServerRaw = messageServer.get();
+    auto vcpu = std::make_unique<NiceMock<MockICPU>>();
+    NiceMock<MockICPU>* vcpuRaw = vcpu.get();
+    auto periodicExecutor = std::make_unique<NiceMock<common::mock_IPeriodicTaskExecutor>>();
+    NiceMock<common::mock_IPeriodicTaskExecutor>* periodicExecutorRaw = periodicExecutor.get();
+    auto dispatchExecutor = std::make_unique<NiceMock<common::mock_IPeriodicTaskExecutor>>();
+    NiceMock<common::mock_IPeriodicTaskExecutor>* dispatchExecutorRaw = dispatchExecutor.get();
+    auto transmitExecutor = std::make_unique<NiceMock<common::mock_IPeriodicTaskExecutor>>();
+    auto subscribersMutexWrapper = std::make_unique<NiceMock<MockMutexWrapper>>();
+    auto requestsMutexWrapper = std::make_unique<NiceMock<MockMutexWrapper>>();
+
+    CpuComDaemon daemon{std::move(messageServer), std::move(vcpu), std::move(periodicExecutor),
+                        std::move(dispatchExecutor), std::move(transmitExecutor),
+                        std::move(subscribersMutexWrapper), std::move(requestsMutexWrapper)};
+
+    EXPECT_CALL(*vcpuRaw, initialize()).WillOnce(Return(true));
+    EXPECT_CALL(*periodicExecutorRaw, submit(_, _))
+        .WillOnce(DoAll(SaveArg<0>(&mTaskCallable), SaveArg<1>(&mPredicateCallable),
+                        Return(ByMove(p.get_future()))));
+    EXPECT_CALL(*dispatchExecutorRaw, submit(_, _))
+        .WillOnce(DoAll(SaveArg<0>(&mDispatchCallable), SaveArg<1>(&mDispatchPredicateCallable),
+                        Return(ByMove(dispatchPromise.get_future()))));
+    // nobody subscribes to the second one
+    EXPECT_CALL(*vcpuRaw, read(_))
+        .WillOnce(DoAll(SetArgReferee<0>(mSubscribeData), Return(true)))
+        .WillOnce(DoAll(SetArgReferee<0>(mRequestData), Return(true)));
+    EXPECT_CALL(*messageServerRaw,
+                sendNotificationMessage(
+                    UnorderedElementsAre(mSessionSubscribeId, mSessionRequestId, mSessionSendId),
+                    mSubscribeCommand, mSubscribeRawData, _));
+    EXPECT_CALL(*messageServerRaw, sendNotificationMessage(_, mRequestCommand, _, _)).Times(0);
+
+    daemon.onSubscribe(mSessionSubscribeId, mSubscribeCommand);
+    daemon.onSubscribe(mSessionRequestId, mSubscribeCommand);
+    daemon.onSubscribe(mSessionSendId, mSubscribeCommand);
+    daemon.onSubscribe(mSessionConnectId, mSubscribeCommand);
+    daemon.onUnsubscribe(mSessionConnectId, mSubscribeCommand);
+    daemon.start();
+    mTaskCallable();
+    mTaskCallable();
+    mDispatchCallable();
+    mDispatchCallable();
+}
+
+TEST_F(CpuComDaemonTest, requestWithoutResponseTimesOutTest)
+{
+    auto messageServer = std::make_unique<NiceMock<MockIMessageServer>>();
+    NiceMock<MockIMessageServer>* messageServerRaw = messageServer.get();
+    auto vcpu = std::make_unique<NiceMock<MockICPU>>();
+    NiceMock<MockICPU>* vcpuRaw = vcpu.get();
+    auto periodicExecutor = std::make_unique<NiceMock<common::mock_IPeriodicTaskExecutor>>();
+    NiceMock<common::mock_IPeriodicTaskExecutor>* periodicExecutorRaw = periodicExecutor.get();
+    auto dispatchExecutor = std::make_unique<NiceMock<common::mock_IPeriodicTaskExecutor>>();
+    NiceMock<common::mock_IPeriodicTaskExecutor>* dispatchExecutorRaw = dispatchExecutor.get();
+    auto transmitExecutor = std::make_unique<NiceMock<common::mock_IPeriodicTaskExecutor>>();
+    NiceMock<common::mock_IPeriodicTaskExecutor>* transmitExecutorRaw = transmitExecutor.get();
+    auto subscribersMutexWrapper = std::make_unique<NiceMock<MockMutexWrapper>>();
+    auto requestsMutexWrapper = std::make_unique<NiceMock<MockMutexWrapper>>();
+
+    CpuComDaemon daemon{std::move(messageServer),
+                        std::move(vcpu),
+                        std::move(periodicExecutor),
+                        std::move(dispatchExecutor),
+                        std::move(transmitExecutor),
+                        std::move(subscribersMutexWrapper),
+                        std::move(requestsMutexWrapper),
+                        TransmitPolicy(),
+                        std::chrono::milliseconds(1)};
+
+    EXPECT_CALL(*vcpuRaw, initialize()).WillOnce(Return(true));
+    EXPECT_CALL(*periodicExecutorRaw, submit(_, _))
+        .WillOnce(DoAll(SaveArg<0>(&mTaskCallable), SaveArg<1>(&mPredicateCallable),
+                        Return(ByMove(p.get_future()))));
+    EXPECT_CALL(*dispatchExecutorRaw, submit(_, _))
+        .WillOnce(DoAll(SaveArg<0>(&mDispatchCallable), SaveArg<1>(&mDispatchPredicateCallable),
+                        Return(ByMove(dispatchPromise.get_future()))));
+    EXPECT_CALL(*transmitExecutorRaw, submit(_, _))
+        .WillOnce(DoAll(SaveArg<0>(&mTransmitCallable), SaveArg<1>(&mTransmitPredicateCallable),
+                        Return(ByMove(transmitPromise.get_future()))));
+    EXPECT_CALL(*vcpuRaw, write(mRequestCommand, mRequestRawData)).WillOnce(Return(true));
+    EXPECT_CALL(*vcpuRaw, read(_)).WillOnce(DoAll(SetArgReferee<0>(mResponseData), Return(true)));
+    // the timeout, and no response for the one coming too late
+    EXPECT_CALL(*messageServerRaw, sendRequestTimeoutMessage(mSessionRequestId, mRequestUUID));
+    EXPECT_CALL(*messageServerRaw, sendRequestResponseMessage(_, _, _)).Times(0);
+
+    daemon.onRequest(mSessionRequestId, mRequestUUID, mRequestCommand, mRequestRawData,
+                     mResponseCommand);
+    daemon.start();
+    mTransmitCallable();
+    std::this_thread::sleep_for(std::chrono::milliseconds(30));
+    mDispatchCallable();
     mTaskCallable();
+    mDispatchCallable();
+}
+
+
+TEST_F(CpuComDaemonTest, identicalRequestsAreSentOnceTest)
+{
+    auto messageServer = std::make_unique<NiceMock<MockIMessageServer>>();
+    NiceMock<MockIMessageServer>* messageServerRaw = messageServer.get();
+    auto vcpu = std::make_unique<NiceMock<MockICPU>>();
+    NiceMock<MockICPU>* vcpuRaw = vcpu.get();
+    auto periodicExecutor = std::make_unique<NiceMock<common::mock_IPeriodicTaskExecutor>>();
+    NiceMock<common::mock_IPeriodicTaskExecutor>* periodicExecutorRaw = periodicExecutor.get();
+    auto dispatchExecutor = std::make_unique<NiceMock<common::mock_IPeriodicTaskExecutor>>();
+    NiceMock<common::mock_IPeriodicTaskExecutor>* dispatchExecutorRaw = dispatchExecutor.get();
+    auto transmitExecutor = std::make_unique<NiceMock<common::mock_IPeriodicTaskExecutor>>();
+    NiceMock<common::mock_IPeriodicTaskExecutor>* transmitExecutorRaw = transmitExecutor.get();
+    auto subscribersMutexWrapper = std::make_unique<NiceMock<MockMutexWrapper>>();
+    auto requestsMutexWrapper = std::make_unique<NiceMock<MockMutexWrapper>>();
+
+    CpuComDaemon daemon{std::move(messageServer), std::move(vcpu), std::move(periodicExecutor),
+                        std::move(dispatchExecutor), std::move(transmitExecutor),
+                        std::move(subscribersMutexWrapper), std::move(requestsMutexWrapper)};
+
+    EXPECT_CALL(*vcpuRaw, initialize()).WillOnce(Return(true));
+    EXPECT_CALL(*periodicExecutorRaw, submit(_, _))
+        .WillOnce(DoAll(SaveArg<0>(&mTaskCallable), SaveArg<1>(&mPredicateCallable),
+                        Return(ByMove(p.get_future()))));
+    EXPECT_CALL(*dispatchExecutorRaw, submit(_, _))
+        .WillOnce(DoAll(SaveArg<0>(&mDispatchCallable), SaveArg<1>(&mDispatchPredicateCallable),
+                        Return(ByMove(dispatchPromise.get_future()))));
+    EXPECT_CALL(*transmitExecutorRaw, submit(_, _))
+        .WillOnce(DoAll(SaveArg<0>(&mTransmitCallable), SaveArg<1>(&mTransmitPredicateCallable),
+                        Return(ByMove(transmitPromise.get_future()))));
+    EXPECT_CALL(*vcpuRaw, read(_)).WillOnce(DoAll(SetArgReferee<0>(mResponseData), Return(true)));
+    EXPECT_CALL(*vcpuRaw, write(mRequestCommand, mRequestRawData)).WillOnce(Return(true));
+    // the second request joins the first one, both get its response
+    EXPECT_CALL(*messageServerRaw,
+                sendRequestResponseMessage(mSessionRequestId, mRequestUUID, mRequestRawData));
+    EXPECT_CALL(*messageServerRaw,
+                sendRequestResponseMessage(mSessionSendId, mSendUUID, mRequestRawData));
+
+    daemon.onRequest(mSessionRequestId, mRequestUUID, mRequestCommand, mRequestRawData,
+                     mResponseCommand);
+    daemon.onRequest(mSessionSendId, mSendUUID, mRequestCommand, mRequestRawData,
+                     mResponseCommand);
+    daemon.start();
+    mTransmitCallable();
+    mTaskCallable();
+    mDispatchCallable();
+}
+
+TEST_F(CpuComDaemonTest, sendTraceIsStampedAtEachHopTest)
+{
+    auto messageServer = std::make_unique<NiceMock<MockIMessageServer>>();
+    NiceMock<MockIMessageServer>* messageServerRaw = messageServer.get();
+    auto vcpu = std::make_unique<NiceMock<MockICPU>>();
+    NiceMock<MockICPU>* vcpuRaw = vcpu.get();
+    auto periodicExecutor = std::make_unique<NiceMock<common::mock_IPeriodicTaskExecutor>>();
+    auto dispatchExecutor = std::make_unique<NiceMock<common::mock_IPeriodicTaskExecutor>>();
+    auto transmitExecutor = std::make_unique<NiceMock<common::mock_IPeriodicTaskExecutor>>();
+    NiceMock<common::mock_IPeriodicTaskExecutor>* transmitExecutorRaw = transmitExecutor.get();
+    auto subscribersMutexWrapper = std::make_unique<NiceMock<MockMutexWrapper>>();
+    auto requestsMutexWrapper = std::make_unique<NiceMock<MockMutexWrapper>>();
+
+    CpuComDaemon daemon{std::move(messageServer), std::move(vcpu), std::move(periodicExecutor),
+                        std::move(dispatchExecutor), std::move(transmitExecutor),
+                        std::move(subscribersMutexWrapper), std::move(requestsMutexWrapper)};
+
+    SendTrace sent;
+    sent.sequence = 42;
+    sent.stamps[SendTrace::ClientEnqueue] = monotonicNow();
+    SendTimes times;
+    times.enquiry = std::chrono::steady_clock::now();
+    times.acknowledgement2 = times.enquiry + std::chrono::milliseconds(2);
+
+    EXPECT_CALL(*vcpuRaw, initialize()).WillOnce(Return(true));
+    EXPECT_CALL(*transmitExecutorRaw, submit(_, _))
+        .WillOnce(DoAll(SaveArg<0>(&mTransmitCallable), SaveArg<1>(&mTransmitPredicateCallable),
+                        Return(ByMove(transmitPromise.get_future()))));
+    EXPECT_CALL(*vcpuRaw, write(mSendCommand, mSendRawData)).WillOnce(Return(true));
+    EXPECT_CALL(*vcpuRaw, lastSendTimes()).WillOnce(Return(times));
+    std::vector<uint8_t> encodedTrace;
+    EXPECT_CALL(*messageServerRaw, sendDeliveryTraceMessage(mSessionSendId, mSendUUID, true, _))
+        .WillOnce(SaveArg<3>(&encodedTrace));
+
+    daemon.start();
+    daemon.onSendCommandWithTrace(mSessionSendId, mSendUUID, mSendCommand, mSendRawData,
+                                  encodeSendTrace(sent));
+    mTransmitCallable();
+
+    SendTrace trace;
+    ASSERT_TRUE(decodeSendTrace(encodedTrace, trace));
+    EXPECT_EQ(42u, trace.sequence);
+    EXPECT_EQ(sent.stamps[SendTrace::ClientEnqueue], trace.stamps[SendTrace::ClientEnqueue]);
+    EXPECT_GE(trace.stamps[SendTrace::DaemonReceive], trace.stamps[SendTrace::ClientEnqueue]);
+    EXPECT_GE(trace.stamps[SendTrace::TransmitDequeue], trace.stamps[SendTrace::DaemonReceive]);
+    EXPECT_EQ(toSendTraceStamp(times.enquiry), trace.stamps[SendTrace::EnquirySent]);
+    EXPECT_EQ(2000000u,
+              trace.latency(SendTrace::EnquirySent, SendTrace::Acknowledgement2Received));
+    EXPECT_GE(trace.stamps[SendTrace::DeliveryStatusSent],
+              trace.stamps[SendTrace::TransmitDequeue]);
+}
+
+TEST_F(CpuComDaemonTest, statsAreSentOnRequestTest)
+{
+    auto messageServer = std::make_unique<NiceMock<MockIMessageServer>>();
+    NiceMock<MockIMessageServer>* messageServerRaw = messageServer.get();
+    auto vcpu = std::make_unique<NiceMock<MockICPU>>();
+    NiceMock<MockICPU>* vcpuRaw = vcpu.get();
+    auto periodicExecutor = std::make_unique<NiceMock<common::mock_IPeriodicTaskExecutor>>();
+    auto dispatchExecutor = std::make_unique<NiceMock<common::mock_IPeriodicTaskExecutor>>();
+    auto transmitExecutor = std::make_unique<NiceMock<common::mock_IPeriodicTaskExecutor>>();
+    NiceMock<common::mock_IPeriodicTaskExecutor>* transmitExecutorRaw = transmitExecutor.get();
+    auto subscribersMutexWrapper = std::make_unique<NiceMock<MockMutexWrapper>>();
+    auto requestsMutexWrapper = std::make_unique<NiceMock<MockMutexWrapper>>();
+    // recorded by the Protocols of the V-CPU
+    auto linkMetrics = std::make_shared<LinkMetrics>();
+    linkMetrics->onFrameSent(mSendCommand, 9, std::chrono::microseconds(800));
+
+    CpuComDaemon daemon{std::move(messageServer),
+                        std::move(vcpu),
+                        std::move(periodicExecutor),
+                        std::move(dispatchExecutor),
+                        std::move(transmitExecutor),
+                        std::move(subscribersMutexWrapper),
+                        std::move(requestsMutexWrapper),
+                        TransmitPolicy(),
+                        kDefaultRequestTimeout,
+                        linkMetrics};
+
+    EXPECT_CALL(*vcpuRaw, initialize()).WillOnce(Return(true));
+    EXPECT_CALL(*transmitExecutorRaw, submit(_, _))
+        .WillOnce(DoAll(SaveArg<0>(&mTransmitCallable), SaveArg<1>(&mTransmitPredicateCallable),
+                        Return(ByMove(transmitPromise.get_future()))));
+    EXPECT_CALL(*vcpuRaw, write(mSendCommand, mSendRawData)).WillOnce(Return(true));
+    std::string stats;
+    EXPECT_CALL(*messageServerRaw, sendStatsMessage(mSessionConnectId, _))
+        .WillOnce(SaveArg<1>(&stats));
+
+    daemon.start();
+    daemon.onSendCommand(mSessionSendId, mSendCommand, mSendRawData);
+    mTransmitCallable();
+    daemon.onStats(mSessionConnectId);
+
+    EXPECT_NE(std::string::npos, stats.find("0x04/0x04"));
+    EXPECT_NE(std::string::npos, stats.find("queue wait            1"));
+    EXPECT_NE(std::string::npos, stats.find("\nreceived 0, max occupancy 0, full 0"));
+    EXPECT_NE(std::string::npos, stats.find("\nnormal        0         1          1"));
+    EXPECT_NE(std::string::npos,
+              stats.find("\nsessionSendId                     1          2          1          0"));
 }
 
 }  // namespace impl
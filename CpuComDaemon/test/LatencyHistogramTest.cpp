@@ -0,0 +1,65 @@
+/*
+ * COPYRIGHT (C) 2024 MITSUBISHI ELECTRIC CORPORATION
+ * ALL RIGHTS RESERVED
+ */
+
+#include "LatencyHistogram.h"
+
+#include <gtest/gtest.h>
+
+namespace com {
+namespace mitsubishielectric {
+namespace ahu {
+namespace cpucom {
+namespace impl {
+
+TEST(LatencyHistogramTest, EmptyHistogramHasNoPercentiles)
+{
+    LatencyHistogram histogram;
+    EXPECT_EQ(0u, histogram.count());
+    EXPECT_EQ(0u, histogram.max());
+    EXPECT_EQ(0u, histogram.percentile(50));
+}
+
+TEST(LatencyHistogramTest, SmallValuesAreExact)
+{
+    LatencyHistogram histogram;
+    for (uint64_t value = 1; value <= 20; ++value) {
+        histogram.record(value);
+    }
+    EXPECT_EQ(20u, histogram.count());
+    EXPECT_EQ(10u, histogram.percentile(50));
+    EXPECT_EQ(19u, histogram.percentile(95));
+    EXPECT_EQ(20u, histogram.percentile(100));
+    EXPECT_EQ(1u, histogram.percentile(0));
+}
+
+TEST(LatencyHistogramTest, LargeValuesAreWithinASixteenth)
+{
+    LatencyHistogram histogram;
+    for (uint64_t value = 1000; value <= 100000; value += 1000) {
+        histogram.record(value);
+    }
+    const uint64_t median = histogram.percentile(50);
+    EXPECT_GE(median, 50000u);
+    EXPECT_LE(median, 50000u + (50000u / 16));
+    const uint64_t p99 = histogram.percentile(99);
+    EXPECT_GE(p99, 99000u);
+    EXPECT_LE(p99, 100000u);
+    EXPECT_EQ(100000u, histogram.max());
+}
+
+TEST(LatencyHistogramTest, HugeValuesAreCountedAsTheLargest)
+{
+    LatencyHistogram histogram;
+    histogram.record(UINT64_MAX);
+    EXPECT_EQ(1u, histogram.count());
+    EXPECT_EQ(LatencyHistogram::kMaxValue, histogram.max());
+    EXPECT_EQ(LatencyHistogram::kMaxValue, histogram.percentile(50));
+}
+
+}  // namespace impl
+}  // namespace cpucom
+}  // namespace ahu
+}  // namespace mitsubishielectric
+}  // namespace com
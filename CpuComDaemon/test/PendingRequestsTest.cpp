@@ -0,0 +1,185 @@
+/*
+ * COPYRIGHT (C) 2024 MITSUBISHI ELECTRIC CORPORATION
+ * ALL RIGHTS RESERVED
+ */
+
+#include "PendingRequests.h"
+
+#include <gtest/gtest.h>
+
+namespace com {
+namespace mitsubishielectric {
+namespace ahu {
+namespace cpucom {
+namespace impl {
+
+namespace {
+
+using std::chrono::milliseconds;
+
+const PendingRequests::Clock::time_point kStart;
+const milliseconds kTimeout(1000);
+const common::CpuCommand kRequestCommand = {0x10, 0x01};
+const std::vector<uint8_t> kData = {0x01, 0x02};
+const std::vector<uint8_t> kOtherData = {0x03};
+const common::CpuCommand kCommand = {0x11, 0x01};
+const common::CpuCommand kOtherCommand = {0x11, 0x02};
+const common::UUID kFirst("00000000-0000-0000-0000-000000000001");
+const common::UUID kSecond("00000000-0000-0000-0000-000000000002");
+const common::UUID kThird("00000000-0000-0000-0000-000000000003");
+const PendingRequests::SessionID kSession = "session";
+const PendingRequests::SessionID kOtherSession = "otherSession";
+
+}  // namespace
+
+class PendingRequestsTest : public ::testing::Test {
+protected:
+    PendingRequestsTest()
+        : m_requests(kTimeout, kStart)
+    {
+    }
+
+    PendingRequests m_requests;
+};
+
+TEST_F(PendingRequestsTest, IdenticalRequestsShareTransaction)
+{
+    m_requests.add({kFirst, kRequestCommand, kCommand, kSession}, kData, kStart);
+    m_requests.add({kSecond, kRequestCommand, kOtherCommand, kSession}, kData, kStart);
+    m_requests.add({kThird, kRequestCommand, kCommand, kOtherSession}, kData, kStart);
+    EXPECT_EQ(3u, m_requests.size());
+
+    std::vector<PendingRequest> requests;
+    EXPECT_TRUE(m_requests.take(kCommand, requests));
+    ASSERT_EQ(2u, requests.size());
+    EXPECT_EQ(kFirst, requests[0].id);
+    EXPECT_EQ(kSession, requests[0].sessionID);
+    EXPECT_EQ(kThird, requests[1].id);
+    EXPECT_EQ(kOtherSession, requests[1].sessionID);
+    EXPECT_FALSE(m_requests.take(kCommand, requests));
+    EXPECT_EQ(1u, m_requests.size());
+}
+
+TEST_F(PendingRequestsTest, TakesOldestTransactionOfCommand)
+{
+    EXPECT_FALSE(m_requests.add({kFirst, kRequestCommand, kCommand, kSession}, kData, kStart));
+    EXPECT_FALSE(
+        m_requests.add({kSecond, kRequestCommand, kCommand, kSession}, kOtherData, kStart));
+    EXPECT_FALSE(m_requests.add({kThird, kOtherCommand, kCommand, kSession}, kData, kStart));
+
+    std::vector<PendingRequest> requests;
+    EXPECT_TRUE(m_requests.take(kCommand, requests));
+    ASSERT_EQ(1u, requests.size());
+    EXPECT_EQ(kFirst, requests[0].id);
+    requests.clear();
+    EXPECT_TRUE(m_requests.take(kCommand, requests));
+    ASSERT_EQ(1u, requests.size());
+    EXPECT_EQ(kSecond, requests[0].id);
+    EXPECT_TRUE(m_requests.coalesced().empty());
+}
+
+TEST_F(PendingRequestsTest, CountsCoalescedRequests)
+{
+    EXPECT_FALSE(m_requests.add({kFirst, kRequestCommand, kCommand, kSession}, kData, kStart));
+    EXPECT_TRUE(m_requests.add({kSecond, kRequestCommand, kCommand, kSession}, kData, kStart));
+
+    // the transaction stays while a request waits for it
+    EXPECT_TRUE(m_requests.remove(kFirst));
+    EXPECT_TRUE(
+        m_requests.add({kThird, kRequestCommand, kCommand, kOtherSession}, kData, kStart));
+
+    std::vector<PendingRequest> requests;
+    EXPECT_TRUE(m_requests.take(kCommand, requests));
+    ASSERT_EQ(2u, requests.size());
+    EXPECT_EQ(kSecond, requests[0].id);
+    EXPECT_EQ(kThird, requests[1].id);
+    ASSERT_EQ(1u, m_requests.coalesced().size());
+    EXPECT_EQ(2u, m_requests.coalesced().at(kRequestCommand));
+
+    // one answered is not joined any more
+    EXPECT_FALSE(m_requests.add({kFirst, kRequestCommand, kCommand, kSession}, kData, kStart));
+}
+
+TEST_F(PendingRequestsTest, RemovesById)
+{
+    m_requests.add({kFirst, kRequestCommand, kCommand, kSession}, kData, kStart);
+    m_requests.add({kSecond, kRequestCommand, kCommand, kSession}, kData, kStart);
+
+    EXPECT_TRUE(m_requests.remove(kFirst));
+    EXPECT_FALSE(m_requests.remove(kFirst));
+    std::vector<PendingRequest> requests;
+    EXPECT_TRUE(m_requests.take(kCommand, requests));
+    ASSERT_EQ(1u, requests.size());
+    EXPECT_EQ(kSecond, requests[0].id);
+}
+
+TEST_F(PendingRequestsTest, SameIdReplacesRequest)
+{
+    m_requests.add({kFirst, kRequestCommand, kCommand, kSession}, kData, kStart);
+    m_requests.add({kFirst, kRequestCommand, kOtherCommand, kSession}, kData, kStart);
+    EXPECT_EQ(1u, m_requests.size());
+
+    std::vector<PendingRequest> requests;
+    EXPECT_FALSE(m_requests.take(kCommand, requests));
+    EXPECT_TRUE(m_requests.take(kOtherCommand, requests));
+}
+
+TEST_F(PendingRequestsTest, RemovesSession)
+{
+    m_requests.add({kFirst, kRequestCommand, kCommand, kSession}, kData, kStart);
+    m_requests.add({kSecond, kRequestCommand, kCommand, kOtherSession}, kData, kStart);
+    m_requests.add({kThird, kRequestCommand, kOtherCommand, kSession}, kData, kStart);
+
+    m_requests.removeSession(kSession);
+    m_requests.removeSession("unknown");
+    EXPECT_EQ(1u, m_requests.size());
+    std::vector<PendingRequest> requests;
+    EXPECT_TRUE(m_requests.take(kCommand, requests));
+    ASSERT_EQ(1u, requests.size());
+    EXPECT_EQ(kSecond, requests[0].id);
+}
+
+TEST_F(PendingRequestsTest, ExpiresAfterTimeout)
+{
+    m_requests.add({kFirst, kRequestCommand, kCommand, kSession}, kData, kStart);
+    m_requests.add({kSecond, kRequestCommand, kOtherCommand, kSession}, kData,
+                   kStart + milliseconds(100));
+    m_requests.add({kThird, kRequestCommand, kCommand, kSession}, kData,
+                   kStart + milliseconds(200));
+
+    EXPECT_TRUE(m_requests.expire(kStart + kTimeout - milliseconds(10)).empty());
+
+    // one answered or cancelled meanwhile does not expire
+    EXPECT_TRUE(m_requests.remove(kSecond));
+    const std::vector<PendingRequest> expired =
+        m_requests.expire(kStart + kTimeout + milliseconds(200));
+    ASSERT_EQ(2u, expired.size());
+    EXPECT_EQ(kFirst, expired[0].id);
+    EXPECT_EQ(kThird, expired[1].id);
+    EXPECT_EQ(0u, m_requests.size());
+
+    std::vector<PendingRequest> requests;
+    EXPECT_FALSE(m_requests.take(kCommand, requests));
+    ASSERT_EQ(1u, m_requests.timeouts().size());
+    EXPECT_EQ(2u, m_requests.timeouts().at(kCommand));
+}
+
+TEST_F(PendingRequestsTest, RequestsLeavingCancelTheirTimers)
+{
+    m_requests.add({kFirst, kRequestCommand, kCommand, kSession}, kData, kStart);
+    m_requests.add({kSecond, kRequestCommand, kOtherCommand, kSession}, kData, kStart);
+    m_requests.add({kThird, kRequestCommand, kCommand, kOtherSession}, kOtherData, kStart);
+    EXPECT_EQ(3u, m_requests.timers());
+
+    std::vector<PendingRequest> requests;
+    EXPECT_TRUE(m_requests.take(kCommand, requests));
+    EXPECT_TRUE(m_requests.remove(kSecond));
+    m_requests.removeSession(kOtherSession);
+    EXPECT_EQ(0u, m_requests.timers());
+}
+
+}  // namespace impl
+}  // namespace cpucom
+}  // namespace ahu
+}  // namespace mitsubishielectric
+}  // namespace com
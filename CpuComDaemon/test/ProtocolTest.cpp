@@ -9,9 +9,14 @@
 #include "Checksum.h"
 
 #include "CpuComDaemonLog.h"
+#include "MockLineDevice.h"
+#include "MockRetryPolicy.h"
 #include "Protocol.h"
+#include "ProtocolStates.h"
 #include "mock/mock_IODevice.h"
 
+#include <algorithm>
+#include <functional>
 #include <iterator>
 
 namespace com {
@@ -26,9 +31,12 @@ using common::mock_IODevice;
 using ::testing::_;
 using ::testing::AtLeast;
 using ::testing::InSequence;
+using ::testing::Invoke;
+using ::testing::InvokeWithoutArgs;
 using ::testing::NiceMock;
 using ::testing::Return;
 using ::testing::SetArgPointee;
+using ::testing::SetArgReferee;
 using ::testing::SetArrayArgument;
 
 namespace {
@@ -37,6 +45,13 @@ const int32_t kCmdLength = 3;
 const int32_t kExtLenLength = 3;
 const int32_t kFrameNumberLength = 2;
 const int32_t kTotalFramesLength = 2;
+
+ACTION_P(ReceiveByte, byte)
+{
+    *arg0 = byte;
+    arg3 = 1;
+    return IODevice::Result::Success;
+}
 }  // namespace
 
 class ProtocolTest : public ::testing::Test {
@@ -193,7 +208,149 @@ TEST_F(ProtocolTest, SendingFrame)
     }
 
     Protocol protocol(std::move(device));
+    const auto before = std::chrono::steady_clock::now();
     protocol.send(m_regularMessage);
+
+    const SendTimes& times = protocol.lastSendTimes();
+    EXPECT_GE(times.enquiry, before);
+    EXPECT_GE(times.acknowledgement2, times.enquiry);
+
+    const LinkMetrics::Snapshot metrics = protocol.linkMetrics().snapshot();
+    const common::CpuCommand command(m_regularMessage[0], m_regularMessage[1]);
+    ASSERT_EQ(1u, metrics.commands.count(command));
+    EXPECT_EQ(1u, metrics.commands.at(command).framesSent);
+    EXPECT_EQ(m_regularMessageFrame.size(), metrics.commands.at(command).bytesSent);
+    EXPECT_EQ(0u, metrics.commands.at(command).retries);
+    EXPECT_EQ(1u, metrics.wire.count());
+    EXPECT_EQ(1u, metrics.handshake.count());
+    EXPECT_EQ(1u, metrics.sendDwell[sending::Ack2].count());
+
+    const std::vector<FlightRecorder::Transition> transitions =
+        protocol.flightRecorder().transitions();
+    ASSERT_FALSE(transitions.empty());
+    EXPECT_EQ(sending::Idle, transitions.front().state);
+    EXPECT_EQ(sending::End, transitions.back().state);
+    for (const FlightRecorder::Transition& transition : transitions) {
+        EXPECT_EQ(FlightRecorder::Sending, transition.machine);
+        if (transition.state == sending::Ack2) {
+            EXPECT_EQ(static_cast<uint8_t>(ACK), transition.byte);
+        }
+    }
+}
+
+TEST_F(ProtocolTest, SendingFrameWaitsWithTimeoutsOfProfile)
+{
+    TimeoutProfile profile = kDefaultTimeoutProfile;
+    profile.response = std::chrono::milliseconds(7);
+    profile.baudRate = 0;
+
+    std::unique_ptr<mock_IODevice> device(new NiceMock<mock_IODevice>());
+    {
+        InSequence sequence;
+        EXPECT_CALL(*device, read(_, _)).Times(1).WillOnce(Return(IODevice::Result::Timeout));
+        EXPECT_CALL(*device, write(ENQ))
+            .Times(1)
+            .WillOnce(Return(std::make_pair(IODevice::Result::Success, 1)));
+        EXPECT_CALL(*device, read(_, std::chrono::milliseconds(7)))
+            .Times(1)
+            .WillOnce(DoAll(SetArgPointee<0>(static_cast<uint8_t>(ACK)),
+                            Return(IODevice::Result::Success)));
+        EXPECT_CALL(*device, write(_, _))
+            .Times(1)
+            .WillOnce(Return(std::make_pair(IODevice::Result::Success, 1)));
+        EXPECT_CALL(*device, read(_, std::chrono::milliseconds(7)))
+            .Times(1)
+            .WillOnce(DoAll(SetArgPointee<0>(static_cast<uint8_t>(ACK)),
+                            Return(IODevice::Result::Success)));
+    }
+
+    Protocol protocol(std::move(device));
+    protocol.setTimeoutProfile(profile);
+    EXPECT_TRUE(protocol.send(m_regularMessage));
+}
+
+TEST_F(ProtocolTest, SendingFrameWithLineDeviceWaitsWithTimeoutsOfProfile)
+{
+    TimeoutProfile profile = kDefaultTimeoutProfile;
+    profile.field = std::chrono::milliseconds(9);
+    profile.baudRate = 0;
+
+    std::unique_ptr<MockLineDevice> device(new NiceMock<MockLineDevice>());
+    {
+        InSequence sequence;
+        EXPECT_CALL(*device, write(ENQ))
+            .Times(1)
+            .WillOnce(Return(std::make_pair(IODevice::Result::Success, 1)));
+        EXPECT_CALL(*device, readAvailable(_, 1, _, _)).Times(1).WillOnce(ReceiveByte(ACK));
+        // a stalled write of the frame is given up after T4
+        EXPECT_CALL(*device, writeVector(_, _, std::chrono::milliseconds(9)))
+            .Times(1)
+            .WillOnce(Return(IODevice::Result::Success));
+        EXPECT_CALL(*device, readAvailable(_, 1, _, _)).Times(1).WillOnce(ReceiveByte(ACK));
+    }
+
+    Protocol protocol(std::move(device));
+    protocol.setTimeoutProfile(profile);
+    EXPECT_TRUE(protocol.send(m_regularMessage));
+}
+
+TEST_F(ProtocolTest, ReceivingFrameWaitsWithTimeoutsOfProfile)
+{
+    TimeoutProfile profile = kDefaultTimeoutProfile;
+    profile.response = std::chrono::milliseconds(7);
+    profile.field = std::chrono::milliseconds(3);
+    profile.baudRate = 0;
+
+    std::unique_ptr<mock_IODevice> device(new NiceMock<mock_IODevice>());
+    const std::chrono::milliseconds field(3);
+    {
+        InSequence sequence;
+        EXPECT_CALL(*device, poll(_)).Times(1).WillOnce(Return(IODevice::Result::Success));
+        EXPECT_CALL(*device, read(_, _))
+            .Times(2)
+            .WillOnce(DoAll(SetArgPointee<0>(static_cast<uint8_t>(ENQ)),
+                            Return(IODevice::Result::Success)))
+            .WillOnce(Return(IODevice::Result::Timeout));
+        EXPECT_CALL(*device, write(ACK))
+            .Times(1)
+            .WillOnce(Return(std::make_pair(IODevice::Result::Success, 1)));
+        EXPECT_CALL(*device, read(_, std::chrono::milliseconds(7)))
+            .Times(1)
+            .WillOnce(DoAll(SetArgPointee<0>(static_cast<uint8_t>(STX)),
+                            Return(IODevice::Result::Success)));
+        EXPECT_CALL(*device, read(_, field))
+            .Times(1)
+            .WillOnce(DoAll(SetArgPointee<0>(static_cast<uint8_t>(m_regularMessageProtocolLength)),
+                            Return(IODevice::Result::Success)));
+        EXPECT_CALL(*device, readMulti(_, kCmdLength, field))
+            .Times(1)
+            .WillOnce(DoAll(SetArrayArgument<0>(m_regularMessage.begin(),
+                                                std::next(m_regularMessage.begin(), kCmdLength)),
+                            Return(IODevice::Result::Success)));
+        EXPECT_CALL(*device, readMulti(_, m_regularMessage.size() - kCmdLength, field))
+            .Times(1)
+            .WillOnce(DoAll(SetArrayArgument<0>(std::next(m_regularMessage.begin(), kCmdLength),
+                                                m_regularMessage.end()),
+                            Return(IODevice::Result::Success)));
+        EXPECT_CALL(*device, read(_, field))
+            .Times(1)
+            .WillOnce(DoAll(SetArgPointee<0>(static_cast<uint8_t>(ETX)),
+                            Return(IODevice::Result::Success)));
+        EXPECT_CALL(*device, read(_, field))
+            .Times(1)
+            .WillOnce(
+                DoAll(SetArgPointee<0>(static_cast<uint8_t>(m_regularMessageProtocolChecksum)),
+                      Return(IODevice::Result::Success)));
+        EXPECT_CALL(*device, write(ACK))
+            .Times(1)
+            .WillOnce(Return(std::make_pair(IODevice::Result::Success, 1)));
+    }
+
+    Protocol protocol(std::move(device));
+    protocol.setTimeoutProfile(profile);
+    std::vector<uint8_t> data;
+    EXPECT_TRUE(protocol.receive(data));
+    EXPECT_EQ(m_regularMessage, data);
 }
 
 TEST_F(ProtocolTest, SendingFrameErrorResend)
@@ -300,6 +457,100 @@ TEST_F(ProtocolTest, SendFrameRetryPermanentError)
     ASSERT_EQ(protocol.send(m_regularMessage), false);
 }
 
+TEST_F(ProtocolTest, SendRetryFollowsRetryPolicy)
+{
+    std::unique_ptr<mock_IODevice> device(new NiceMock<mock_IODevice>());
+    std::unique_ptr<MockRetryPolicy> policy(new MockRetryPolicy());
+    {
+        InSequence sequence;
+        EXPECT_CALL(*device, open(IODevice::OpenMode::ReadWrite)).Times(1);
+        EXPECT_CALL(*device, read(_, _)).Times(1).WillOnce(Return(IODevice::Result::Error));
+        EXPECT_CALL(*policy, onFailure(1))
+            .Times(1)
+            .WillOnce(Return(RetryDecision{true, std::chrono::milliseconds(0), true}));
+        EXPECT_CALL(*device, close()).Times(1);
+        EXPECT_CALL(*device, open(IODevice::OpenMode::ReadWrite)).Times(1);
+        EXPECT_CALL(*device, read(_, _)).Times(1).WillOnce(Return(IODevice::Result::Error));
+        EXPECT_CALL(*policy, onFailure(2))
+            .Times(1)
+            .WillOnce(Return(RetryDecision{false, std::chrono::milliseconds(0), false}));
+        EXPECT_CALL(*device, close()).Times(1);
+    }
+    EXPECT_CALL(*policy, onSuccess(_)).Times(0);
+
+    Protocol protocol(std::move(device));
+    protocol.setRetryPolicy(std::move(policy));
+    EXPECT_FALSE(protocol.send(m_regularMessage));
+
+    const RetryStatistics::Entries entries = protocol.retryStatistics().entries();
+    ASSERT_EQ(1u, entries.size());
+    const RetryStatistics::Entry& entry = entries.at(common::CpuCommand(1, 2));
+    EXPECT_EQ(1u, entry.retriedMessages);
+    EXPECT_EQ(1u, entry.failedMessages);
+    EXPECT_EQ(2u, entry.failedAttempts);
+    EXPECT_EQ(2u, entry.maxFailedAttempts);
+}
+
+TEST_F(ProtocolTest, SendRetryReportsSuccessToRetryPolicy)
+{
+    std::unique_ptr<mock_IODevice> device(new NiceMock<mock_IODevice>());
+    std::unique_ptr<MockRetryPolicy> policy(new MockRetryPolicy());
+    {
+        InSequence sequence;
+        EXPECT_CALL(*device, read(_, _)).Times(1).WillOnce(Return(IODevice::Result::Error));
+        EXPECT_CALL(*policy, onFailure(1))
+            .Times(1)
+            .WillOnce(Return(RetryDecision{true, std::chrono::milliseconds(1), false}));
+        EXPECT_CALL(*device, read(_, _)).Times(1).WillOnce(Return(IODevice::Result::Timeout));
+        EXPECT_CALL(*device, write(ENQ))
+            .Times(1)
+            .WillOnce(Return(std::make_pair(IODevice::Result::Success, 1)));
+        EXPECT_CALL(*device, read(_, _))
+            .Times(1)
+            .WillOnce(DoAll(SetArgPointee<0>(static_cast<uint8_t>(ACK)),
+                            Return(IODevice::Result::Success)));
+        EXPECT_CALL(*device, write(_, _))
+            .Times(1)
+            .WillOnce(Return(std::make_pair(IODevice::Result::Success, 1)));
+        EXPECT_CALL(*device, read(_, _))
+            .Times(1)
+            .WillOnce(DoAll(SetArgPointee<0>(static_cast<uint8_t>(ACK)),
+                            Return(IODevice::Result::Success)));
+        EXPECT_CALL(*policy, onSuccess(1)).Times(1);
+        // a message sent at the first attempt is not recorded
+        EXPECT_CALL(*device, read(_, _)).Times(1).WillOnce(Return(IODevice::Result::Timeout));
+        EXPECT_CALL(*device, write(ENQ))
+            .Times(1)
+            .WillOnce(Return(std::make_pair(IODevice::Result::Success, 1)));
+        EXPECT_CALL(*device, read(_, _))
+            .Times(1)
+            .WillOnce(DoAll(SetArgPointee<0>(static_cast<uint8_t>(ACK)),
+                            Return(IODevice::Result::Success)));
+        EXPECT_CALL(*device, write(_, _))
+            .Times(1)
+            .WillOnce(Return(std::make_pair(IODevice::Result::Success, 1)));
+        EXPECT_CALL(*device, read(_, _))
+            .Times(1)
+            .WillOnce(DoAll(SetArgPointee<0>(static_cast<uint8_t>(ACK)),
+                            Return(IODevice::Result::Success)));
+        EXPECT_CALL(*policy, onSuccess(0)).Times(1);
+    }
+
+    Protocol protocol(std::move(device));
+    protocol.setRetryPolicy(std::move(policy));
+    EXPECT_TRUE(protocol.send(m_regularMessage));
+    EXPECT_TRUE(protocol.send(m_regularMessage));
+
+    const RetryStatistics::Entries entries = protocol.retryStatistics().entries();
+    ASSERT_EQ(1u, entries.size());
+    const RetryStatistics::Entry& entry = entries.at(common::CpuCommand(1, 2));
+    EXPECT_EQ(1u, entry.retriedMessages);
+    EXPECT_EQ(0u, entry.failedMessages);
+    EXPECT_EQ(1u, entry.failedAttempts);
+    EXPECT_GE(entry.retryTime, std::chrono::milliseconds(1));
+    EXPECT_EQ(entry.retryTime, entry.maxRetryTime);
+}
+
 TEST_F(ProtocolTest, SendRetryEnquiryAfterError)
 {
     std::unique_ptr<mock_IODevice> device(new mock_IODevice());
@@ -481,9 +732,15 @@ TEST_F(ProtocolTest, ReceivingFrame)
     }
 
     Protocol protocol(std::move(device));
+    const auto before = std::chrono::steady_clock::now();
     std::vector<uint8_t> data;
-    protocol.receive(data);
+    EXPECT_TRUE(protocol.receive(data));
     EXPECT_EQ(std::equal(data.begin(), data.end(), m_regularMessage.begin()), true);
+    EXPECT_EQ(m_regularMessage, data);
+
+    const ReceiveTimes& times = protocol.lastReceiveTimes();
+    EXPECT_GE(times.frameStart, before);
+    EXPECT_GE(times.frameChecked, times.frameStart);
 }
 
 TEST_F(ProtocolTest, ReceivingStartTextWithError)
@@ -516,6 +773,7 @@ TEST_F(ProtocolTest, ReceivingStartTextWithError)
     std::vector<uint8_t> data;
     protocol.receive(data);
     EXPECT_EQ(std::equal(data.begin(), data.end(), m_regularMessage.begin()), true);
+    EXPECT_EQ(std::chrono::steady_clock::time_point(), protocol.lastReceiveTimes().frameChecked);
 }
 
 TEST_F(ProtocolTest, ReceivingPollingWithError)
@@ -537,6 +795,26 @@ TEST_F(ProtocolTest, ReceivingPollingWithError)
     EXPECT_EQ(std::equal(data.begin(), data.end(), m_regularMessage.begin()), true);
 }
 
+TEST_F(ProtocolTest, ReceivingPollingRechecksInputOfSharedLine)
+{
+    std::unique_ptr<MockLineDevice> device(new NiceMock<MockLineDevice>());
+    {
+        InSequence sequence;
+        // send() may read ahead on the same line, so polling never waits for good
+        EXPECT_CALL(*device, poll(kDefaultTimeoutProfile.retry))
+            .Times(2)
+            .WillRepeatedly(Return(IODevice::Result::Timeout));
+        EXPECT_CALL(*device, poll(kDefaultTimeoutProfile.retry))
+            .Times(1)
+            .WillOnce(Return(IODevice::Result::Error));
+    }
+    EXPECT_CALL(*device, drain(_, _)).Times(0);
+
+    Protocol protocol(std::move(device));
+    std::vector<uint8_t> data;
+    EXPECT_FALSE(protocol.receive(data));
+}
+
 TEST_F(ProtocolTest, ReceivingEnquiryWithTimeoutOrError)
 {
     std::unique_ptr<mock_IODevice> device(new mock_IODevice());
@@ -795,6 +1073,112 @@ TEST_F(ProtocolTest, ReceivingFrameAfterSeveralEnquiries)
     EXPECT_EQ(std::equal(data.begin(), data.end(), m_regularMessage.begin()), true);
 }
 
+TEST_F(ProtocolTest, ReceivingFrameAfterGarbageBurst)
+{
+    const int kBurstLength = 1000;
+    std::unique_ptr<mock_IODevice> device(new NiceMock<mock_IODevice>());
+    {
+        InSequence sequence;
+        EXPECT_CALL(*device, poll(_)).Times(1).WillOnce(Return(IODevice::Result::Success));
+        EXPECT_CALL(*device, read(_, _))
+            .Times(kBurstLength)
+            .WillRepeatedly(DoAll(SetArgPointee<0>(static_cast<uint8_t>(0xff)),
+                                  Return(IODevice::Result::Success)));
+        EXPECT_CALL(*device, read(_, _))
+            .Times(2)
+            .WillOnce(DoAll(SetArgPointee<0>(static_cast<uint8_t>(ENQ)),
+                            Return(IODevice::Result::Success)))
+            .WillOnce(Return(IODevice::Result::Timeout));
+        EXPECT_CALL(*device, write(ACK))
+            .Times(1)
+            .WillOnce(Return(std::make_pair(IODevice::Result::Success, 1)));
+        EXPECT_CALL(*device, read(_, _))
+            .Times(2)
+            .WillOnce(DoAll(SetArgPointee<0>(static_cast<uint8_t>(STX)),
+                            Return(IODevice::Result::Success)))
+            .WillOnce(DoAll(SetArgPointee<0>(static_cast<uint8_t>(m_regularMessageProtocolLength)),
+                            Return(IODevice::Result::Success)));
+        EXPECT_CALL(*device, readMulti(_, kCmdLength, _))
+            .Times(1)
+            .WillOnce(DoAll(SetArrayArgument<0>(m_regularMessage.begin(),
+                                                std::next(m_regularMessage.begin(), kCmdLength)),
+                            Return(IODevice::Result::Success)));
+        EXPECT_CALL(*device, readMulti(_, m_regularMessage.size() - kCmdLength, _))
+            .Times(1)
+            .WillOnce(DoAll(SetArrayArgument<0>(std::next(m_regularMessage.begin(), kCmdLength),
+                                                m_regularMessage.end()),
+                            Return(IODevice::Result::Success)));
+        EXPECT_CALL(*device, read(_, _))
+            .Times(2)
+            .WillOnce(DoAll(SetArgPointee<0>(static_cast<uint8_t>(ETX)),
+                            Return(IODevice::Result::Success)))
+            .WillOnce(
+                DoAll(SetArgPointee<0>(static_cast<uint8_t>(m_regularMessageProtocolChecksum)),
+                      Return(IODevice::Result::Success)));
+        EXPECT_CALL(*device, write(ACK))
+            .Times(1)
+            .WillOnce(Return(std::make_pair(IODevice::Result::Success, 1)));
+    }
+
+    Protocol protocol(std::move(device));
+    std::vector<uint8_t> data;
+    EXPECT_TRUE(protocol.receive(data));
+    EXPECT_EQ(m_regularMessage, data);
+}
+
+TEST_F(ProtocolTest, ReceivingEnquiryAfterGarbageBurstWithLineDevice)
+{
+    std::unique_ptr<MockLineDevice> device(new NiceMock<MockLineDevice>());
+    {
+        InSequence sequence;
+        EXPECT_CALL(*device, poll(_)).Times(1).WillOnce(Return(IODevice::Result::Success));
+        // the whole burst is discarded by one call, its last byte is NAK
+        EXPECT_CALL(*device, drain(_, _))
+            .Times(1)
+            .WillOnce(DoAll(SetArgReferee<0>(ILineDevice::DrainTail{{0xff, NAK}}),
+                            SetArgReferee<1>(8192u), Return(IODevice::Result::Success)));
+        EXPECT_CALL(*device, poll(_)).Times(1).WillOnce(Return(IODevice::Result::Success));
+        EXPECT_CALL(*device, drain(_, _))
+            .Times(1)
+            .WillOnce(DoAll(SetArgReferee<0>(ILineDevice::DrainTail{{0xff, ENQ}}),
+                            SetArgReferee<1>(8192u), Return(IODevice::Result::Success)));
+        EXPECT_CALL(*device, write(ACK))
+            .Times(1)
+            .WillOnce(Return(std::make_pair(IODevice::Result::Success, 1)));
+        EXPECT_CALL(*device, readAvailable(_, _, _, _))
+            .Times(1)
+            .WillOnce(Return(IODevice::Result::Error));
+    }
+    EXPECT_CALL(*device, read(_, _)).Times(0);
+
+    Protocol protocol(std::move(device));
+    std::vector<uint8_t> data;
+    EXPECT_FALSE(protocol.receive(data));
+}
+
+TEST_F(ProtocolTest, SendingFrameAfterGarbageBurstWithLineDevice)
+{
+    std::unique_ptr<MockLineDevice> device(new NiceMock<MockLineDevice>());
+    {
+        InSequence sequence;
+        EXPECT_CALL(*device, drain(_, _))
+            .Times(1)
+            .WillOnce(DoAll(SetArgReferee<1>(8192u), Return(IODevice::Result::Success)));
+        EXPECT_CALL(*device, write(ENQ))
+            .Times(1)
+            .WillOnce(Return(std::make_pair(IODevice::Result::Success, 1)));
+        EXPECT_CALL(*device, readAvailable(_, 1, _, _)).Times(1).WillOnce(ReceiveByte(ACK));
+        EXPECT_CALL(*device, writeVector(_, _, _))
+            .Times(1)
+            .WillOnce(Return(IODevice::Result::Success));
+        EXPECT_CALL(*device, readAvailable(_, 1, _, _)).Times(1).WillOnce(ReceiveByte(ACK));
+    }
+    EXPECT_CALL(*device, read(_, _)).Times(0);
+
+    Protocol protocol(std::move(device));
+    EXPECT_TRUE(protocol.send(m_regularMessage));
+}
+
 // 6.3.3 Receiving other than ENQ in idle state
 TEST_F(ProtocolTest, ReceivingOtherThanEnquiryInIdleState)
 {
@@ -1460,6 +1844,14 @@ TEST_F(ProtocolTest, ProtocolDeniesFrameIfChecksumsDoNotMatch)
     std::vector<uint8_t> data;
     protocol.receive(data);
     EXPECT_EQ(std::equal(data.begin(), data.end(), m_regularMessage.begin()), true);
+
+    const LinkMetrics::Snapshot metrics = protocol.linkMetrics().snapshot();
+    const common::CpuCommand command(m_regularMessage[0], m_regularMessage[1]);
+    ASSERT_EQ(1u, metrics.commands.count(command));
+    EXPECT_EQ(1u, metrics.commands.at(command).checksumMismatches);
+    EXPECT_EQ(1u, metrics.commands.at(command).framesReceived);
+    EXPECT_EQ(m_regularMessageFrame.size(), metrics.commands.at(command).bytesReceived);
+    EXPECT_EQ(1u, metrics.naksSent);
 }
 
 TEST_F(ProtocolTest, ReceivingChecksumWithTimeoutOrError)
@@ -1922,8 +2314,9 @@ TEST_F(ProtocolTest, ReceivingExtendedLengthFrame)
 
     Protocol protocol(std::move(device));
     std::vector<uint8_t> data;
-    protocol.receive(data);
+    EXPECT_TRUE(protocol.receive(data));
     EXPECT_EQ(std::equal(data.begin(), data.end(), m_extendedLengthMessage.begin()), true);
+    EXPECT_EQ(m_extendedLengthMessage, data);
 }
 
 TEST_F(ProtocolTest, ReceivingExtendedLengthFrameWithTimeoutOrError)
@@ -2056,6 +2449,230 @@ TEST_F(ProtocolTest, SendingFrameDivisionFrames)
     protocol.send(m_frameDivisionMessage);
 }
 
+TEST_F(ProtocolTest, SendingFrameDivisionFramesWithGatherWrite)
+{
+    std::unique_ptr<MockLineDevice> device(new NiceMock<MockLineDevice>());
+    std::vector<std::vector<uint8_t>> written;
+    auto writeVector = [&written](const struct iovec* iov, int count, std::chrono::milliseconds) {
+        std::vector<uint8_t> frame;
+        for (int i = 0; i < count; ++i) {
+            const uint8_t* base = static_cast<const uint8_t*>(iov[i].iov_base);
+            frame.insert(frame.end(), base, base + iov[i].iov_len);
+        }
+        written.push_back(frame);
+        return IODevice::Result::Success;
+    };
+    {
+        InSequence sequence;
+        EXPECT_CALL(*device, drain(_, _)).Times(1).WillOnce(Return(IODevice::Result::Timeout));
+        EXPECT_CALL(*device, write(ENQ))
+            .Times(1)
+            .WillOnce(Return(std::make_pair(IODevice::Result::Success, 1)));
+        EXPECT_CALL(*device, readAvailable(_, 1, _, _)).Times(1).WillOnce(ReceiveByte(ACK));
+        EXPECT_CALL(*device, writeVector(_, _, _)).Times(1).WillOnce(Invoke(writeVector));
+        EXPECT_CALL(*device, readAvailable(_, 1, _, _)).Times(1).WillOnce(ReceiveByte(ACK));
+
+        EXPECT_CALL(*device, drain(_, _)).Times(1).WillOnce(Return(IODevice::Result::Timeout));
+        EXPECT_CALL(*device, write(ENQ))
+            .Times(1)
+            .WillOnce(Return(std::make_pair(IODevice::Result::Success, 1)));
+        EXPECT_CALL(*device, readAvailable(_, 1, _, _)).Times(1).WillOnce(ReceiveByte(ACK));
+        EXPECT_CALL(*device, writeVector(_, _, _)).Times(1).WillOnce(Invoke(writeVector));
+        EXPECT_CALL(*device, readAvailable(_, 1, _, _)).Times(1).WillOnce(ReceiveByte(ACK));
+    }
+    EXPECT_CALL(*device, write(_, _)).Times(0);
+
+    Protocol protocol(std::move(device));
+    EXPECT_TRUE(protocol.send(m_frameDivisionMessage));
+    ASSERT_EQ(2u, written.size());
+    EXPECT_EQ(m_frameDivisionMessageFrame1, written[0]);
+    EXPECT_EQ(m_frameDivisionMessageFrame2, written[1]);
+}
+
+TEST_F(ProtocolTest, SendingPipelinedFrameDivisionFrames)
+{
+    std::unique_ptr<MockLineDevice> device(new NiceMock<MockLineDevice>());
+    std::vector<std::vector<uint8_t>> written;
+    auto writeVector = [&written](const struct iovec* iov, int count, std::chrono::milliseconds) {
+        std::vector<uint8_t> frame;
+        for (int i = 0; i < count; ++i) {
+            const uint8_t* base = static_cast<const uint8_t*>(iov[i].iov_base);
+            frame.insert(frame.end(), base, base + iov[i].iov_len);
+        }
+        written.push_back(frame);
+        return IODevice::Result::Success;
+    };
+    std::vector<uint8_t> offer;
+    auto writeOffer = [&offer](const uint8_t* data, size_t size) {
+        offer.assign(data, data + size);
+        return std::make_pair(IODevice::Result::Success, static_cast<int>(size));
+    };
+    {
+        InSequence sequence;
+        EXPECT_CALL(*device, drain(_, _)).Times(1).WillOnce(Return(IODevice::Result::Timeout));
+        EXPECT_CALL(*device, write(_, 2)).Times(1).WillOnce(Invoke(writeOffer));
+        EXPECT_CALL(*device, readAvailable(_, 1, _, _)).Times(1).WillOnce(ReceiveByte(DC3));
+        EXPECT_CALL(*device, writeVector(_, _, _)).Times(1).WillOnce(Invoke(writeVector));
+        EXPECT_CALL(*device, readAvailable(_, 1, _, _)).Times(1).WillOnce(ReceiveByte(ACK));
+        // the second frame follows the acknowledgement without an enquiry
+        EXPECT_CALL(*device, writeVector(_, _, _)).Times(1).WillOnce(Invoke(writeVector));
+        EXPECT_CALL(*device, readAvailable(_, 1, _, _)).Times(1).WillOnce(ReceiveByte(ACK));
+    }
+    EXPECT_CALL(*device, write(ENQ)).Times(0);
+
+    Protocol protocol(std::move(device));
+    protocol.setPipelinedDivision(true);
+    EXPECT_TRUE(protocol.send(m_frameDivisionMessage));
+    EXPECT_EQ((std::vector<uint8_t>{DC2, ENQ}), offer);
+    ASSERT_EQ(2u, written.size());
+    EXPECT_EQ(m_frameDivisionMessageFrame1, written[0]);
+    EXPECT_EQ(m_frameDivisionMessageFrame2, written[1]);
+}
+
+TEST_F(ProtocolTest, SendingFrameDivisionFramesWhenPipeliningDeclined)
+{
+    std::unique_ptr<MockLineDevice> device(new NiceMock<MockLineDevice>());
+    {
+        InSequence sequence;
+        EXPECT_CALL(*device, drain(_, _)).Times(1).WillOnce(Return(IODevice::Result::Timeout));
+        EXPECT_CALL(*device, write(_, 2))
+            .Times(1)
+            .WillOnce(Return(std::make_pair(IODevice::Result::Success, 2)));
+        // a receiver without pipelining answers the offer like any other enquiry
+        EXPECT_CALL(*device, readAvailable(_, 1, _, _)).Times(1).WillOnce(ReceiveByte(ACK));
+        EXPECT_CALL(*device, writeVector(_, _, _))
+            .Times(1)
+            .WillOnce(Return(IODevice::Result::Success));
+        EXPECT_CALL(*device, readAvailable(_, 1, _, _)).Times(1).WillOnce(ReceiveByte(ACK));
+
+        EXPECT_CALL(*device, drain(_, _)).Times(1).WillOnce(Return(IODevice::Result::Timeout));
+        EXPECT_CALL(*device, write(ENQ))
+            .Times(1)
+            .WillOnce(Return(std::make_pair(IODevice::Result::Success, 1)));
+        EXPECT_CALL(*device, readAvailable(_, 1, _, _)).Times(1).WillOnce(ReceiveByte(ACK));
+        EXPECT_CALL(*device, writeVector(_, _, _))
+            .Times(1)
+            .WillOnce(Return(IODevice::Result::Success));
+        EXPECT_CALL(*device, readAvailable(_, 1, _, _)).Times(1).WillOnce(ReceiveByte(ACK));
+    }
+
+    Protocol protocol(std::move(device));
+    protocol.setPipelinedDivision(true);
+    EXPECT_TRUE(protocol.send(m_frameDivisionMessage));
+}
+
+TEST_F(ProtocolTest, SendingPipelinedFrameDivisionFramesWaitsOnSimultaneousOffers)
+{
+    std::unique_ptr<MockLineDevice> device(new NiceMock<MockLineDevice>());
+    std::vector<std::vector<uint8_t>> offers;
+    auto writeOffer = [&offers](const uint8_t* data, size_t size) {
+        offers.emplace_back(data, data + size);
+        return std::make_pair(IODevice::Result::Success, static_cast<int>(size));
+    };
+    {
+        InSequence sequence;
+        EXPECT_CALL(*device, drain(_, _)).Times(1).WillOnce(Return(IODevice::Result::Timeout));
+        EXPECT_CALL(*device, write(_, 2)).Times(1).WillOnce(Invoke(writeOffer));
+        // the offer of the peer collides with ours like an ENQ, it does not accept ours
+        EXPECT_CALL(*device, readAvailable(_, 1, _, _)).Times(1).WillOnce(ReceiveByte(DC2));
+        EXPECT_CALL(*device, write(NAK))
+            .Times(1)
+            .WillOnce(Return(std::make_pair(IODevice::Result::Success, 1)));
+        EXPECT_CALL(*device, drain(_, _)).Times(1).WillOnce(Return(IODevice::Result::Timeout));
+        EXPECT_CALL(*device, write(_, 2)).Times(1).WillOnce(Invoke(writeOffer));
+        EXPECT_CALL(*device, readAvailable(_, 1, _, _)).Times(1).WillOnce(ReceiveByte(DC3));
+        EXPECT_CALL(*device, writeVector(_, _, _))
+            .Times(1)
+            .WillOnce(Return(IODevice::Result::Success));
+        EXPECT_CALL(*device, readAvailable(_, 1, _, _)).Times(1).WillOnce(ReceiveByte(ACK));
+        EXPECT_CALL(*device, writeVector(_, _, _))
+            .Times(1)
+            .WillOnce(Return(IODevice::Result::Success));
+        EXPECT_CALL(*device, readAvailable(_, 1, _, _)).Times(1).WillOnce(ReceiveByte(ACK));
+    }
+    EXPECT_CALL(*device, write(ENQ)).Times(0);
+
+    Protocol protocol(std::move(device));
+    protocol.setPipelinedDivision(true);
+    EXPECT_TRUE(protocol.send(m_frameDivisionMessage));
+    ASSERT_EQ(2u, offers.size());
+    EXPECT_EQ((std::vector<uint8_t>{DC2, ENQ}), offers[1]);
+    // waiting for the peer is not a failed attempt
+    EXPECT_EQ(0u, protocol.r2());
+}
+
+TEST_F(ProtocolTest, SendingPipelinedFrameDivisionFramesDeniesUnexpectedAcceptance)
+{
+    std::unique_ptr<MockLineDevice> device(new NiceMock<MockLineDevice>());
+    {
+        InSequence sequence;
+        EXPECT_CALL(*device, drain(_, _)).Times(1).WillOnce(Return(IODevice::Result::Timeout));
+        EXPECT_CALL(*device, write(ENQ))
+            .Times(1)
+            .WillOnce(Return(std::make_pair(IODevice::Result::Success, 1)));
+        // DC3 without an offer is not an acknowledgement
+        EXPECT_CALL(*device, readAvailable(_, 1, _, _)).Times(1).WillOnce(ReceiveByte(DC3));
+        EXPECT_CALL(*device, drain(_, _)).Times(1).WillOnce(Return(IODevice::Result::Timeout));
+        EXPECT_CALL(*device, write(ENQ))
+            .Times(1)
+            .WillOnce(Return(std::make_pair(IODevice::Result::Success, 1)));
+        EXPECT_CALL(*device, readAvailable(_, 1, _, _)).Times(1).WillOnce(ReceiveByte(ACK));
+        EXPECT_CALL(*device, writeVector(_, _, _))
+            .Times(1)
+            .WillOnce(Return(IODevice::Result::Success));
+        EXPECT_CALL(*device, readAvailable(_, 1, _, _)).Times(1).WillOnce(ReceiveByte(ACK));
+    }
+    EXPECT_CALL(*device, write(_, _)).Times(0);
+
+    Protocol protocol(std::move(device));
+    EXPECT_TRUE(protocol.send(m_regularMessage));
+}
+
+TEST_F(ProtocolTest, ReceivingFrameWithLineDevice)
+{
+    std::unique_ptr<MockLineDevice> device(new NiceMock<MockLineDevice>());
+    std::vector<uint8_t> line;
+    size_t position = 0;
+    auto readAvailable = [&line, &position](uint8_t* data, size_t size,
+                                            std::chrono::milliseconds, size_t& received) {
+        received = std::min(size, line.size() - position);
+        std::copy_n(line.begin() + position, received, data);
+        position += received;
+        return (received > 0) ? IODevice::Result::Success : IODevice::Result::Timeout;
+    };
+    auto transmit = [&line, &position](const std::vector<uint8_t>& bytes) {
+        line.assign(bytes.begin(), bytes.end());
+        position = 0;
+        return std::make_pair(IODevice::Result::Success, 1);
+    };
+    {
+        InSequence sequence;
+        EXPECT_CALL(*device, poll(_)).Times(1).WillOnce(Return(IODevice::Result::Success));
+        EXPECT_CALL(*device, drain(_, _))
+            .Times(1)
+            .WillOnce(DoAll(SetArgReferee<0>(ILineDevice::DrainTail{{0xff, ENQ}}),
+                            SetArgReferee<1>(1u), Return(IODevice::Result::Success)));
+        EXPECT_CALL(*device, write(ACK))
+            .Times(1)
+            .WillOnce(InvokeWithoutArgs(std::bind(transmit, m_regularMessageFrame)));
+        // [STX][LEN], then the rest of the frame announced by LEN
+        EXPECT_CALL(*device, readAvailable(_, 2, _, _)).Times(1).WillOnce(Invoke(readAvailable));
+        EXPECT_CALL(*device, readAvailable(_, m_regularMessageProtocolLength, _, _))
+            .Times(1)
+            .WillOnce(Invoke(readAvailable));
+        EXPECT_CALL(*device, write(ACK))
+            .Times(1)
+            .WillOnce(Return(std::make_pair(IODevice::Result::Success, 1)));
+    }
+    EXPECT_CALL(*device, read(_, _)).Times(0);
+    EXPECT_CALL(*device, readMulti(_, _, _)).Times(0);
+
+    Protocol protocol(std::move(device));
+    std::vector<uint8_t> data;
+    EXPECT_TRUE(protocol.receive(data));
+    EXPECT_EQ(m_regularMessage, data);
+}
+
 TEST_F(ProtocolTest, ReceivingFrameDivisionFrames)
 {
     std::unique_ptr<mock_IODevice> device(new mock_IODevice());
@@ -2196,8 +2813,202 @@ TEST_F(ProtocolTest, ReceivingFrameDivisionFrames)
 
     Protocol protocol(std::move(device));
     std::vector<uint8_t> data;
-    protocol.receive(data);
+    EXPECT_TRUE(protocol.receive(data));
     EXPECT_EQ(std::equal(data.begin(), data.end(), m_frameDivisionMessage.begin()), true);
+    EXPECT_EQ(m_frameDivisionMessage, data);
+}
+
+TEST_F(ProtocolTest, SendingFrameWithSendOnlyProtocol)
+{
+    std::unique_ptr<MockLineDevice> device(new NiceMock<MockLineDevice>());
+    {
+        InSequence sequence;
+        // the enquiry is not answered, so the line is released for a retry
+        EXPECT_CALL(*device, drain(_, _)).Times(1).WillOnce(Return(IODevice::Result::Timeout));
+        EXPECT_CALL(*device, write(ENQ))
+            .Times(1)
+            .WillOnce(Return(std::make_pair(IODevice::Result::Success, 1)));
+        EXPECT_CALL(*device, readAvailable(_, 1, _, _))
+            .Times(1)
+            .WillOnce(DoAll(SetArgReferee<3>(0u), Return(IODevice::Result::Timeout)));
+        EXPECT_CALL(*device, drain(_, _)).Times(1).WillOnce(Return(IODevice::Result::Timeout));
+        EXPECT_CALL(*device, write(ENQ))
+            .Times(1)
+            .WillOnce(Return(std::make_pair(IODevice::Result::Success, 1)));
+        EXPECT_CALL(*device, readAvailable(_, 1, _, _)).Times(1).WillOnce(ReceiveByte(ACK));
+        EXPECT_CALL(*device, writeVector(_, _, _))
+            .Times(1)
+            .WillOnce(Return(IODevice::Result::Success));
+        EXPECT_CALL(*device, readAvailable(_, 1, _, _)).Times(1).WillOnce(ReceiveByte(ACK));
+    }
+
+    SendOnlyProtocol protocol(std::move(device));
+    EXPECT_TRUE(protocol.send(m_regularMessage));
+}
+
+TEST_F(ProtocolTest, SendOnlyProtocolDoesNotReceive)
+{
+    std::unique_ptr<mock_IODevice> device(new NiceMock<mock_IODevice>());
+    EXPECT_CALL(*device, poll(_)).Times(0);
+    EXPECT_CALL(*device, read(_, _)).Times(0);
+    EXPECT_CALL(*device, write(_)).Times(0);
+
+    SendOnlyProtocol protocol(std::move(device));
+    std::vector<uint8_t> data = {1, 2, 3};
+    EXPECT_FALSE(protocol.receive(data));
+    EXPECT_TRUE(data.empty());
+}
+
+TEST_F(ProtocolTest, ReceivingFrameWithReceiveOnlyProtocol)
+{
+    std::unique_ptr<MockLineDevice> device(new NiceMock<MockLineDevice>());
+    std::vector<uint8_t> line;
+    size_t position = 0;
+    auto readAvailable = [&line, &position](uint8_t* data, size_t size,
+                                            std::chrono::milliseconds, size_t& received) {
+        received = std::min(size, line.size() - position);
+        std::copy_n(line.begin() + position, received, data);
+        position += received;
+        return (received > 0) ? IODevice::Result::Success : IODevice::Result::Timeout;
+    };
+    auto transmit = [&line, &position](const std::vector<uint8_t>& bytes) {
+        line.assign(bytes.begin(), bytes.end());
+        position = 0;
+        return std::make_pair(IODevice::Result::Success, 1);
+    };
+    {
+        InSequence sequence;
+        // a stale byte in front of the enquiry makes the receiver poll again
+        EXPECT_CALL(*device, poll(_)).Times(1).WillOnce(Return(IODevice::Result::Success));
+        EXPECT_CALL(*device, drain(_, _))
+            .Times(1)
+            .WillOnce(DoAll(SetArgReferee<0>(ILineDevice::DrainTail{{0, 0xff}}),
+                            SetArgReferee<1>(1u), Return(IODevice::Result::Success)));
+        EXPECT_CALL(*device, poll(_)).Times(1).WillOnce(Return(IODevice::Result::Success));
+        EXPECT_CALL(*device, drain(_, _))
+            .Times(1)
+            .WillOnce(DoAll(SetArgReferee<0>(ILineDevice::DrainTail{{0, ENQ}}),
+                            SetArgReferee<1>(1u), Return(IODevice::Result::Success)));
+        EXPECT_CALL(*device, write(ACK))
+            .Times(1)
+            .WillOnce(InvokeWithoutArgs(std::bind(transmit, m_regularMessageFrame)));
+        EXPECT_CALL(*device, write(ACK))
+            .Times(1)
+            .WillOnce(Return(std::make_pair(IODevice::Result::Success, 1)));
+    }
+    EXPECT_CALL(*device, readAvailable(_, _, _, _)).WillRepeatedly(Invoke(readAvailable));
+
+    ReceiveOnlyProtocol protocol(std::move(device));
+    std::vector<uint8_t> data;
+    EXPECT_TRUE(protocol.receive(data));
+    EXPECT_EQ(m_regularMessage, data);
+}
+
+TEST_F(ProtocolTest, ReceiveOnlyProtocolDoesNotSend)
+{
+    std::unique_ptr<mock_IODevice> device(new NiceMock<mock_IODevice>());
+    EXPECT_CALL(*device, read(_, _)).Times(0);
+    EXPECT_CALL(*device, write(_)).Times(0);
+    EXPECT_CALL(*device, write(_, _)).Times(0);
+
+    ReceiveOnlyProtocol protocol(std::move(device));
+    EXPECT_FALSE(protocol.send(m_regularMessage));
+}
+
+TEST_F(ProtocolTest, ReceivingPipelinedFrameDivisionFrames)
+{
+    std::unique_ptr<MockLineDevice> device(new NiceMock<MockLineDevice>());
+    std::vector<uint8_t> line;
+    size_t position = 0;
+    auto readAvailable = [&line, &position](uint8_t* data, size_t size,
+                                            std::chrono::milliseconds, size_t& received) {
+        received = std::min(size, line.size() - position);
+        std::copy_n(line.begin() + position, received, data);
+        position += received;
+        return (received > 0) ? IODevice::Result::Success : IODevice::Result::Timeout;
+    };
+    auto transmit = [&line, &position](const std::vector<uint8_t>& bytes) {
+        line.assign(bytes.begin(), bytes.end());
+        position = 0;
+        return std::make_pair(IODevice::Result::Success, 1);
+    };
+    {
+        InSequence sequence;
+        EXPECT_CALL(*device, poll(_)).Times(1).WillOnce(Return(IODevice::Result::Success));
+        EXPECT_CALL(*device, drain(_, _))
+            .Times(1)
+            .WillOnce(DoAll(SetArgReferee<0>(ILineDevice::DrainTail{{DC2, ENQ}}),
+                            SetArgReferee<1>(2u), Return(IODevice::Result::Success)));
+        EXPECT_CALL(*device, write(DC3))
+            .Times(1)
+            .WillOnce(InvokeWithoutArgs(std::bind(transmit, m_frameDivisionMessageFrame1)));
+        // the second frame follows the acknowledgement without an enquiry
+        EXPECT_CALL(*device, write(ACK))
+            .Times(1)
+            .WillOnce(InvokeWithoutArgs(std::bind(transmit, m_frameDivisionMessageFrame2)));
+        EXPECT_CALL(*device, write(ACK))
+            .Times(1)
+            .WillOnce(Return(std::make_pair(IODevice::Result::Success, 1)));
+    }
+    EXPECT_CALL(*device, readAvailable(_, _, _, _)).WillRepeatedly(Invoke(readAvailable));
+    EXPECT_CALL(*device, read(_, _)).Times(0);
+
+    Protocol protocol(std::move(device));
+    protocol.setPipelinedDivision(true);
+    std::vector<uint8_t> data;
+    EXPECT_TRUE(protocol.receive(data));
+    EXPECT_EQ(m_frameDivisionMessage, data);
+}
+
+TEST_F(ProtocolTest, ReceivingFrameDivisionFramesIgnoresPipeliningOfferWhenDisabled)
+{
+    std::unique_ptr<MockLineDevice> device(new NiceMock<MockLineDevice>());
+    std::vector<uint8_t> line;
+    size_t position = 0;
+    auto readAvailable = [&line, &position](uint8_t* data, size_t size,
+                                            std::chrono::milliseconds, size_t& received) {
+        received = std::min(size, line.size() - position);
+        std::copy_n(line.begin() + position, received, data);
+        position += received;
+        return (received > 0) ? IODevice::Result::Success : IODevice::Result::Timeout;
+    };
+    auto transmit = [&line, &position](const std::vector<uint8_t>& bytes) {
+        line.assign(bytes.begin(), bytes.end());
+        position = 0;
+        return std::make_pair(IODevice::Result::Success, 1);
+    };
+    {
+        InSequence sequence;
+        EXPECT_CALL(*device, poll(_)).Times(1).WillOnce(Return(IODevice::Result::Success));
+        EXPECT_CALL(*device, drain(_, _))
+            .Times(1)
+            .WillOnce(DoAll(SetArgReferee<0>(ILineDevice::DrainTail{{DC2, ENQ}}),
+                            SetArgReferee<1>(2u), Return(IODevice::Result::Success)));
+        EXPECT_CALL(*device, write(ACK))
+            .Times(1)
+            .WillOnce(InvokeWithoutArgs(std::bind(transmit, m_frameDivisionMessageFrame1)));
+        EXPECT_CALL(*device, write(ACK))
+            .Times(1)
+            .WillOnce(Return(std::make_pair(IODevice::Result::Success, 1)));
+        // the next frame is enquired again
+        EXPECT_CALL(*device, drain(_, _))
+            .Times(1)
+            .WillOnce(DoAll(SetArgReferee<0>(ILineDevice::DrainTail{{0, ENQ}}),
+                            SetArgReferee<1>(1u), Return(IODevice::Result::Success)));
+        EXPECT_CALL(*device, write(ACK))
+            .Times(1)
+            .WillOnce(InvokeWithoutArgs(std::bind(transmit, m_frameDivisionMessageFrame2)));
+        EXPECT_CALL(*device, write(ACK))
+            .Times(1)
+            .WillOnce(Return(std::make_pair(IODevice::Result::Success, 1)));
+    }
+    EXPECT_CALL(*device, readAvailable(_, _, _, _)).WillRepeatedly(Invoke(readAvailable));
+    EXPECT_CALL(*device, write(DC3)).Times(0);
+
+    Protocol protocol(std::move(device));
+    std::vector<uint8_t> data;
+    EXPECT_TRUE(protocol.receive(data));
+    EXPECT_EQ(m_frameDivisionMessage, data);
 }
 
 TEST_F(ProtocolTest, ReceivingDataFrameNumberWithTimeoutOrError)
@@ -0,0 +1,191 @@
+/*
+ * COPYRIGHT (C) 2024 MITSUBISHI ELECTRIC CORPORATION
+ * ALL RIGHTS RESERVED
+ */
+
+#include "ReceiveQueue.h"
+
+#include <gtest/gtest.h>
+#include <thread>
+
+namespace com {
+namespace mitsubishielectric {
+namespace ahu {
+namespace cpucom {
+namespace impl {
+
+namespace {
+
+using std::chrono::milliseconds;
+using std::chrono::steady_clock;
+
+const common::CpuCommand kCommand = {0x01, 0x02};
+
+ReceivedMessage message(uint8_t value, steady_clock::time_point received = steady_clock::now())
+{
+    return {kCommand, {value}, received};
+}
+
+}  // namespace
+
+TEST(ReceiveQueueTest, PopsMessagePushed)
+{
+    ReceiveQueue queue;
+    EXPECT_TRUE(queue.push(message(1)));
+    EXPECT_EQ(1u, queue.occupancy());
+
+    ReceivedMessage popped;
+    EXPECT_TRUE(queue.pop(popped, milliseconds(0)));
+    EXPECT_EQ(kCommand, popped.command);
+    EXPECT_EQ(std::vector<uint8_t>{1}, popped.data);
+    EXPECT_EQ(0u, queue.occupancy());
+}
+
+TEST(ReceiveQueueTest, PopTimesOutWhenEmpty)
+{
+    ReceiveQueue queue;
+    ReceivedMessage popped;
+    const auto start = steady_clock::now();
+    EXPECT_FALSE(queue.pop(popped, milliseconds(20)));
+    EXPECT_GE(steady_clock::now() - start, milliseconds(20));
+}
+
+TEST(ReceiveQueueTest, PushWakesWaitingPop)
+{
+    ReceiveQueue queue;
+    std::thread receiver([&queue]() {
+        std::this_thread::sleep_for(milliseconds(20));
+        queue.push(message(7));
+    });
+
+    ReceivedMessage popped;
+    EXPECT_TRUE(queue.pop(popped, milliseconds(10000)));
+    EXPECT_EQ(std::vector<uint8_t>{7}, popped.data);
+    receiver.join();
+}
+
+TEST(ReceiveQueueTest, CloseWakesWaitingPop)
+{
+    ReceiveQueue queue;
+    std::thread closer([&queue]() {
+        std::this_thread::sleep_for(milliseconds(20));
+        queue.close();
+    });
+
+    ReceivedMessage popped;
+    const auto start = steady_clock::now();
+    EXPECT_FALSE(queue.pop(popped, milliseconds(10000)));
+    EXPECT_LT(steady_clock::now() - start, milliseconds(5000));
+    closer.join();
+}
+
+TEST(ReceiveQueueTest, FullQueueRejectsPush)
+{
+    ReceiveQueue queue;
+    for (size_t i = 0; i < ReceiveQueue::kCapacity; ++i) {
+        EXPECT_TRUE(queue.push(message(0)));
+    }
+    EXPECT_FALSE(queue.push(message(1)));
+    queue.waitForRoom(milliseconds(5));
+
+    const ReceiveStatistics statistics = queue.statistics();
+    EXPECT_EQ(ReceiveQueue::kCapacity, statistics.received);
+    EXPECT_EQ(1u, statistics.full);
+    EXPECT_GE(statistics.maxStall, 5000u);
+    EXPECT_EQ(statistics.maxStall, statistics.totalStall);
+    EXPECT_EQ(ReceiveQueue::kCapacity, statistics.maxOccupancy);
+}
+
+TEST(ReceiveQueueTest, PopWakesStalledPush)
+{
+    ReceiveQueue queue;
+    for (size_t i = 0; i < ReceiveQueue::kCapacity; ++i) {
+        EXPECT_TRUE(queue.push(message(0)));
+    }
+    std::thread dispatcher([&queue]() {
+        std::this_thread::sleep_for(milliseconds(10));
+        ReceivedMessage popped;
+        queue.pop(popped, milliseconds(0));
+    });
+    const auto start = steady_clock::now();
+    queue.waitForRoom(milliseconds(10000));
+    EXPECT_LT(steady_clock::now() - start, milliseconds(5000));
+    EXPECT_TRUE(queue.push(message(1)));
+    dispatcher.join();
+}
+
+TEST(ReceiveQueueTest, CloseWakesStalledPush)
+{
+    ReceiveQueue queue;
+    for (size_t i = 0; i < ReceiveQueue::kCapacity; ++i) {
+        EXPECT_TRUE(queue.push(message(0)));
+    }
+    std::thread closer([&queue]() {
+        std::this_thread::sleep_for(milliseconds(10));
+        queue.close();
+    });
+    const auto start = steady_clock::now();
+    queue.waitForRoom(milliseconds(10000));
+    EXPECT_LT(steady_clock::now() - start, milliseconds(5000));
+    closer.join();
+}
+
+TEST(ReceiveQueueTest, StatisticsAreFormatted)
+{
+    ReceiveStatistics statistics = {};
+    statistics.received = 3;
+    statistics.maxOccupancy = 2;
+    statistics.full = 1;
+    statistics.totalStall = 40;
+    statistics.maxStall = 40;
+    EXPECT_EQ("received 3, max occupancy 2, full 1, stalled us 40, max stall us 40\n",
+              formatReceiveStats(statistics));
+}
+
+TEST(ReceiveQueueTest, MeasuresWaitAndDispatch)
+{
+    ReceiveQueue queue;
+    EXPECT_TRUE(queue.push(message(1, steady_clock::now() - milliseconds(5))));
+    EXPECT_TRUE(queue.push(message(2)));
+
+    ReceivedMessage popped;
+    EXPECT_TRUE(queue.pop(popped, milliseconds(0)));
+    queue.onDispatched(steady_clock::now() - milliseconds(3));
+    EXPECT_TRUE(queue.pop(popped, milliseconds(0)));
+
+    const ReceiveStatistics statistics = queue.statistics();
+    EXPECT_EQ(2u, statistics.received);
+    EXPECT_EQ(2u, statistics.maxOccupancy);
+    EXPECT_GE(statistics.maxWait, 5000u);
+    EXPECT_GE(statistics.totalWait, statistics.maxWait);
+    EXPECT_EQ(1u, statistics.dispatched);
+    EXPECT_GE(statistics.maxDispatch, 3000u);
+    EXPECT_EQ(statistics.maxDispatch, statistics.totalDispatch);
+}
+
+TEST(ReceiveQueueTest, HandsOverBetweenThreadsInOrder)
+{
+    constexpr int kCount = 10000;
+    ReceiveQueue queue;
+    std::thread receiver([&queue]() {
+        for (int i = 0; i < kCount; ++i) {
+            while (!queue.push(message(static_cast<uint8_t>(i)))) {
+                queue.waitForRoom(milliseconds(10));
+            }
+        }
+    });
+
+    for (int i = 0; i < kCount; ++i) {
+        ReceivedMessage popped;
+        ASSERT_TRUE(queue.pop(popped, milliseconds(10000))) << i;
+        ASSERT_EQ(static_cast<uint8_t>(i), popped.data[0]) << i;
+    }
+    receiver.join();
+    EXPECT_EQ(static_cast<uint64_t>(kCount), queue.statistics().received);
+}
+
+}  // namespace impl
+}  // namespace cpucom
+}  // namespace ahu
+}  // namespace mitsubishielectric
+}  // namespace com
@@ -0,0 +1,78 @@
+/*
+ * COPYRIGHT (C) 2024 MITSUBISHI ELECTRIC CORPORATION
+ * ALL RIGHTS RESERVED
+ */
+
+#include "SendTrace.h"
+
+#include <gtest/gtest.h>
+
+namespace com {
+namespace mitsubishielectric {
+namespace ahu {
+namespace cpucom {
+namespace impl {
+
+TEST(SendTraceTest, EncodedTraceIsDecodedAsItWas)
+{
+    SendTrace trace;
+    trace.sequence = nextSendTraceSequence();
+    for (size_t hop = 0; hop < SendTrace::HopCount; ++hop) {
+        trace.stamps[hop] = 0x0102030405060708ull + hop;
+    }
+
+    const std::vector<uint8_t> data = encodeSendTrace(trace);
+    ASSERT_EQ(kSendTraceSize, data.size());
+    EXPECT_EQ(0x08, data[8]);  // little endian
+
+    SendTrace decoded;
+    ASSERT_TRUE(decodeSendTrace(data, decoded));
+    EXPECT_EQ(trace.sequence, decoded.sequence);
+    for (size_t hop = 0; hop < SendTrace::HopCount; ++hop) {
+        EXPECT_EQ(trace.stamps[hop], decoded.stamps[hop]);
+    }
+}
+
+TEST(SendTraceTest, MalformedTraceIsNotDecoded)
+{
+    SendTrace trace;
+    trace.sequence = 7;
+    std::vector<uint8_t> data = encodeSendTrace(trace);
+    data.pop_back();
+    EXPECT_FALSE(decodeSendTrace(data, trace));
+    EXPECT_EQ(7u, trace.sequence);
+}
+
+TEST(SendTraceTest, LatencyOfHopsNotReachedIsZero)
+{
+    SendTrace trace;
+    trace.stamps[SendTrace::ClientEnqueue] = 1000;
+    trace.stamps[SendTrace::DaemonReceive] = 4000;
+    EXPECT_EQ(3000u, trace.latency(SendTrace::ClientEnqueue, SendTrace::DaemonReceive));
+    EXPECT_EQ(0u, trace.latency(SendTrace::DaemonReceive, SendTrace::TransmitDequeue));
+    EXPECT_EQ(0u, trace.latency(SendTrace::EnquirySent, SendTrace::DaemonReceive));
+    EXPECT_NE(nextSendTraceSequence(), nextSendTraceSequence());
+}
+
+TEST(SendTraceTest, EncodedReceiveStampsAreDecodedAsTheyWere)
+{
+    ReceiveStamps stamps;
+    stamps.frameStart = 0x0102030405060708ull;
+    stamps.frameChecked = monotonicNow();
+
+    const std::vector<uint8_t> data = encodeReceiveStamps(stamps);
+    ASSERT_EQ(kReceiveStampsSize, data.size());
+
+    ReceiveStamps decoded;
+    ASSERT_TRUE(decodeReceiveStamps(data, decoded));
+    EXPECT_EQ(stamps.frameStart, decoded.frameStart);
+    EXPECT_EQ(stamps.frameChecked, decoded.frameChecked);
+    EXPECT_FALSE(decodeReceiveStamps(std::vector<uint8_t>(data.begin(), data.end() - 1), decoded));
+    EXPECT_EQ(0u, ReceiveStamps().age());
+}
+
+}  // namespace impl
+}  // namespace cpucom
+}  // namespace ahu
+}  // namespace mitsubishielectric
+}  // namespace com
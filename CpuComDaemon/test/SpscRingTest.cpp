@@ -0,0 +1,99 @@
+/*
+ * COPYRIGHT (C) 2024 MITSUBISHI ELECTRIC CORPORATION
+ * ALL RIGHTS RESERVED
+ */
+
+#include "SpscRing.h"
+
+#include <gtest/gtest.h>
+#include <memory>
+#include <thread>
+
+namespace com {
+namespace mitsubishielectric {
+namespace ahu {
+namespace cpucom {
+namespace impl {
+
+TEST(SpscRingTest, PopsInOrderPushed)
+{
+    SpscRing<int, 4> ring;
+    EXPECT_TRUE(ring.empty());
+    int value = 0;
+    EXPECT_FALSE(ring.pop(value));
+
+    EXPECT_TRUE(ring.push(1));
+    EXPECT_TRUE(ring.push(2));
+    EXPECT_EQ(2u, ring.size());
+    EXPECT_TRUE(ring.pop(value));
+    EXPECT_EQ(1, value);
+    EXPECT_TRUE(ring.pop(value));
+    EXPECT_EQ(2, value);
+    EXPECT_TRUE(ring.empty());
+}
+
+TEST(SpscRingTest, FullRingRejectsPush)
+{
+    SpscRing<std::unique_ptr<int>, 2> ring;
+    EXPECT_TRUE(ring.push(std::make_unique<int>(1)));
+    EXPECT_TRUE(ring.push(std::make_unique<int>(2)));
+
+    auto rejected = std::make_unique<int>(3);
+    EXPECT_FALSE(ring.push(std::move(rejected)));
+    ASSERT_NE(nullptr, rejected);
+    EXPECT_EQ(3, *rejected);
+
+    std::unique_ptr<int> value;
+    EXPECT_TRUE(ring.pop(value));
+    EXPECT_EQ(1, *value);
+    EXPECT_TRUE(ring.push(std::move(rejected)));
+}
+
+TEST(SpscRingTest, WrapsAround)
+{
+    SpscRing<int, 4> ring;
+    int value = 0;
+    for (int i = 0; i < 10; ++i) {
+        EXPECT_TRUE(ring.push(i * 2));
+        EXPECT_TRUE(ring.push(i * 2 + 1));
+        EXPECT_TRUE(ring.pop(value));
+        EXPECT_EQ(i * 2, value);
+        EXPECT_TRUE(ring.pop(value));
+        EXPECT_EQ(i * 2 + 1, value);
+    }
+    EXPECT_TRUE(ring.empty());
+}
+
+TEST(SpscRingTest, HandsOverBetweenThreadsInOrder)
+{
+    constexpr int kCount = 100000;
+    SpscRing<int, 8> ring;
+
+    std::thread producer([&ring]() {
+        for (int i = 0; i < kCount; ++i) {
+            while (!ring.push(int(i))) {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    int expected = 0;
+    while (expected < kCount) {
+        int value = -1;
+        if (ring.pop(value)) {
+            ASSERT_EQ(expected, value);
+            ++expected;
+        }
+        else {
+            std::this_thread::yield();
+        }
+    }
+    producer.join();
+    EXPECT_TRUE(ring.empty());
+}
+
+}  // namespace impl
+}  // namespace cpucom
+}  // namespace ahu
+}  // namespace mitsubishielectric
+}  // namespace com
@@ -0,0 +1,144 @@
+/*
+ * COPYRIGHT (C) 2024 MITSUBISHI ELECTRIC CORPORATION
+ * ALL RIGHTS RESERVED
+ */
+
+#include "SubscriberTable.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include <thread>
+
+namespace com {
+namespace mitsubishielectric {
+namespace ahu {
+namespace cpucom {
+namespace impl {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+using ::testing::UnorderedElementsAre;
+
+namespace {
+
+const common::CpuCommand kCommand = {0x11, 0x00};
+const common::CpuCommand kOtherCommand = {0x00, 0x11};
+const SubscriberTable::SessionID kSession = "session";
+const SubscriberTable::SessionID kOtherSession = "otherSession";
+
+}  // namespace
+
+TEST(SubscriberTableTest, FindsSubscribers)
+{
+    SubscriberTable table;
+    EXPECT_TRUE(table.subscribe(kSession, kCommand));
+    EXPECT_TRUE(table.subscribe(kOtherSession, kCommand));
+    EXPECT_TRUE(table.subscribe(kOtherSession, kOtherCommand));
+
+    EXPECT_THAT(table.find(kCommand).subscribers(), UnorderedElementsAre(kSession, kOtherSession));
+    EXPECT_THAT(table.find(kOtherCommand).subscribers(), ElementsAre(kOtherSession));
+    EXPECT_EQ(2u, table.commandCount());
+}
+
+TEST(SubscriberTableTest, SubscribingTwiceAddsNothing)
+{
+    SubscriberTable table;
+    EXPECT_TRUE(table.subscribe(kSession, kCommand));
+    EXPECT_FALSE(table.subscribe(kSession, kCommand));
+    EXPECT_THAT(table.find(kCommand).subscribers(), ElementsAre(kSession));
+}
+
+TEST(SubscriberTableTest, UnknownCommandHasNoSubscribers)
+{
+    SubscriberTable table;
+    for (unsigned first = 0; first < 256; ++first) {
+        const common::CpuCommand command(static_cast<uint8_t>(first), 0xff);
+        EXPECT_THAT(table.find(command).subscribers(), IsEmpty());
+    }
+    EXPECT_EQ(0u, table.commandCount());
+}
+
+TEST(SubscriberTableTest, Unsubscribes)
+{
+    SubscriberTable table;
+    table.subscribe(kSession, kCommand);
+    table.subscribe(kOtherSession, kCommand);
+
+    EXPECT_TRUE(table.unsubscribe(kSession, kCommand));
+    EXPECT_FALSE(table.unsubscribe(kSession, kCommand));
+    EXPECT_FALSE(table.unsubscribe(kSession, kOtherCommand));
+    EXPECT_THAT(table.find(kCommand).subscribers(), ElementsAre(kOtherSession));
+
+    EXPECT_TRUE(table.unsubscribe(kOtherSession, kCommand));
+    EXPECT_THAT(table.find(kCommand).subscribers(), IsEmpty());
+    EXPECT_EQ(0u, table.commandCount());
+}
+
+TEST(SubscriberTableTest, RemovesSessionFromAllItsCommands)
+{
+    SubscriberTable table;
+    table.subscribe(kSession, kCommand);
+    table.subscribe(kSession, kOtherCommand);
+    table.subscribe(kOtherSession, kCommand);
+
+    table.removeSession(kSession);
+    table.removeSession("unknown");
+    EXPECT_THAT(table.find(kCommand).subscribers(), ElementsAre(kOtherSession));
+    EXPECT_THAT(table.find(kOtherCommand).subscribers(), IsEmpty());
+    EXPECT_EQ(1u, table.commandCount());
+
+    // and it may subscribe again
+    EXPECT_TRUE(table.subscribe(kSession, kOtherCommand));
+}
+
+TEST(SubscriberTableTest, SnapshotOutlivesChange)
+{
+    SubscriberTable table;
+    table.subscribe(kSession, kCommand);
+
+    std::atomic_bool unsubscribed(false);
+    std::thread writer;
+    {
+        const SubscriberTable::Snapshot snapshot = table.find(kCommand);
+        writer = std::thread([&table, &unsubscribed]() {
+            table.unsubscribe(kSession, kCommand);
+            unsubscribed = true;
+        });
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        // the array it holds is not freed under it
+        EXPECT_FALSE(unsubscribed);
+        EXPECT_THAT(snapshot.subscribers(), ElementsAre(kSession));
+    }
+    writer.join();
+    EXPECT_TRUE(unsubscribed);
+    EXPECT_THAT(table.find(kCommand).subscribers(), IsEmpty());
+}
+
+TEST(SubscriberTableTest, FindsWhileChanged)
+{
+    SubscriberTable table;
+    table.subscribe(kOtherSession, kCommand);
+    std::atomic_bool done(false);
+
+    std::thread reader([&table, &done]() {
+        while (!done) {
+            const SubscriberTable::Snapshot snapshot = table.find(kCommand);
+            const SubscriberTable::Subscribers& subscribers = snapshot.subscribers();
+            ASSERT_FALSE(subscribers.empty());
+            ASSERT_LE(subscribers.size(), 2u);
+            ASSERT_EQ(kOtherSession, subscribers.front());
+        }
+    });
+    for (int i = 0; i < 2000; ++i) {
+        table.subscribe(kSession, kCommand);
+        table.unsubscribe(kSession, kCommand);
+    }
+    done = true;
+    reader.join();
+}
+
+}  // namespace impl
+}  // namespace cpucom
+}  // namespace ahu
+}  // namespace mitsubishielectric
+}  // namespace com
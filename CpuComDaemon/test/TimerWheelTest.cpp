@@ -0,0 +1,146 @@
+/*
+ * COPYRIGHT (C) 2024 MITSUBISHI ELECTRIC CORPORATION
+ * ALL RIGHTS RESERVED
+ */
+
+#include "TimerWheel.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+namespace com {
+namespace mitsubishielectric {
+namespace ahu {
+namespace cpucom {
+namespace impl {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+using std::chrono::milliseconds;
+using std::chrono::seconds;
+
+namespace {
+
+const TimerWheel::Clock::time_point kStart;
+
+}  // namespace
+
+TEST(TimerWheelTest, ExpiresAtFirstTickAfterDeadline)
+{
+    TimerWheel wheel(kStart);
+    wheel.schedule(1, kStart + milliseconds(25));
+    std::vector<TimerWheel::TimerID> expired;
+
+    wheel.advance(kStart + milliseconds(29), expired);
+    EXPECT_THAT(expired, IsEmpty());
+    wheel.advance(kStart + milliseconds(30), expired);
+    EXPECT_THAT(expired, ElementsAre(1u));
+    EXPECT_EQ(0u, wheel.size());
+}
+
+TEST(TimerWheelTest, ExpiresSoonestFirst)
+{
+    TimerWheel wheel(kStart);
+    wheel.schedule(1, kStart + milliseconds(300));
+    wheel.schedule(2, kStart + milliseconds(100));
+    wheel.schedule(3, kStart + milliseconds(200));
+    EXPECT_EQ(3u, wheel.size());
+
+    std::vector<TimerWheel::TimerID> expired;
+    wheel.advance(kStart + seconds(1), expired);
+    EXPECT_THAT(expired, ElementsAre(2u, 3u, 1u));
+}
+
+TEST(TimerWheelTest, PastDeadlineExpiresOnNextAdvance)
+{
+    TimerWheel wheel(kStart);
+    std::vector<TimerWheel::TimerID> expired;
+    wheel.advance(kStart + seconds(1), expired);
+
+    wheel.schedule(1, kStart);
+    wheel.advance(kStart + seconds(1), expired);
+    EXPECT_THAT(expired, IsEmpty());
+    wheel.advance(kStart + seconds(1) + TimerWheel::kTick, expired);
+    EXPECT_THAT(expired, ElementsAre(1u));
+}
+
+TEST(TimerWheelTest, FarTimersCascadeOnTime)
+{
+    // beyond the near wheel, beyond the far wheel and across a turn of either
+    const std::vector<milliseconds> deadlines = {milliseconds(2550), milliseconds(2560),
+                                                 milliseconds(2570), seconds(10),
+                                                 seconds(163),       seconds(164),
+                                                 seconds(400),       seconds(1000)};
+    TimerWheel wheel(kStart);
+    for (size_t i = 0; i < deadlines.size(); ++i) {
+        wheel.schedule(i, kStart + deadlines[i]);
+    }
+
+    for (size_t i = 0; i < deadlines.size(); ++i) {
+        std::vector<TimerWheel::TimerID> expired;
+        wheel.advance(kStart + deadlines[i] - TimerWheel::kTick, expired);
+        EXPECT_THAT(expired, IsEmpty()) << i;
+        wheel.advance(kStart + deadlines[i], expired);
+        EXPECT_THAT(expired, ElementsAre(i)) << i;
+    }
+    EXPECT_EQ(0u, wheel.size());
+}
+
+TEST(TimerWheelTest, CancelledTimersDoNotExpire)
+{
+    // in the near wheel, in the far wheel and beyond it
+    TimerWheel wheel(kStart);
+    const TimerWheel::Handle near = wheel.schedule(1, kStart + milliseconds(100));
+    wheel.schedule(2, kStart + milliseconds(100));
+    const TimerWheel::Handle far = wheel.schedule(3, kStart + seconds(10));
+    const TimerWheel::Handle overflow = wheel.schedule(4, kStart + seconds(400));
+    wheel.schedule(5, kStart + seconds(400));
+
+    wheel.cancel(near);
+    wheel.cancel(far);
+    wheel.cancel(overflow);
+    EXPECT_EQ(2u, wheel.size());
+    std::vector<TimerWheel::TimerID> expired;
+    wheel.advance(kStart + seconds(1000), expired);
+    EXPECT_THAT(expired, ElementsAre(2u, 5u));
+
+    // one which expired already is left alone
+    const TimerWheel::Handle due = wheel.schedule(6, kStart + seconds(1001));
+    wheel.schedule(7, kStart + seconds(1002));
+    expired.clear();
+    wheel.advance(kStart + seconds(1001), expired);
+    wheel.cancel(due);
+    EXPECT_THAT(expired, ElementsAre(6u));
+    EXPECT_EQ(1u, wheel.size());
+}
+
+TEST(TimerWheelTest, SchedulesWhileTurning)
+{
+    TimerWheel wheel(kStart);
+    std::vector<TimerWheel::TimerID> expired;
+    TimerWheel::Clock::time_point now = kStart;
+    // a timer 5 s ahead, scheduled every 330 ms for 10 minutes
+    TimerWheel::TimerID next = 0;
+    TimerWheel::TimerID due = 0;
+    while (now < kStart + std::chrono::minutes(10)) {
+        wheel.schedule(next++, now + seconds(5));
+        now += milliseconds(330);
+        wheel.advance(now, expired);
+        for (TimerWheel::TimerID id : expired) {
+            EXPECT_EQ(due, id);
+            // expired within the tick after the deadline
+            const auto deadline = kStart + milliseconds(330) * static_cast<int>(id) + seconds(5);
+            EXPECT_LE(deadline, now);
+            EXPECT_GT(deadline + milliseconds(330) + TimerWheel::kTick, now);
+            ++due;
+        }
+        expired.clear();
+    }
+    EXPECT_EQ(next - due, wheel.size());
+}
+
+}  // namespace impl
+}  // namespace cpucom
+}  // namespace ahu
+}  // namespace mitsubishielectric
+}  // namespace com
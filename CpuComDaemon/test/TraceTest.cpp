@@ -0,0 +1,160 @@
+/*
+ * COPYRIGHT (C) 2024 MITSUBISHI ELECTRIC CORPORATION
+ * ALL RIGHTS RESERVED
+ */
+
+#include "Trace.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+#include <unistd.h>
+
+namespace com {
+namespace mitsubishielectric {
+namespace ahu {
+namespace cpucom {
+namespace impl {
+
+namespace {
+
+const uint16_t kFunction = 7;
+const uint16_t kLogID = 42;
+
+struct PlainId {
+    uint8_t bytes[16];
+};
+
+class TextId {
+public:
+    std::string toString() const { return "00000000-0000-0000-0000-000000000001"; }
+};
+
+std::vector<TraceRecord> recordsOf(uint16_t logID)
+{
+    std::stringstream stream;
+    writeTrace(stream);
+    std::vector<TraceRecord> records;
+    EXPECT_TRUE(readTrace(stream, records));
+    records.erase(std::remove_if(records.begin(), records.end(),
+                                 [logID](const TraceRecord& record) {
+                                     return record.logID != logID;
+                                 }),
+                  records.end());
+    return records;
+}
+
+}  // namespace
+
+TEST(TraceRingTest, KeepsArgsAndPayloadPrefix)
+{
+    TraceRing ring(3);
+    const std::vector<uint8_t> data(100, 0xab);
+    ring.write(kFunction, kLogID, {1, 2, 3, 4, 5}, TracePayload::Bytes, data.data(), data.size());
+
+    std::vector<TraceRecord> records;
+    ring.snapshot(records);
+    ASSERT_EQ(1u, records.size());
+    const TraceRecord& record = records[0];
+    EXPECT_EQ(3u, record.thread);
+    EXPECT_EQ(kFunction, record.functionID);
+    EXPECT_EQ(kLogID, record.logID);
+    ASSERT_EQ(kTraceArgCount, record.argCount);
+    EXPECT_EQ(4u, record.args[3]);
+    EXPECT_EQ(TracePayload::Bytes, record.payloadType);
+    EXPECT_EQ(100u, record.length);
+    EXPECT_EQ(0xab, record.payload[kTracePayloadSize - 1]);
+}
+
+TEST(TraceRingTest, OverwritesOldestRecords)
+{
+    TraceRing ring(0);
+    for (uint64_t i = 0; i < (TraceRing::kCapacity + 10); ++i) {
+        ring.write(kFunction, kLogID, {i}, TracePayload::None, nullptr, 0);
+    }
+
+    std::vector<TraceRecord> records;
+    ring.snapshot(records);
+    ASSERT_EQ(TraceRing::kCapacity, records.size());
+    EXPECT_EQ(10u, records.front().args[0]);
+    EXPECT_EQ(TraceRing::kCapacity + 9, records.back().args[0]);
+}
+
+TEST(TraceTest, ThreadsTraceInRingsOfTheirOwn)
+{
+    const uint16_t logID = kLogID + 1;
+    trace(kFunction, logID, {1});
+    std::thread([logID]() { trace(kFunction, logID, {2}); }).join();
+
+    const std::vector<TraceRecord> records = recordsOf(logID);
+    ASSERT_EQ(2u, records.size());
+    EXPECT_EQ(1u, records[0].args[0]);
+    EXPECT_EQ(2u, records[1].args[0]);
+    EXPECT_NE(records[0].thread, records[1].thread);
+}
+
+TEST(TraceTest, IdsAreTracedWithoutFormatting)
+{
+    const uint16_t logID = kLogID + 2;
+    PlainId plainId = {};
+    plainId.bytes[15] = 0x01;
+    traceId(kFunction, logID, {}, plainId);
+    traceId(kFunction, logID, {}, TextId());
+
+    const std::vector<TraceRecord> records = recordsOf(logID);
+    ASSERT_EQ(2u, records.size());
+    EXPECT_EQ(TracePayload::Id, records[0].payloadType);
+    EXPECT_EQ(16u, records[0].length);
+    EXPECT_EQ(0x01, records[0].payload[15]);
+    EXPECT_EQ(TracePayload::Text, records[1].payloadType);
+    EXPECT_EQ(36u, records[1].length);
+}
+
+TEST(TraceTest, TraceIsWrittenFromSignalHandlers)
+{
+    const uint16_t logID = kLogID + 3;
+    trace(kFunction, logID, {1});
+    std::thread([logID]() { trace(kFunction, logID, {2}); }).join();
+
+    char path[] = "/tmp/TraceTestXXXXXX";
+    const int fd = mkstemp(path);
+    ASSERT_LE(0, fd);
+    EXPECT_TRUE(writeTraceFromSignal(fd));
+    close(fd);
+
+    std::ifstream file(path, std::ios_base::binary);
+    std::vector<TraceRecord> records;
+    EXPECT_TRUE(readTrace(file, records));
+    std::remove(path);
+    records.erase(std::remove_if(records.begin(), records.end(),
+                                 [logID](const TraceRecord& record) {
+                                     return record.logID != logID;
+                                 }),
+                  records.end());
+    ASSERT_EQ(2u, records.size());
+    std::sort(records.begin(), records.end(), [](const TraceRecord& a, const TraceRecord& b) {
+        return a.args[0] < b.args[0];
+    });
+    EXPECT_EQ(1u, records[0].args[0]);
+    EXPECT_EQ(2u, records[1].args[0]);
+    EXPECT_NE(records[0].thread, records[1].thread);
+}
+
+TEST(TraceTest, OtherDataIsNotReadAsTrace)
+{
+    std::stringstream stream("not a trace at all");
+    std::vector<TraceRecord> records;
+    EXPECT_FALSE(readTrace(stream, records));
+    EXPECT_TRUE(records.empty());
+}
+
+}  // namespace impl
+}  // namespace cpucom
+}  // namespace ahu
+}  // namespace mitsubishielectric
+}  // namespace com
@@ -0,0 +1,517 @@
+/*
+ * COPYRIGHT (C) 2024 MITSUBISHI ELECTRIC CORPORATION
+ * ALL RIGHTS RESERVED
+ */
+
+#include "TransmitQueue.h"
+
+#include <gtest/gtest.h>
+
+#include <thread>
+
+namespace com {
+namespace mitsubishielectric {
+namespace ahu {
+namespace cpucom {
+namespace impl {
+
+namespace {
+
+using std::chrono::milliseconds;
+
+const common::CpuCommand kControlCommand = std::make_pair(0x11, 0x00);
+const common::CpuCommand kNormalCommand = std::make_pair(0x22, 0x00);
+const common::CpuCommand kBulkCommand = std::make_pair(0x33, 0x00);
+const common::CpuCommand kCoalescedCommand = std::make_pair(0x44, 0x00);  // normal
+
+const TransmitClassTable kTable = {{kControlCommand, TransmitClass::Control},
+                                   {kBulkCommand, TransmitClass::Bulk}};
+
+const TransmitQueue::ClientID kClient = "client";
+const TransmitQueue::ClientID kOtherClient = "other client";
+
+class TransmitQueueTest : public ::testing::Test {
+protected:
+    TransmitQueueTest()
+        : m_queue({kTable, {kCoalescedCommand}, kDefaultQuotaProfile}, 2)
+    {
+    }
+
+    bool push(const common::CpuCommand& command,
+              TransmitQueue::Done done = nullptr,
+              const TransmitQueue::ClientID& client = kClient)
+    {
+        return m_queue.push(client, command, {command.first}, std::move(done)) ==
+               TransmitQueue::Admission::Queued;
+    }
+
+    bool serve(bool result = true, milliseconds duration = milliseconds(0))
+    {
+        return m_queue.serve(
+            [this, result, duration](const common::CpuCommand& command,
+                                     const std::vector<uint8_t>& data) {
+                EXPECT_EQ(std::vector<uint8_t>{command.first}, data);
+                std::this_thread::sleep_for(duration);
+                m_sent.push_back(command);
+                return result;
+            },
+            milliseconds(0));
+    }
+
+    TransmitQueue m_queue;
+    std::vector<common::CpuCommand> m_sent;
+};
+
+}  // namespace
+
+TEST(TransmitClassTableTest, ParsesTable)
+{
+    TransmitClassTable table = defaultTransmitClassTable();
+    EXPECT_TRUE(parseTransmitClassTable("fd01=normal,11aB=control,2200=bulk", table));
+    const TransmitClassTable expected = {{std::make_pair(0xfd, 0x01), TransmitClass::Normal},
+                                         {std::make_pair(0x11, 0xab), TransmitClass::Control},
+                                         {std::make_pair(0x22, 0x00), TransmitClass::Bulk}};
+    EXPECT_EQ(expected, table);
+
+    EXPECT_TRUE(parseTransmitClassTable("", table));
+    EXPECT_EQ(expected, table);
+}
+
+TEST(TransmitClassTableTest, MalformedTableIsRejected)
+{
+    for (const char* text : {"fd01", "fd01=", "fd1=bulk", "fd001=bulk", "fdx1=bulk", "fd01=high",
+                             "fd01=bulk,,1100=control", "fd01=bulk;1100=control"}) {
+        TransmitClassTable table = defaultTransmitClassTable();
+        EXPECT_FALSE(parseTransmitClassTable(text, table)) << text;
+        EXPECT_EQ(defaultTransmitClassTable(), table) << text;
+    }
+}
+
+TEST(CoalescedCommandsTest, ParsesCommands)
+{
+    CoalescedCommands commands;
+    EXPECT_TRUE(parseCoalescedCommands("1100,fD01", commands));
+    const CoalescedCommands expected = {std::make_pair(0x11, 0x00), std::make_pair(0xfd, 0x01)};
+    EXPECT_EQ(expected, commands);
+
+    EXPECT_TRUE(parseCoalescedCommands("", commands));
+    EXPECT_EQ(expected, commands);
+
+    for (const char* text : {"110", "11000", "11x0", "1100,,fd01", "1100;fd01", "1100=bulk"}) {
+        CoalescedCommands unchanged = expected;
+        EXPECT_FALSE(parseCoalescedCommands(text, unchanged)) << text;
+        EXPECT_EQ(expected, unchanged) << text;
+    }
+}
+
+TEST_F(TransmitQueueTest, CommandsAreClassifiedByTable)
+{
+    EXPECT_EQ(TransmitClass::Control, m_queue.classOf(kControlCommand));
+    EXPECT_EQ(TransmitClass::Bulk, m_queue.classOf(kBulkCommand));
+    EXPECT_EQ(TransmitClass::Normal, m_queue.classOf(kNormalCommand));
+    EXPECT_EQ(TransmitClass::Normal, m_queue.classOf(std::make_pair(0x55, 0x00)));
+}
+
+TEST_F(TransmitQueueTest, HigherClassIsSentFirst)
+{
+    EXPECT_TRUE(push(kBulkCommand));
+    EXPECT_TRUE(push(kNormalCommand));
+    EXPECT_TRUE(push(kControlCommand));
+    EXPECT_TRUE(push(kNormalCommand));
+
+    while (serve()) {
+    }
+    const std::vector<common::CpuCommand> expected = {kControlCommand, kNormalCommand,
+                                                      kNormalCommand, kBulkCommand};
+    EXPECT_EQ(expected, m_sent);
+}
+
+TEST_F(TransmitQueueTest, CommandsOfClassAreSentInOrder)
+{
+    const common::CpuCommand otherCommand = std::make_pair(0x22, 0x01);
+    EXPECT_TRUE(push(kNormalCommand));
+    EXPECT_TRUE(push(otherCommand));
+
+    while (serve()) {
+    }
+    const std::vector<common::CpuCommand> expected = {kNormalCommand, otherCommand};
+    EXPECT_EQ(expected, m_sent);
+}
+
+TEST_F(TransmitQueueTest, FullClassRejectsCommands)
+{
+    EXPECT_TRUE(push(kBulkCommand));
+    EXPECT_TRUE(push(kBulkCommand));
+    EXPECT_FALSE(push(kBulkCommand));
+    // the other classes are not affected
+    EXPECT_TRUE(push(kControlCommand));
+    EXPECT_TRUE(push(kNormalCommand));
+
+    EXPECT_EQ(1u, m_queue.statistics(TransmitClass::Bulk).rejected);
+    EXPECT_EQ(0u, m_queue.statistics(TransmitClass::Normal).rejected);
+
+    // room again after a command is sent
+    while (serve()) {
+    }
+    EXPECT_TRUE(push(kBulkCommand));
+}
+
+TEST_F(TransmitQueueTest, ResultIsPassedToDone)
+{
+    std::vector<bool> results;
+    auto done = [&results](bool result) { results.push_back(result); };
+    EXPECT_TRUE(push(kNormalCommand, done));
+    EXPECT_TRUE(push(kNormalCommand, done));
+
+    EXPECT_TRUE(serve(true));
+    EXPECT_TRUE(serve(false));
+    const std::vector<bool> expected = {true, false};
+    EXPECT_EQ(expected, results);
+}
+
+TEST_F(TransmitQueueTest, StatisticsOfClass)
+{
+    EXPECT_TRUE(push(kControlCommand));
+    EXPECT_TRUE(push(kControlCommand));
+    EXPECT_FALSE(push(kControlCommand));
+    EXPECT_EQ(2u, m_queue.statistics(TransmitClass::Control).depth);
+    std::this_thread::sleep_for(milliseconds(2));
+
+    EXPECT_TRUE(serve(true, milliseconds(3)));
+    TransmitClassStatistics statistics = m_queue.statistics(TransmitClass::Control);
+    EXPECT_EQ(1u, statistics.depth);
+    EXPECT_EQ(2u, statistics.maxDepth);
+    EXPECT_EQ(1u, statistics.sent);
+    EXPECT_EQ(1u, statistics.rejected);
+    EXPECT_LE(2000u, statistics.maxWait);
+    EXPECT_EQ(statistics.maxWait, statistics.totalWait);
+    EXPECT_LE(3000u, statistics.maxService);
+    EXPECT_EQ(statistics.maxService, statistics.totalService);
+
+    EXPECT_TRUE(serve(true));
+    statistics = m_queue.statistics(TransmitClass::Control);
+    EXPECT_EQ(0u, statistics.depth);
+    EXPECT_EQ(2u, statistics.sent);
+    EXPECT_LE(5000u, statistics.totalWait);
+
+    const TransmitClassStatistics normal = m_queue.statistics(TransmitClass::Normal);
+    EXPECT_EQ(0u, normal.maxDepth);
+    EXPECT_EQ(0u, normal.sent);
+}
+
+TEST_F(TransmitQueueTest, ServeWaitsForCommand)
+{
+    std::thread producer([this]() {
+        std::this_thread::sleep_for(milliseconds(10));
+        push(kNormalCommand);
+    });
+    EXPECT_TRUE(m_queue.serve(
+        [](const common::CpuCommand&, const std::vector<uint8_t>&) { return true; },
+        milliseconds(5000)));
+    producer.join();
+}
+
+TEST_F(TransmitQueueTest, CloseDropsCommandsAndWakesServe)
+{
+    EXPECT_TRUE(push(kNormalCommand));
+    m_queue.close();
+    EXPECT_EQ(0u, m_queue.statistics(TransmitClass::Normal).depth);
+    EXPECT_FALSE(serve());
+    EXPECT_FALSE(push(kNormalCommand));
+    EXPECT_TRUE(m_sent.empty());
+
+    TransmitQueue queue;
+    std::thread closer([&queue]() {
+        std::this_thread::sleep_for(milliseconds(10));
+        queue.close();
+    });
+    EXPECT_FALSE(queue.serve(
+        [](const common::CpuCommand&, const std::vector<uint8_t>&) { return true; },
+        milliseconds(5000)));
+    closer.join();
+}
+
+TEST_F(TransmitQueueTest, CloseReportsDroppedCommandsAsNotSent)
+{
+    std::vector<bool> results;
+    auto done = [&results](bool result) { results.push_back(result); };
+    EXPECT_TRUE(push(kNormalCommand, done));
+    EXPECT_TRUE(push(kBulkCommand, done));
+    EXPECT_TRUE(push(kCoalescedCommand, done));
+    EXPECT_TRUE(push(kCoalescedCommand, done));
+    EXPECT_TRUE(push(kControlCommand));
+
+    m_queue.close();
+    const std::vector<bool> expected = {false, false, false, false};
+    EXPECT_EQ(expected, results);
+    EXPECT_FALSE(serve());
+    EXPECT_TRUE(m_sent.empty());
+}
+
+TEST_F(TransmitQueueTest, StatisticsAreFormatted)
+{
+    EXPECT_TRUE(push(kBulkCommand));
+    EXPECT_TRUE(push(kBulkCommand));
+    EXPECT_FALSE(push(kBulkCommand));
+    EXPECT_TRUE(serve());
+
+    const std::string stats = formatTransmitStats(m_queue);
+    EXPECT_EQ(0u, stats.find("transmit  depth max depth"));
+    EXPECT_NE(std::string::npos, stats.find("\ncontrol       0         0          0          0"));
+    EXPECT_NE(std::string::npos, stats.find("\nbulk          1         2          1          1"));
+    // the command rejected as the queue was full is not consumed
+    EXPECT_NE(std::string::npos, stats.find("\nclient                     commands"));
+    EXPECT_NE(std::string::npos, stats.find("\nclient                            2 "));
+}
+
+TEST_F(TransmitQueueTest, CoalescedCommandSendsLatestData)
+{
+    std::vector<std::vector<uint8_t>> sent;
+    auto send = [&sent](const common::CpuCommand&, const std::vector<uint8_t>& data) {
+        sent.push_back(data);
+        return true;
+    };
+    std::vector<int> done;
+    m_queue.push(kClient, kCoalescedCommand, {1}, [&done](bool) { done.push_back(1); });
+    m_queue.push(kClient, kCoalescedCommand, {2}, nullptr);
+    m_queue.push(kClient, kCoalescedCommand, {3}, [&done](bool) { done.push_back(3); });
+
+    EXPECT_TRUE(m_queue.serve(send, milliseconds(0)));
+    EXPECT_FALSE(m_queue.serve(send, milliseconds(0)));
+    const std::vector<std::vector<uint8_t>> expected = {{3}};
+    EXPECT_EQ(expected, sent);
+    // the client is told the result of sending the latest data for each of its commands
+    const std::vector<int> expectedDone = {1, 3};
+    EXPECT_EQ(expectedDone, done);
+
+    const TransmitClassStatistics statistics = m_queue.statistics(TransmitClass::Normal);
+    EXPECT_EQ(1u, statistics.sent);
+    EXPECT_EQ(2u, statistics.replaced);
+    EXPECT_EQ(1u, statistics.maxDepth);
+    EXPECT_EQ(3u, m_queue.consumption(kClient).commands);
+}
+
+TEST_F(TransmitQueueTest, CoalescedCommandIsNotReplacedByOtherClient)
+{
+    std::vector<std::vector<uint8_t>> sent;
+    auto send = [&sent](const common::CpuCommand&, const std::vector<uint8_t>& data) {
+        sent.push_back(data);
+        return true;
+    };
+    std::vector<bool> results;
+    auto done = [&results](bool result) { results.push_back(result); };
+    m_queue.push(kClient, kCoalescedCommand, {1}, done);
+    m_queue.push(kOtherClient, kCoalescedCommand, {2}, done);
+
+    while (m_queue.serve(send, milliseconds(0))) {
+    }
+    const std::vector<std::vector<uint8_t>> expected = {{1}, {2}};
+    EXPECT_EQ(expected, sent);
+    EXPECT_EQ((std::vector<bool>{true, true}), results);
+    EXPECT_EQ(0u, m_queue.statistics(TransmitClass::Normal).replaced);
+}
+
+TEST_F(TransmitQueueTest, ReplacingCoalescedCommandIsChargedToQuota)
+{
+    TransmitQueue queue({TransmitClassTable(), {kCoalescedCommand}, {10, 0}});
+    EXPECT_EQ(TransmitQueue::Admission::Queued,
+              queue.push(kClient, kCoalescedCommand, std::vector<uint8_t>(8, 1), nullptr));
+    EXPECT_EQ(TransmitQueue::Admission::Throttled,
+              queue.push(kClient, kCoalescedCommand, std::vector<uint8_t>(8, 2), nullptr));
+    EXPECT_EQ(TransmitQueue::Admission::Queued,
+              queue.push(kClient, kCoalescedCommand, std::vector<uint8_t>(2, 3), nullptr));
+
+    const ClientConsumption consumption = queue.consumption(kClient);
+    EXPECT_EQ(2u, consumption.commands);
+    EXPECT_EQ(10u, consumption.bytes);
+    EXPECT_EQ(1u, consumption.throttled);
+    const TransmitClassStatistics statistics = queue.statistics(TransmitClass::Normal);
+    EXPECT_EQ(1u, statistics.replaced);
+    EXPECT_EQ(1u, statistics.rejected);
+
+    std::vector<std::vector<uint8_t>> sent;
+    auto send = [&sent](const common::CpuCommand&, const std::vector<uint8_t>& data) {
+        sent.push_back(data);
+        return true;
+    };
+    while (queue.serve(send, milliseconds(0))) {
+    }
+    const std::vector<std::vector<uint8_t>> expected = {std::vector<uint8_t>(2, 3)};
+    EXPECT_EQ(expected, sent);
+}
+
+TEST_F(TransmitQueueTest, ReplacedCommandFinishesByItsNewSize)
+{
+    TransmitQueue queue({TransmitClassTable(), {kCoalescedCommand}, {0, 0}}, 8);
+    const common::CpuCommand a = std::make_pair(0xa0, 0x00);
+    const common::CpuCommand b = std::make_pair(0xb0, 0x00);
+    queue.push(kClient, kCoalescedCommand, std::vector<uint8_t>(10), nullptr);
+    queue.push(kClient, a, std::vector<uint8_t>(10), nullptr);
+    queue.push(kOtherClient, b, std::vector<uint8_t>(10), nullptr);
+    queue.push(kOtherClient, b, std::vector<uint8_t>(10), nullptr);
+    // the bigger data is behind the commands the other client queued meanwhile,
+    // and the next command of the client stays behind it
+    queue.push(kClient, kCoalescedCommand, std::vector<uint8_t>(30), nullptr);
+
+    std::vector<uint8_t> sent;
+    auto send = [&sent](const common::CpuCommand& command, const std::vector<uint8_t>&) {
+        sent.push_back(command.first);
+        return true;
+    };
+    while (queue.serve(send, milliseconds(0))) {
+    }
+    const std::vector<uint8_t> expected = {0xb0, 0xb0, kCoalescedCommand.first, 0xa0};
+    EXPECT_EQ(expected, sent);
+}
+
+TEST_F(TransmitQueueTest, CoalescedCommandKeepsItsPlace)
+{
+    EXPECT_TRUE(push(kCoalescedCommand));
+    EXPECT_TRUE(push(kNormalCommand));
+    // replacing needs no room in the full class
+    EXPECT_TRUE(push(kCoalescedCommand));
+
+    while (serve()) {
+    }
+    const std::vector<common::CpuCommand> expected = {kCoalescedCommand, kNormalCommand};
+    EXPECT_EQ(expected, m_sent);
+    EXPECT_EQ(0u, m_queue.statistics(TransmitClass::Normal).rejected);
+}
+
+TEST_F(TransmitQueueTest, CommandIsQueuedAgainOnceTaken)
+{
+    EXPECT_TRUE(push(kCoalescedCommand));
+    EXPECT_TRUE(serve());
+    EXPECT_TRUE(push(kCoalescedCommand));
+    EXPECT_TRUE(serve());
+    EXPECT_EQ(2u, m_sent.size());
+    EXPECT_EQ(0u, m_queue.statistics(TransmitClass::Normal).replaced);
+}
+
+TEST_F(TransmitQueueTest, CommandsWhichAreNotCoalescedAreQueuedAgain)
+{
+    EXPECT_TRUE(push(kControlCommand));
+    EXPECT_TRUE(push(kControlCommand));
+
+    while (serve()) {
+    }
+    EXPECT_EQ(2u, m_sent.size());
+    EXPECT_EQ(0u, m_queue.statistics(TransmitClass::Control).replaced);
+}
+
+TEST_F(TransmitQueueTest, ClientOverItsQuotaIsThrottled)
+{
+    TransmitQueue queue({TransmitClassTable(), CoalescedCommands(), {10, 0}});
+    EXPECT_EQ(TransmitQueue::Admission::Queued,
+              queue.push(kClient, kNormalCommand, std::vector<uint8_t>(8), nullptr));
+    EXPECT_EQ(TransmitQueue::Admission::Throttled,
+              queue.push(kClient, kNormalCommand, std::vector<uint8_t>(8), nullptr));
+    // the others have their own quota
+    EXPECT_EQ(TransmitQueue::Admission::Queued,
+              queue.push(kOtherClient, kNormalCommand, std::vector<uint8_t>(8), nullptr));
+    // which is not used up by the rest of the second
+    EXPECT_EQ(TransmitQueue::Admission::Queued,
+              queue.push(kClient, kNormalCommand, std::vector<uint8_t>(2), nullptr));
+
+    const ClientConsumption consumption = queue.consumption(kClient);
+    EXPECT_EQ(2u, consumption.commands);
+    EXPECT_EQ(10u, consumption.bytes);
+    EXPECT_EQ(2u, consumption.frames);
+    EXPECT_EQ(1u, consumption.throttled);
+    EXPECT_EQ(1u, queue.statistics(TransmitClass::Normal).rejected);
+}
+
+TEST_F(TransmitQueueTest, FramesAreLimitedToo)
+{
+    TransmitQueue queue({TransmitClassTable(), CoalescedCommands(), {0, 2}});
+    // a command with more than 1 KB of data is divided into 2 frames
+    EXPECT_EQ(TransmitQueue::Admission::Queued,
+              queue.push(kClient, kNormalCommand, std::vector<uint8_t>(1100), nullptr));
+    EXPECT_EQ(TransmitQueue::Admission::Throttled,
+              queue.push(kClient, kNormalCommand, std::vector<uint8_t>(1), nullptr));
+    EXPECT_EQ(2u, queue.consumption(kClient).frames);
+}
+
+TEST_F(TransmitQueueTest, RemovedClientIsForgotten)
+{
+    TransmitQueue queue({TransmitClassTable(), CoalescedCommands(), {10, 0}});
+    queue.push(kClient, kNormalCommand, std::vector<uint8_t>(10), nullptr);
+    EXPECT_EQ(1u, queue.consumption(kClient).commands);
+
+    queue.removeClient(kClient);
+    EXPECT_EQ(0u, queue.consumption(kClient).commands);
+    EXPECT_EQ(TransmitQueue::Admission::Queued,
+              queue.push(kClient, kNormalCommand, std::vector<uint8_t>(10), nullptr));
+    // the command queued before is still sent
+    std::vector<size_t> sent;
+    auto send = [&sent](const common::CpuCommand&, const std::vector<uint8_t>& data) {
+        sent.push_back(data.size());
+        return true;
+    };
+    while (queue.serve(send, milliseconds(0))) {
+    }
+    EXPECT_EQ(2u, sent.size());
+}
+
+TEST_F(TransmitQueueTest, ClientsShareClassFairly)
+{
+    TransmitQueue queue({TransmitClassTable(), CoalescedCommands(), {0, 0}}, 8);
+    const common::CpuCommand a = std::make_pair(0xa0, 0x00);
+    const common::CpuCommand b = std::make_pair(0xb0, 0x00);
+    // a burst of a client is queued before the other client sends anything
+    for (uint8_t i = 1; i <= 4; ++i) {
+        queue.push(kClient, a, std::vector<uint8_t>(10, i), nullptr);
+    }
+    for (uint8_t i = 1; i <= 2; ++i) {
+        queue.push(kOtherClient, b, std::vector<uint8_t>(10, i), nullptr);
+    }
+    // and a big command of the other client has to wait for its share
+    queue.push(kOtherClient, b, std::vector<uint8_t>(40, 3), nullptr);
+
+    std::vector<std::pair<uint8_t, uint8_t>> sent;
+    auto send = [&sent](const common::CpuCommand& command, const std::vector<uint8_t>& data) {
+        sent.emplace_back(command.first, data[0]);
+        return true;
+    };
+    while (queue.serve(send, milliseconds(0))) {
+    }
+    const std::vector<std::pair<uint8_t, uint8_t>> expected = {
+        {0xa0, 1}, {0xb0, 1}, {0xa0, 2}, {0xb0, 2}, {0xa0, 3}, {0xa0, 4}, {0xb0, 3}};
+    EXPECT_EQ(expected, sent);
+}
+
+TEST_F(TransmitQueueTest, ClientJoiningLaterIsNotAheadOfOthers)
+{
+    TransmitQueue queue({TransmitClassTable(), CoalescedCommands(), {0, 0}}, 8);
+    const common::CpuCommand a = std::make_pair(0xa0, 0x00);
+    const common::CpuCommand b = std::make_pair(0xb0, 0x00);
+    std::vector<uint8_t> sent;
+    auto send = [&sent](const common::CpuCommand& command, const std::vector<uint8_t>&) {
+        sent.push_back(command.first);
+        return true;
+    };
+    for (int i = 0; i < 4; ++i) {
+        queue.push(kClient, a, std::vector<uint8_t>(10), nullptr);
+    }
+    EXPECT_TRUE(queue.serve(send, milliseconds(0)));
+    EXPECT_TRUE(queue.serve(send, milliseconds(0)));
+    // the other client does not get credit for the time it sent nothing
+    queue.push(kOtherClient, b, std::vector<uint8_t>(10), nullptr);
+    queue.push(kOtherClient, b, std::vector<uint8_t>(10), nullptr);
+    while (queue.serve(send, milliseconds(0))) {
+    }
+    const std::vector<uint8_t> expected = {0xa0, 0xa0, 0xa0, 0xb0, 0xa0, 0xb0};
+    EXPECT_EQ(expected, sent);
+}
+
+TEST_F(TransmitQueueTest, NothingToServe)
+{
+    EXPECT_FALSE(serve());
+    EXPECT_TRUE(m_sent.empty());
+}
+
+}  // namespace impl
+}  // namespace cpucom
+}  // namespace ahu
+}  // namespace mitsubishielectric
+}  // namespace com
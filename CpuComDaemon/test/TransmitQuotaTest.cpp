@@ -0,0 +1,117 @@
+/*
+ * COPYRIGHT (C) 2024 MITSUBISHI ELECTRIC CORPORATION
+ * ALL RIGHTS RESERVED
+ */
+
+#include "TransmitQuota.h"
+
+#include <gtest/gtest.h>
+
+namespace com {
+namespace mitsubishielectric {
+namespace ahu {
+namespace cpucom {
+namespace impl {
+
+namespace {
+
+using std::chrono::microseconds;
+using std::chrono::milliseconds;
+
+const TokenBucket::Clock::time_point kStart;
+
+}  // namespace
+
+TEST(TransmitQuotaTest, ParsesProfile)
+{
+    QuotaProfile profile = kDefaultQuotaProfile;
+    EXPECT_TRUE(parseQuotaProfile("bytes=1000,frames=10", profile));
+    EXPECT_EQ(1000u, profile.bytesPerSecond);
+    EXPECT_EQ(10u, profile.framesPerSecond);
+
+    EXPECT_TRUE(parseQuotaProfile("frames=0", profile));
+    EXPECT_EQ(1000u, profile.bytesPerSecond);
+    EXPECT_EQ(0u, profile.framesPerSecond);
+}
+
+TEST(TransmitQuotaTest, MalformedProfileIsRejected)
+{
+    for (const char* text : {"bytes", "bytes=", "bytes=-1", "bytes=1k", "commands=10",
+                             "bytes=1,,frames=1", "bytes=1;frames=1"}) {
+        QuotaProfile profile = kDefaultQuotaProfile;
+        EXPECT_FALSE(parseQuotaProfile(text, profile)) << text;
+        EXPECT_EQ(kDefaultQuotaProfile.bytesPerSecond, profile.bytesPerSecond) << text;
+        EXPECT_EQ(kDefaultQuotaProfile.framesPerSecond, profile.framesPerSecond) << text;
+    }
+}
+
+TEST(TransmitQuotaTest, FramesOfCommand)
+{
+    EXPECT_EQ(1u, framesOf(0));
+    EXPECT_EQ(1u, framesOf(1027));
+    EXPECT_EQ(2u, framesOf(1028));
+    EXPECT_EQ(3u, framesOf(2049));
+}
+
+TEST(TransmitQuotaTest, BucketStartsWithSecondWorthOfTokens)
+{
+    TokenBucket bucket(100, kStart);
+    EXPECT_FALSE(bucket.has(101, kStart));
+    EXPECT_TRUE(bucket.take(60, kStart));
+    EXPECT_FALSE(bucket.take(60, kStart));
+    EXPECT_TRUE(bucket.take(40, kStart));
+    EXPECT_FALSE(bucket.has(1, kStart));
+}
+
+TEST(TransmitQuotaTest, BucketIsRefilledAtRate)
+{
+    TokenBucket bucket(100, kStart);
+    EXPECT_TRUE(bucket.take(100, kStart));
+    EXPECT_FALSE(bucket.has(1, kStart + milliseconds(9)));
+    EXPECT_TRUE(bucket.has(1, kStart + milliseconds(10)));
+    EXPECT_TRUE(bucket.take(50, kStart + milliseconds(500)));
+    EXPECT_FALSE(bucket.has(1, kStart + milliseconds(500)));
+}
+
+TEST(TransmitQuotaTest, FractionsOfTokensAddUp)
+{
+    TokenBucket bucket(3, kStart);
+    EXPECT_TRUE(bucket.take(3, kStart));
+    TokenBucket::Clock::time_point now = kStart;
+    // a token every 333.3 ms, checked every 100 ms
+    for (int i = 0; i < 3; ++i) {
+        now += milliseconds(100);
+        EXPECT_FALSE(bucket.has(1, now)) << i;
+    }
+    now += milliseconds(100);
+    EXPECT_TRUE(bucket.take(1, now));
+    now += milliseconds(600);
+    EXPECT_TRUE(bucket.take(2, now));
+}
+
+TEST(TransmitQuotaTest, BucketHoldsAtMostSecondWorth)
+{
+    TokenBucket bucket(100, kStart);
+    EXPECT_TRUE(bucket.take(100, kStart));
+    EXPECT_FALSE(bucket.has(101, kStart + std::chrono::seconds(10)));
+    EXPECT_TRUE(bucket.has(100, kStart + std::chrono::seconds(10)));
+
+    TokenBucket full(100, kStart);
+    EXPECT_FALSE(full.has(101, kStart + milliseconds(999)));
+    // time going backwards adds nothing
+    EXPECT_TRUE(full.take(100, kStart + milliseconds(999)));
+    EXPECT_FALSE(full.has(1, kStart + microseconds(1)));
+}
+
+TEST(TransmitQuotaTest, ZeroRateIsNoLimit)
+{
+    TokenBucket bucket(0, kStart);
+    EXPECT_TRUE(bucket.take(UINT32_MAX, kStart));
+    EXPECT_TRUE(bucket.take(UINT32_MAX, kStart));
+}
+
+}  // namespace impl
+}  // namespace cpucom
+}  // namespace ahu
+}  // namespace mitsubishielectric
+}  // namespace com
@@ -30,11 +30,19 @@ public:
     MOCK_METHOD2(setCancelRequestMessageHandler, void(OnCancelRequestHandler, CpuComDaemon*));
     MOCK_METHOD2(setSendCommandWithDeliveryStatusMessageHandler,
                  void(OnSendCommandWithDeliveryStatusHandler, CpuComDaemon*));
-    MOCK_METHOD3(sendNotificationMessage,
-                 void(SessionID, common::CpuCommand, std::vector<uint8_t>&));
+    MOCK_METHOD2(setSendCommandWithTraceMessageHandler,
+                 void(OnSendCommandWithTraceHandler, CpuComDaemon*));
+    MOCK_METHOD2(setStatsMessageHandler, void(OnStatsHandler, CpuComDaemon*));
+    MOCK_METHOD4(sendNotificationMessage,
+                 void(const std::vector<SessionID>&, common::CpuCommand,
+                      const std::vector<uint8_t>&, const std::vector<uint8_t>&));
     MOCK_METHOD3(sendRequestResponseMessage, void(SessionID, common::UUID, std::vector<uint8_t>&));
-    MOCK_METHOD3(sendSendCommandResultMessage, void(SessionID, common::CpuCommand, common::Error));
+    MOCK_METHOD2(sendRequestTimeoutMessage, void(SessionID, common::UUID));
+    MOCK_METHOD3(sendSendCommandResultMessage, void(SessionID, common::CpuCommand, int));
     MOCK_METHOD3(sendDeliveryStatusMessage, void(SessionID, common::UUID, bool));
+    MOCK_METHOD4(sendDeliveryTraceMessage,
+                 void(SessionID, common::UUID, bool, const std::vector<uint8_t>&));
+    MOCK_METHOD2(sendStatsMessage, void(SessionID, const std::string&));
 };
 
 }  // namespace impl
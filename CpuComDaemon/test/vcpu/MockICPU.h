@@ -21,6 +21,8 @@ public:
     MOCK_METHOD0(initialize, bool());
     MOCK_METHOD1(read, bool(std::pair<common::CpuCommand, std::vector<uint8_t>>&));
     MOCK_METHOD2(write, bool(const common::CpuCommand&, const std::vector<uint8_t>&));
+    MOCK_CONST_METHOD0(lastSendTimes, SendTimes());
+    MOCK_CONST_METHOD0(lastReceiveTimes, ReceiveTimes());
 };
 
 }  // namespace impl
@@ -0,0 +1,36 @@
+/*
+ * COPYRIGHT (C) 2024 MITSUBISHI ELECTRIC CORPORATION
+ * ALL RIGHTS RESERVED
+ */
+
+#ifndef COM_MITSUBISHIELECTRIC_AHU_CPUCOM_MOCKLINEDEVICE_H_
+#define COM_MITSUBISHIELECTRIC_AHU_CPUCOM_MOCKLINEDEVICE_H_
+
+#include "ILineDevice.h"
+
+#include <mock/mock_IODevice.h>
+
+#include <gmock/gmock.h>
+
+namespace com {
+namespace mitsubishielectric {
+namespace ahu {
+namespace cpucom {
+namespace impl {
+
+class MockLineDevice : public common::mock_IODevice, public ILineDevice {
+public:
+    MOCK_METHOD3(writeVector,
+                 common::IODevice::Result(const struct iovec*, int, std::chrono::milliseconds));
+    MOCK_METHOD4(readAvailable,
+                 common::IODevice::Result(uint8_t*, size_t, std::chrono::milliseconds, size_t&));
+    MOCK_METHOD2(drain, common::IODevice::Result(DrainTail&, size_t&));
+};
+
+}  // namespace impl
+}  // namespace cpucom
+}  // namespace ahu
+}  // namespace mitsubishielectric
+}  // namespace com
+
+#endif  // COM_MITSUBISHIELECTRIC_AHU_CPUCOM_MOCKLINEDEVICE_H_
@@ -0,0 +1,87 @@
+/*
+ * COPYRIGHT (C) 2024 MITSUBISHI ELECTRIC CORPORATION
+ * ALL RIGHTS RESERVED
+ */
+
+#include "FlightRecorder.h"
+#include "ProtocolStates.h"
+
+#include <gtest/gtest.h>
+
+#include <thread>
+
+namespace com {
+namespace mitsubishielectric {
+namespace ahu {
+namespace cpucom {
+namespace impl {
+
+namespace {
+const std::chrono::steady_clock::time_point kEntered(std::chrono::milliseconds(10));
+}  // namespace
+
+TEST(FlightRecorderTest, RecordsTransitionsOldestFirst)
+{
+    FlightRecorder recorder;
+    EXPECT_TRUE(recorder.transitions().empty());
+
+    recorder.record(FlightRecorder::Sending, sending::Ack, static_cast<uint8_t>(Event::Pass),
+                    0x06, kEntered, kEntered + std::chrono::microseconds(700));
+    recorder.record(FlightRecorder::Receiving, receiving::Checksum,
+                    static_cast<uint8_t>(Event::Deny), 0x42, kEntered,
+                    kEntered + std::chrono::microseconds(30));
+
+    const std::vector<FlightRecorder::Transition> transitions = recorder.transitions();
+    ASSERT_EQ(2u, transitions.size());
+    EXPECT_EQ(FlightRecorder::Sending, transitions[0].machine);
+    EXPECT_EQ(sending::Ack, transitions[0].state);
+    EXPECT_EQ(static_cast<uint8_t>(Event::Pass), transitions[0].event);
+    EXPECT_EQ(0x06, transitions[0].byte);
+    EXPECT_EQ(700u, transitions[0].dwell);
+    EXPECT_EQ(10700000u, transitions[0].left);
+    EXPECT_EQ(FlightRecorder::Receiving, transitions[1].machine);
+    EXPECT_EQ(30u, transitions[1].dwell);
+    EXPECT_STREQ("cs", FlightRecorder::stateName(transitions[1].machine, transitions[1].state));
+    EXPECT_STREQ("deny", FlightRecorder::eventName(transitions[1].event));
+}
+
+TEST(FlightRecorderTest, KeepsTheLastTransitionsWhenFull)
+{
+    FlightRecorder recorder;
+    for (size_t i = 0; i < FlightRecorder::kCapacity + 10; ++i) {
+        recorder.record(FlightRecorder::Receiving, receiving::Data,
+                        static_cast<uint8_t>(Event::Pass), static_cast<uint8_t>(i), kEntered,
+                        kEntered);
+    }
+
+    const std::vector<FlightRecorder::Transition> transitions = recorder.transitions();
+    ASSERT_EQ(FlightRecorder::kCapacity, transitions.size());
+    EXPECT_EQ(10u, transitions.front().byte);
+    EXPECT_EQ(static_cast<uint8_t>(FlightRecorder::kCapacity + 9), transitions.back().byte);
+}
+
+TEST(FlightRecorderTest, RecordsFromBothMachinesAtOnce)
+{
+    FlightRecorder recorder;
+    const size_t perThread = 1000;
+    auto record = [&recorder, perThread](FlightRecorder::Machine machine) {
+        for (size_t i = 0; i < perThread; ++i) {
+            recorder.record(machine, 1, 0, 0, kEntered, kEntered);
+        }
+    };
+    std::thread sender(record, FlightRecorder::Sending);
+    std::thread receiver(record, FlightRecorder::Receiving);
+    for (size_t i = 0; i < 100; ++i) {
+        EXPECT_LE(recorder.transitions().size(), FlightRecorder::kCapacity);
+    }
+    sender.join();
+    receiver.join();
+
+    EXPECT_EQ(FlightRecorder::kCapacity, recorder.transitions().size());
+}
+
+}  // namespace impl
+}  // namespace cpucom
+}  // namespace ahu
+}  // namespace mitsubishielectric
+}  // namespace com
@@ -0,0 +1,144 @@
+/*
+ * COPYRIGHT (C) 2024 MITSUBISHI ELECTRIC CORPORATION
+ * ALL RIGHTS RESERVED
+ */
+
+#include "FrameChecksum.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "Checksum.h"
+#include "FrameFormat.h"
+
+namespace com {
+namespace mitsubishielectric {
+namespace ahu {
+namespace cpucom {
+namespace impl {
+
+using namespace frame;
+
+namespace {
+
+// longer than any frame, with room for every misalignment of a 16 byte vector
+const size_t kMaxLength = kMaxWireFrameLength + 64;
+const size_t kMaxOffset = 16;
+
+std::vector<uint8_t> randomBytes(size_t size)
+{
+    std::minstd_rand random(1);
+    std::vector<uint8_t> bytes(size);
+    for (uint8_t& b : bytes) {
+        b = static_cast<uint8_t>(random());
+    }
+    return bytes;
+}
+
+uint8_t expectedChecksum(const uint8_t* data, size_t length)
+{
+    return common::checksum(data, data + length);
+}
+
+}  // namespace
+
+TEST(FrameChecksumTest, BlockChecksumMatchesCommonChecksum)
+{
+    const std::vector<uint8_t> bytes = randomBytes(kMaxLength + kMaxOffset);
+    for (size_t offset = 0; offset < kMaxOffset; ++offset) {
+        for (size_t length = 0; length <= kMaxLength; ++length) {
+            const uint8_t* data = bytes.data() + offset;
+            ASSERT_EQ(expectedChecksum(data, length), blockChecksum(data, length))
+                << "offset " << offset << ", length " << length;
+        }
+    }
+}
+
+TEST(FrameChecksumTest, WordChecksumMatchesCommonChecksum)
+{
+    const std::vector<uint8_t> bytes = randomBytes(kMaxLength + kMaxOffset);
+    for (size_t offset = 0; offset < kMaxOffset; ++offset) {
+        for (size_t length = 0; length <= kMaxLength; ++length) {
+            const uint8_t* data = bytes.data() + offset;
+            ASSERT_EQ(expectedChecksum(data, length), wordChecksum(data, length))
+                << "offset " << offset << ", length " << length;
+        }
+    }
+}
+
+TEST(FrameChecksumTest, EveryByteValueAtEveryPositionOfVector)
+{
+    std::vector<uint8_t> bytes = randomBytes(64);
+    for (size_t position = 0; position < bytes.size(); ++position) {
+        const uint8_t original = bytes[position];
+        for (uint32_t value = 0; value <= UINT8_MAX; ++value) {
+            bytes[position] = static_cast<uint8_t>(value);
+            const uint8_t expected = expectedChecksum(bytes.data(), bytes.size());
+            ASSERT_EQ(expected, blockChecksum(bytes.data(), bytes.size()))
+                << "position " << position << ", value " << value;
+            ASSERT_EQ(expected, wordChecksum(bytes.data(), bytes.size()))
+                << "position " << position << ", value " << value;
+        }
+        bytes[position] = original;
+    }
+}
+
+TEST(FrameChecksumTest, ChecksumContinuesFromSeed)
+{
+    const std::vector<uint8_t> bytes = randomBytes(kMaxLength);
+    const uint8_t expected = expectedChecksum(bytes.data(), bytes.size());
+    for (size_t split = 0; split <= bytes.size(); ++split) {
+        const uint8_t* rest = bytes.data() + split;
+        const size_t restLength = bytes.size() - split;
+        ASSERT_EQ(expected, blockChecksum(rest, restLength, blockChecksum(bytes.data(), split)))
+            << "split " << split;
+        ASSERT_EQ(expected, wordChecksum(rest, restLength, wordChecksum(bytes.data(), split)))
+            << "split " << split;
+    }
+}
+
+TEST(FrameChecksumTest, CopyWithChecksumCopiesAndMatchesCommonChecksum)
+{
+    const std::vector<uint8_t> bytes = randomBytes(kMaxLength + kMaxOffset);
+    std::vector<uint8_t> copy(kMaxLength + kMaxOffset);
+    for (size_t offset = 0; offset < kMaxOffset; ++offset) {
+        for (size_t length = 0; length <= kMaxLength; ++length) {
+            const uint8_t* data = bytes.data() + offset;
+            std::fill(copy.begin(), copy.end(), 0);
+            ASSERT_EQ(expectedChecksum(data, length),
+                      copyWithChecksum(copy.data() + kMaxOffset - offset, data, length))
+                << "offset " << offset << ", length " << length;
+            ASSERT_TRUE(std::equal(data, data + length, copy.data() + kMaxOffset - offset))
+                << "offset " << offset << ", length " << length;
+            // nothing is written past the copy
+            ASSERT_TRUE(std::all_of(copy.begin() + kMaxOffset - offset + length, copy.end(),
+                                    [](uint8_t b) { return b == 0; }))
+                << "offset " << offset << ", length " << length;
+        }
+    }
+}
+
+TEST(FrameChecksumTest, FrameChecksumCoversLengthToEtx)
+{
+    const std::vector<uint8_t> payload = randomBytes(kMaxExtendedLengthFrameDivisionFrameLength);
+    const uint8_t header[] = {STX, EXT_LEN, 1, 2, 3, 0, 4, 16, 0, 1, 0, 2};
+    for (uint32_t headerLength = kStxLength; headerLength <= sizeof(header); ++headerLength) {
+        for (uint32_t payloadLength = 0; payloadLength <= payload.size(); ++payloadLength) {
+            std::vector<uint8_t> frame(header + kStxLength, header + headerLength);
+            frame.insert(frame.end(), payload.begin(), payload.begin() + payloadLength);
+            frame.push_back(ETX);
+            ASSERT_EQ(expectedChecksum(frame.data(), frame.size()),
+                      frameChecksum(header, headerLength, payload.data(), payloadLength))
+                << "header " << headerLength << ", payload " << payloadLength;
+        }
+    }
+}
+
+}  // namespace impl
+}  // namespace cpucom
+}  // namespace ahu
+}  // namespace mitsubishielectric
+}  // namespace com
@@ -0,0 +1,151 @@
+/*
+ * COPYRIGHT (C) 2024 MITSUBISHI ELECTRIC CORPORATION
+ * ALL RIGHTS RESERVED
+ */
+
+#include "FrameEncoder.h"
+
+#include "Checksum.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <iterator>
+#include <vector>
+
+namespace com {
+namespace mitsubishielectric {
+namespace ahu {
+namespace cpucom {
+namespace impl {
+
+using ::testing::TestWithParam;
+using ::testing::Values;
+
+namespace {
+const uint8_t kCommand = 0x12;
+const uint8_t kSubCommand = 0x34;
+const uint8_t kCodebit = 0x44;
+const uint32_t kMaxFrameDataLength = 1024;
+
+std::vector<uint8_t> makeMessage(size_t dataLength)
+{
+    std::vector<uint8_t> message = {kCommand, kSubCommand, kCodebit};
+    for (size_t i = 0; i < dataLength; ++i) {
+        message.push_back(static_cast<uint8_t>(i * 7 + 1));
+    }
+    return message;
+}
+
+void appendFooter(std::vector<uint8_t>& frame)
+{
+    frame.push_back(ETX);
+    frame.push_back(common::checksum(std::next(frame.begin()), frame.end()));
+}
+
+void appendLength(std::vector<uint8_t>& frame, uint32_t length)
+{
+    frame.push_back(static_cast<uint8_t>((length >> 16) & 0x000000ff));
+    frame.push_back(static_cast<uint8_t>((length >> 8) & 0x000000ff));
+    frame.push_back(static_cast<uint8_t>(length & 0x000000ff));
+}
+
+// Builds the frames of a message byte by byte, as they are expected on the line
+std::vector<std::vector<uint8_t>> expectedFrames(const std::vector<uint8_t>& message)
+{
+    std::vector<std::vector<uint8_t>> frames;
+    const size_t dataLength = message.size() - 3;
+    if (message.size() <= 251) {
+        std::vector<uint8_t> frame = {STX, static_cast<uint8_t>(message.size() + 2)};
+        frame.insert(frame.end(), message.begin(), message.end());
+        appendFooter(frame);
+        frames.push_back(frame);
+    }
+    else if (message.size() <= 1030) {
+        std::vector<uint8_t> frame = {STX, EXT_LEN, kCommand, kSubCommand, kCodebit};
+        appendLength(frame, message.size() + 5);
+        frame.insert(frame.end(), std::next(message.begin(), 3), message.end());
+        appendFooter(frame);
+        frames.push_back(frame);
+    }
+    else {
+        const uint32_t total = (dataLength + kMaxFrameDataLength - 1) / kMaxFrameDataLength;
+        for (uint32_t i = 0; i < total; ++i) {
+            const uint32_t offset = i * kMaxFrameDataLength;
+            const uint32_t length = std::min<uint32_t>(dataLength - offset, kMaxFrameDataLength);
+            const uint8_t codebit = kCodebit | ((i == total - 1) ? 0x03 : 0x02);
+            std::vector<uint8_t> frame = {STX, EXT_LEN, kCommand, kSubCommand, codebit};
+            appendLength(frame, length + 12);
+            frame.push_back(static_cast<uint8_t>(i >> 8));
+            frame.push_back(static_cast<uint8_t>(i));
+            frame.push_back(static_cast<uint8_t>(total >> 8));
+            frame.push_back(static_cast<uint8_t>(total));
+            auto begin = std::next(message.begin(), 3 + offset);
+            frame.insert(frame.end(), begin, std::next(begin, length));
+            appendFooter(frame);
+            frames.push_back(frame);
+        }
+    }
+    return frames;
+}
+
+std::vector<uint8_t> linearize(const FrameEncoder::Frame& frame)
+{
+    std::vector<uint8_t> bytes(frame.size());
+    frame.copyTo(bytes.data());
+    return bytes;
+}
+
+std::vector<uint8_t> gather(const FrameEncoder::Frame& frame)
+{
+    std::vector<uint8_t> bytes;
+    for (const auto& buffer : frame.iov()) {
+        const uint8_t* base = static_cast<const uint8_t*>(buffer.iov_base);
+        bytes.insert(bytes.end(), base, base + buffer.iov_len);
+    }
+    return bytes;
+}
+}  // namespace
+
+class FrameEncoderTest : public TestWithParam<size_t> {
+};
+
+TEST_P(FrameEncoderTest, FramesMatchExpectedLayout)
+{
+    const std::vector<uint8_t> message = makeMessage(GetParam());
+    const auto expected = expectedFrames(message);
+
+    FrameEncoder encoder(message);
+    ASSERT_EQ(expected.size(), encoder.frameCount());
+    EXPECT_EQ(expected.size(), FrameEncoder::frameCount(message.size()));
+    for (uint32_t i = 0; i < encoder.frameCount(); ++i) {
+        const FrameEncoder::Frame frame = encoder.frame(i);
+        EXPECT_EQ(expected[i].size(), frame.size());
+        EXPECT_EQ(expected[i], linearize(frame));
+        EXPECT_EQ(expected[i], gather(frame));
+    }
+}
+
+// data lengths around the regular, extended length and frame division limits
+INSTANTIATE_TEST_CASE_P(DataLengths,
+                        FrameEncoderTest,
+                        Values(0, 1, 2, 247, 248, 249, 250, 1026, 1027, 1028, 1029, 2048, 2049,
+                               4096, 65536, 65537));
+
+TEST(FrameEncoderPayloadTest, PayloadPointsIntoMessage)
+{
+    const std::vector<uint8_t> message = makeMessage(3000);
+    FrameEncoder encoder(message);
+    ASSERT_EQ(3u, encoder.frameCount());
+    for (uint32_t i = 0; i < encoder.frameCount(); ++i) {
+        const FrameEncoder::Frame frame = encoder.frame(i);
+        EXPECT_EQ(message.data() + 3 + i * kMaxFrameDataLength, frame.payload);
+    }
+    EXPECT_EQ(3000u - 2 * kMaxFrameDataLength, encoder.frame(2).payloadLength);
+}
+
+}  // namespace impl
+}  // namespace cpucom
+}  // namespace ahu
+}  // namespace mitsubishielectric
+}  // namespace com
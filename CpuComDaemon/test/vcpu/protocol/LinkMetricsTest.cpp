@@ -0,0 +1,112 @@
+/*
+ * COPYRIGHT (C) 2024 MITSUBISHI ELECTRIC CORPORATION
+ * ALL RIGHTS RESERVED
+ */
+
+#include "LinkMetrics.h"
+#include "ProtocolStates.h"
+
+#include <gtest/gtest.h>
+
+namespace com {
+namespace mitsubishielectric {
+namespace ahu {
+namespace cpucom {
+namespace impl {
+
+namespace {
+const common::CpuCommand kSmallCommand(0x01, 0x02);
+const common::CpuCommand kLargeCommand(0x0a, 0x0b);
+}  // namespace
+
+TEST(LinkMetricsTest, CountsTrafficPerCommand)
+{
+    LinkMetrics metrics;
+    metrics.onFrameSent(kSmallCommand, 10, std::chrono::microseconds(500));
+    metrics.onFrameSent(kSmallCommand, 12, std::chrono::microseconds(700));
+    metrics.onMessageSent(kSmallCommand, 2, std::chrono::microseconds(3000));
+    metrics.onNakReceived(kSmallCommand);
+    metrics.onFrameReceived(kLargeCommand, 300);
+    metrics.onChecksumMismatch(kLargeCommand);
+    metrics.onNakSent();
+    metrics.onReceiveTimeout(receiving::Data);
+    metrics.onReceiveTimeout(receiving::Data);
+
+    const LinkMetrics::Snapshot snapshot = metrics.snapshot();
+    ASSERT_EQ(2u, snapshot.commands.size());
+    const LinkMetrics::CommandCounters& small = snapshot.commands.at(kSmallCommand);
+    EXPECT_EQ(2u, small.framesSent);
+    EXPECT_EQ(22u, small.bytesSent);
+    EXPECT_EQ(2u, small.retries);
+    EXPECT_EQ(1u, small.naksReceived);
+    EXPECT_EQ(3000u, small.wireTime);
+    const LinkMetrics::CommandCounters& large = snapshot.commands.at(kLargeCommand);
+    EXPECT_EQ(1u, large.framesReceived);
+    EXPECT_EQ(300u, large.bytesReceived);
+    EXPECT_EQ(1u, large.checksumMismatches);
+    EXPECT_EQ(1u, snapshot.naksSent);
+    EXPECT_EQ(2u, snapshot.receiveTimeouts[receiving::Data]);
+    EXPECT_EQ(2u, snapshot.handshake.count());
+    EXPECT_EQ(700u, snapshot.handshake.max());
+    EXPECT_EQ(1u, snapshot.wire.count());
+}
+
+TEST(LinkMetricsTest, StatsListCommandsTakingMostBytesFirst)
+{
+    LinkMetrics metrics;
+    metrics.onFrameSent(kSmallCommand, 10, std::chrono::microseconds(500));
+    metrics.onFrameReceived(kLargeCommand, 300);
+    metrics.onReceiveTimeout(receiving::Checksum);
+    StateDwells dwells;
+    dwells.add(sending::Ack2, std::chrono::microseconds(900));
+    metrics.onStatesLeft(FlightRecorder::Sending, dwells);
+
+    const std::string stats = formatLinkStats(metrics.snapshot(), LatencyHistogram());
+    const size_t large = stats.find("0x0a/0x0b");
+    const size_t small = stats.find("0x01/0x02");
+    ASSERT_NE(std::string::npos, large);
+    ASSERT_NE(std::string::npos, small);
+    EXPECT_LT(large, small);
+    EXPECT_NE(std::string::npos, stats.find("receive timeouts: cs 1\n"));
+    EXPECT_NE(std::string::npos, stats.find("enq-ack2"));
+    EXPECT_NE(std::string::npos, stats.find("\ntx ack2 "));
+    EXPECT_EQ(std::string::npos, stats.find("\nrx "));
+}
+
+TEST(LinkMetricsTest, CountsDwellPerState)
+{
+    LinkMetrics metrics;
+    StateDwells dwells;
+    dwells.add(sending::Ack, std::chrono::microseconds(300));
+    dwells.add(sending::Ack, std::chrono::microseconds(500));
+    metrics.onStatesLeft(FlightRecorder::Sending, dwells);
+    dwells.add(receiving::Data, std::chrono::microseconds(80));
+    metrics.onStatesLeft(FlightRecorder::Receiving, dwells);
+
+    const LinkMetrics::Snapshot snapshot = metrics.snapshot();
+    EXPECT_EQ(2u, snapshot.sendDwell[sending::Ack].count());
+    EXPECT_EQ(500u, snapshot.sendDwell[sending::Ack].max());
+    EXPECT_EQ(0u, snapshot.sendDwell[sending::Ack2].count());
+    EXPECT_EQ(1u, snapshot.receiveDwell[receiving::Data].count());
+    EXPECT_EQ(0u, snapshot.receiveDwell[receiving::Ack].count());
+}
+
+TEST(LinkMetricsTest, StateDwellsTellWhenFull)
+{
+    StateDwells dwells;
+    for (size_t i = 1; i < StateDwells::kCapacity; ++i) {
+        EXPECT_TRUE(dwells.add(sending::Ack, std::chrono::microseconds(1)));
+    }
+    EXPECT_FALSE(dwells.add(sending::Ack, std::chrono::microseconds(1)));
+
+    LinkMetrics metrics;
+    metrics.onStatesLeft(FlightRecorder::Sending, dwells);
+    EXPECT_TRUE(dwells.add(sending::Ack, std::chrono::microseconds(1)));
+    EXPECT_EQ(StateDwells::kCapacity, metrics.snapshot().sendDwell[sending::Ack].count());
+}
+
+}  // namespace impl
+}  // namespace cpucom
+}  // namespace ahu
+}  // namespace mitsubishielectric
+}  // namespace com
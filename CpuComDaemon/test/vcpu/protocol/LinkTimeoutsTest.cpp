@@ -0,0 +1,184 @@
+/*
+ * COPYRIGHT (C) 2024 MITSUBISHI ELECTRIC CORPORATION
+ * ALL RIGHTS RESERVED
+ */
+
+#include "LinkTimeouts.h"
+
+#include <gtest/gtest.h>
+
+namespace com {
+namespace mitsubishielectric {
+namespace ahu {
+namespace cpucom {
+namespace impl {
+
+namespace {
+
+using std::chrono::microseconds;
+using std::chrono::milliseconds;
+
+TimeoutProfile autoTuned()
+{
+    TimeoutProfile profile = kDefaultTimeoutProfile;
+    profile.baudRate = 0;
+    profile.autoTune = true;
+    return profile;
+}
+
+}  // namespace
+
+TEST(LinkTimeoutsTest, ParsesProfile)
+{
+    TimeoutProfile profile = kDefaultTimeoutProfile;
+    EXPECT_TRUE(
+        parseTimeoutProfile("response=20,field=5,retry=2,baud=115200,autotune=1", profile));
+    EXPECT_EQ(milliseconds(20), profile.response);
+    EXPECT_EQ(milliseconds(5), profile.field);
+    EXPECT_EQ(milliseconds(2), profile.retry);
+    EXPECT_EQ(115200u, profile.baudRate);
+    EXPECT_TRUE(profile.autoTune);
+}
+
+TEST(LinkTimeoutsTest, ParsingKeepsValuesNotGiven)
+{
+    TimeoutProfile profile = kDefaultTimeoutProfile;
+    EXPECT_TRUE(parseTimeoutProfile("field=10", profile));
+    EXPECT_EQ(kDefaultTimeoutProfile.response, profile.response);
+    EXPECT_EQ(milliseconds(10), profile.field);
+    EXPECT_EQ(kDefaultTimeoutProfile.retry, profile.retry);
+    EXPECT_EQ(kDefaultTimeoutProfile.baudRate, profile.baudRate);
+    EXPECT_FALSE(profile.autoTune);
+
+    EXPECT_TRUE(parseTimeoutProfile("", profile));
+    EXPECT_EQ(milliseconds(10), profile.field);
+}
+
+TEST(LinkTimeoutsTest, MalformedProfileIsRejected)
+{
+    for (const char* text : {"response", "response=", "response=-1", "response=2x", "ack=20",
+                             "field=5,,retry=2", "field=5;retry=2"}) {
+        TimeoutProfile profile = kDefaultTimeoutProfile;
+        EXPECT_FALSE(parseTimeoutProfile(text, profile)) << text;
+        EXPECT_EQ(kDefaultTimeoutProfile.response, profile.response) << text;
+        EXPECT_EQ(kDefaultTimeoutProfile.field, profile.field) << text;
+    }
+}
+
+TEST(LinkTimeoutsTest, DefaultTimeoutsAddTimeOnWire)
+{
+    LinkTimeouts timeouts;
+    EXPECT_EQ(milliseconds(5), timeouts.retry());
+    // 11 bits per byte at 1 Mbaud
+    EXPECT_EQ(microseconds(11), timeouts.timeOnWire(1));
+    EXPECT_EQ(microseconds(11396), timeouts.timeOnWire(1036));
+    EXPECT_EQ(milliseconds(51), timeouts.response(1));
+    EXPECT_EQ(milliseconds(62), timeouts.response(1036));
+    EXPECT_EQ(milliseconds(62), timeouts.field(1036));
+
+    TimeoutProfile profile = kDefaultTimeoutProfile;
+    profile.baudRate = 0;
+    timeouts.setProfile(profile);
+    EXPECT_EQ(milliseconds(50), timeouts.response(1036));
+    EXPECT_EQ(milliseconds(50), timeouts.field(1036));
+}
+
+TEST(LinkTimeoutsTest, LatenciesAreIgnoredWithoutAutoTune)
+{
+    TimeoutProfile profile = autoTuned();
+    profile.autoTune = false;
+    LinkTimeouts timeouts(profile);
+    for (size_t i = 0; i < LatencyWindow::kSize; ++i) {
+        timeouts.onResponse(1, microseconds(100));
+        timeouts.onField(1, microseconds(100));
+    }
+    EXPECT_EQ(milliseconds(50), timeouts.response(1));
+    EXPECT_EQ(milliseconds(50), timeouts.field(1));
+}
+
+TEST(LinkTimeoutsTest, AutoTuneFollowsPercentileOfLatencies)
+{
+    LinkTimeouts timeouts(autoTuned());
+    for (size_t i = 1; i < LatencyWindow::kMinSamples; ++i) {
+        timeouts.onResponse(1, microseconds(3000));
+    }
+    // not enough samples yet
+    EXPECT_EQ(milliseconds(50), timeouts.response(1));
+
+    timeouts.onResponse(1, microseconds(3000));
+    EXPECT_EQ(milliseconds(6), timeouts.response(1));
+    // the fields are tuned separately
+    EXPECT_EQ(milliseconds(50), timeouts.field(1));
+}
+
+TEST(LinkTimeoutsTest, AutoTuneIgnoresRareOutliers)
+{
+    LinkTimeouts timeouts(autoTuned());
+    for (size_t i = 0; i < LatencyWindow::kSize; ++i) {
+        timeouts.onField(1, microseconds((i == 0) ? 40000 : 2500));
+    }
+    EXPECT_EQ(milliseconds(5), timeouts.field(1));
+
+    // but not frequent ones
+    for (size_t i = 0; i < LatencyWindow::kSize; ++i) {
+        timeouts.onField(1, microseconds(((i % 16) == 0) ? 7000 : 2500));
+    }
+    EXPECT_EQ(milliseconds(14), timeouts.field(1));
+}
+
+TEST(LinkTimeoutsTest, AutoTuneStaysWithinLimits)
+{
+    LinkTimeouts timeouts(autoTuned());
+    for (size_t i = 0; i < LatencyWindow::kSize; ++i) {
+        timeouts.onResponse(1, microseconds(10));
+        timeouts.onField(1, milliseconds(200));
+    }
+    EXPECT_EQ(LinkTimeouts::kMinTimeout, timeouts.response(1));
+    EXPECT_EQ(milliseconds(50), timeouts.field(1));
+}
+
+TEST(LinkTimeoutsTest, AutoTuneExcludesTimeOnWire)
+{
+    TimeoutProfile profile = autoTuned();
+    profile.baudRate = 1000000;
+    LinkTimeouts timeouts(profile);
+    // a frame of 1036 bytes is acknowledged 1 ms after it left the line
+    for (size_t i = 0; i < LatencyWindow::kSize; ++i) {
+        timeouts.onResponse(1036, timeouts.timeOnWire(1036) + milliseconds(1));
+    }
+    EXPECT_EQ(milliseconds(3), timeouts.response(1));
+    EXPECT_EQ(milliseconds(14), timeouts.response(1036));
+}
+
+TEST(LinkTimeoutsTest, WriteTimeoutIsNotTuned)
+{
+    TimeoutProfile profile = autoTuned();
+    profile.baudRate = 1000000;
+    LinkTimeouts timeouts(profile);
+    EXPECT_EQ(milliseconds(62), timeouts.write(1036));
+
+    for (size_t i = 0; i < LatencyWindow::kSize; ++i) {
+        timeouts.onField(1036, timeouts.timeOnWire(1036) + milliseconds(1));
+    }
+    EXPECT_EQ(milliseconds(14), timeouts.field(1036));
+    // the line stalls on the output buffer of the UART, not on the peer
+    EXPECT_EQ(milliseconds(62), timeouts.write(1036));
+}
+
+TEST(LinkTimeoutsTest, SettingProfileDropsLatencies)
+{
+    LinkTimeouts timeouts(autoTuned());
+    for (size_t i = 0; i < LatencyWindow::kSize; ++i) {
+        timeouts.onResponse(1, microseconds(3000));
+    }
+    EXPECT_EQ(milliseconds(6), timeouts.response(1));
+
+    timeouts.setProfile(autoTuned());
+    EXPECT_EQ(milliseconds(50), timeouts.response(1));
+}
+
+}  // namespace impl
+}  // namespace cpucom
+}  // namespace ahu
+}  // namespace mitsubishielectric
+}  // namespace com
@@ -0,0 +1,31 @@
+/*
+ * COPYRIGHT (C) 2024 MITSUBISHI ELECTRIC CORPORATION
+ * ALL RIGHTS RESERVED
+ */
+
+#ifndef COM_MITSUBISHIELECTRIC_AHU_CPUCOM_MOCKRETRYPOLICY_H_
+#define COM_MITSUBISHIELECTRIC_AHU_CPUCOM_MOCKRETRYPOLICY_H_
+
+#include "RetryPolicy.h"
+
+#include <gmock/gmock.h>
+
+namespace com {
+namespace mitsubishielectric {
+namespace ahu {
+namespace cpucom {
+namespace impl {
+
+class MockRetryPolicy : public IRetryPolicy {
+public:
+    MOCK_METHOD1(onFailure, RetryDecision(uint32_t));
+    MOCK_METHOD1(onSuccess, void(uint32_t));
+};
+
+}  // namespace impl
+}  // namespace cpucom
+}  // namespace ahu
+}  // namespace mitsubishielectric
+}  // namespace com
+
+#endif  // COM_MITSUBISHIELECTRIC_AHU_CPUCOM_MOCKRETRYPOLICY_H_
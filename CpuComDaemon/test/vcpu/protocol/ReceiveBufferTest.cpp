@@ -0,0 +1,312 @@
+/*
+ * COPYRIGHT (C) 2024 MITSUBISHI ELECTRIC CORPORATION
+ * ALL RIGHTS RESERVED
+ */
+
+#include "MockLineDevice.h"
+#include "ReceiveBuffer.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <iterator>
+#include <vector>
+
+#include "Checksum.h"
+
+namespace com {
+namespace mitsubishielectric {
+namespace ahu {
+namespace cpucom {
+namespace impl {
+
+using common::IODevice;
+
+using ::testing::_;
+using ::testing::DoAll;
+using ::testing::Invoke;
+using ::testing::InSequence;
+using ::testing::NiceMock;
+using ::testing::Return;
+using ::testing::SetArgPointee;
+using ::testing::SetArgReferee;
+using ::testing::SetArrayArgument;
+
+namespace {
+
+const std::chrono::milliseconds kTimeout(100);
+
+// Serves the bytes of a line, at most chunk bytes per call
+class Line {
+public:
+    Line(std::vector<uint8_t> bytes, size_t chunk)
+        : m_bytes(std::move(bytes))
+        , m_position(0)
+        , m_chunk(chunk)
+    {
+    }
+
+    IODevice::Result readAvailable(uint8_t* data,
+                                   size_t size,
+                                   std::chrono::milliseconds,
+                                   size_t& received)
+    {
+        received = std::min({size, m_chunk, m_bytes.size() - m_position});
+        std::copy_n(m_bytes.begin() + m_position, received, data);
+        m_position += received;
+        return (received > 0) ? IODevice::Result::Success : IODevice::Result::Timeout;
+    }
+
+private:
+    std::vector<uint8_t> m_bytes;
+    size_t m_position;
+    size_t m_chunk;
+};
+
+}  // namespace
+
+TEST(ReceiveBufferTest, ReadsAreForwardedWithoutLineDevice)
+{
+    NiceMock<common::mock_IODevice> device;
+    ReceiveBuffer buffer(device, nullptr);
+    buffer.setExpected(8);
+    {
+        InSequence sequence;
+        EXPECT_CALL(device, read(_, kTimeout))
+            .WillOnce(DoAll(SetArgPointee<0>(0x02), Return(IODevice::Result::Success)));
+        EXPECT_CALL(device, readMulti(_, 3, kTimeout)).WillOnce(Return(IODevice::Result::Timeout));
+    }
+
+    uint8_t b = 0;
+    uint8_t multi[3] = {};
+    EXPECT_EQ(IODevice::Result::Success, buffer.read(&b, kTimeout));
+    EXPECT_EQ(0x02, b);
+    EXPECT_EQ(IODevice::Result::Timeout, buffer.readMulti(multi, sizeof(multi), kTimeout));
+    EXPECT_TRUE(buffer.empty());
+}
+
+TEST(ReceiveBufferTest, ExpectedBytesAreReadAtOnce)
+{
+    NiceMock<MockLineDevice> device;
+    Line line({1, 2, 3, 4, 5, 6}, 64);
+    ReceiveBuffer buffer(device, &device);
+    buffer.setExpected(6);
+    EXPECT_CALL(device, readAvailable(_, 6, _, _))
+        .Times(1)
+        .WillOnce(Invoke(&line, &Line::readAvailable));
+
+    uint8_t b = 0;
+    uint8_t multi[3] = {};
+    EXPECT_EQ(IODevice::Result::Success, buffer.read(&b, kTimeout));
+    EXPECT_EQ(1, b);
+    EXPECT_EQ(IODevice::Result::Success, buffer.readMulti(multi, sizeof(multi), kTimeout));
+    EXPECT_EQ((std::vector<uint8_t>{2, 3, 4}), std::vector<uint8_t>(multi, multi + 3));
+    EXPECT_FALSE(buffer.empty());
+    EXPECT_EQ(IODevice::Result::Success, buffer.read(&b, kTimeout));
+    EXPECT_EQ(IODevice::Result::Success, buffer.read(&b, kTimeout));
+    EXPECT_EQ(6, b);
+    EXPECT_TRUE(buffer.empty());
+}
+
+TEST(ReceiveBufferTest, BytesBeyondExpectedAreNotRead)
+{
+    NiceMock<MockLineDevice> device;
+    Line line({1, 2, 3, 4}, 64);
+    ReceiveBuffer buffer(device, &device);
+    buffer.setExpected(2);
+    {
+        InSequence sequence;
+        EXPECT_CALL(device, readAvailable(_, 2, _, _))
+            .WillOnce(Invoke(&line, &Line::readAvailable));
+        EXPECT_CALL(device, readAvailable(_, 1, _, _))
+            .Times(2)
+            .WillRepeatedly(Invoke(&line, &Line::readAvailable));
+    }
+
+    uint8_t b = 0;
+    for (uint8_t expected = 1; expected <= 4; ++expected) {
+        EXPECT_EQ(IODevice::Result::Success, buffer.read(&b, kTimeout));
+        EXPECT_EQ(expected, b);
+    }
+}
+
+TEST(ReceiveBufferTest, LargeFieldIsReadIntoDestination)
+{
+    NiceMock<MockLineDevice> device;
+    std::vector<uint8_t> bytes(3000);
+    for (size_t i = 0; i < bytes.size(); ++i) {
+        bytes[i] = static_cast<uint8_t>(i);
+    }
+    Line line(bytes, 1000);
+    ReceiveBuffer buffer(device, &device);
+    buffer.setExpected(bytes.size());
+    EXPECT_CALL(device, readAvailable(_, _, _, _))
+        .Times(3)
+        .WillRepeatedly(Invoke(&line, &Line::readAvailable));
+
+    std::vector<uint8_t> data(bytes.size());
+    EXPECT_EQ(IODevice::Result::Success, buffer.readMulti(data.data(), data.size(), kTimeout));
+    EXPECT_EQ(bytes, data);
+    EXPECT_TRUE(buffer.empty());
+}
+
+TEST(ReceiveBufferTest, FieldTimesOutWhenLineStops)
+{
+    NiceMock<MockLineDevice> device;
+    Line line({1, 2}, 64);
+    ReceiveBuffer buffer(device, &device);
+    buffer.setExpected(2);
+    EXPECT_CALL(device, readAvailable(_, _, _, _))
+        .WillRepeatedly(Invoke(&line, &Line::readAvailable));
+
+    uint8_t multi[3] = {};
+    EXPECT_EQ(IODevice::Result::Timeout, buffer.readMulti(multi, sizeof(multi), kTimeout));
+    EXPECT_TRUE(buffer.empty());
+}
+
+TEST(ReceiveBufferTest, ErrorIsReported)
+{
+    NiceMock<MockLineDevice> device;
+    ReceiveBuffer buffer(device, &device);
+    buffer.setExpected(4);
+    EXPECT_CALL(device, readAvailable(_, 4, _, _)).WillOnce(Return(IODevice::Result::Error));
+
+    uint8_t b = 0;
+    EXPECT_EQ(IODevice::Result::Error, buffer.read(&b, kTimeout));
+}
+
+TEST(ReceiveBufferTest, ChecksumAccumulatesBytesReadSinceReset)
+{
+    NiceMock<MockLineDevice> device;
+    std::vector<uint8_t> bytes(1100);
+    for (size_t i = 0; i < bytes.size(); ++i) {
+        bytes[i] = static_cast<uint8_t>(i * 7 + 3);
+    }
+    Line line(bytes, 5);
+    ReceiveBuffer buffer(device, &device);
+    EXPECT_CALL(device, readAvailable(_, _, _, _))
+        .WillRepeatedly(Invoke(&line, &Line::readAvailable));
+
+    // the first byte is not checksummed, the rest is read from the buffer and directly
+    uint8_t b = 0;
+    std::vector<uint8_t> data(bytes.size() - 4);
+    buffer.setExpected(4);
+    EXPECT_EQ(IODevice::Result::Success, buffer.read(&b, kTimeout));
+    buffer.resetChecksum();
+    EXPECT_EQ(0, buffer.checksum());
+    EXPECT_EQ(IODevice::Result::Success, buffer.readMulti(data.data(), 2, kTimeout));
+    EXPECT_EQ(IODevice::Result::Success, buffer.read(&b, kTimeout));
+    EXPECT_EQ(IODevice::Result::Success, buffer.readMulti(data.data(), data.size(), kTimeout));
+    EXPECT_TRUE(buffer.empty());
+
+    EXPECT_EQ(common::checksum(std::next(bytes.begin()), bytes.end()), buffer.checksum());
+}
+
+TEST(ReceiveBufferTest, ChecksumAccumulatesBytesReadWithoutLineDevice)
+{
+    NiceMock<common::mock_IODevice> device;
+    ReceiveBuffer buffer(device, nullptr);
+    const uint8_t multi[] = {0x10, 0x32, 0x54};
+    {
+        InSequence sequence;
+        EXPECT_CALL(device, read(_, kTimeout))
+            .WillOnce(DoAll(SetArgPointee<0>(0x02), Return(IODevice::Result::Success)));
+        EXPECT_CALL(device, readMulti(_, 3, kTimeout))
+            .WillOnce(DoAll(SetArrayArgument<0>(multi, multi + sizeof(multi)),
+                            Return(IODevice::Result::Success)));
+        EXPECT_CALL(device, read(_, kTimeout)).WillOnce(Return(IODevice::Result::Timeout));
+    }
+
+    uint8_t b = 0;
+    uint8_t data[3] = {};
+    EXPECT_EQ(IODevice::Result::Success, buffer.read(&b, kTimeout));
+    EXPECT_EQ(IODevice::Result::Success, buffer.readMulti(data, sizeof(data), kTimeout));
+    EXPECT_EQ(IODevice::Result::Timeout, buffer.read(&b, kTimeout));
+    const uint8_t bytes[] = {0x02, 0x10, 0x32, 0x54};
+    EXPECT_EQ(common::checksum(bytes, bytes + sizeof(bytes)), buffer.checksum());
+}
+
+TEST(ReceiveBufferTest, DrainDiscardsBufferedAndPendingBytes)
+{
+    NiceMock<MockLineDevice> device;
+    Line line({1, 2, 3, 4}, 64);
+    ReceiveBuffer buffer(device, &device);
+    buffer.setExpected(4);
+    EXPECT_CALL(device, readAvailable(_, 4, _, _))
+        .WillOnce(Invoke(&line, &Line::readAvailable));
+    EXPECT_CALL(device, drain(_, _))
+        .Times(2)
+        .WillOnce(Invoke([](ILineDevice::DrainTail& tail, size_t& drained) {
+            const uint8_t pending[] = {0xff, 0x12, 0x05};
+            shiftIntoTail(tail, pending, sizeof(pending));
+            drained = sizeof(pending);
+            return IODevice::Result::Success;
+        }))
+        .WillOnce(DoAll(SetArgReferee<1>(0u), Return(IODevice::Result::Timeout)));
+
+    uint8_t b = 0;
+    ILineDevice::DrainTail tail = {};
+    size_t drained = 0;
+    EXPECT_EQ(IODevice::Result::Success, buffer.read(&b, kTimeout));
+    EXPECT_EQ(IODevice::Result::Success, buffer.drain(tail, drained));
+    EXPECT_EQ((ILineDevice::DrainTail{{0x12, 0x05}}), tail);
+    EXPECT_EQ(3u + 3u, drained);
+    EXPECT_TRUE(buffer.empty());
+    EXPECT_EQ(IODevice::Result::Timeout, buffer.drain(tail, drained));
+    EXPECT_EQ(0u, drained);
+}
+
+TEST(ReceiveBufferTest, DrainKeepsLastBufferedBytes)
+{
+    NiceMock<MockLineDevice> device;
+    Line line({1, 2, 3}, 64);
+    ReceiveBuffer buffer(device, &device);
+    buffer.setExpected(3);
+    EXPECT_CALL(device, readAvailable(_, 3, _, _))
+        .WillOnce(Invoke(&line, &Line::readAvailable));
+    EXPECT_CALL(device, drain(_, _))
+        .WillOnce(DoAll(SetArgReferee<1>(0u), Return(IODevice::Result::Timeout)));
+
+    uint8_t b = 0;
+    ILineDevice::DrainTail tail = {};
+    size_t drained = 0;
+    EXPECT_EQ(IODevice::Result::Success, buffer.read(&b, kTimeout));
+    EXPECT_EQ(IODevice::Result::Success, buffer.drain(tail, drained));
+    EXPECT_EQ((ILineDevice::DrainTail{{2, 3}}), tail);
+    EXPECT_EQ(2u, drained);
+}
+
+TEST(ReceiveBufferTest, DrainReadsByteByByteWithoutLineDevice)
+{
+    const int kBurstLength = 500;
+    NiceMock<common::mock_IODevice> device;
+    ReceiveBuffer buffer(device, nullptr);
+    {
+        InSequence sequence;
+        EXPECT_CALL(device, read(_, IODevice::kTimeoutImmediate))
+            .Times(kBurstLength - 1)
+            .WillRepeatedly(DoAll(SetArgPointee<0>(0xff), Return(IODevice::Result::Success)));
+        EXPECT_CALL(device, read(_, IODevice::kTimeoutImmediate))
+            .WillOnce(DoAll(SetArgPointee<0>(0x05), Return(IODevice::Result::Success)));
+        EXPECT_CALL(device, read(_, IODevice::kTimeoutImmediate))
+            .WillOnce(Return(IODevice::Result::Timeout));
+        EXPECT_CALL(device, read(_, IODevice::kTimeoutImmediate))
+            .WillOnce(DoAll(SetArgPointee<0>(0xff), Return(IODevice::Result::Success)));
+        EXPECT_CALL(device, read(_, IODevice::kTimeoutImmediate))
+            .WillOnce(Return(IODevice::Result::Error));
+    }
+
+    ILineDevice::DrainTail tail = {};
+    size_t drained = 0;
+    EXPECT_EQ(IODevice::Result::Success, buffer.drain(tail, drained));
+    EXPECT_EQ((ILineDevice::DrainTail{{0xff, 0x05}}), tail);
+    EXPECT_EQ(static_cast<size_t>(kBurstLength), drained);
+    EXPECT_EQ(IODevice::Result::Error, buffer.drain(tail, drained));
+}
+
+}  // namespace impl
+}  // namespace cpucom
+}  // namespace ahu
+}  // namespace mitsubishielectric
+}  // namespace com
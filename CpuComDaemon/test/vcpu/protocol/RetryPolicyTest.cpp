@@ -0,0 +1,166 @@
+/*
+ * COPYRIGHT (C) 2024 MITSUBISHI ELECTRIC CORPORATION
+ * ALL RIGHTS RESERVED
+ */
+
+#include "RetryPolicy.h"
+
+#include <gtest/gtest.h>
+
+namespace com {
+namespace mitsubishielectric {
+namespace ahu {
+namespace cpucom {
+namespace impl {
+
+namespace {
+
+using std::chrono::milliseconds;
+
+const uint32_t kSeed = 1;
+
+AdaptiveRetryPolicy::Settings settings()
+{
+    return AdaptiveRetryPolicy::kDefaultSettings;
+}
+
+// sends messages which fail attempts times and then get through
+void sendAfterFailures(AdaptiveRetryPolicy& policy, uint32_t attempts)
+{
+    for (uint32_t attempt = 1; attempt <= attempts; ++attempt) {
+        policy.onFailure(attempt);
+    }
+    policy.onSuccess(attempts);
+}
+
+}  // namespace
+
+TEST(FixedRetryPolicyTest, RetriesWithSameDelayAndReinitsPeriodically)
+{
+    FixedRetryPolicy policy(milliseconds(5), 240, 6);
+    for (uint32_t attempt = 1; attempt < 240; ++attempt) {
+        const RetryDecision decision = policy.onFailure(attempt);
+        EXPECT_TRUE(decision.retry);
+        EXPECT_EQ(milliseconds(5), decision.delay);
+        EXPECT_EQ((attempt % 6) == 0, decision.reinit) << attempt;
+    }
+    EXPECT_FALSE(policy.onFailure(240).retry);
+}
+
+TEST(AdaptiveRetryPolicyTest, BackoffDoublesWithJitterUpToMaxDelay)
+{
+    AdaptiveRetryPolicy policy(settings(), kSeed);
+    const milliseconds ceilings[] = {milliseconds(5),  milliseconds(10), milliseconds(20),
+                                     milliseconds(40), milliseconds(80), milliseconds(80)};
+    uint32_t attempt = 1;
+    for (const milliseconds ceiling : ceilings) {
+        const RetryDecision decision = policy.onFailure(attempt++);
+        ASSERT_TRUE(decision.retry);
+        EXPECT_GE(decision.delay, ceiling / 2);
+        EXPECT_LE(decision.delay, ceiling);
+    }
+}
+
+TEST(AdaptiveRetryPolicyTest, GivesUpWhenBudgetIsSpent)
+{
+    AdaptiveRetryPolicy::Settings s = settings();
+    s.budget = milliseconds(100);
+    AdaptiveRetryPolicy policy(s, kSeed);
+    milliseconds delayed(0);
+    uint32_t attempt = 1;
+    for (RetryDecision decision = policy.onFailure(attempt); decision.retry;
+         decision = policy.onFailure(++attempt)) {
+        delayed += decision.delay;
+    }
+    EXPECT_LE(delayed, s.budget);
+    EXPECT_GT(delayed + s.maxDelay, s.budget);
+    // the message has been given up, so the link is dead
+    EXPECT_TRUE(policy.dead());
+}
+
+TEST(AdaptiveRetryPolicyTest, GivesUpAfterMaxAttempts)
+{
+    AdaptiveRetryPolicy::Settings s = settings();
+    s.maxAttempts = 3;
+    AdaptiveRetryPolicy policy(s, kSeed);
+    EXPECT_TRUE(policy.onFailure(1).retry);
+    EXPECT_TRUE(policy.onFailure(2).retry);
+    EXPECT_FALSE(policy.onFailure(3).retry);
+}
+
+TEST(AdaptiveRetryPolicyTest, ReinitsSoonerOnUnhealthyLink)
+{
+    AdaptiveRetryPolicy policy(settings(), kSeed);
+    EXPECT_EQ(AdaptiveRetryPolicy::kMaxHealth, policy.health());
+
+    // a healthy link is reopened after healthyReinitAttempts attempts only
+    uint32_t firstReinit = 0;
+    for (uint32_t attempt = 1; firstReinit == 0; ++attempt) {
+        const RetryDecision decision = policy.onFailure(attempt);
+        ASSERT_TRUE(decision.retry);
+        firstReinit = decision.reinit ? attempt : 0;
+    }
+    EXPECT_GT(firstReinit, settings().unhealthyReinitAttempts);
+    EXPECT_LE(firstReinit, settings().healthyReinitAttempts);
+    policy.onSuccess(firstReinit);
+
+    // lots of retried messages wear the link down
+    for (int i = 0; i < 10; ++i) {
+        sendAfterFailures(policy, 10);
+    }
+    EXPECT_LT(policy.health(), AdaptiveRetryPolicy::kMaxHealth / 2);
+    EXPECT_FALSE(policy.dead());
+    EXPECT_FALSE(policy.onFailure(1).reinit);
+    EXPECT_FALSE(policy.onFailure(2).reinit);
+    EXPECT_TRUE(policy.onFailure(3).reinit || policy.onFailure(4).reinit ||
+                policy.onFailure(5).reinit || policy.onFailure(6).reinit);
+}
+
+TEST(AdaptiveRetryPolicyTest, FailsFastOnDeadLinkUntilMessageGetsThrough)
+{
+    AdaptiveRetryPolicy::Settings s = settings();
+    s.maxAttempts = 4;
+    AdaptiveRetryPolicy policy(s, kSeed);
+    for (uint32_t attempt = 1; policy.onFailure(attempt).retry; ++attempt) {
+    }
+    ASSERT_TRUE(policy.dead());
+
+    // messages on a dead link are probed once more before they are given up,
+    // the device is reopened after every unhealthyReinitAttempts failed attempts
+    const uint32_t kMessages = 6;
+    uint32_t reinits = 0;
+    for (uint32_t message = 0; message < kMessages; ++message) {
+        const RetryDecision probe = policy.onFailure(1);
+        EXPECT_TRUE(probe.retry);
+        EXPECT_LE(probe.delay, s.initialDelay);
+        reinits += probe.reinit ? 1 : 0;
+        EXPECT_FALSE(policy.onFailure(s.deadAttempts).retry);
+    }
+    EXPECT_GT(reinits, 0u);
+    EXPECT_LT(reinits, kMessages);
+
+    // once a message gets through the link is retried as usual again
+    policy.onSuccess(1);
+    EXPECT_FALSE(policy.dead());
+    for (uint32_t attempt = 1; attempt < s.maxAttempts; ++attempt) {
+        EXPECT_TRUE(policy.onFailure(attempt).retry) << attempt;
+    }
+}
+
+TEST(AdaptiveRetryPolicyTest, SuccessRestoresHealth)
+{
+    AdaptiveRetryPolicy policy(settings(), kSeed);
+    sendAfterFailures(policy, 10);
+    const uint32_t worn = policy.health();
+    EXPECT_LT(worn, AdaptiveRetryPolicy::kMaxHealth);
+    for (int i = 0; i < 4; ++i) {
+        policy.onSuccess(0);
+    }
+    EXPECT_EQ(AdaptiveRetryPolicy::kMaxHealth, policy.health());
+}
+
+}  // namespace impl
+}  // namespace cpucom
+}  // namespace ahu
+}  // namespace mitsubishielectric
+}  // namespace com
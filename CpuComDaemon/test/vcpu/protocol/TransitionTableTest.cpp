@@ -0,0 +1,81 @@
+/*
+ * COPYRIGHT (C) 2024 MITSUBISHI ELECTRIC CORPORATION
+ * ALL RIGHTS RESERVED
+ */
+
+#include "ProtocolStates.h"
+#include "TransitionTable.h"
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+namespace com {
+namespace mitsubishielectric {
+namespace ahu {
+namespace cpucom {
+namespace impl {
+
+namespace {
+
+enum class Light { Red, Green, Off, Count };
+enum class Signal { Next, Stop };
+
+// clang-format off
+constexpr Transitions<Light, 2> kLights[] = {
+    transitions(Light::Red,   Light::Green, Light::Off),
+    transitions(Light::Green, Light::Red,   Light::Off),
+    transitions(Light::Off,   Light::Off,   Light::Off),
+};
+
+constexpr Transitions<Light, 2> kMisorderedLights[] = {
+    transitions(Light::Green, Light::Red,   Light::Off),
+    transitions(Light::Red,   Light::Green, Light::Off),
+    transitions(Light::Off,   Light::Off,   Light::Off),
+};
+
+constexpr Transitions<Light, 2> kIncompleteLights[] = {
+    transitions(Light::Red,   Light::Green, Light::Off),
+    transitions(Light::Green, Light::Red,   Light::Off),
+};
+
+constexpr Transitions<Light, 2> kInvalidLights[] = {
+    transitions(Light::Red,   Light::Green, Light::Count),
+    transitions(Light::Green, Light::Red,   Light::Off),
+    transitions(Light::Off,   Light::Off,   Light::Off),
+};
+// clang-format on
+
+}  // namespace
+
+TEST(TransitionTableTest, ProtocolTablesAreComplete)
+{
+    EXPECT_TRUE(isComplete(sending::kTransitions));
+    EXPECT_TRUE(isComplete(receiving::kTransitions));
+}
+
+TEST(TransitionTableTest, IncompleteTablesAreDetected)
+{
+    EXPECT_TRUE(isComplete(kLights));
+    EXPECT_FALSE(isComplete(kMisorderedLights));
+    EXPECT_FALSE(isComplete(kIncompleteLights));
+    EXPECT_FALSE(isComplete(kInvalidLights));
+}
+
+TEST(TransitionTableTest, MachineRunsUntilFinalStateHandled)
+{
+    std::vector<Light> visited;
+    runStateMachine(kLights, Light::Red, Light::Off, [&visited](Light light) {
+        visited.push_back(light);
+        return (visited.size() < 4) ? Signal::Next : Signal::Stop;
+    });
+    EXPECT_EQ(
+        (std::vector<Light>{Light::Red, Light::Green, Light::Red, Light::Green, Light::Off}),
+        visited);
+}
+
+}  // namespace impl
+}  // namespace cpucom
+}  // namespace ahu
+}  // namespace mitsubishielectric
+}  // namespace com
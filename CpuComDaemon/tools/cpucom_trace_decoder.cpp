@@ -0,0 +1,253 @@
+/*
+ * COPYRIGHT (C) 2024 MITSUBISHI ELECTRIC CORPORATION
+ * ALL RIGHTS RESERVED
+ */
+
+#include "Log.h"
+#include "Trace.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+static const std::string LOGDOG_FORMAT_PATH = "vendor/melco/efw/Config/LogdogFormat";
+
+using com::mitsubishielectric::ahu::common::FunctionID;
+using namespace com::mitsubishielectric::ahu::cpucom::impl;
+
+namespace {
+
+// formats of the LogIDs of a function
+using Formats = std::map<uint16_t, std::string>;
+
+/**
+ * Reads a table dumped by cpucomdaemon_csv_generator or libcpucom_csv_generator, of which
+ * each row starts with a LogID and its format.
+ */
+bool readFormats(const std::string& path, Formats& formats)
+{
+    std::ifstream file(path);
+    if (!file) {
+        return false;
+    }
+    std::string line;
+    while (std::getline(file, line)) {
+        std::vector<std::string> fields(1);
+        bool quoted = false;
+        for (size_t i = 0; i <= line.size(); ++i) {
+            if (i == line.size()) {
+                // a quoted field goes on in the next line
+                std::string next;
+                if (!quoted || !std::getline(file, next)) {
+                    break;
+                }
+                fields.back() += '\n';
+                line = next;
+                i = static_cast<size_t>(-1);
+                continue;
+            }
+            const char c = line[i];
+            if (c == '"') {
+                if (quoted && ((i + 1) < line.size()) && (line[i + 1] == '"')) {
+                    fields.back() += c;
+                    ++i;
+                }
+                else {
+                    quoted = !quoted;
+                }
+            }
+            else if ((c == ',') && !quoted) {
+                fields.emplace_back();
+            }
+            else {
+                fields.back() += c;
+            }
+        }
+        char* end = nullptr;
+        const unsigned long logID = std::strtoul(fields[0].c_str(), &end, 0);
+        if ((fields.size() < 2) || fields[0].empty() || (*end != '\0')) {
+            continue;  // a header
+        }
+        formats[static_cast<uint16_t>(logID)] = fields[1];
+    }
+    return true;
+}
+
+std::string formatPayload(const TraceRecord& record)
+{
+    const size_t captured = std::min<size_t>(record.length, kTracePayloadSize);
+    std::string text;
+    char hex[3];
+    switch (record.payloadType) {
+        case TracePayload::None:
+            break;
+        case TracePayload::Bytes:
+            for (size_t i = 0; i < captured; ++i) {
+                std::snprintf(hex, sizeof(hex), "%02x", record.payload[i]);
+                text += hex;
+            }
+            if (record.length > captured) {
+                text += "...";
+            }
+            break;
+        case TracePayload::Text:
+            text.assign(reinterpret_cast<const char*>(record.payload), captured);
+            break;
+        case TracePayload::Id:
+            for (size_t i = 0; i < captured; ++i) {
+                if ((i == 4) || (i == 6) || (i == 8) || (i == 10)) {
+                    text += '-';
+                }
+                std::snprintf(hex, sizeof(hex), "%02x", record.payload[i]);
+                text += hex;
+            }
+            break;
+    }
+    return text;
+}
+
+/**
+ * Formats the record as printf() would have: the numbers traced for the conversions of the
+ * format, the payload for its %s.
+ */
+std::string formatRecord(const std::string& format, const TraceRecord& record)
+{
+    std::string text;
+    size_t arg = 0;
+    for (size_t i = 0; i < format.size(); ++i) {
+        if ((format[i] != '%') || ((i + 1) == format.size())) {
+            text += format[i];
+            continue;
+        }
+        if (format[i + 1] == '%') {
+            text += '%';
+            ++i;
+            continue;
+        }
+        // flags, width and precision are kept, the length is that of the traced numbers
+        std::string spec = "%";
+        size_t j = i + 1;
+        while ((j < format.size()) && (std::string("-+ #0123456789.").find(format[j]) !=
+                                       std::string::npos)) {
+            spec += format[j++];
+        }
+        while ((j < format.size()) && (std::string("hlLqjzt").find(format[j]) !=
+                                       std::string::npos)) {
+            ++j;
+        }
+        if (j == format.size()) {
+            text += format.substr(i);
+            break;
+        }
+        const char conversion = format[j];
+        i = j;
+
+        char value[64] = {};
+        if (conversion == 's') {
+            text += formatPayload(record);
+        }
+        else if (arg >= record.argCount) {
+            text += '?';
+        }
+        else if ((conversion == 'd') || (conversion == 'i')) {
+            std::snprintf(value, sizeof(value), (spec + "lld").c_str(),
+                          static_cast<long long>(record.args[arg++]));
+            text += value;
+        }
+        else if (conversion == 'c') {
+            std::snprintf(value, sizeof(value), (spec + "c").c_str(),
+                          static_cast<int>(record.args[arg++]));
+            text += value;
+        }
+        else {
+            std::snprintf(value, sizeof(value), (spec + "ll" + conversion).c_str(),
+                          static_cast<unsigned long long>(record.args[arg++]));
+            text += value;
+        }
+    }
+    // each record is printed on a line of its own, the newline may be written escaped
+    for (;;) {
+        if (!text.empty() && (text.back() == '\n')) {
+            text.pop_back();
+        }
+        else if ((text.size() >= 2) && (text.compare(text.size() - 2, 2, "\\n") == 0)) {
+            text.resize(text.size() - 2);
+        }
+        else {
+            break;
+        }
+    }
+    return text;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[])
+{
+    if ((argc != 2) && (argc != 3)) {
+        std::cerr << "usage: " << argv[0] << " <trace file> [<LogdogFormat directory>]"
+                  << std::endl;
+        return 1;
+    }
+
+    std::string logdogFormatFullPath;
+    if (argc == 3) {
+        logdogFormatFullPath = argv[2];
+    }
+    else {
+        const char* androidBuildTop = std::getenv("ANDROID_BUILD_TOP");
+        logdogFormatFullPath =
+            std::string((androidBuildTop != nullptr) ? androidBuildTop : ".") + "/" +
+            LOGDOG_FORMAT_PATH;
+    }
+
+    const std::map<FunctionID, std::string> tables = {
+        {FunctionID::cpuc_daemon, "CPUC_DAEMON.csv"},
+        {FunctionID::cpuc_daemon_error, "CPUC_DAEMON_ERROR.csv"},
+        {FunctionID::cpuc_lib, "CPUC_LIB.csv"},
+    };
+    std::map<uint16_t, Formats> formats;
+    for (const auto& table : tables) {
+        const std::string path = logdogFormatFullPath + "/" + table.second;
+        if (!readFormats(path, formats[static_cast<uint16_t>(table.first)])) {
+            std::cerr << "cannot read " << path << std::endl;
+        }
+    }
+
+    std::ifstream traceFile(argv[1], std::ios_base::binary);
+    std::vector<TraceRecord> records;
+    if (!readTrace(traceFile, records)) {
+        std::cerr << argv[1] << " is not a trace" << std::endl;
+        return 1;
+    }
+    // a trace written from a signal handler has the rings one after another
+    std::stable_sort(records.begin(), records.end(),
+                     [](const TraceRecord& a, const TraceRecord& b) {
+                         return a.timestamp < b.timestamp;
+                     });
+
+    const uint64_t start = records.empty() ? 0 : records.front().timestamp;
+    for (const TraceRecord& record : records) {
+        char prefix[48] = {};
+        const uint64_t elapsed = record.timestamp - start;
+        std::snprintf(prefix, sizeof(prefix), "%6llu.%06llu T%02u ",
+                      static_cast<unsigned long long>(elapsed / 1000000000),
+                      static_cast<unsigned long long>((elapsed / 1000) % 1000000),
+                      static_cast<unsigned>(record.thread));
+        const Formats& functionFormats = formats[record.functionID];
+        auto format = functionFormats.find(record.logID);
+        if (format != functionFormats.end()) {
+            std::cout << prefix << formatRecord(format->second, record) << '\n';
+        }
+        else {
+            std::cout << prefix << "unknown log " << record.functionID << ":" << record.logID
+                      << '\n';
+        }
+    }
+    return 0;
+}
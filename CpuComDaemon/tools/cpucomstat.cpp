@@ -0,0 +1,78 @@
+/*
+ * COPYRIGHT (C) 2024 MITSUBISHI ELECTRIC CORPORATION
+ * ALL RIGHTS RESERVED
+ */
+
+#include <chrono>
+#include <future>
+#include <iostream>
+#include <memory>
+#include <string>
+
+#include "CpuComMessage.h"
+#include "Executors.h"
+#include "Socket.h"
+#include "messenger/Messenger.h"
+
+using com::mitsubishielectric::ahu::common::InitializeCommonLogMessages;
+using com::mitsubishielectric::ahu::common::Messenger;
+using com::mitsubishielectric::ahu::common::PausableSingleThreadExecutor;
+using com::mitsubishielectric::ahu::common::SingleThreadExecutor;
+using com::mitsubishielectric::ahu::common::Socket;
+using com::mitsubishielectric::ahu::common::TerminateCommonLogMessages;
+
+using com::mitsubishielectric::ahu::cpucom::impl::CpuComId;
+using com::mitsubishielectric::ahu::cpucom::impl::kCpuComDaemonSocketName;
+
+namespace {
+
+const std::chrono::seconds kStatsTimeout(5);
+
+// gets the answer of cpucomdaemon to CpuComId::Stats
+class StatsReader {
+public:
+    void onStats(std::string report) { m_report.set_value(std::move(report)); }
+
+    std::future<std::string> report() { return m_report.get_future(); }
+
+private:
+    std::promise<std::string> m_report;
+};
+
+}  // namespace
+
+/**
+ * Prints the traffic of the V-CPU link per command and its latencies,
+ * as cpucomdaemon counted them since it started.
+ */
+int main()
+{
+    int result = 0;
+    InitializeCommonLogMessages();
+
+    StatsReader reader;
+    std::future<std::string> report = reader.report();
+    auto messenger = std::make_unique<Messenger<CpuComId>>(
+        kCpuComDaemonSocketName, std::make_unique<Socket>(),
+        std::make_unique<PausableSingleThreadExecutor>(), std::make_unique<SingleThreadExecutor>());
+    messenger->setMessageHandler(CpuComId::Stats, &StatsReader::onStats, &reader);
+
+    if (messenger->initialize({}, {}) && messenger->connect()) {
+        messenger->sendMessage(CpuComId::Stats).wait();
+        if (report.wait_for(kStatsTimeout) == std::future_status::ready) {
+            std::cout << report.get();
+        }
+        else {
+            std::cout << "no answer from cpucomdaemon" << std::endl;
+            result = 1;
+        }
+        messenger->disconnect();
+    }
+    else {
+        std::cout << "can not connect to cpucomdaemon" << std::endl;
+        result = 1;
+    }
+
+    TerminateCommonLogMessages();
+    return result;
+}
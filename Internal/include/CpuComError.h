@@ -0,0 +1,28 @@
+/*
+ * COPYRIGHT (C) 2024 MITSUBISHI ELECTRIC CORPORATION
+ * ALL RIGHTS RESERVED
+ */
+
+#ifndef COM_MITSUBISHIELECTRIC_AHU_CPUCOM_CPUCOMERROR_H_
+#define COM_MITSUBISHIELECTRIC_AHU_CPUCOM_CPUCOMERROR_H_
+
+namespace com {
+namespace mitsubishielectric {
+namespace ahu {
+namespace cpucom {
+
+/**
+ * Error codes of the commands cpucomdaemon did not send, besides those of common::Error.
+ */
+enum CpuComError : int {
+    // the client is over its quota, unlike after common::ERR_BUSY a command sent again
+    // is only accepted once the quota has refilled, which takes up to a second
+    ERR_THROTTLED = 0x100,
+};
+
+}  // namespace cpucom
+}  // namespace ahu
+}  // namespace mitsubishielectric
+}  // namespace com
+
+#endif  // COM_MITSUBISHIELECTRIC_AHU_CPUCOM_CPUCOMERROR_H_
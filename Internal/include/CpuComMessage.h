@@ -27,6 +27,10 @@ enum class CpuComId : uint8_t {
     Request,
     RequestResponse,
     CancelRequest,
+    Stats,  // asks the daemon for the metrics of the link, answered with them as text
+    SendCommandWithTrace,  // SendCommandWithDeliveryStatus carrying a SendTrace
+    DeliveryTrace,         // DeliveryStatus carrying the SendTrace stamped by the daemon
+    RequestTimeout,        // answers a Request whose response did not come in time
 };
 using CpuComMessage = common::Message<CpuComId>;
 using CpuComMessageParser = common::Message<CpuComId>::Parser;
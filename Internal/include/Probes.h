@@ -0,0 +1,125 @@
+/*
+ * COPYRIGHT (C) 2024 MITSUBISHI ELECTRIC CORPORATION
+ * ALL RIGHTS RESERVED
+ */
+
+#ifndef COM_MITSUBISHIELECTRIC_AHU_CPUCOM_PROBES_H_
+#define COM_MITSUBISHIELECTRIC_AHU_CPUCOM_PROBES_H_
+
+#include <cstdint>
+
+/**
+ * USDT probes of provider cpucom, which bpftrace or perf attach to at run time,
+ * e.g. with the scripts in CpuComDaemon/tools/bpftrace. A probe is a single nop and
+ * a .note.stapsdt entry telling the tracer where its arguments are, in the format of
+ * systemtap's sys/sdt.h, which is not available to the Android build. Nothing is executed
+ * while no tracer is attached, except what the arguments take to be evaluated.
+ * Every argument is passed as uint64_t, at most 4 of them.
+ *
+ * CpuComDaemon:
+ *   send_begin(command, length)                   Protocol::send() started a message
+ *   send_end(command, length, result, ns)         it ended, ns in send(), retries included
+ *   state_exit(machine, state, event, us)         a state of the send (0) or receive (1)
+ *                                                 machine was left after us
+ *   send_retry(command, attempt)                  a failed attempt of send() is retried
+ *   port_reinit(attempt, result)                  the device was reopened before a retry
+ *   fanout(command, length, subscribers, checked) a received message is notified
+ *   request_match(command, length, requests, checked)
+ *                                                 it answers requests
+ * libCpuCom v2::CpuCom:
+ *   client_send(command, length)                  send(), sendTraced() or request() hands
+ *                                                 a command to cpucomdaemon
+ *   client_notification(command, length, checked) a notification is passed to its callback
+ * command is CMD << 8 | SUBCMD. checked is when the checksum of the message was found
+ * correct, in ns of CLOCK_MONOTONIC like nsecs of bpftrace, 0 if it is not known.
+ */
+
+// probes are compiled in where the note format is known, -DCPUCOM_PROBES=0 leaves them out
+#ifndef CPUCOM_PROBES
+#if defined(__ELF__) && (defined(__x86_64__) || defined(__aarch64__))
+#define CPUCOM_PROBES 1
+#else
+#define CPUCOM_PROBES 0
+#endif
+#endif
+
+#if CPUCOM_PROBES
+
+#define CPUCOM_PROBE_ARG(value) "nor"(static_cast<uint64_t>(value))
+
+// the note of probe name with the argument string args, see sys/sdt.h
+#define CPUCOM_PROBE_ASM(name, args, ...)                     \
+    __asm__ __volatile__("990: nop\n"                         \
+                         ".pushsection .note.stapsdt,\"?\",\"note\"\n" \
+                         ".balign 4\n"                        \
+                         ".4byte 992f-991f, 994f-993f, 3\n"   \
+                         "991: .asciz \"stapsdt\"\n"          \
+                         "992: .balign 4\n"                   \
+                         "993: .8byte 990b\n"                 \
+                         ".8byte _.stapsdt.base\n"            \
+                         ".8byte 0\n"                         \
+                         ".asciz \"cpucom\"\n"                \
+                         ".asciz \"" #name "\"\n"             \
+                         ".asciz \"" args "\"\n"              \
+                         "994: .balign 4\n"                   \
+                         ".popsection\n"                      \
+                         ".ifndef _.stapsdt.base\n"           \
+                         ".pushsection .stapsdt.base,\"aG\",\"progbits\",.stapsdt.base,comdat\n" \
+                         ".weak _.stapsdt.base\n"             \
+                         ".hidden _.stapsdt.base\n"           \
+                         "_.stapsdt.base: .space 1\n"         \
+                         ".size _.stapsdt.base, 1\n"          \
+                         ".popsection\n"                      \
+                         ".endif\n"                           \
+                         :                                    \
+                         : __VA_ARGS__)
+
+#define CPUCOM_PROBE2(name, a1, a2) \
+    CPUCOM_PROBE_ASM(name, "8@%0 8@%1", CPUCOM_PROBE_ARG(a1), CPUCOM_PROBE_ARG(a2))
+#define CPUCOM_PROBE3(name, a1, a2, a3)                                                   \
+    CPUCOM_PROBE_ASM(name, "8@%0 8@%1 8@%2", CPUCOM_PROBE_ARG(a1), CPUCOM_PROBE_ARG(a2), \
+                     CPUCOM_PROBE_ARG(a3))
+#define CPUCOM_PROBE4(name, a1, a2, a3, a4)                                                    \
+    CPUCOM_PROBE_ASM(name, "8@%0 8@%1 8@%2 8@%3", CPUCOM_PROBE_ARG(a1), CPUCOM_PROBE_ARG(a2), \
+                     CPUCOM_PROBE_ARG(a3), CPUCOM_PROBE_ARG(a4))
+
+#else
+
+// the arguments are still compiled, so that they keep building either way
+#define CPUCOM_PROBE2(name, a1, a2) \
+    do {                            \
+        (void)(a1);                 \
+        (void)(a2);                 \
+    } while (false)
+#define CPUCOM_PROBE3(name, a1, a2, a3) \
+    do {                                \
+        (void)(a1);                     \
+        CPUCOM_PROBE2(name, a2, a3);    \
+    } while (false)
+#define CPUCOM_PROBE4(name, a1, a2, a3, a4) \
+    do {                                    \
+        (void)(a1);                         \
+        CPUCOM_PROBE3(name, a2, a3, a4);    \
+    } while (false)
+
+#endif  // CPUCOM_PROBES
+
+namespace com {
+namespace mitsubishielectric {
+namespace ahu {
+namespace cpucom {
+namespace impl {
+
+// command argument of the probes
+inline uint64_t probeCommand(uint8_t command, uint8_t subcommand)
+{
+    return (static_cast<uint64_t>(command) << 8) | subcommand;
+}
+
+}  // namespace impl
+}  // namespace cpucom
+}  // namespace ahu
+}  // namespace mitsubishielectric
+}  // namespace com
+
+#endif  // COM_MITSUBISHIELECTRIC_AHU_CPUCOM_PROBES_H_
@@ -0,0 +1,94 @@
+/*
+ * COPYRIGHT (C) 2024 MITSUBISHI ELECTRIC CORPORATION
+ * ALL RIGHTS RESERVED
+ */
+
+#ifndef COM_MITSUBISHIELECTRIC_AHU_CPUCOM_SENDTRACE_H_
+#define COM_MITSUBISHIELECTRIC_AHU_CPUCOM_SENDTRACE_H_
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace com {
+namespace mitsubishielectric {
+namespace ahu {
+namespace cpucom {
+
+/**
+ * Times at which a command sent by v2::ICpuCom::sendTraced() passed each hop on its way
+ * to the V-CPU. They are ns of CLOCK_MONOTONIC, which the client and cpucomdaemon share,
+ * so the differences between them are the latencies of the hops.
+ */
+struct SendTrace {
+    enum Hop : uint8_t {
+        ClientEnqueue = 0,         // sendTraced() was called
+        DaemonReceive,             // cpucomdaemon got the command from the socket
+        TransmitDequeue,           // the transmit thread took it from the queue
+        EnquirySent,               // the first ENQ offering it was written to the UART
+        Acknowledgement2Received,  // the V-CPU acknowledged its last frame
+        DeliveryStatusSent,        // cpucomdaemon answered the client
+        HopCount,
+    };
+
+    uint64_t sequence = 0;           // unique among the traces of all clients
+    uint64_t stamps[HopCount] = {};  // 0 for a hop which was not reached
+
+    // ns from hop from to hop to, 0 if either of them was not reached
+    uint64_t latency(Hop from, Hop to) const;
+};
+
+/**
+ * Times at which a message notified to v2::ICpuCom::subscribeStamped() was read from the
+ * UART, in ns of CLOCK_MONOTONIC like the stamps of SendTrace. How far the time the callback
+ * runs is behind frameChecked is the delay of cpucomdaemon and of the client together.
+ */
+struct ReceiveStamps {
+    uint64_t frameStart = 0;    // STX of its first frame was read
+    uint64_t frameChecked = 0;  // the checksum of its last frame was found correct
+
+    // ns from frameChecked to now, 0 if it was not stamped
+    uint64_t age() const;
+};
+
+namespace impl {
+
+constexpr size_t kSendTraceSize = sizeof(uint64_t) * (1 + SendTrace::HopCount);
+
+// time as stamped in SendTrace, 0 for the epoch of the steady clock
+uint64_t toSendTraceStamp(std::chrono::steady_clock::time_point time);
+
+// now as stamped in SendTrace
+uint64_t monotonicNow();
+
+// sequence for a new SendTrace, the pid of the process in the upper 32 bits
+uint64_t nextSendTraceSequence();
+
+/**
+ * Encodes trace to be carried by a message, as kSendTraceSize little endian bytes.
+ */
+std::vector<uint8_t> encodeSendTrace(const SendTrace& trace);
+
+/**
+ * @return false if data was not encoded by encodeSendTrace(), trace is not changed then
+ */
+bool decodeSendTrace(const std::vector<uint8_t>& data, SendTrace& trace);
+
+constexpr size_t kReceiveStampsSize = sizeof(uint64_t) * 2;
+
+// encodes stamps to be carried by a notification, as kReceiveStampsSize little endian bytes
+std::vector<uint8_t> encodeReceiveStamps(const ReceiveStamps& stamps);
+
+/**
+ * @return false if data was not encoded by encodeReceiveStamps(), stamps are not changed then
+ */
+bool decodeReceiveStamps(const std::vector<uint8_t>& data, ReceiveStamps& stamps);
+
+}  // namespace impl
+}  // namespace cpucom
+}  // namespace ahu
+}  // namespace mitsubishielectric
+}  // namespace com
+
+#endif  // COM_MITSUBISHIELECTRIC_AHU_CPUCOM_SENDTRACE_H_
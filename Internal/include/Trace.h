@@ -0,0 +1,209 @@
+/*
+ * COPYRIGHT (C) 2024 MITSUBISHI ELECTRIC CORPORATION
+ * ALL RIGHTS RESERVED
+ */
+
+#ifndef COM_MITSUBISHIELECTRIC_AHU_CPUCOM_TRACE_H_
+#define COM_MITSUBISHIELECTRIC_AHU_CPUCOM_TRACE_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <iosfwd>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace com {
+namespace mitsubishielectric {
+namespace ahu {
+namespace cpucom {
+namespace impl {
+
+constexpr size_t kTraceArgCount = 4;
+constexpr size_t kTracePayloadSize = 44;
+
+enum class TracePayload : uint8_t {
+    None,
+    Bytes,  // printed in hex
+    Text,
+    Id,  // the 16 bytes of a UUID
+};
+
+/**
+ * A log message traced in binary: the LogID of its format in the LogdogFormat tables with
+ * the numbers for it, and the first bytes of its data. Formatted offline by
+ * cpucom_trace_decoder.
+ */
+struct TraceRecord {
+    uint64_t timestamp;  // ns of the steady clock
+    uint32_t thread;     // number of the ring
+    uint16_t functionID;
+    uint16_t logID;
+    uint64_t args[kTraceArgCount];
+    uint16_t length;  // of the payload traced, of which up to kTracePayloadSize bytes are kept
+    uint8_t argCount;
+    TracePayload payloadType;
+    uint8_t payload[kTracePayloadSize];
+};
+static_assert(sizeof(TraceRecord) == 96, "trace records are written as they are");
+
+/**
+ * The records traced by one thread. The oldest ones are overwritten once it is full.
+ * Written without locks by its thread, read by snapshot() from any thread meanwhile.
+ */
+class TraceRing {
+public:
+    static constexpr size_t kCapacity = 1024;  // a power of two
+
+    explicit TraceRing(uint32_t thread);
+
+    void write(uint16_t functionID,
+               uint16_t logID,
+               std::initializer_list<uint64_t> args,
+               TracePayload payloadType,
+               const void* payload,
+               size_t length);
+
+    /**
+     * @param records gets the records in the ring appended, the oldest first; those being
+     *        overwritten meanwhile are left out
+     */
+    void snapshot(std::vector<TraceRecord>& records) const;
+
+    /**
+     * Calls visit with each record of snapshot() instead, allocating nothing.
+     */
+    template <typename Visit>
+    void forEach(Visit visit) const;
+
+    uint32_t thread() const;
+
+    /**
+     * Takes the ring for the calling thread.
+     * @return false if another thread has it
+     */
+    bool take();
+    void release();
+
+private:
+    struct Slot {
+        std::atomic<uint64_t> sequence;  // odd while written
+        TraceRecord record;
+    };
+
+    const uint32_t m_thread;
+    std::atomic_bool m_owned;
+    std::unique_ptr<Slot[]> m_slots;
+    std::atomic<uint64_t> m_head;
+};
+
+/**
+ * The ring of the calling thread, taken on its first trace. The rings of threads which
+ * ended are given to new threads with the records left in them.
+ */
+TraceRing& threadTraceRing();
+
+/**
+ * Writes the records of all the rings, the oldest first.
+ */
+void writeTrace(std::ostream& stream);
+
+/**
+ * Writes the records of all the rings to fd like writeTrace(), ring after ring rather than
+ * the oldest first. Takes no lock and allocates nothing, so that the handler of a fatal
+ * signal can call it.
+ * @return false if fd could not be written
+ */
+bool writeTraceFromSignal(int fd);
+
+/**
+ * Reads records written by writeTrace() or writeTraceFromSignal().
+ * @return false if stream does not hold a trace
+ */
+bool readTrace(std::istream& stream, std::vector<TraceRecord>& records);
+
+template <typename Visit>
+void TraceRing::forEach(Visit visit) const
+{
+    const uint64_t head = m_head.load(std::memory_order_acquire);
+    const uint64_t first = (head > kCapacity) ? (head - kCapacity) : 0;
+    for (uint64_t position = first; position < head; ++position) {
+        const Slot& slot = m_slots[position & (kCapacity - 1)];
+        const uint64_t sequence = slot.sequence.load(std::memory_order_acquire);
+        if (sequence != ((position * 2) + 2)) {
+            continue;  // overwritten already
+        }
+        const TraceRecord record = slot.record;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load(std::memory_order_relaxed) == sequence) {
+            visit(record);
+        }
+    }
+}
+
+/**
+ * Traces logID of functionID with up to kTraceArgCount numbers for its format.
+ */
+template <typename FunctionID, typename LogID>
+void trace(FunctionID functionID, LogID logID, std::initializer_list<uint64_t> args = {})
+{
+    threadTraceRing().write(static_cast<uint16_t>(functionID), static_cast<uint16_t>(logID),
+                            args, TracePayload::None, nullptr, 0);
+}
+
+/**
+ * Traces logID with data, of which the first kTracePayloadSize bytes are kept.
+ */
+template <typename FunctionID, typename LogID>
+void trace(FunctionID functionID,
+           LogID logID,
+           std::initializer_list<uint64_t> args,
+           const std::vector<uint8_t>& data)
+{
+    threadTraceRing().write(static_cast<uint16_t>(functionID), static_cast<uint16_t>(logID),
+                            args, TracePayload::Bytes, data.data(), data.size());
+}
+
+namespace detail {
+
+// an id of 16 plain bytes is traced as it is
+template <typename Id>
+typename std::enable_if<std::is_trivially_copyable<Id>::value && (sizeof(Id) == 16)>::type
+traceId(uint16_t functionID, uint16_t logID, std::initializer_list<uint64_t> args, const Id& id)
+{
+    threadTraceRing().write(functionID, logID, args, TracePayload::Id, &id, sizeof(id));
+}
+
+template <typename Id>
+typename std::enable_if<!(std::is_trivially_copyable<Id>::value && (sizeof(Id) == 16))>::type
+traceId(uint16_t functionID, uint16_t logID, std::initializer_list<uint64_t> args, const Id& id)
+{
+    const std::string text = id.toString();
+    threadTraceRing().write(functionID, logID, args, TracePayload::Text, text.data(),
+                            text.size());
+}
+
+}  // namespace detail
+
+/**
+ * Traces logID with a UUID, printed for the %s of its format.
+ */
+template <typename FunctionID, typename LogID, typename Id>
+void traceId(FunctionID functionID,
+             LogID logID,
+             std::initializer_list<uint64_t> args,
+             const Id& id)
+{
+    detail::traceId(static_cast<uint16_t>(functionID), static_cast<uint16_t>(logID), args, id);
+}
+
+}  // namespace impl
+}  // namespace cpucom
+}  // namespace ahu
+}  // namespace mitsubishielectric
+}  // namespace com
+
+#endif  // COM_MITSUBISHIELECTRIC_AHU_CPUCOM_TRACE_H_
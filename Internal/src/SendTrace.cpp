@@ -0,0 +1,117 @@
+/*
+ * COPYRIGHT (C) 2024 MITSUBISHI ELECTRIC CORPORATION
+ * ALL RIGHTS RESERVED
+ */
+
+#include "SendTrace.h"
+
+#include <unistd.h>
+
+#include <atomic>
+
+namespace com {
+namespace mitsubishielectric {
+namespace ahu {
+namespace cpucom {
+namespace impl {
+
+namespace {
+
+void putValue(std::vector<uint8_t>& data, uint64_t value)
+{
+    for (size_t i = 0; i < sizeof(value); ++i) {
+        data.push_back(static_cast<uint8_t>(value >> (8 * i)));
+    }
+}
+
+uint64_t getValue(const uint8_t* data)
+{
+    uint64_t value = 0;
+    for (size_t i = 0; i < sizeof(value); ++i) {
+        value |= static_cast<uint64_t>(data[i]) << (8 * i);
+    }
+    return value;
+}
+
+}  // namespace
+
+uint64_t toSendTraceStamp(std::chrono::steady_clock::time_point time)
+{
+    // the steady clock is CLOCK_MONOTONIC on Linux
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count());
+}
+
+uint64_t monotonicNow() { return toSendTraceStamp(std::chrono::steady_clock::now()); }
+
+uint64_t nextSendTraceSequence()
+{
+    static std::atomic<uint32_t> next(0);
+    return (static_cast<uint64_t>(::getpid()) << 32) | ++next;
+}
+
+std::vector<uint8_t> encodeSendTrace(const SendTrace& trace)
+{
+    std::vector<uint8_t> data;
+    data.reserve(kSendTraceSize);
+    putValue(data, trace.sequence);
+    for (uint64_t stamp : trace.stamps) {
+        putValue(data, stamp);
+    }
+    return data;
+}
+
+bool decodeSendTrace(const std::vector<uint8_t>& data, SendTrace& trace)
+{
+    if (data.size() != kSendTraceSize) {
+        return false;
+    }
+    trace.sequence = getValue(&data[0]);
+    for (size_t hop = 0; hop < SendTrace::HopCount; ++hop) {
+        trace.stamps[hop] = getValue(&data[sizeof(uint64_t) * (1 + hop)]);
+    }
+    return true;
+}
+
+std::vector<uint8_t> encodeReceiveStamps(const ReceiveStamps& stamps)
+{
+    std::vector<uint8_t> data;
+    data.reserve(kReceiveStampsSize);
+    putValue(data, stamps.frameStart);
+    putValue(data, stamps.frameChecked);
+    return data;
+}
+
+bool decodeReceiveStamps(const std::vector<uint8_t>& data, ReceiveStamps& stamps)
+{
+    if (data.size() != kReceiveStampsSize) {
+        return false;
+    }
+    stamps.frameStart = getValue(&data[0]);
+    stamps.frameChecked = getValue(&data[sizeof(uint64_t)]);
+    return true;
+}
+
+}  // namespace impl
+
+uint64_t SendTrace::latency(Hop from, Hop to) const
+{
+    if ((stamps[from] == 0) || (stamps[to] < stamps[from])) {
+        return 0;
+    }
+    return stamps[to] - stamps[from];
+}
+
+uint64_t ReceiveStamps::age() const
+{
+    const uint64_t now = impl::monotonicNow();
+    if ((frameChecked == 0) || (now < frameChecked)) {
+        return 0;
+    }
+    return now - frameChecked;
+}
+
+}  // namespace cpucom
+}  // namespace ahu
+}  // namespace mitsubishielectric
+}  // namespace com
@@ -0,0 +1,258 @@
+/*
+ * COPYRIGHT (C) 2024 MITSUBISHI ELECTRIC CORPORATION
+ * ALL RIGHTS RESERVED
+ */
+
+#include "Trace.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <istream>
+#include <mutex>
+#include <ostream>
+
+#include <unistd.h>
+
+namespace com {
+namespace mitsubishielectric {
+namespace ahu {
+namespace cpucom {
+namespace impl {
+
+namespace {
+
+const char kTraceMagic[8] = {'C', 'P', 'U', 'C', 'T', 'R', 'C', '1'};
+
+struct TraceHeader {
+    char magic[sizeof(kTraceMagic)];
+    uint32_t recordSize;
+    uint32_t recordCount;
+};
+
+class TraceRings {
+public:
+    static TraceRings& instance()
+    {
+        // never destroyed, threads may trace while the process exits
+        static TraceRings* rings = new TraceRings();
+        return *rings;
+    }
+
+    std::shared_ptr<TraceRing> take()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (const std::shared_ptr<TraceRing>& ring : m_rings) {
+            if (ring->take()) {
+                return ring;
+            }
+        }
+        m_rings.push_back(std::make_shared<TraceRing>(static_cast<uint32_t>(m_rings.size())));
+        m_rings.back()->take();
+        // published complete, for a signal handler which may interrupt this
+        m_published.store(new Published{m_rings.back().get(), m_published.load()},
+                          std::memory_order_release);
+        return m_rings.back();
+    }
+
+    void snapshot(std::vector<TraceRecord>& records)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (const std::shared_ptr<TraceRing>& ring : m_rings) {
+            ring->snapshot(records);
+        }
+    }
+
+    // the rings, read without the lock, the newest first
+    template <typename Visit>
+    void forEachRing(Visit visit) const
+    {
+        for (const Published* published = m_published.load(std::memory_order_acquire);
+             published != nullptr; published = published->next) {
+            visit(*published->ring);
+        }
+    }
+
+private:
+    // never freed, like the rings
+    struct Published {
+        const TraceRing* ring;
+        const Published* next;
+    };
+
+    std::mutex m_mutex;
+    std::vector<std::shared_ptr<TraceRing>> m_rings;
+    std::atomic<const Published*> m_published{nullptr};
+};
+
+// write() all of size bytes, as long as it writes some of them
+bool writeFully(int fd, const void* data, size_t size)
+{
+    const char* bytes = static_cast<const char*>(data);
+    while (size > 0) {
+        const ssize_t written = ::write(fd, bytes, size);
+        if (written <= 0) {
+            if ((written < 0) && (errno == EINTR)) {
+                continue;
+            }
+            return false;
+        }
+        bytes += written;
+        size -= static_cast<size_t>(written);
+    }
+    return true;
+}
+
+// gives the ring of a thread back when it ends
+class TraceRingOwner {
+public:
+    TraceRingOwner()
+        : m_ring(TraceRings::instance().take())
+    {
+    }
+
+    ~TraceRingOwner() { m_ring->release(); }
+
+    TraceRing& ring() { return *m_ring; }
+
+private:
+    std::shared_ptr<TraceRing> m_ring;
+};
+
+}  // namespace
+
+constexpr size_t TraceRing::kCapacity;
+
+TraceRing::TraceRing(uint32_t thread)
+    : m_thread(thread)
+    , m_owned(false)
+    , m_slots(new Slot[kCapacity]())
+    , m_head(0)
+{
+}
+
+void TraceRing::write(uint16_t functionID,
+                      uint16_t logID,
+                      std::initializer_list<uint64_t> args,
+                      TracePayload payloadType,
+                      const void* payload,
+                      size_t length)
+{
+    const uint64_t position = m_head.load(std::memory_order_relaxed);
+    Slot& slot = m_slots[position & (kCapacity - 1)];
+    slot.sequence.store((position * 2) + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    TraceRecord& record = slot.record;
+    record.timestamp = static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch())
+            .count());
+    record.thread = m_thread;
+    record.functionID = functionID;
+    record.logID = logID;
+    record.argCount = static_cast<uint8_t>(std::min(args.size(), kTraceArgCount));
+    std::copy_n(args.begin(), record.argCount, record.args);
+    record.payloadType = payloadType;
+    record.length = static_cast<uint16_t>(std::min<size_t>(length, UINT16_MAX));
+    if (length > 0) {
+        std::memcpy(record.payload, payload, std::min(length, kTracePayloadSize));
+    }
+
+    slot.sequence.store((position * 2) + 2, std::memory_order_release);
+    m_head.store(position + 1, std::memory_order_release);
+}
+
+void TraceRing::snapshot(std::vector<TraceRecord>& records) const
+{
+    forEach([&records](const TraceRecord& record) { records.push_back(record); });
+}
+
+uint32_t TraceRing::thread() const { return m_thread; }
+
+bool TraceRing::take()
+{
+    bool owned = false;
+    return m_owned.compare_exchange_strong(owned, true);
+}
+
+void TraceRing::release() { m_owned = false; }
+
+TraceRing& threadTraceRing()
+{
+    thread_local TraceRingOwner owner;
+    return owner.ring();
+}
+
+void writeTrace(std::ostream& stream)
+{
+    std::vector<TraceRecord> records;
+    TraceRings::instance().snapshot(records);
+    std::stable_sort(records.begin(), records.end(),
+                     [](const TraceRecord& a, const TraceRecord& b) {
+                         return a.timestamp < b.timestamp;
+                     });
+
+    TraceHeader header = {};
+    std::memcpy(header.magic, kTraceMagic, sizeof(kTraceMagic));
+    header.recordSize = sizeof(TraceRecord);
+    header.recordCount = static_cast<uint32_t>(records.size());
+    stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    stream.write(reinterpret_cast<const char*>(records.data()),
+                 static_cast<std::streamsize>(records.size() * sizeof(TraceRecord)));
+}
+
+bool writeTraceFromSignal(int fd)
+{
+    // the count is written once known, after the records
+    TraceHeader header = {};
+    std::memcpy(header.magic, kTraceMagic, sizeof(kTraceMagic));
+    header.recordSize = sizeof(TraceRecord);
+    if (!writeFully(fd, &header, sizeof(header))) {
+        return false;
+    }
+
+    TraceRecord buffer[32];
+    size_t buffered = 0;
+    bool written = true;
+    TraceRings::instance().forEachRing([&](const TraceRing& ring) {
+        ring.forEach([&](const TraceRecord& record) {
+            buffer[buffered++] = record;
+            ++header.recordCount;
+            if (buffered == (sizeof(buffer) / sizeof(buffer[0]))) {
+                written = written && writeFully(fd, buffer, sizeof(buffer));
+                buffered = 0;
+            }
+        });
+    });
+    written = written && writeFully(fd, buffer, buffered * sizeof(TraceRecord));
+    return written && (::lseek(fd, 0, SEEK_SET) == 0) && writeFully(fd, &header, sizeof(header));
+}
+
+bool readTrace(std::istream& stream, std::vector<TraceRecord>& records)
+{
+    TraceHeader header = {};
+    if (!stream.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+        (std::memcmp(header.magic, kTraceMagic, sizeof(kTraceMagic)) != 0) ||
+        (header.recordSize != sizeof(TraceRecord))) {
+        return false;
+    }
+    if (header.recordCount == 0) {
+        return true;
+    }
+    const size_t first = records.size();
+    records.resize(first + header.recordCount);
+    if (!stream.read(reinterpret_cast<char*>(&records[first]),
+                     static_cast<std::streamsize>(header.recordCount * sizeof(TraceRecord)))) {
+        records.resize(first);
+        return false;
+    }
+    return true;
+}
+
+}  // namespace impl
+}  // namespace cpucom
+}  // namespace ahu
+}  // namespace mitsubishielectric
+}  // namespace com
@@ -12,7 +12,9 @@
 #include <memory>
 #include <vector>
 
+#include "CpuComError.h"
 #include "CpuCommand.h"
+#include "SendTrace.h"
 
 namespace com {
 namespace mitsubishielectric {
@@ -29,6 +31,7 @@ public:
 class ICpuCommandErrorListener {
 public:
     virtual ~ICpuCommandErrorListener() = default;
+    // errorCode is a common::Error, or ERR_THROTTLED when the client is over its quota
     virtual void onError(const common::CpuCommand& command, int errorCode) = 0;
 };
 
@@ -63,14 +66,27 @@ public:
     virtual std::vector<uint8_t> data() = 0;
     virtual void wait() = 0;
     virtual std::future_status wait_for(const std::chrono::milliseconds& timeout_duration) = 0;
+    /**
+     * Waits like wait() and tells whether cpucomdaemon gave up waiting for the response,
+     * in which case data() is empty. A response which cannot time out just waits.
+     */
+    virtual bool timedOut()
+    {
+        wait();
+        return false;
+    }
 };
 
 class ICpuCom {
 public:
     using OnCommand = std::function<void(common::CpuCommand, std::vector<uint8_t>)>;
+    using OnStampedCommand =
+        std::function<void(common::CpuCommand, std::vector<uint8_t>, ReceiveStamps)>;
+    // errorCode is a common::Error, or ERR_THROTTLED when the client is over its quota
     using OnSendCommandError = std::function<void(common::CpuCommand, int errorCode)>;
     using OnConnectionClosed = std::function<void()>;
     using DeliveryStatusCallback = std::function<void(bool)>;
+    using DeliveryTraceCallback = std::function<void(bool, SendTrace)>;
 
 public:
     static std::unique_ptr<ICpuCom> create();
@@ -86,14 +102,50 @@ public:
     virtual void send(common::CpuCommand command,
                       std::vector<uint8_t> data,
                       DeliveryStatusCallback deliveryStatusCallback) = 0;
+    /**
+     * Sends like send() with a DeliveryStatusCallback and also gets the SendTrace of the
+     * command, stamped at each hop on its way to the V-CPU and back. An implementation which
+     * does not trace sends with the delivery status alone, and no hop of the trace is stamped.
+     */
+    virtual void sendTraced(common::CpuCommand command,
+                            std::vector<uint8_t> data,
+                            DeliveryTraceCallback deliveryTraceCallback)
+    {
+        send(std::move(command), std::move(data), [deliveryTraceCallback](bool result) {
+            deliveryTraceCallback(result, SendTrace());
+        });
+    }
     virtual std::unique_ptr<ICpuComResponse> request(common::CpuCommand requestCommand,
                                                      std::vector<uint8_t> requestData,
                                                      common::CpuCommand responseCommand) = 0;
 
     virtual void subscribe(common::CpuCommand command, OnCommand callback) = 0;
     virtual void subscribe(std::list<common::CpuCommand> commands, OnCommand callback) = 0;
+    /**
+     * Subscribes like subscribe() and also gets the ReceiveStamps of each message, telling
+     * when it arrived from the V-CPU, e.g. to find how stale it is when the callback runs.
+     * An implementation which does not stamp subscribes with subscribe(), and every message
+     * is delivered as not stamped.
+     */
+    virtual void subscribeStamped(common::CpuCommand command, OnStampedCommand callback)
+    {
+        subscribe(std::move(command), unstamped(std::move(callback)));
+    }
+    virtual void subscribeStamped(std::list<common::CpuCommand> commands,
+                                  OnStampedCommand callback)
+    {
+        subscribe(std::move(commands), unstamped(std::move(callback)));
+    }
     virtual void unsubscribe(common::CpuCommand command) = 0;
     virtual void unsubscribe(std::list<common::CpuCommand> commands) = 0;
+
+private:
+    static OnCommand unstamped(OnStampedCommand callback)
+    {
+        return [callback](common::CpuCommand command, std::vector<uint8_t> data) {
+            callback(std::move(command), std::move(data), ReceiveStamps());
+        };
+    }
 };
 }  // namespace v2
 
@@ -35,6 +35,8 @@ enum LogID {
     NotificationsThreadFunctionPoolHup,
     NotificationsThreadFunctionPoolHupStopFd,
     NotificationsThreadFunctionStopRequest,
+    SendTraced,
+    RequestTimedOut,
 };
 
 void InitializeLibCpuComLogMessages();
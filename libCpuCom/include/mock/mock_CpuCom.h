@@ -46,6 +46,7 @@ public:
     MOCK_METHOD0(data, std::vector<uint8_t>());
     MOCK_METHOD0(wait, void());
     MOCK_METHOD1(wait_for, std::future_status(const std::chrono::milliseconds& timeout_duration));
+    MOCK_METHOD0(timedOut, bool());
 };
 
 class mock_ICpuCom : public ICpuCom {
@@ -59,12 +60,19 @@ public:
                  void(common::CpuCommand command,
                       std::vector<uint8_t> data,
                       DeliveryStatusCallback deliveryStatusCallback));
+    MOCK_METHOD3(sendTraced,
+                 void(common::CpuCommand command,
+                      std::vector<uint8_t> data,
+                      DeliveryTraceCallback deliveryTraceCallback));
     MOCK_METHOD3(request,
                  std::unique_ptr<ICpuComResponse>(common::CpuCommand requestCommand,
                                                   std::vector<uint8_t> requestData,
                                                   common::CpuCommand responseCommand));
     MOCK_METHOD2(subscribe, void(common::CpuCommand command, OnCommand callback));
     MOCK_METHOD2(subscribe, void(std::list<common::CpuCommand> commands, OnCommand callback));
+    MOCK_METHOD2(subscribeStamped, void(common::CpuCommand command, OnStampedCommand callback));
+    MOCK_METHOD2(subscribeStamped,
+                 void(std::list<common::CpuCommand> commands, OnStampedCommand callback));
     MOCK_METHOD1(unsubscribe, void(common::CpuCommand command));
     MOCK_METHOD1(unsubscribe, void(std::list<common::CpuCommand> commands));
 };
@@ -13,7 +13,9 @@
 
 #include "Log.h"
 #include "Pack.h"
+#include "Probes.h"
 #include "Socket.h"
+#include "Trace.h"
 #include "message/CpuComMessenger.h"
 
 namespace com {
@@ -44,9 +46,12 @@ std::unique_ptr<ICpuCom> ICpuCom::create()
     return std::make_unique<CpuCom>(std::move(messenger));
 }
 
-CpuComResponse::CpuComResponse(std::future<std::vector<uint8_t>>&& f, std::function<void()> deleter)
+CpuComResponse::CpuComResponse(std::future<std::vector<uint8_t>>&& f,
+                               std::function<void()> deleter,
+                               std::shared_ptr<const std::atomic_bool> timedOut)
     : m_future(new (std::nothrow) std::future<std::vector<uint8_t>>(std::move(f)))
     , m_deleter(deleter)
+    , m_timedOut(std::move(timedOut))
 {
 }
 
@@ -67,6 +72,15 @@ std::future_status CpuComResponse::wait_for(const std::chrono::milliseconds& tim
     return m_future->wait_for(timeout_duration);
 }
 
+bool CpuComResponse::timedOut()
+{
+    // data() took the value of the future already
+    if (m_future->valid()) {
+        m_future->wait();
+    }
+    return m_timedOut && *m_timedOut;
+}
+
 CpuCom::CpuCom(std::unique_ptr<impl::IMessenger> messenger)
     : m_messenger(std::move(messenger))
 {
@@ -78,7 +92,7 @@ CpuCom::CpuCom(std::unique_ptr<impl::IMessenger> messenger)
             canceled = count > 0;
         }
         if (canceled) {
-            MLOGD(common::FunctionID::cpuc_lib, LogID::CancelRequest, id.toString());
+            impl::traceId(common::FunctionID::cpuc_lib, LogID::CancelRequest, {}, id);
             m_messenger->sendCancelRequestMessage(std::move(id));
         }
     };
@@ -92,7 +106,7 @@ CpuCom::~CpuCom()
     std::lock_guard<std::mutex> lock(m_requestsMutex);
     for (auto& request : m_requests) {
         std::vector<uint8_t> empty;
-        request.second.set_value(empty);
+        request.second.response.set_value(empty);
     }
 }
 
@@ -121,7 +135,9 @@ bool CpuCom::initialize(OnSendCommandError errorCallback, OnConnectionClosed onC
     m_messenger->setSendCommandResultMessageHandler(&CpuCom::onSendCommandResult, this);
     m_messenger->setNotificationMessageHandler(&CpuCom::onNotification, this);
     m_messenger->setRequestResponseMessageHandler(&CpuCom::onRequestResponse, this);
+    m_messenger->setRequestTimeoutMessageHandler(&CpuCom::onRequestTimeout, this);
     m_messenger->setDeliveryStatusMessageHandler(&CpuCom::onDeliveryStatus, this);
+    m_messenger->setDeliveryTraceMessageHandler(&CpuCom::onDeliveryTrace, this);
 
     return initialized;
 }
@@ -132,7 +148,8 @@ void CpuCom::disconnect() { m_messenger->disconnect(); }
 
 void CpuCom::send(CpuCommand command, std::vector<uint8_t> data)
 {
-    MLOGD(common::FunctionID::cpuc_lib, LogID::Send, command.first, command.second);
+    impl::trace(common::FunctionID::cpuc_lib, LogID::Send, {command.first, command.second});
+    CPUCOM_PROBE2(client_send, impl::probeCommand(command.first, command.second), data.size());
     m_messenger->sendSendCommandMessage(std::move(command), std::move(data));
 }
 
@@ -145,12 +162,33 @@ void CpuCom::send(common::CpuCommand command,
     m_deliveryStatusCallbacks.insert(std::make_pair(id, deliveryStatusCallback));
     lock.unlock();
 
-    MLOGD(common::FunctionID::cpuc_lib, LogID::SendWithDeliveryConfirmation, command.first,
-          command.second, id.toString());
+    impl::traceId(common::FunctionID::cpuc_lib, LogID::SendWithDeliveryConfirmation,
+                  {command.first, command.second}, id);
+    CPUCOM_PROBE2(client_send, impl::probeCommand(command.first, command.second), data.size());
     m_messenger->sendSendCommandWithDeliveryStatusMessage(std::move(id), std::move(command),
                                                           std::move(data));
 }
 
+void CpuCom::sendTraced(common::CpuCommand command,
+                        std::vector<uint8_t> data,
+                        DeliveryTraceCallback deliveryTraceCallback)
+{
+    SendTrace trace;
+    trace.sequence = impl::nextSendTraceSequence();
+    trace.stamps[SendTrace::ClientEnqueue] = impl::monotonicNow();
+
+    UUID id;
+    std::unique_lock<std::mutex> lock(m_deliveryTraceCallbacksMutex);
+    m_deliveryTraceCallbacks.insert(std::make_pair(id, deliveryTraceCallback));
+    lock.unlock();
+
+    impl::traceId(common::FunctionID::cpuc_lib, LogID::SendTraced,
+                  {command.first, command.second, trace.sequence}, id);
+    CPUCOM_PROBE2(client_send, impl::probeCommand(command.first, command.second), data.size());
+    m_messenger->sendSendCommandWithTraceMessage(std::move(id), std::move(command),
+                                                 std::move(data), impl::encodeSendTrace(trace));
+}
+
 std::unique_ptr<ICpuComResponse> CpuCom::request(CpuCommand requestCommand,
                                                  std::vector<uint8_t> requestData,
                                                  CpuCommand responseCommand)
@@ -164,20 +202,41 @@ std::unique_ptr<ICpuComResponse> CpuCom::request(CpuCommand requestCommand,
         }
     };
 
-    std::promise<std::vector<uint8_t>> result;
-    std::unique_ptr<ICpuComResponse> response =
-        std::make_unique<CpuComResponse>(result.get_future(), cleanup);
+    PendingRequest pending = {std::promise<std::vector<uint8_t>>(),
+                              std::make_shared<std::atomic_bool>(false)};
+    std::unique_ptr<ICpuComResponse> response = std::make_unique<CpuComResponse>(
+        pending.response.get_future(), cleanup, pending.timedOut);
     std::unique_lock<std::mutex> lock(m_requestsMutex);
-    m_requests.insert(std::make_pair(id, std::move(result)));
+    m_requests.insert(std::make_pair(id, std::move(pending)));
     lock.unlock();
 
-    MLOGD(common::FunctionID::cpuc_lib, LogID::Request, id.toString());
+    impl::traceId(common::FunctionID::cpuc_lib, LogID::Request, {}, id);
+    CPUCOM_PROBE2(client_send, impl::probeCommand(requestCommand.first, requestCommand.second),
+                  requestData.size());
     m_messenger->sendRequestMessage(std::move(id), std::move(requestCommand),
                                     std::move(requestData), std::move(responseCommand));
     return response;
 }
 
 void CpuCom::subscribe(CpuCommand command, OnCommand callback)
+{
+    OnStampedCommand stamped;
+    if (callback) {
+        stamped = [callback](CpuCommand command, std::vector<uint8_t> data, ReceiveStamps) {
+            callback(std::move(command), std::move(data));
+        };
+    }
+    subscribeStamped(std::move(command), std::move(stamped));
+}
+
+void CpuCom::subscribe(std::list<common::CpuCommand> commands, OnCommand callback)
+{
+    for (auto i = commands.begin(); i != commands.end(); ++i) {
+        subscribe(*i, callback);
+    }
+}
+
+void CpuCom::subscribeStamped(CpuCommand command, OnStampedCommand callback)
 {
     std::unique_lock<std::mutex> lock(m_callbacksMutex);
     bool result = m_callbacks.find(command) == m_callbacks.end();
@@ -188,10 +247,10 @@ void CpuCom::subscribe(CpuCommand command, OnCommand callback)
     }
 }
 
-void CpuCom::subscribe(std::list<common::CpuCommand> commands, OnCommand callback)
+void CpuCom::subscribeStamped(std::list<common::CpuCommand> commands, OnStampedCommand callback)
 {
     for (auto i = commands.begin(); i != commands.end(); ++i) {
-        subscribe(*i, callback);
+        subscribeStamped(*i, callback);
     }
 }
 
@@ -211,10 +270,12 @@ void CpuCom::unsubscribe(std::list<common::CpuCommand> commands)
     }
 }
 
-void CpuCom::onNotification(CpuCommand command, std::vector<uint8_t> data)
+void CpuCom::onNotification(CpuCommand command,
+                            std::vector<uint8_t> data,
+                            std::vector<uint8_t> stamps)
 {
-    MLOGD(common::FunctionID::cpuc_lib, LogID::Receive, command.first, command.second);
-    OnCommand callback;
+    impl::trace(common::FunctionID::cpuc_lib, LogID::Receive, {command.first, command.second});
+    OnStampedCommand callback;
     {
         std::lock_guard<std::mutex> lock(m_callbacksMutex);
         auto c = m_callbacks.find(command);
@@ -223,7 +284,12 @@ void CpuCom::onNotification(CpuCommand command, std::vector<uint8_t> data)
         }
     }
     if (callback) {
-        callback(std::move(command), std::move(data));
+        // stamps which can not be decoded are left 0, as not stamped
+        ReceiveStamps receiveStamps;
+        impl::decodeReceiveStamps(stamps, receiveStamps);
+        CPUCOM_PROBE3(client_notification, impl::probeCommand(command.first, command.second),
+                      data.size(), receiveStamps.frameChecked);
+        callback(std::move(command), std::move(data), receiveStamps);
     }
 }
 
@@ -237,20 +303,33 @@ void CpuCom::onSendCommandResult(CpuCommand command, int result)
 
 void CpuCom::onRequestResponse(UUID id, std::vector<uint8_t> data)
 {
-    MLOGD(common::FunctionID::cpuc_lib, LogID::Response, id.toString());
+    impl::traceId(common::FunctionID::cpuc_lib, LogID::Response, {}, id);
     std::lock_guard<std::mutex> lock(m_requestsMutex);
     auto i = m_requests.find(id);
     bool found = (i != m_requests.end());
     if (found) {
-        i->second.set_value(data);
-        MLOGD(common::FunctionID::cpuc_lib, LogID::ResponseDelivered, id.toString());
+        i->second.response.set_value(data);
+        impl::traceId(common::FunctionID::cpuc_lib, LogID::ResponseDelivered, {}, id);
     }
     else {
-        MLOGD(common::FunctionID::cpuc_lib, LogID::ResponseDropped, id.toString());
+        impl::traceId(common::FunctionID::cpuc_lib, LogID::ResponseDropped, {}, id);
     }
     m_requests.erase(id);
 }
 
+void CpuCom::onRequestTimeout(UUID id)
+{
+    impl::traceId(common::FunctionID::cpuc_lib, LogID::RequestTimedOut, {}, id);
+    std::lock_guard<std::mutex> lock(m_requestsMutex);
+    auto i = m_requests.find(id);
+    if (i != m_requests.end()) {
+        // the flag is set before the value wakes the caller
+        i->second.timedOut->store(true);
+        i->second.response.set_value(std::vector<uint8_t>());
+        m_requests.erase(i);
+    }
+}
+
 void CpuCom::onDeliveryStatus(UUID id, bool status)
 {
     std::unique_lock<std::mutex> lock(m_deliveryStatusCallbacksMutex);
@@ -259,11 +338,30 @@ void CpuCom::onDeliveryStatus(UUID id, bool status)
     lock.unlock();
 
     if (callback) {
-        MLOGD(common::FunctionID::cpuc_lib, LogID::DeliveryStatusProvided, id.toString());
+        impl::traceId(common::FunctionID::cpuc_lib, LogID::DeliveryStatusProvided, {}, id);
         callback(status);
     }
     else {
-        MLOGD(common::FunctionID::cpuc_lib, LogID::DeliveryStatusDropped, id.toString());
+        impl::traceId(common::FunctionID::cpuc_lib, LogID::DeliveryStatusDropped, {}, id);
+    }
+}
+
+void CpuCom::onDeliveryTrace(UUID id, bool status, std::vector<uint8_t> encodedTrace)
+{
+    std::unique_lock<std::mutex> lock(m_deliveryTraceCallbacksMutex);
+    DeliveryTraceCallback callback = m_deliveryTraceCallbacks[id];
+    m_deliveryTraceCallbacks.erase(id);
+    lock.unlock();
+
+    if (callback) {
+        SendTrace trace;
+        // a trace which can not be decoded is given without stamps, the status still counts
+        impl::decodeSendTrace(encodedTrace, trace);
+        impl::traceId(common::FunctionID::cpuc_lib, LogID::DeliveryStatusProvided, {}, id);
+        callback(status, trace);
+    }
+    else {
+        impl::traceId(common::FunctionID::cpuc_lib, LogID::DeliveryStatusDropped, {}, id);
     }
 }
 
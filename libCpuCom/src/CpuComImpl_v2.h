@@ -8,6 +8,7 @@
 
 #include "CpuCom.h"
 
+#include <atomic>
 #include <map>
 #include <memory>
 #include <mutex>
@@ -29,7 +30,10 @@ namespace v2 {
 
 class CpuComResponse final : public ICpuComResponse {
 public:
-    explicit CpuComResponse(std::future<std::vector<uint8_t>>&& f, std::function<void()> deleter);
+    // timedOut is set before the future is made ready, if cpucomdaemon gives up on the request
+    explicit CpuComResponse(std::future<std::vector<uint8_t>>&& f,
+                            std::function<void()> deleter,
+                            std::shared_ptr<const std::atomic_bool> timedOut = nullptr);
     ~CpuComResponse();
 
     std::vector<uint8_t> data() override;
@@ -38,9 +42,12 @@ public:
 
     std::future_status wait_for(const std::chrono::milliseconds& timeout_duration) override;
 
+    bool timedOut() override;
+
 private:
     std::unique_ptr<std::future<std::vector<uint8_t>>> m_future;
     std::function<void()> m_deleter;
+    std::shared_ptr<const std::atomic_bool> m_timedOut;
 };
 
 class CpuCom : public ICpuCom {
@@ -57,33 +64,51 @@ public:
     virtual void send(common::CpuCommand command,
                       std::vector<uint8_t> data,
                       DeliveryStatusCallback deliveryStatusCallback) override;
+    virtual void sendTraced(common::CpuCommand command,
+                            std::vector<uint8_t> data,
+                            DeliveryTraceCallback deliveryTraceCallback) override;
     virtual std::unique_ptr<ICpuComResponse> request(common::CpuCommand requestCommand,
                                                      std::vector<uint8_t> requestData,
                                                      common::CpuCommand responseCommand) override;
     virtual void subscribe(common::CpuCommand command, OnCommand callback) override;
     virtual void subscribe(std::list<common::CpuCommand> commands, OnCommand callback) override;
+    virtual void subscribeStamped(common::CpuCommand command, OnStampedCommand callback) override;
+    virtual void subscribeStamped(std::list<common::CpuCommand> commands,
+                                  OnStampedCommand callback) override;
     virtual void unsubscribe(common::CpuCommand command) override;
     virtual void unsubscribe(std::list<common::CpuCommand> commands) override;
 
-    void onNotification(common::CpuCommand command, std::vector<uint8_t> data);
+    void onNotification(common::CpuCommand command,
+                        std::vector<uint8_t> data,
+                        std::vector<uint8_t> stamps);
     void onSendCommandResult(common::CpuCommand command, int result);
     void onRequestResponse(common::UUID id, std::vector<uint8_t> data);
+    void onRequestTimeout(common::UUID id);
     void onDeliveryStatus(common::UUID id, bool status);
+    void onDeliveryTrace(common::UUID id, bool status, std::vector<uint8_t> trace);
 
 private:
     OnSendCommandError m_errorCallback;
     OnConnectionClosed m_onConnectionClosed;
 
-    std::map<common::CpuCommand, OnCommand> m_callbacks;
+    // callbacks of subscribe() are wrapped to drop the stamps
+    std::map<common::CpuCommand, OnStampedCommand> m_callbacks;
     std::mutex m_callbacksMutex;
 
-    std::map<common::UUID, std::promise<std::vector<uint8_t>>> m_requests;
+    struct PendingRequest {
+        std::promise<std::vector<uint8_t>> response;
+        std::shared_ptr<std::atomic_bool> timedOut;
+    };
+    std::map<common::UUID, PendingRequest> m_requests;
     std::mutex m_requestsMutex;
     std::shared_ptr<std::function<void(common::UUID)>> m_cancelFunc;
 
     std::map<common::UUID, DeliveryStatusCallback> m_deliveryStatusCallbacks;
     std::mutex m_deliveryStatusCallbacksMutex;
 
+    std::map<common::UUID, DeliveryTraceCallback> m_deliveryTraceCallbacks;
+    std::mutex m_deliveryTraceCallbacksMutex;
+
     std::unique_ptr<impl::IMessenger> m_messenger;
 };
 
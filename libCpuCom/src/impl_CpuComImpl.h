@@ -209,7 +209,8 @@ public:
     {
         CpuCommand command;
         std::vector<uint8_t> commandData;
-        if (unpack(data, command, commandData) == data.cend()) {
+        std::vector<uint8_t> stamps;  // ReceiveStamps, which ICpuCommandListener does not take
+        if (unpack(data, command, commandData, stamps) == data.cend()) {
             std::list<ICpuCommandListener*> listeners;
             {
                 std::unique_lock<std::mutex> lock(m_listenersMutex);
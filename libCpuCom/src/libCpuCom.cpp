@@ -12,6 +12,7 @@ namespace ahu {
 namespace cpucom {
 
 using common::DisplayTypeDecInt32;
+using common::DisplayTypeDecUInt64;
 using common::DisplayTypeHexUInt8;
 using common::DisplayTypeString;
 
@@ -42,6 +43,8 @@ void InitializeLibCpuComLogMessages()
         {LogID::NotificationsThreadFunctionPoolHup,     "NotificationsThreadFunction: Received POOLHUP\n"},
         {LogID::NotificationsThreadFunctionPoolHupStopFd, "NotificationsThreadFunction: Received POOLHUP. StopFd\n"},
         {LogID::NotificationsThreadFunctionStopRequest, "NotificationsThreadFunction: Stop request\n"},
+        {LogID::SendTraced,                       "Send [%02x,%02x] traced as %lu id = %s\n", {DisplayTypeHexUInt8("Command"), DisplayTypeHexUInt8("Subcommand"), DisplayTypeDecUInt64("Sequence"), DisplayTypeString(36, "Request ID")}},
+        {LogID::RequestTimedOut,                  "Request timed out  %s\n", {DisplayTypeString(36, "Request ID")}},
 
     };
     // clang-format on
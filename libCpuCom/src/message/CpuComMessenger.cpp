@@ -55,12 +55,24 @@ void CpuComMessenger::setRequestResponseMessageHandler(OnRequestResponseHandler
     mMessenger->setMessageHandler(CpuComId::RequestResponse, handler, cpuCom);
 }
 
+void CpuComMessenger::setRequestTimeoutMessageHandler(OnRequestTimeoutHandler handler,
+                                                      v2::CpuCom* cpuCom)
+{
+    mMessenger->setMessageHandler(CpuComId::RequestTimeout, handler, cpuCom);
+}
+
 void CpuComMessenger::setDeliveryStatusMessageHandler(OnDeliveryStatusHandler handler,
                                                       v2::CpuCom* cpuCom)
 {
     mMessenger->setMessageHandler(CpuComId::DeliveryStatus, handler, cpuCom);
 }
 
+void CpuComMessenger::setDeliveryTraceMessageHandler(OnDeliveryTraceHandler handler,
+                                                     v2::CpuCom* cpuCom)
+{
+    mMessenger->setMessageHandler(CpuComId::DeliveryTrace, handler, cpuCom);
+}
+
 void CpuComMessenger::sendCancelRequestMessage(common::UUID uuid)
 {
     mMessenger->sendMessage(CpuComId::CancelRequest, std::move(uuid));
@@ -89,6 +101,15 @@ void CpuComMessenger::sendSendCommandWithDeliveryStatusMessage(common::UUID uuid
                             std::move(command), std::move(data));
 }
 
+void CpuComMessenger::sendSendCommandWithTraceMessage(common::UUID uuid,
+                                                      common::CpuCommand command,
+                                                      std::vector<uint8_t> data,
+                                                      std::vector<uint8_t> trace)
+{
+    mMessenger->sendMessage(CpuComId::SendCommandWithTrace, std::move(uuid), std::move(command),
+                            std::move(data), std::move(trace));
+}
+
 void CpuComMessenger::sendRequestMessage(common::UUID uuid,
                                          common::CpuCommand requestCommand,
                                          std::vector<uint8_t> data,
@@ -44,9 +44,15 @@ public:
     void setRequestResponseMessageHandler(OnRequestResponseHandler handler,
                                           v2::CpuCom* cpuCom) override;
 
+    void setRequestTimeoutMessageHandler(OnRequestTimeoutHandler handler,
+                                         v2::CpuCom* cpuCom) override;
+
     void setDeliveryStatusMessageHandler(OnDeliveryStatusHandler handler,
                                          v2::CpuCom* cpuCom) override;
 
+    void setDeliveryTraceMessageHandler(OnDeliveryTraceHandler handler,
+                                        v2::CpuCom* cpuCom) override;
+
     void sendCancelRequestMessage(common::UUID uuid) override;
 
     void sendSubscribeMessage(common::CpuCommand command) override;
@@ -59,6 +65,11 @@ public:
                                                   common::CpuCommand command,
                                                   std::vector<uint8_t> data) override;
 
+    void sendSendCommandWithTraceMessage(common::UUID uuid,
+                                         common::CpuCommand command,
+                                         std::vector<uint8_t> data,
+                                         std::vector<uint8_t> trace) override;
+
     void sendRequestMessage(common::UUID uuid,
                             common::CpuCommand requestCommand,
                             std::vector<uint8_t> data,
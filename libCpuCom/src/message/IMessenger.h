@@ -42,7 +42,10 @@ public:
     virtual void setSendCommandResultMessageHandler(OnSendCommandResultHandler handler,
                                                     v2::CpuCom* cpuCom) = 0;
 
-    using OnNotificationHandler = void (v2::CpuCom::*)(common::CpuCommand, std::vector<uint8_t>);
+    // the stamps are ReceiveStamps as encoded by encodeReceiveStamps()
+    using OnNotificationHandler = void (v2::CpuCom::*)(common::CpuCommand,
+                                                       std::vector<uint8_t>,
+                                                       std::vector<uint8_t>);
     virtual void setNotificationMessageHandler(OnNotificationHandler handler,
                                                v2::CpuCom* cpuCom) = 0;
 
@@ -50,10 +53,18 @@ public:
     virtual void setRequestResponseMessageHandler(OnRequestResponseHandler handler,
                                                   v2::CpuCom* cpuCom) = 0;
 
+    using OnRequestTimeoutHandler = void (v2::CpuCom::*)(common::UUID);
+    virtual void setRequestTimeoutMessageHandler(OnRequestTimeoutHandler handler,
+                                                 v2::CpuCom* cpuCom) = 0;
+
     using OnDeliveryStatusHandler = void (v2::CpuCom::*)(common::UUID, bool);
     virtual void setDeliveryStatusMessageHandler(OnDeliveryStatusHandler handler,
                                                  v2::CpuCom* cpuCom) = 0;
 
+    using OnDeliveryTraceHandler = void (v2::CpuCom::*)(common::UUID, bool, std::vector<uint8_t>);
+    virtual void setDeliveryTraceMessageHandler(OnDeliveryTraceHandler handler,
+                                                v2::CpuCom* cpuCom) = 0;
+
     virtual void sendCancelRequestMessage(common::UUID uuid) = 0;
 
     virtual void sendSubscribeMessage(common::CpuCommand command) = 0;
@@ -66,6 +77,12 @@ public:
                                                           common::CpuCommand command,
                                                           std::vector<uint8_t> data) = 0;
 
+    // trace is a SendTrace as encoded by encodeSendTrace()
+    virtual void sendSendCommandWithTraceMessage(common::UUID uuid,
+                                                 common::CpuCommand command,
+                                                 std::vector<uint8_t> data,
+                                                 std::vector<uint8_t> trace) = 0;
+
     virtual void sendRequestMessage(common::UUID uuid,
                                     common::CpuCommand requestCommand,
                                     std::vector<uint8_t> data,
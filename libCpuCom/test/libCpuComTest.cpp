@@ -102,11 +102,13 @@ public:
         , m_testNotificationCommand1(std::make_pair(0x13, 0x31))
         , m_testNotificationMessage1(
               CpuComId::Notification,
-              pack(m_testNotificationCommand1, std::vector<uint8_t>({0x01, 0x02, 0x03, 0x04})))
+              pack(m_testNotificationCommand1, std::vector<uint8_t>({0x01, 0x02, 0x03, 0x04}),
+                   encodeReceiveStamps(ReceiveStamps())))
         , m_testNotificationCommand2(std::make_pair(0x02, 0x04))
         , m_testNotificationData2({0x10, 0x20, 0x30, 0x40})
         , m_testNotificationMessage2(CpuComId::Notification,
-                                     pack(m_testNotificationCommand2, m_testNotificationData2))
+                                     pack(m_testNotificationCommand2, m_testNotificationData2,
+                                          encodeReceiveStamps(ReceiveStamps())))
         , m_testNotificationCommandSizeNotCorrectMessage(
               CpuComId::Notification,
               pack(m_testNotificationCommand1, std::vector<uint8_t>()))
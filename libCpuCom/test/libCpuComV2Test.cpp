@@ -35,6 +35,15 @@ public:
         m_sendUuid = uuid;
     }
 
+    void sendSendCommandWithTraceMessage(common::UUID uuid,
+                                         common::CpuCommand command,
+                                         std::vector<uint8_t> data,
+                                         std::vector<uint8_t> trace) override
+    {
+        MockIMessenger::sendSendCommandWithTraceMessage(uuid, command, data, trace);
+        m_sendUuid = uuid;
+    }
+
     void sendRequestMessage(common::UUID uuid,
                             common::CpuCommand requestCommand,
                             std::vector<uint8_t> data,
@@ -152,6 +161,26 @@ TEST_F(libCpuComV2Test, createCpuComResponseTest)
     EXPECT_EQ(response->data(), data);
 }
 
+TEST_F(libCpuComV2Test, responseWithoutTimeoutTest)
+{
+    // a response implemented before timedOut() was added
+    class Response : public v2::ICpuComResponse {
+    public:
+        std::vector<uint8_t> data() override { return std::vector<uint8_t>(); }
+        void wait() override { ++waits; }
+        std::future_status wait_for(const std::chrono::milliseconds&) override
+        {
+            return std::future_status::ready;
+        }
+
+        int waits = 0;
+    };
+    Response response;
+
+    EXPECT_FALSE(response.timedOut());
+    EXPECT_EQ(1, response.waits);
+}
+
 TEST_F(libCpuComV2Test, subscribeAndInitializeTest)
 {
     auto messenger = std::make_unique<NiceMock<MockIMessenger>>();
@@ -174,7 +203,9 @@ TEST_F(libCpuComV2Test, subscribeAndInitializeTest)
     EXPECT_CALL(*messengerRaw, setSendCommandResultMessageHandler(_, &cpucom)).Times(2);
     EXPECT_CALL(*messengerRaw, setNotificationMessageHandler(_, &cpucom)).Times(2);
     EXPECT_CALL(*messengerRaw, setRequestResponseMessageHandler(_, &cpucom)).Times(2);
+    EXPECT_CALL(*messengerRaw, setRequestTimeoutMessageHandler(_, &cpucom)).Times(2);
     EXPECT_CALL(*messengerRaw, setDeliveryStatusMessageHandler(_, &cpucom)).Times(2);
+    EXPECT_CALL(*messengerRaw, setDeliveryTraceMessageHandler(_, &cpucom)).Times(2);
 
     cpucom.subscribe(m_testSubscribeCommand1, m_testCommandCallback);
     cpucom.initialize(m_testSendCommandErrorCallback, connectionClosedCallback);
@@ -323,10 +354,75 @@ TEST_F(libCpuComV2Test, onNotificationTest)
 
     v2::CpuCom cpucom{std::move(messenger)};
 
-    cpucom.onNotification(m_testNotificationCommand, m_testNotificationMessageData);
+    cpucom.onNotification(m_testNotificationCommand, m_testNotificationMessageData, {});
+
+    cpucom.subscribe(m_testNotificationCommand, m_testCommandCallback);
+    cpucom.onNotification(m_testNotificationCommand, m_testNotificationMessageData, {});
+}
+
+TEST_F(libCpuComV2Test, onStampedNotificationTest)
+{
+    auto messenger = std::make_unique<NiceMock<MockIMessenger>>();
+    NiceMock<MockIMessenger>* messengerRaw = messenger.get();
+
+    EXPECT_CALL(*messengerRaw, sendSubscribeMessage(m_testNotificationCommand)).Times(1);
+
+    v2::CpuCom cpucom{std::move(messenger)};
 
+    ReceiveStamps sent;
+    sent.frameStart = 1000;
+    sent.frameChecked = 2000;
+    int calls = 0;
+    ReceiveStamps received;
+    cpucom.subscribeStamped(m_testNotificationCommand,
+                            [&](common::CpuCommand command, std::vector<uint8_t> data,
+                                ReceiveStamps stamps) {
+                                EXPECT_EQ(m_testNotificationCommand, command);
+                                EXPECT_EQ(m_testNotificationMessageData, data);
+                                received = stamps;
+                                ++calls;
+                            });
+    // subscribing again keeps the first callback
     cpucom.subscribe(m_testNotificationCommand, m_testCommandCallback);
-    cpucom.onNotification(m_testNotificationCommand, m_testNotificationMessageData);
+
+    cpucom.onNotification(m_testNotificationCommand, m_testNotificationMessageData,
+                          encodeReceiveStamps(sent));
+    EXPECT_EQ(1, calls);
+    EXPECT_EQ(sent.frameStart, received.frameStart);
+    EXPECT_EQ(sent.frameChecked, received.frameChecked);
+    EXPECT_GT(received.age(), 0u);
+
+    // stamps which can not be decoded are delivered as not stamped
+    cpucom.onNotification(m_testNotificationCommand, m_testNotificationMessageData, {0x01});
+    EXPECT_EQ(2, calls);
+    EXPECT_EQ(0u, received.frameChecked);
+}
+
+TEST_F(libCpuComV2Test, subscribeStampedWithoutStampingTest)
+{
+    auto messenger = std::make_unique<NiceMock<MockIMessenger>>();
+    NiceMock<MockIMessenger>* messengerRaw = messenger.get();
+
+    EXPECT_CALL(*messengerRaw, sendSubscribeMessage(m_testNotificationCommand)).Times(1);
+
+    v2::CpuCom cpucom{std::move(messenger)};
+
+    ReceiveStamps sent;
+    sent.frameChecked = 2000;
+    int calls = 0;
+    // what an implementation which does not override subscribeStamped() does
+    cpucom.v2::ICpuCom::subscribeStamped(
+        std::list<common::CpuCommand>{m_testNotificationCommand},
+        [&](common::CpuCommand command, std::vector<uint8_t> data, ReceiveStamps stamps) {
+            EXPECT_EQ(m_testNotificationCommand, command);
+            EXPECT_EQ(m_testNotificationMessageData, data);
+            EXPECT_EQ(0u, stamps.frameChecked);
+            ++calls;
+        });
+
+    cpucom.onNotification(m_testNotificationCommand, m_testNotificationMessageData,
+                          encodeReceiveStamps(sent));
+    EXPECT_EQ(1, calls);
 }
 
 TEST_F(libCpuComV2Test, onSendCommandResultTest)
@@ -364,6 +460,28 @@ TEST_F(libCpuComV2Test, onRequestResponseTest)
     cpucom.onRequestResponse(id, data);
 }
 
+TEST_F(libCpuComV2Test, onRequestTimeoutTest)
+{
+    auto messenger = std::make_unique<NiceMock<MockUUIDMessenger>>();
+    NiceMock<MockUUIDMessenger>* messengerRaw = messenger.get();
+
+    v2::CpuCom cpucom{std::move(messenger)};
+
+    auto answered =
+        cpucom.request(m_testRequestCommand1, m_testRequestMessageData, m_testResponseCommand);
+    cpucom.onRequestResponse(messengerRaw->getRequestUuid(), m_testRequestMessageData);
+    EXPECT_EQ(m_testRequestMessageData, answered->data());
+    EXPECT_FALSE(answered->timedOut());
+
+    auto expired =
+        cpucom.request(m_testRequestCommand2, m_testRequestMessageData, m_testResponseCommand);
+    cpucom.onRequestTimeout(messengerRaw->getRequestUuid());
+    EXPECT_TRUE(expired->timedOut());
+    EXPECT_TRUE(expired->data().empty());
+    // a response after the timeout finds the request gone
+    cpucom.onRequestResponse(messengerRaw->getRequestUuid(), m_testRequestMessageData);
+}
+
 TEST_F(libCpuComV2Test, onDeliveryStatusTest)
 {
     auto messenger = std::make_unique<NiceMock<MockUUIDMessenger>>();
@@ -386,6 +504,67 @@ TEST_F(libCpuComV2Test, onDeliveryStatusTest)
     cpucom.onDeliveryStatus(id, status);
 }
 
+TEST_F(libCpuComV2Test, onDeliveryTraceTest)
+{
+    auto messenger = std::make_unique<NiceMock<MockUUIDMessenger>>();
+    NiceMock<MockUUIDMessenger>* messengerRaw = messenger.get();
+
+    std::vector<uint8_t> encodedTrace;
+    EXPECT_CALL(*messengerRaw, sendSendCommandWithTraceMessage(_, _, _, _))
+        .WillOnce(SaveArg<3>(&encodedTrace));
+
+    v2::CpuCom cpucom{std::move(messenger)};
+
+    int calls = 0;
+    SendTrace delivered;
+    cpucom.sendTraced(m_testSendCommandWithDeliveryStatusCommand1,
+                      m_testSendCommandWithDeliveryStatusMessageData,
+                      [&calls, &delivered](bool status, SendTrace trace) {
+                          EXPECT_TRUE(status);
+                          delivered = trace;
+                          ++calls;
+                      });
+
+    SendTrace sent;
+    ASSERT_TRUE(decodeSendTrace(encodedTrace, sent));
+    EXPECT_NE(0u, sent.stamps[SendTrace::ClientEnqueue]);
+    EXPECT_EQ(0u, sent.stamps[SendTrace::DaemonReceive]);
+
+    // as stamped by the daemon
+    sent.stamps[SendTrace::DaemonReceive] = sent.stamps[SendTrace::ClientEnqueue] + 5000;
+    const common::UUID id = messengerRaw->getSendUuid();
+    cpucom.onDeliveryTrace(id, true, encodeSendTrace(sent));
+    cpucom.onDeliveryTrace(id, true, encodeSendTrace(sent));
+
+    EXPECT_EQ(1, calls);
+    EXPECT_EQ(sent.sequence, delivered.sequence);
+    EXPECT_EQ(5000u, delivered.latency(SendTrace::ClientEnqueue, SendTrace::DaemonReceive));
+}
+
+TEST_F(libCpuComV2Test, sendTracedWithoutTracingTest)
+{
+    auto messenger = std::make_unique<NiceMock<MockUUIDMessenger>>();
+    NiceMock<MockUUIDMessenger>* messengerRaw = messenger.get();
+
+    EXPECT_CALL(*messengerRaw, sendSendCommandWithDeliveryStatusMessage(_, _, _));
+    EXPECT_CALL(*messengerRaw, sendSendCommandWithTraceMessage(_, _, _, _)).Times(0);
+
+    v2::CpuCom cpucom{std::move(messenger)};
+
+    int calls = 0;
+    // what an implementation which does not override sendTraced() does
+    cpucom.v2::ICpuCom::sendTraced(m_testSendCommandWithDeliveryStatusCommand1,
+                                   m_testSendCommandWithDeliveryStatusMessageData,
+                                   [&calls](bool status, SendTrace trace) {
+                                       EXPECT_TRUE(status);
+                                       EXPECT_EQ(0u, trace.stamps[SendTrace::ClientEnqueue]);
+                                       ++calls;
+                                   });
+    cpucom.onDeliveryStatus(messengerRaw->getSendUuid(), true);
+
+    EXPECT_EQ(1, calls);
+}
+
 }  // namespace impl
 }  // namespace cpucom
 }  // namespace ahu
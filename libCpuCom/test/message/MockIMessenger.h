@@ -25,7 +25,9 @@ public:
     MOCK_METHOD2(setSendCommandResultMessageHandler, void(OnSendCommandResultHandler, v2::CpuCom*));
     MOCK_METHOD2(setNotificationMessageHandler, void(OnNotificationHandler, v2::CpuCom*));
     MOCK_METHOD2(setRequestResponseMessageHandler, void(OnRequestResponseHandler, v2::CpuCom*));
+    MOCK_METHOD2(setRequestTimeoutMessageHandler, void(OnRequestTimeoutHandler, v2::CpuCom*));
     MOCK_METHOD2(setDeliveryStatusMessageHandler, void(OnDeliveryStatusHandler, v2::CpuCom*));
+    MOCK_METHOD2(setDeliveryTraceMessageHandler, void(OnDeliveryTraceHandler, v2::CpuCom*));
 
     MOCK_METHOD1(sendCancelRequestMessage, void(common::UUID));
     MOCK_METHOD1(sendSubscribeMessage, void(common::CpuCommand));
@@ -33,6 +35,11 @@ public:
     MOCK_METHOD2(sendSendCommandMessage, void(common::CpuCommand, std::vector<uint8_t>));
     MOCK_METHOD3(sendSendCommandWithDeliveryStatusMessage,
                  void(common::UUID, common::CpuCommand, std::vector<uint8_t>));
+    MOCK_METHOD4(sendSendCommandWithTraceMessage,
+                 void(common::UUID,
+                      common::CpuCommand,
+                      std::vector<uint8_t>,
+                      std::vector<uint8_t>));
     MOCK_METHOD4(sendRequestMessage,
                  void(common::UUID, common::CpuCommand, std::vector<uint8_t>, common::CpuCommand));
 };
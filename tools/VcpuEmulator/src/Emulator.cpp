@@ -5,6 +5,7 @@
 
 #include "Emulator.h"
 
+#include <chrono>
 #include <fstream>
 #include <iomanip>
 #include <iterator>
@@ -106,6 +107,28 @@ void Emulator::stoprepeat()
     m_repeaters.clear();
 }
 
+void Emulator::throughput(const CpuCommand& command, uint32_t size, uint32_t count)
+{
+    auto measure = [this, command, size, count]() {
+        const std::vector<uint8_t> data(size, 0x55);
+        uint32_t sent = 0;
+        const auto start = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < count; ++i) {
+            if (m_mcpu->write(command, data)) {
+                ++sent;
+            }
+        }
+        const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - start);
+        const uint64_t bytes = static_cast<uint64_t>(sent) * size;
+        const uint64_t rate = (elapsed.count() > 0) ? (bytes * 1000 / 1024) / elapsed.count() : 0;
+        MLOGD_SERIAL("[emulator]", "Throughput %u/%u x %u bytes in %lld ms - %llu KB/s\n", sent,
+                     count, size, static_cast<long long>(elapsed.count()),
+                     static_cast<unsigned long long>(rate));
+    };
+    m_workerThread->push(measure);
+}
+
 void Emulator::mcpuThreadFunction()
 {
     using namespace std::placeholders;
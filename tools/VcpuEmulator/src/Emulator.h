@@ -45,6 +45,7 @@ public:
                 std::chrono::milliseconds interval);
     void stoprepeat(const std::string& name);
     void stoprepeat();
+    void throughput(const common::CpuCommand& command, uint32_t size, uint32_t count);
 
 private:
     void mcpuThreadFunction();
@@ -74,12 +74,14 @@ int main()
     DeviceConfigureEmulatorSocket configureEmulatorSocket(emulatorDevice);
     auto device = std::make_unique<MasterDevice>(kVCPUEmulatorSocketName, configureEmulatorSocket);
     auto protocol = std::make_unique<Protocol>(std::move(device));
+    protocol->setPipelinedDivision(true);
     auto mcpu = std::make_shared<CPU>(std::move(protocol), impl::kAddressMCPU);
 
     impl::UARTDevice uartDevice;
     DeviceConfigureUART configureUART(uartDevice);
     auto vcpudevice = std::make_unique<IODevice>(kUartDeviceName, configureUART);
     auto vcpuprotocol = std::make_unique<Protocol>(std::move(vcpudevice));
+    vcpuprotocol->setPipelinedDivision(true);
     auto vcpu = std::make_shared<CPU>(std::move(vcpuprotocol), impl::kAddressVCPU);
 
     auto rulesBuilder = std::make_unique<RulesBuilder>(mcpu, vcpu);
@@ -146,6 +148,27 @@ int main()
                         }
                     }
                 }
+                else if (what == "throughput") {
+                    // throughput <command> <payload size> <count>
+                    if (tokens.size() >= 3) {
+                        std::string commandString = tokens.front();
+                        tokens.pop_front();
+                        std::pair<uint8_t, uint8_t> command;
+                        bool commandParsed = commandFromString(commandString, command);
+                        std::string sizeString = tokens.front();
+                        tokens.pop_front();
+                        std::string countString = tokens.front();
+                        tokens.pop_front();
+                        auto isNumber = [](const std::string& s) {
+                            return !s.empty() && std::all_of(s.begin(), s.end(),
+                                                             [](char c) { return std::isdigit(c); });
+                        };
+                        if (commandParsed && isNumber(sizeString) && isNumber(countString)) {
+                            emulator->throughput(command, stoi(sizeString, 0, 10),
+                                                 stoi(countString, 0, 10));
+                        }
+                    }
+                }
                 else if (what == "stoprepeat") {
                     if (!tokens.empty()) {
                         std::string name = tokens.front();
@@ -85,6 +85,34 @@ int main()
             TEST_FAILED;
         }
     }
+    {
+        START_TEST("Send test with trace");
+
+        std::promise<SendTrace> p;
+        auto f = p.get_future();
+
+        client->sendTraced(requestCommand, requestData, [&p](bool status, SendTrace trace) {
+            std::cout << "delivered: " << status << std::endl;
+            p.set_value(trace);
+        });
+
+        if (f.wait_for(3s) == std::future_status::ready) {
+            const SendTrace trace = f.get();
+            const char* const hops[] = {"client->daemon", "queued", "dequeue->ENQ", "ENQ->ACK2",
+                                        "ACK2->status"};
+            for (uint8_t hop = SendTrace::ClientEnqueue; hop < SendTrace::DeliveryStatusSent;
+                 ++hop) {
+                std::cout << std::setw(16) << hops[hop] << ": "
+                          << trace.latency(static_cast<SendTrace::Hop>(hop),
+                                           static_cast<SendTrace::Hop>(hop + 1)) /
+                                 1000
+                          << " us" << std::endl;
+            }
+        }
+        else {
+            TEST_FAILED;
+        }
+    }
     {
         START_TEST("Wait for delivery confirmation");
         {